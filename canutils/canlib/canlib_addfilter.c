@@ -0,0 +1,93 @@
+/****************************************************************************
+ * canutils/canlib/canlib_addfilter.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/ioctl.h>
+
+#include <stdbool.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Name: canlib_addfilter
+ *
+ * Description:
+ *   Wrapper for CANIOC_ADD_STDFILTER and CANIOC_ADD_EXTFILTER.
+ *
+ * Input Parameter:
+ *   fd     - file descriptor of an opened can device
+ *   filter - the filter to add
+ *
+ * Returned Value:
+ *   A non-negative filter ID is returned on success.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the nature of the
+ *   error.
+ *
+ ****************************************************************************/
+
+int canlib_addfilter(int fd, FAR const struct canlib_filter_s *filter)
+{
+  int ret;
+
+  if (filter->extended)
+    {
+#ifdef CONFIG_CAN_EXTID
+      struct canioc_extfilter_s xfilter;
+
+      xfilter.xf_id1  = filter->id;
+      xfilter.xf_id2  = filter->mask;
+      xfilter.xf_type = CAN_FILTER_MASK;
+      xfilter.xf_prio = CAN_MSGPRIO_HIGH;
+
+      ret = ioctl(fd, CANIOC_ADD_EXTFILTER, (unsigned long)&xfilter);
+      if (ret < 0)
+        {
+          canerr("CANIOC_ADD_EXTFILTER failed, errno=%d\n", errno);
+        }
+#else
+      set_errno(EINVAL);
+      ret = ERROR;
+#endif
+    }
+  else
+    {
+      struct canioc_stdfilter_s sfilter;
+
+      sfilter.sf_id1  = filter->id;
+      sfilter.sf_id2  = filter->mask;
+      sfilter.sf_type = CAN_FILTER_MASK;
+      sfilter.sf_prio = CAN_MSGPRIO_HIGH;
+
+      ret = ioctl(fd, CANIOC_ADD_STDFILTER, (unsigned long)&sfilter);
+      if (ret < 0)
+        {
+          canerr("CANIOC_ADD_STDFILTER failed, errno=%d\n", errno);
+        }
+    }
+
+  return ret;
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+ * canutils/canlib/canlib_delfilter.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/ioctl.h>
+
+#include <stdbool.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Name: canlib_delfilter
+ *
+ * Description:
+ *   Wrapper for CANIOC_DEL_STDFILTER and CANIOC_DEL_EXTFILTER.
+ *
+ * Input Parameter:
+ *   fd       - file descriptor of an opened can device
+ *   extended - the filter matches 29-bit IDs
+ *   filterid - the filter ID returned by canlib_addfilter()
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the
+ *   nature of the error.
+ *
+ ****************************************************************************/
+
+int canlib_delfilter(int fd, bool extended, int filterid)
+{
+  int ret;
+
+  if (extended)
+    {
+#ifdef CONFIG_CAN_EXTID
+      ret = ioctl(fd, CANIOC_DEL_EXTFILTER, (unsigned long)filterid);
+      if (ret < 0)
+        {
+          canerr("CANIOC_DEL_EXTFILTER failed, errno=%d\n", errno);
+        }
+#else
+      set_errno(EINVAL);
+      ret = ERROR;
+#endif
+    }
+  else
+    {
+      ret = ioctl(fd, CANIOC_DEL_STDFILTER, (unsigned long)filterid);
+      if (ret < 0)
+        {
+          canerr("CANIOC_DEL_STDFILTER failed, errno=%d\n", errno);
+        }
+    }
+
+  return ret;
+}
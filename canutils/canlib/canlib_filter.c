@@ -0,0 +1,84 @@
+/****************************************************************************
+ * canutils/canlib/canlib_filter.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Name: canlib_filter
+ *
+ * Description:
+ *   Software version of the ID/mask filters, for drivers without filter
+ *   support.  The frames that match none of the filters are removed.
+ *
+ * Input Parameter:
+ *   frames   - the frames to filter
+ *   nframes  - the number of frames
+ *   filters  - the filters
+ *   nfilters - the number of filters
+ *
+ * Returned Value:
+ *   The number of frames kept at the start of "frames".
+ *
+ ****************************************************************************/
+
+size_t canlib_filter(FAR struct canlib_frame_s *frames, size_t nframes,
+                     FAR const struct canlib_filter_s *filters,
+                     int nfilters)
+{
+  FAR const struct canlib_filter_s *filter;
+  size_t nkept = 0;
+  size_t i;
+  int j;
+
+  for (i = 0; i < nframes; i++)
+    {
+      for (j = 0; j < nfilters; j++)
+        {
+          filter = &filters[j];
+          if (filter->extended == frames[i].extended &&
+              ((frames[i].id ^ filter->id) & filter->mask) == 0)
+            {
+              break;
+            }
+        }
+
+      if (j < nfilters)
+        {
+          if (nkept != i)
+            {
+              memcpy(&frames[nkept], &frames[i],
+                     sizeof(struct canlib_frame_s));
+            }
+
+          nkept++;
+        }
+    }
+
+  return nkept;
+}
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * canutils/canlib/canlib_readv.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_CAN_FD
+static const uint8_t g_dlc2bytes[16] =
+{
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64
+};
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: canlib_readv
+ *
+ * Description:
+ *   Read the frames pending in the driver (up to "nframes" and up to
+ *   CONFIG_CANUTILS_CANLIB_NBATCH, or CANLIB_READV_MINFRAMES if that is
+ *   larger) with a single read() and time stamp them.
+ *
+ * Input Parameter:
+ *   fd      - file descriptor of an opened can device
+ *   frames  - buffer for the received frames
+ *   nframes - the size of the buffer in frames, at least
+ *             CANLIB_READV_MINFRAMES
+ *   timeout - the time to wait for a frame in ms (-1 waits forever)
+ *
+ * Returned Value:
+ *   The number of frames received, zero on timeout.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the nature of the
+ *   error: EINVAL if "nframes" is less than CANLIB_READV_MINFRAMES.
+ *
+ ****************************************************************************/
+
+ssize_t canlib_readv(int fd, FAR struct canlib_frame_s *frames,
+                     size_t nframes, int timeout)
+{
+  struct can_msg_s buffer[CONFIG_CANUTILS_CANLIB_NBATCH * CAN_MSGLEN(0) /
+                          sizeof(struct can_msg_s) + 2];
+  FAR struct can_msg_s *msg;
+  FAR struct canlib_frame_s *frame;
+#ifndef CONFIG_CAN_TIMESTAMP
+  struct timespec now;
+#endif
+  struct pollfd fds;
+  ssize_t nbytes;
+  size_t offset;
+  size_t size;
+  size_t len;
+  size_t n;
+  int ret;
+
+  /* The driver returns as many whole messages as fit in the buffer, each
+   * one taking CAN_MSGLEN(data length) bytes.  The buffer is sized for
+   * "nframes" empty messages, so that short messages cannot overflow
+   * "frames" (fewer long messages fit).  It must also have room for one
+   * message of any length, or that message would never be read.
+   */
+
+  if (nframes < CANLIB_READV_MINFRAMES)
+    {
+      errno = EINVAL;
+      return ERROR;
+    }
+
+  if (nframes > CONFIG_CANUTILS_CANLIB_NBATCH)
+    {
+      nframes = CONFIG_CANUTILS_CANLIB_NBATCH;
+      if (nframes < CANLIB_READV_MINFRAMES)
+        {
+          nframes = CANLIB_READV_MINFRAMES;
+        }
+    }
+
+  /* Wait for the first frame.  Without a timeout the read() blocks. */
+
+  if (timeout >= 0)
+    {
+      fds.fd      = fd;
+      fds.events  = POLLIN;
+      fds.revents = 0;
+
+      ret = poll(&fds, 1, timeout);
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            {
+              canerr("poll failed, errno=%d\n", errno);
+            }
+
+          return ret;
+        }
+    }
+
+  size   = nframes * CAN_MSGLEN(0);
+  nbytes = read(fd, buffer, size);
+  if (nbytes < 0)
+    {
+      if (errno == EAGAIN)
+        {
+          return 0;
+        }
+
+      canerr("read failed, errno=%d\n", errno);
+      return ERROR;
+    }
+
+#ifndef CONFIG_CAN_TIMESTAMP
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+  clock_gettime(CLOCK_REALTIME, &now);
+#endif
+#endif
+
+  for (n = 0, offset = 0;
+       n < nframes && offset + CAN_MSGLEN(0) <= (size_t)nbytes;
+       n++, offset += CAN_MSGLEN(len))
+    {
+      msg   = (FAR struct can_msg_s *)((FAR uint8_t *)buffer + offset);
+      frame = &frames[n];
+
+#ifdef CONFIG_CAN_FD
+      len   = g_dlc2bytes[msg->cm_hdr.ch_dlc];
+#else
+      len   = msg->cm_hdr.ch_dlc;
+#endif
+      if (offset + CAN_MSGLEN(len) > (size_t)nbytes)
+        {
+          break;
+        }
+
+#ifdef CONFIG_CAN_TIMESTAMP
+      frame->ts.tv_sec  = msg->cm_hdr.ch_ts.tv_sec;
+      frame->ts.tv_nsec = msg->cm_hdr.ch_ts.tv_usec * 1000;
+#else
+      frame->ts         = now;
+#endif
+      frame->id         = msg->cm_hdr.ch_id;
+      frame->dlc        = msg->cm_hdr.ch_dlc;
+      frame->rtr        = msg->cm_hdr.ch_rtr;
+#ifdef CONFIG_CAN_EXTID
+      frame->extended   = msg->cm_hdr.ch_extid;
+#else
+      frame->extended   = false;
+#endif
+#ifdef CONFIG_CAN_ERRORS
+      frame->error      = msg->cm_hdr.ch_error;
+#else
+      frame->error      = false;
+#endif
+
+      memcpy(frame->data, msg->cm_data, len);
+    }
+
+  return n;
+}
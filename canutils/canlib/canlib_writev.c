@@ -0,0 +1,151 @@
+/****************************************************************************
+ * canutils/canlib/canlib_writev.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_CAN_FD
+static const uint8_t g_dlc2bytes[16] =
+{
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64
+};
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: canlib_writev
+ *
+ * Description:
+ *   Queue several frames for transmission, CONFIG_CANUTILS_CANLIB_NBATCH
+ *   frames per write().
+ *
+ * Input Parameter:
+ *   fd      - file descriptor of an opened can device
+ *   frames  - the frames to send
+ *   nframes - the number of frames
+ *
+ * Returned Value:
+ *   The number of frames queued (less than "nframes" if the device is
+ *   non-blocking and the TX FIFO is full).  Otherwise -1 (ERROR) is
+ *   returned with the errno variable set to indicate the nature of the
+ *   error.
+ *
+ ****************************************************************************/
+
+ssize_t canlib_writev(int fd, FAR const struct canlib_frame_s *frames,
+                      size_t nframes)
+{
+  struct can_msg_s buffer[CONFIG_CANUTILS_CANLIB_NBATCH];
+  FAR struct can_msg_s *msg;
+  FAR const struct canlib_frame_s *frame;
+  ssize_t nbytes;
+  size_t offset;
+  size_t size;
+  size_t nsent = 0;
+  size_t len;
+  size_t n;
+  uint8_t dlc;
+
+  while (nsent < nframes)
+    {
+      /* Pack the next frames the way the driver expects them: each one
+       * takes CAN_MSGLEN() bytes.
+       */
+
+      for (n = 0, offset = 0;
+           n < CONFIG_CANUTILS_CANLIB_NBATCH && nsent + n < nframes;
+           n++, offset += CAN_MSGLEN(len))
+        {
+          msg   = (FAR struct can_msg_s *)((FAR uint8_t *)buffer + offset);
+          frame = &frames[nsent + n];
+
+#ifdef CONFIG_CAN_FD
+          dlc   = frame->dlc & 0xf;
+          len   = g_dlc2bytes[dlc];
+#else
+          dlc   = frame->dlc > CAN_MAXDATALEN ? CAN_MAXDATALEN : frame->dlc;
+          len   = dlc;
+#endif
+
+          memset(&msg->cm_hdr, 0, sizeof(struct can_hdr_s));
+          msg->cm_hdr.ch_id    = frame->id;
+          msg->cm_hdr.ch_dlc   = dlc;
+          msg->cm_hdr.ch_rtr   = frame->rtr;
+#ifdef CONFIG_CAN_EXTID
+          msg->cm_hdr.ch_extid = frame->extended;
+#endif
+          memcpy(msg->cm_data, frame->data, len);
+        }
+
+      size   = offset;
+      nbytes = write(fd, buffer, size);
+      if (nbytes < 0)
+        {
+          if (errno == EAGAIN && nsent > 0)
+            {
+              break;
+            }
+
+          canerr("write failed, errno=%d\n", errno);
+          return ERROR;
+        }
+
+      /* Count the messages that were accepted */
+
+      for (n = 0, offset = 0; offset < (size_t)nbytes; n++)
+        {
+          msg = (FAR struct can_msg_s *)((FAR uint8_t *)buffer + offset);
+#ifdef CONFIG_CAN_FD
+          offset += CAN_MSGLEN(g_dlc2bytes[msg->cm_hdr.ch_dlc]);
+#else
+          offset += CAN_MSGLEN(msg->cm_hdr.ch_dlc);
+#endif
+        }
+
+      nsent += n;
+      if ((size_t)nbytes < size)
+        {
+          break;
+        }
+    }
+
+  return nsent;
+}
@@ -0,0 +1,883 @@
+/****************************************************************************
+ * canutils/libobd2/obd_poll.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/obd.h"
+#include "canutils/obd_pid.h"
+#include "canutils/obd_frame.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Physical addressing of the ECUs (ISO 15765-4).  With 11-bit IDs the
+ * ECU #n answers with 0x7e8 + n and is addressed with 0x7e0 + n.  With
+ * 29-bit IDs the ECU address is the low byte of the response ID.
+ */
+
+#define OBD_STD_NECUS         8
+#define OBD_STD_TXOFFSET      8
+#define OBD_EXT_RXMASK        0x1fffff00
+#define OBD_EXT_RXBASE        0x18daf100
+#define OBD_EXT_TXBASE        0x18da00f1
+
+/* Number of CAN messages taken with each read() */
+
+#define OBD_POLL_NRXMSGS      8
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Data length of the mode 01 PIDs 00-5f (SAE J1979).  Zero means that the
+ * length is not fixed or not known: these PIDs are always requested alone
+ * and take the length of the response.
+ */
+
+static const uint8_t g_pidlen[0x60] =
+{
+  4, 4, 2, 2, 1, 1, 0, 0, 0, 0, 1, 1, 2, 1, 1, 1, /* 00-0f */
+  2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, /* 10-1f */
+  4, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 1, 1, /* 20-2f */
+  1, 2, 2, 1, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 2, /* 30-3f */
+  4, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 4, /* 40-4f */
+  4, 1, 1, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 1, /* 50-5f */
+};
+
+/* Functional request for the supported PIDs 01-c0 of all ECUs */
+
+static const uint8_t g_discover[8] =
+{
+  OBD_SINGLE_FRAME | OBD_SF_DATA_LEN(7), OBD_SHOW_DATA,
+  0x00, 0x20, 0x40, 0x60, 0x80, 0xa0
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd_poll_gettime
+ ****************************************************************************/
+
+static void obd_poll_gettime(FAR struct timespec *ts)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, ts);
+#else
+  clock_gettime(CLOCK_REALTIME, ts);
+#endif
+}
+
+/****************************************************************************
+ * Name: obd_poll_settimeout
+ *
+ * Description:
+ *   Set "deadline" to "msec" milliseconds after "now".
+ *
+ ****************************************************************************/
+
+static void obd_poll_settimeout(FAR struct timespec *deadline,
+                                FAR const struct timespec *now, int msec)
+{
+  deadline->tv_sec  = now->tv_sec + msec / 1000;
+  deadline->tv_nsec = now->tv_nsec + (msec % 1000) * 1000000;
+  if (deadline->tv_nsec >= 1000000000)
+    {
+      deadline->tv_sec++;
+      deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_remaining
+ *
+ * Description:
+ *   Return the milliseconds left until "deadline" (zero when the deadline
+ *   has passed).
+ *
+ ****************************************************************************/
+
+static int obd_poll_remaining(FAR const struct timespec *deadline,
+                              FAR const struct timespec *now)
+{
+  int64_t nsec;
+
+  nsec = (int64_t)(deadline->tv_sec - now->tv_sec) * 1000000000 +
+         (deadline->tv_nsec - now->tv_nsec);
+
+  return nsec > 0 ? (int)((nsec + 999999) / 1000000) : 0;
+}
+
+/****************************************************************************
+ * Name: obd_poll_pidlen
+ ****************************************************************************/
+
+static uint8_t obd_poll_pidlen(uint8_t pid)
+{
+  /* PIDs 00, 20, 40, ... are the bitmaps of the supported PIDs */
+
+  if ((pid & 0x1f) == 0)
+    {
+      return 4;
+    }
+
+  return pid < sizeof(g_pidlen) ? g_pidlen[pid] : 0;
+}
+
+/****************************************************************************
+ * Name: obd_poll_supported
+ ****************************************************************************/
+
+static bool obd_poll_supported(FAR const struct obd_ecu_s *ecu, uint8_t pid)
+{
+  if (pid == 0)
+    {
+      return true;
+    }
+
+  pid--;
+  return (ecu->supported[pid >> 3] & (0x80 >> (pid & 7))) != 0;
+}
+
+/****************************************************************************
+ * Name: obd_poll_send
+ *
+ * Description:
+ *   Send a padded 8 bytes frame with "data" to the CAN ID "id".
+ *
+ ****************************************************************************/
+
+static int obd_poll_send(FAR struct obd_poll_s *poller, uint32_t id,
+                         FAR const uint8_t *data, int len)
+{
+  FAR struct obd_dev_s *dev = poller->dev;
+  FAR struct can_msg_s *msg = &dev->can_txmsg;
+  int msgsize;
+  int nbytes;
+
+  memset(msg, 0, sizeof(struct can_msg_s));
+  msg->cm_hdr.ch_id    = id;
+  msg->cm_hdr.ch_dlc   = 8;
+#ifdef CONFIG_CAN_EXTID
+  msg->cm_hdr.ch_extid = (dev->can_mode == CAN_EXT);
+#endif
+  memcpy(msg->cm_data, data, len);
+
+  msgsize = CAN_MSGLEN(8);
+  nbytes  = write(dev->can_fd, msg, msgsize);
+  if (nbytes != msgsize)
+    {
+      return nbytes < 0 ? -errno : -EAGAIN;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_ecu
+ *
+ * Description:
+ *   Find the ECU that sent a message.  While obd_poll_init() runs, unknown
+ *   ECUs are added to the ECU table.
+ *
+ ****************************************************************************/
+
+static FAR struct obd_ecu_s *obd_poll_ecu(FAR struct obd_poll_s *poller,
+                                          FAR const struct can_hdr_s *hdr)
+{
+  FAR struct obd_ecu_s *ecu;
+  uint32_t rxid = hdr->ch_id;
+  uint32_t txid;
+  int i;
+
+  if (poller->dev->can_mode == CAN_EXT)
+    {
+#ifdef CONFIG_CAN_EXTID
+      if (!hdr->ch_extid || (rxid & OBD_EXT_RXMASK) != OBD_EXT_RXBASE)
+        {
+          return NULL;
+        }
+
+      txid = OBD_EXT_TXBASE | ((rxid & 0xff) << 8);
+#else
+      return NULL;
+#endif
+    }
+  else
+    {
+#ifdef CONFIG_CAN_EXTID
+      if (hdr->ch_extid)
+        {
+          return NULL;
+        }
+#endif
+
+      if (rxid < OBD_PID_STD_RESPONSE ||
+          rxid >= OBD_PID_STD_RESPONSE + OBD_STD_NECUS)
+        {
+          return NULL;
+        }
+
+      txid = rxid - OBD_STD_TXOFFSET;
+    }
+
+  for (i = 0; i < poller->necus; i++)
+    {
+      if (poller->ecus[i].rxid == rxid)
+        {
+          return &poller->ecus[i];
+        }
+    }
+
+  if (!poller->discover || poller->necus >= CONFIG_LIBOBD2_POLL_MAXECUS)
+    {
+      return NULL;
+    }
+
+  ecu = &poller->ecus[poller->necus++];
+  memset(ecu, 0, sizeof(struct obd_ecu_s));
+  ecu->rxid = rxid;
+  ecu->txid = txid;
+  return ecu;
+}
+
+/****************************************************************************
+ * Name: obd_poll_request
+ *
+ * Description:
+ *   Request the next PIDs of an idle ECU.  The PIDs of the ECU are taken
+ *   round-robin, up to six at a time when the ECU accepts multi-PID
+ *   requests.
+ *
+ ****************************************************************************/
+
+static int obd_poll_request(FAR struct obd_poll_s *poller,
+                            FAR struct obd_ecu_s *ecu)
+{
+  FAR struct obd_pidval_s *value;
+  struct timespec now;
+  uint8_t data[2 + OBD_POLL_MAXBATCH];
+  uint8_t index = ecu - poller->ecus;
+  int maxpids = ecu->nobatch ? 1 : OBD_POLL_MAXBATCH;
+  int next = ecu->next;
+  int npids = 0;
+  int ret;
+  int i;
+
+  for (i = 0; i < poller->npids && npids < maxpids; i++)
+    {
+      value = &poller->values[next];
+      if (value->ecu == index)
+        {
+          /* PIDs of unknown length can only be requested alone */
+
+          if (obd_poll_pidlen(value->pid) == 0)
+            {
+              if (npids > 0)
+                {
+                  break;
+                }
+
+              maxpids = 1;
+            }
+
+          data[2 + npids] = value->pid;
+          ecu->inflight[npids++] = next;
+        }
+
+      if (++next >= poller->npids)
+        {
+          next = 0;
+        }
+    }
+
+  if (npids == 0)
+    {
+      return OK;
+    }
+
+  data[0] = OBD_SINGLE_FRAME | OBD_SF_DATA_LEN(npids + 1);
+  data[1] = OBD_SHOW_DATA;
+
+  ret = obd_poll_send(poller, ecu->txid, data, npids + 2);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  obd_poll_gettime(&now);
+  obd_poll_settimeout(&ecu->deadline, &now, poller->timeout);
+
+  ecu->next      = next;
+  ecu->ninflight = npids;
+  ecu->rxlen     = 0;
+  poller->nrequests++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_findpid
+ ****************************************************************************/
+
+static FAR struct obd_pidval_s *
+obd_poll_findpid(FAR struct obd_poll_s *poller, FAR struct obd_ecu_s *ecu,
+                 uint8_t pid)
+{
+  int i;
+
+  for (i = 0; i < ecu->ninflight; i++)
+    {
+      if (poller->values[ecu->inflight[i]].pid == pid)
+        {
+          return &poller->values[ecu->inflight[i]];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: obd_poll_discover
+ *
+ * Description:
+ *   Save the supported PIDs bitmaps answered to the discovery request.
+ *
+ ****************************************************************************/
+
+static void obd_poll_discover(FAR struct obd_ecu_s *ecu,
+                              FAR const uint8_t *buf, int len)
+{
+  int pos;
+
+  if (buf[0] != OBD_SHOW_DATA + OBD_RESP_BASE)
+    {
+      return;
+    }
+
+  for (pos = 1; pos + 5 <= len && (buf[pos] & 0x1f) == 0; pos += 5)
+    {
+      memcpy(&ecu->supported[buf[pos] >> 3], &buf[pos + 1], 4);
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_response
+ *
+ * Description:
+ *   Demultiplex a complete response into the value table.  A multi-PID
+ *   response holds the PIDs in any order, each one followed by its data.
+ *
+ *   Returns the number of values updated.
+ *
+ ****************************************************************************/
+
+static int obd_poll_response(FAR struct obd_poll_s *poller,
+                             FAR struct obd_ecu_s *ecu,
+                             FAR const uint8_t *buf, int len)
+{
+  FAR struct obd_pidval_s *value;
+  struct timespec now;
+  bool batch = ecu->ninflight > 1;
+  int dlen;
+  int pos;
+  int n;
+
+  if (poller->discover)
+    {
+      obd_poll_discover(ecu, buf, len);
+      return 0;
+    }
+
+  if (ecu->ninflight == 0)
+    {
+      return 0;
+    }
+
+  /* Negative response: 0x7f, mode, code */
+
+  if (buf[0] == 0x7f && len >= 3 && buf[1] == OBD_SHOW_DATA)
+    {
+      if (buf[2] == 0x78)
+        {
+          /* Response pending: the ECU needs more time */
+
+          obd_poll_gettime(&now);
+          obd_poll_settimeout(&ecu->deadline, &now, poller->timeout);
+          return 0;
+        }
+
+      ecu->nobatch   = ecu->nobatch || batch;
+      ecu->ninflight = 0;
+      poller->nerrors++;
+      return 0;
+    }
+
+  if (buf[0] != OBD_SHOW_DATA + OBD_RESP_BASE)
+    {
+      return 0;
+    }
+
+  /* Check the whole response before updating any value, the data of a
+   * multi-PID response cannot be split without the length of every PID.
+   */
+
+  for (pos = 1; pos < len; pos += dlen + 1)
+    {
+      dlen = batch ? obd_poll_pidlen(buf[pos]) : len - pos - 1;
+      if (obd_poll_findpid(poller, ecu, buf[pos]) == NULL || dlen <= 0 ||
+          dlen > OBD_POLL_MAXDATA || pos + 1 + dlen > len)
+        {
+          ecu->nobatch   = ecu->nobatch || batch;
+          ecu->ninflight = 0;
+          poller->nerrors++;
+          return 0;
+        }
+    }
+
+  obd_poll_gettime(&now);
+
+  for (n = 0, pos = 1; pos < len; pos += dlen + 1, n++)
+    {
+      value = obd_poll_findpid(poller, ecu, buf[pos]);
+      dlen  = batch ? obd_poll_pidlen(buf[pos]) : len - pos - 1;
+
+      memcpy(value->data, &buf[pos + 1], dlen);
+      value->len = dlen;
+      value->ts  = now;
+      value->count++;
+    }
+
+  ecu->ninflight = 0;
+  return n;
+}
+
+/****************************************************************************
+ * Name: obd_poll_frame
+ *
+ * Description:
+ *   Handle a CAN message received from an ECU.  Multi-frame (ISO-TP)
+ *   responses are reassembled per ECU, so the frames of several ECUs may
+ *   interleave.
+ *
+ *   Returns the number of values updated or a negated errno value.
+ *
+ ****************************************************************************/
+
+static int obd_poll_frame(FAR struct obd_poll_s *poller,
+                          FAR struct obd_ecu_s *ecu,
+                          FAR const struct can_msg_s *msg)
+{
+  FAR const uint8_t *data = msg->cm_data;
+  uint8_t fc[3];
+  int dlc = msg->cm_hdr.ch_dlc;
+  int len;
+
+  if (dlc < 2)
+    {
+      return 0;
+    }
+
+  switch (OBD_FRAME_TYPE(data[0]))
+    {
+      case OBD_SINGLE_FRAME:
+        len = OBD_SF_DATA_LEN(data[0]);
+        if (len == 0 || len > dlc - 1)
+          {
+            return 0;
+          }
+
+        ecu->rxlen = 0;
+        return obd_poll_response(poller, ecu, &data[1], len);
+
+      case OBD_FIRST_FRAME:
+        len = OBD_FF_DATA_LEN_D0(data[0]) | OBD_FF_DATA_LEN_D1(data[1]);
+        if (dlc < 8 || len < 8)
+          {
+            return 0;
+          }
+
+        if (len > OBD_POLL_RXSIZE)
+          {
+            ecu->rxlen = 0;
+            poller->nerrors++;
+
+            fc[0] = OBD_FLWCTRL_FRAME | OBD_FC_OVERFLOW;
+          }
+        else
+          {
+            memcpy(ecu->rxbuf, &data[2], 6);
+            ecu->rxlen = len;
+            ecu->rxpos = 6;
+            ecu->rxseq = 1;
+
+            fc[0] = OBD_FLWCTRL_FRAME | OBD_FC_CTS;
+          }
+
+        /* Let the ECU send all the consecutive frames without delay */
+
+        fc[1] = 0;
+        fc[2] = 0;
+        return obd_poll_send(poller, ecu->txid, fc, 3);
+
+      case OBD_CONSEC_FRAME:
+        if (ecu->rxlen == 0)
+          {
+            return 0;
+          }
+
+        if (OBD_CF_SEQ_NUM(data[0]) != ecu->rxseq)
+          {
+            ecu->rxlen = 0;
+            poller->nerrors++;
+            return 0;
+          }
+
+        len = ecu->rxlen - ecu->rxpos;
+        if (len > dlc - 1)
+          {
+            len = dlc - 1;
+          }
+
+        memcpy(&ecu->rxbuf[ecu->rxpos], &data[1], len);
+        ecu->rxpos += len;
+        ecu->rxseq  = (ecu->rxseq + 1) & 0xf;
+
+        if (ecu->rxpos < ecu->rxlen)
+          {
+            return 0;
+          }
+
+        ecu->rxlen = 0;
+        return obd_poll_response(poller, ecu, ecu->rxbuf, ecu->rxpos);
+
+      default:
+        return 0;
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_receive
+ *
+ * Description:
+ *   Wait up to "timeout" ms for CAN messages and handle all of them.  The
+ *   next request is sent to an ECU as soon as its response is complete.
+ *
+ *   Returns the number of values updated or a negated errno value.
+ *
+ ****************************************************************************/
+
+static int obd_poll_receive(FAR struct obd_poll_s *poller, int timeout)
+{
+  struct can_msg_s buffer[OBD_POLL_NRXMSGS];
+  FAR struct can_msg_s *msg;
+  FAR struct obd_ecu_s *ecu;
+  struct pollfd fds;
+  ssize_t nbytes;
+  size_t msglen;
+  size_t offset;
+  int nupdated = 0;
+  int pending;
+  int ret;
+
+  fds.fd      = poller->dev->can_fd;
+  fds.events  = POLLIN;
+  fds.revents = 0;
+
+  ret = poll(&fds, 1, timeout);
+  if (ret <= 0)
+    {
+      return ret < 0 && errno != EINTR ? -errno : 0;
+    }
+
+  nbytes = read(poller->dev->can_fd, buffer, sizeof(buffer));
+  if (nbytes < 0)
+    {
+      return errno == EINTR || errno == EAGAIN ? 0 : -errno;
+    }
+
+  /* The driver packs the messages, each one takes CAN_MSGLEN(dlc) bytes */
+
+  for (offset = 0; offset + CAN_MSGLEN(0) <= (size_t)nbytes;
+       offset += msglen)
+    {
+      msg    = (FAR struct can_msg_s *)((FAR uint8_t *)buffer + offset);
+      msglen = CAN_MSGLEN(msg->cm_hdr.ch_dlc);
+      if (offset + msglen > (size_t)nbytes)
+        {
+          break;
+        }
+
+#ifdef CONFIG_CAN_ERRORS
+      if (msg->cm_hdr.ch_error)
+        {
+          continue;
+        }
+#endif
+
+      if (msg->cm_hdr.ch_rtr)
+        {
+          continue;
+        }
+
+      ecu = obd_poll_ecu(poller, &msg->cm_hdr);
+      if (ecu == NULL)
+        {
+          continue;
+        }
+
+      pending = ecu->ninflight;
+
+      ret = obd_poll_frame(poller, ecu, msg);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      nupdated += ret;
+
+      /* Keep the ECU busy: ask for its next PIDs right away */
+
+      if (pending > 0 && ecu->ninflight == 0)
+        {
+          ret = obd_poll_request(poller, ecu);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return nupdated;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd_poll_init
+ *
+ * Description:
+ *   Prepare the polling of the mode 01 PIDs in "pids".  A functional
+ *   request asks every ECU for its supported PIDs and each PID is then
+ *   assigned to the first ECU that supports it.
+ *
+ *   It will return the number of ECUs found, -ENODEV if no ECU answered or
+ *   a negated errno value if error.
+ *
+ ****************************************************************************/
+
+int obd_poll_init(FAR struct obd_poll_s *poller, FAR struct obd_dev_s *dev,
+                  FAR const uint8_t *pids, int npids, int timeout)
+{
+  struct timespec deadline;
+  struct timespec now;
+  int remaining;
+  int ret;
+  int i;
+  int j;
+
+  if (npids <= 0 || npids > CONFIG_LIBOBD2_POLL_MAXPIDS || timeout <= 0)
+    {
+      return -EINVAL;
+    }
+
+  memset(poller, 0, sizeof(struct obd_poll_s));
+  poller->dev     = dev;
+  poller->npids   = npids;
+  poller->timeout = timeout;
+
+  for (i = 0; i < npids; i++)
+    {
+      poller->values[i].pid = pids[i];
+      poller->values[i].ecu = OBD_POLL_NOECU;
+    }
+
+  /* Ask all ECUs for the supported PIDs and wait for the answers */
+
+  ret = obd_poll_send(poller, dev->can_mode == CAN_EXT ?
+                      OBD_PID_EXT_REQUEST : OBD_PID_STD_REQUEST,
+                      g_discover, sizeof(g_discover));
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  poller->discover = true;
+
+  obd_poll_gettime(&now);
+  obd_poll_settimeout(&deadline, &now, timeout);
+
+  while ((remaining = obd_poll_remaining(&deadline, &now)) > 0)
+    {
+      ret = obd_poll_receive(poller, remaining);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      obd_poll_gettime(&now);
+    }
+
+  poller->discover = false;
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (poller->necus == 0)
+    {
+      return -ENODEV;
+    }
+
+  /* Give each PID to the first ECU that supports it */
+
+  for (i = 0; i < npids; i++)
+    {
+      for (j = 0; j < poller->necus; j++)
+        {
+          if (obd_poll_supported(&poller->ecus[j], pids[i]))
+            {
+              poller->values[i].ecu = j;
+              break;
+            }
+        }
+    }
+
+  return poller->necus;
+}
+
+/****************************************************************************
+ * Name: obd_poll_run
+ *
+ * Description:
+ *   Keep one request in flight to every ECU and collect the responses for
+ *   "timeout" ms.  A timeout of zero handles the messages already received
+ *   without waiting.
+ *
+ *   It will return the number of PID values updated or a negated errno
+ *   value if error.
+ *
+ ****************************************************************************/
+
+int obd_poll_run(FAR struct obd_poll_s *poller, int timeout)
+{
+  FAR struct obd_ecu_s *ecu;
+  struct timespec end;
+  struct timespec now;
+  int nupdated = 0;
+  int remaining;
+  int wait;
+  int ret;
+  int i;
+
+  obd_poll_gettime(&now);
+  obd_poll_settimeout(&end, &now, timeout);
+
+  do
+    {
+      wait = obd_poll_remaining(&end, &now);
+      wait = wait > 0 ? wait : 0;
+
+      for (i = 0; i < poller->necus; i++)
+        {
+          ecu = &poller->ecus[i];
+          if (ecu->ninflight > 0)
+            {
+              remaining = obd_poll_remaining(&ecu->deadline, &now);
+              if (remaining > 0)
+                {
+                  wait = remaining < wait ? remaining : wait;
+                  continue;
+                }
+
+              /* No answer, drop the request and go on with the next PIDs */
+
+              ecu->ninflight = 0;
+              ecu->rxlen     = 0;
+              poller->ntimeouts++;
+            }
+
+          ret = obd_poll_request(poller, ecu);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          if (ecu->ninflight > 0 && poller->timeout < wait)
+            {
+              wait = poller->timeout;
+            }
+        }
+
+      ret = obd_poll_receive(poller, wait);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      nupdated += ret;
+      obd_poll_gettime(&now);
+    }
+  while (obd_poll_remaining(&end, &now) > 0);
+
+  return nupdated;
+}
+
+/****************************************************************************
+ * Name: obd_poll_value
+ *
+ * Description:
+ *   Return the latest value received for a polled PID or NULL if the PID
+ *   is not polled.
+ *
+ ****************************************************************************/
+
+FAR const struct obd_pidval_s *obd_poll_value(FAR struct obd_poll_s *poller,
+                                              uint8_t pid)
+{
+  int i;
+
+  for (i = 0; i < poller->npids; i++)
+    {
+      if (poller->values[i].pid == pid)
+        {
+          return &poller->values[i];
+        }
+    }
+
+  return NULL;
+}
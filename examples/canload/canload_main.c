@@ -0,0 +1,402 @@
+/****************************************************************************
+ * apps/examples/canload/canload_main.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include "canutils/canlib.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define CANLOAD_MAXFILTERS  4
+
+/* Size of g_frames: receiving takes at least CANLIB_READV_MINFRAMES frames
+ * per read().
+ */
+
+#define CANLOAD_NFRAMES \
+  (CONFIG_CANUTILS_CANLIB_NBATCH > CANLIB_READV_MINFRAMES ? \
+   CONFIG_CANUTILS_CANLIB_NBATCH : CANLIB_READV_MINFRAMES)
+
+/* Nominal length of a classic CAN frame with the interframe space and
+ * without stuff bits.
+ */
+
+#define CANLOAD_STDBITS(n)  (47 + 8 * (n))
+#define CANLOAD_EXTBITS(n)  (67 + 8 * (n))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct canload_stats_s
+{
+  unsigned long frames;        /* Frames read from/written to the driver */
+  unsigned long accepted;      /* Frames that passed the software filter */
+  unsigned long calls;         /* read()/write() calls that moved frames */
+  unsigned long bits;          /* Nominal bits of the frames */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct canlib_frame_s g_frames[CANLOAD_NFRAMES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: canload_gettime
+ *
+ * Description:
+ *   Return the current time in ms.
+ *
+ ****************************************************************************/
+
+static uint32_t canload_gettime(void)
+{
+  struct timespec ts;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+  return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: canload_bits
+ ****************************************************************************/
+
+static unsigned long canload_bits(FAR const struct canlib_frame_s *frame)
+{
+  int len = frame->rtr ? 0 : (frame->dlc > 8 ? 8 : frame->dlc);
+
+  return frame->extended ? CANLOAD_EXTBITS(len) : CANLOAD_STDBITS(len);
+}
+
+/****************************************************************************
+ * Name: canload_show
+ ****************************************************************************/
+
+static void canload_show(FAR const char *what,
+                         FAR const struct canload_stats_s *stats,
+                         uint32_t msec, int baud)
+{
+  unsigned long rate = stats->frames * 1000 / (msec ? msec : 1);
+  unsigned long kept = stats->accepted * 1000 / (msec ? msec : 1);
+  unsigned long avg  = stats->frames * 10 /
+                       (stats->calls ? stats->calls : 1);
+
+  printf("%s: %lu frames/s (%lu/s accepted), %lu calls, "
+         "%lu.%lu frames/call", what, rate, kept, stats->calls,
+         avg / 10, avg % 10);
+
+  if (baud > 0)
+    {
+      /* Bus load in 0.1% */
+
+      unsigned long load = (unsigned long)
+        ((uint64_t)stats->bits * 1000 * 1000 / ((uint64_t)baud * msec));
+
+      printf(", load %lu.%lu%%", load / 10, load % 10);
+    }
+
+  printf("\n");
+}
+
+/****************************************************************************
+ * Name: canload_show_usage
+ ****************************************************************************/
+
+static void canload_show_usage(FAR const char *progname, int exitcode)
+{
+  fprintf(stderr, "USAGE: %s [OPTIONS]\n", progname);
+  fprintf(stderr, "\nWhere OPTIONS include:\n");
+  fprintf(stderr, "  -d <dev>      CAN device (default %s)\n",
+          CONFIG_EXAMPLES_CANLOAD_DEVPATH);
+  fprintf(stderr, "  -s <seconds>  Test duration (default 10)\n");
+  fprintf(stderr, "  -b <frames>   Frames per read()/write() (1-%d)\n",
+          CONFIG_CANUTILS_CANLIB_NBATCH);
+  fprintf(stderr, "  -t            Send frames instead of receiving\n");
+  fprintf(stderr, "  -i <id>       ID of the frames sent (default 0x123)\n");
+  fprintf(stderr, "  -l <dlc>      Length of the frames sent (default 8)\n");
+  fprintf(stderr, "  -x            Use 29-bit IDs\n");
+  fprintf(stderr, "  -f <id:mask>  Receive only the matching IDs "
+          "(up to %d)\n", CANLOAD_MAXFILTERS);
+  fprintf(stderr, "  -S            Filter in software, not in the driver\n");
+  exit(exitcode);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * canload_main
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct canlib_filter_s filters[CANLOAD_MAXFILTERS];
+  int filterids[CANLOAD_MAXFILTERS];
+  struct canload_stats_s total;
+  struct canload_stats_s second;
+  FAR const char *devpath = CONFIG_EXAMPLES_CANLOAD_DEVPATH;
+  FAR char *endptr;
+  uint32_t start;
+  uint32_t last;
+  uint32_t now;
+  bool transmit = false;
+  bool extended = false;
+  bool software = false;
+  int nfilters = 0;
+  int duration = 10;
+  int batch = CONFIG_CANUTILS_CANLIB_NBATCH;
+  uint32_t id = 0x123;
+  uint32_t seqno = 0;
+  int dlc = 8;
+  int baud = 0;
+  ssize_t n;
+  int fd;
+  int ret;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "d:s:b:ti:l:xf:Sh")) != ERROR)
+    {
+      switch (opt)
+        {
+          case 'd':
+            devpath = optarg;
+            break;
+
+          case 's':
+            duration = atoi(optarg);
+            break;
+
+          case 'b':
+            batch = atoi(optarg);
+            if (batch < 1 || batch > CONFIG_CANUTILS_CANLIB_NBATCH)
+              {
+                canload_show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 't':
+            transmit = true;
+            break;
+
+          case 'i':
+            id = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'l':
+            dlc = atoi(optarg);
+            if (dlc < 0 || dlc > 8)
+              {
+                canload_show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 'x':
+            extended = true;
+            break;
+
+          case 'f':
+            if (nfilters >= CANLOAD_MAXFILTERS)
+              {
+                canload_show_usage(argv[0], EXIT_FAILURE);
+              }
+
+            filters[nfilters].id   = strtoul(optarg, &endptr, 0);
+            filters[nfilters].mask = *endptr == ':' ?
+                                     strtoul(endptr + 1, NULL, 0) :
+                                     0x1fffffff;
+            nfilters++;
+            break;
+
+          case 'S':
+            software = true;
+            break;
+
+          case 'h':
+            canload_show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          default:
+            canload_show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  if (!transmit && batch < CANLIB_READV_MINFRAMES)
+    {
+      printf("Receiving %d frames per read()\n",
+             (int)CANLIB_READV_MINFRAMES);
+      batch = CANLIB_READV_MINFRAMES;
+    }
+
+  fd = open(devpath, O_RDWR);
+  if (fd < 0)
+    {
+      fprintf(stderr, "ERROR: open %s failed: %d\n", devpath, errno);
+      return EXIT_FAILURE;
+    }
+
+  if (canlib_getbaud(fd, &baud) < 0)
+    {
+      baud = 0;
+    }
+
+  /* Filters are set up in the driver when possible, so the frames that do
+   * not match never wake up this task.
+   */
+
+  for (i = 0; i < nfilters; i++)
+    {
+      filters[i].extended = extended;
+      filterids[i]        = ERROR;
+
+      if (!software)
+        {
+          filterids[i] = canlib_addfilter(fd, &filters[i]);
+          if (filterids[i] < 0)
+            {
+              printf("Driver filters not available (%d), "
+                     "filtering in software\n", errno);
+              software = true;
+            }
+        }
+    }
+
+  if (transmit)
+    {
+      for (i = 0; i < batch; i++)
+        {
+          memset(&g_frames[i], 0, sizeof(struct canlib_frame_s));
+          g_frames[i].id       = id;
+          g_frames[i].extended = extended;
+          g_frames[i].dlc      = dlc;
+        }
+    }
+
+  printf("%s %s for %d seconds, %d frames per call, baud %d\n",
+         transmit ? "Sending to" : "Receiving from", devpath, duration,
+         batch, baud);
+
+  memset(&total, 0, sizeof(total));
+  memset(&second, 0, sizeof(second));
+
+  start = last = now = canload_gettime();
+  while (now - start < (uint32_t)duration * 1000)
+    {
+      if (transmit)
+        {
+          /* Use the data as a frame counter */
+
+          for (i = 0; i < batch; i++, seqno++)
+            {
+              memcpy(g_frames[i].data, &seqno, dlc > 4 ? 4 : dlc);
+            }
+
+          n = canlib_writev(fd, g_frames, batch);
+        }
+      else
+        {
+          n = canlib_readv(fd, g_frames, batch, 100);
+        }
+
+      if (n < 0)
+        {
+          fprintf(stderr, "ERROR: %s failed: %d\n",
+                  transmit ? "canlib_writev" : "canlib_readv", errno);
+          break;
+        }
+
+      if (n > 0)
+        {
+          second.frames += n;
+          second.calls++;
+
+          for (i = 0; i < n; i++)
+            {
+              second.bits += canload_bits(&g_frames[i]);
+            }
+
+          if (!transmit && software && nfilters > 0)
+            {
+              n = canlib_filter(g_frames, n, filters, nfilters);
+            }
+
+          second.accepted += n;
+        }
+
+      now = canload_gettime();
+      if (now - last >= 1000)
+        {
+          canload_show(transmit ? "TX" : "RX", &second, now - last, baud);
+
+          total.frames   += second.frames;
+          total.accepted += second.accepted;
+          total.calls    += second.calls;
+          total.bits     += second.bits;
+          memset(&second, 0, sizeof(second));
+          last = now;
+        }
+    }
+
+  total.frames   += second.frames;
+  total.accepted += second.accepted;
+  total.calls    += second.calls;
+  total.bits     += second.bits;
+
+  canload_show("Total", &total, now - start, baud);
+
+  for (i = 0; i < nfilters; i++)
+    {
+      if (filterids[i] >= 0)
+        {
+          canlib_delfilter(fd, extended, filterids[i]);
+        }
+    }
+
+  ret = close(fd);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
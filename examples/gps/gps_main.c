@@ -39,13 +39,223 @@
 
 #include <nuttx/config.h>
 
+#include <sys/stat.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
 #include <wchar.h>
 #include <syslog.h>
 
 #include "gpsutils/minmea.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_GPS_BENCHMARK_PASSES
+#  define CONFIG_EXAMPLES_GPS_BENCHMARK_PASSES 10
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_GPS_BENCHMARK
+/****************************************************************************
+ * Name: gps_elapsed
+ *
+ * Description:
+ *   Return the time in microseconds since 'start'
+ *
+ ****************************************************************************/
+
+static uint32_t gps_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  return (now.tv_sec - start->tv_sec) * 1000000 +
+         (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Name: gps_parseline
+ *
+ * Description:
+ *   Parse one sentence with the line based minmea_parse_*() functions.
+ *   Returns the sentence ID if it was parsed.
+ *
+ ****************************************************************************/
+
+static enum minmea_sentence_id gps_parseline(FAR const char *line)
+{
+  union
+  {
+    struct minmea_sentence_rmc rmc;
+    struct minmea_sentence_gga gga;
+    struct minmea_sentence_gsa gsa;
+    struct minmea_sentence_gll gll;
+    struct minmea_sentence_gst gst;
+    struct minmea_sentence_gsv gsv;
+  } frame;
+
+  enum minmea_sentence_id id = minmea_sentence_id(line, false);
+  bool parsed;
+
+  switch (id)
+    {
+      case MINMEA_SENTENCE_RMC:
+        parsed = minmea_parse_rmc(&frame.rmc, line);
+        break;
+
+      case MINMEA_SENTENCE_GGA:
+        parsed = minmea_parse_gga(&frame.gga, line);
+        break;
+
+      case MINMEA_SENTENCE_GSA:
+        parsed = minmea_parse_gsa(&frame.gsa, line);
+        break;
+
+      case MINMEA_SENTENCE_GLL:
+        parsed = minmea_parse_gll(&frame.gll, line);
+        break;
+
+      case MINMEA_SENTENCE_GST:
+        parsed = minmea_parse_gst(&frame.gst, line);
+        break;
+
+      case MINMEA_SENTENCE_GSV:
+        parsed = minmea_parse_gsv(&frame.gsv, line);
+        break;
+
+      default:
+        return id;
+    }
+
+  return parsed ? id : MINMEA_INVALID;
+}
+
+/****************************************************************************
+ * Name: gps_benchmark
+ *
+ * Description:
+ *   Parse a recorded NMEA log several times, first one line at a time with
+ *   minmea_sentence_id() and minmea_parse_*() and then with the streaming
+ *   parser, and report the throughput of each.
+ *
+ ****************************************************************************/
+
+static int gps_benchmark(FAR const char *path)
+{
+  struct minmea_stream stream;
+  struct timespec start;
+  struct stat buf;
+  FAR char *log;
+  uint32_t usecs;
+  uint32_t nline;
+  uint32_t nstream;
+  size_t size;
+  int pass;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0 || fstat(fd, &buf) < 0)
+    {
+      printf("Unable to open file %s\n", path);
+      return EXIT_FAILURE;
+    }
+
+  size = buf.st_size;
+  log  = malloc(size + 1);
+  if (log == NULL || read(fd, log, size) != (ssize_t)size)
+    {
+      printf("Unable to read %lu bytes from %s\n", (unsigned long)size, path);
+      free(log);
+      close(fd);
+      return EXIT_FAILURE;
+    }
+
+  log[size] = '\0';
+  close(fd);
+
+  /* Line based parser */
+
+  nline = 0;
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  for (pass = 0; pass < CONFIG_EXAMPLES_GPS_BENCHMARK_PASSES; pass++)
+    {
+      FAR const char *ptr = log;
+
+      while (*ptr != '\0')
+        {
+          char line[MINMEA_MAX_LENGTH + 4];
+          size_t len = strcspn(ptr, "\r\n");
+
+          if (len < sizeof(line))
+            {
+              memcpy(line, ptr, len);
+              line[len] = '\0';
+
+              if (gps_parseline(line) > MINMEA_UNKNOWN)
+                {
+                  nline++;
+                }
+            }
+
+          ptr += len;
+          ptr += strspn(ptr, "\r\n");
+        }
+    }
+
+  usecs = gps_elapsed(&start);
+  printf("Line parser.....: %lu sentences, %lu us, %lu bytes/s\n",
+         (unsigned long)nline, (unsigned long)usecs,
+         (unsigned long)((uint64_t)size * pass * 1000000 /
+                         (usecs ? usecs : 1)));
+
+  /* Streaming parser */
+
+  nstream = 0;
+  minmea_stream_init(&stream, false);
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  for (pass = 0; pass < CONFIG_EXAMPLES_GPS_BENCHMARK_PASSES; pass++)
+    {
+      size_t offset = 0;
+
+      while (offset < size)
+        {
+          offset += minmea_stream_feed(&stream, &log[offset],
+                                       size - offset);
+          if (stream.id > MINMEA_UNKNOWN)
+            {
+              nstream++;
+            }
+        }
+    }
+
+  usecs = gps_elapsed(&start);
+  printf("Stream parser...: %lu sentences, %lu us, %lu bytes/s\n",
+         (unsigned long)nstream, (unsigned long)usecs,
+         (unsigned long)((uint64_t)size * pass * 1000000 /
+                         (usecs ? usecs : 1)));
+  printf("Discarded.......: %lu sentences\n",
+         (unsigned long)stream.nerrors);
+
+  if (nline != nstream)
+    {
+      printf("ERROR: The parsers decoded a different number of sentences\n");
+    }
+
+  free(log);
+  return nline == nstream ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -56,10 +266,20 @@
 
 int main(int argc, FAR char *argv[])
 {
+  struct minmea_stream stream;
+  char buffer[64];
+  ssize_t nread;
+  size_t offset;
   int fd;
-  int cnt;
-  char ch;
-  char line[MINMEA_MAX_LENGTH];
+
+#ifdef CONFIG_EXAMPLES_GPS_BENCHMARK
+  /* gps -b <log> measures the parsers with a recorded NMEA log */
+
+  if (argc == 3 && strcmp(argv[1], "-b") == 0)
+    {
+      return gps_benchmark(argv[2]);
+    }
+#endif
 
   /* Open the GPS serial port */
 
@@ -67,84 +287,67 @@ int main(int argc, FAR char *argv[])
   if (fd < 0)
     {
       printf("Unable to open file /dev/ttyS1\n");
+      return EXIT_FAILURE;
     }
 
+  minmea_stream_init(&stream, false);
+
   /* Run forever */
 
   for (; ; )
     {
-      /* Read until we complete a line */
+      /* Take whatever the serial driver has buffered */
 
-      cnt = 0;
-      do
+      nread = read(fd, buffer, sizeof(buffer));
+      if (nread <= 0)
         {
-          read(fd, &ch, 1);
-          if (ch != '\r' && ch != '\n')
-            {
-              line[cnt++] = ch;
-            }
+          continue;
         }
-      while (ch != '\r' && ch != '\n');
 
-      line[cnt] = '\0';
+      /* And decode every sentence that it completes */
 
-      switch (minmea_sentence_id(line, false))
+      for (offset = 0; offset < nread; )
         {
-          case MINMEA_SENTENCE_RMC:
-            {
-              struct minmea_sentence_rmc frame;
+          offset += minmea_stream_feed(&stream, &buffer[offset],
+                                       nread - offset);
 
-              if (minmea_parse_rmc(&frame, line))
+          switch (stream.id)
+            {
+              case MINMEA_SENTENCE_RMC:
                 {
+                  FAR struct minmea_sentence_rmc *frame = &stream.frame.rmc;
+
                   printf("Fixed-point Latitude...........: %d\n",
-                         minmea_rescale(&frame.latitude, 1000));
+                         minmea_rescale(&frame->latitude, 1000));
                   printf("Fixed-point Longitude..........: %d\n",
-                         minmea_rescale(&frame.longitude, 1000));
+                         minmea_rescale(&frame->longitude, 1000));
                   printf("Fixed-point Speed..............: %d\n",
-                         minmea_rescale(&frame.speed, 1000));
+                         minmea_rescale(&frame->speed, 1000));
                   printf("Floating point degree latitude.: %2.6f\n",
-                         minmea_tocoord(&frame.latitude));
+                         minmea_tocoord(&frame->latitude));
                   printf("Floating point degree longitude: %2.6f\n",
-                         minmea_tocoord(&frame.longitude));
+                         minmea_tocoord(&frame->longitude));
                   printf("Floating point speed...........: %2.6f\n",
-                         minmea_tocoord(&frame.speed));
-                }
-              else
-                {
-                    printf("$xxRMC sentence is not parsed\n");
+                         minmea_tocoord(&frame->speed));
                 }
-            }
-            break;
-
-          case MINMEA_SENTENCE_GGA:
-            {
-              struct minmea_sentence_gga frame;
+                break;
 
-              if (minmea_parse_gga(&frame, line))
+              case MINMEA_SENTENCE_GGA:
                 {
+                  FAR struct minmea_sentence_gga *frame = &stream.frame.gga;
+
                   printf("Fix quality....................: %d\n",
-                         frame.fix_quality);
+                         frame->fix_quality);
                   printf("Altitude.......................: %d\n",
-                         frame.altitude.value);
+                         frame->altitude.value);
                   printf("Tracked satellites.............: %d\n",
-                         frame.satellites_tracked);
-                }
-              else
-                {
-                  printf("$xxGGA sentence is not parsed\n");
+                         frame->satellites_tracked);
                 }
+                break;
+
+              default:
+                break;
             }
-            break;
-
-          case MINMEA_INVALID:
-          case MINMEA_UNKNOWN:
-          case MINMEA_SENTENCE_GSA:
-          case MINMEA_SENTENCE_GLL:
-          case MINMEA_SENTENCE_GST:
-          case MINMEA_SENTENCE_GSV:
-            {
-            }
-            break;
         }
     }
 
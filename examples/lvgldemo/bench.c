@@ -0,0 +1,363 @@
+/****************************************************************************
+ * apps/examples/lvgldemo/bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <graphics/lvgl.h>
+
+#include "bench.h"
+
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_BENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define BENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define BENCH_CLOCK CLOCK_REALTIME
+#endif
+
+#define BENCH_IMG_W     64
+#define BENCH_IMG_H     64
+#define BENCH_TEXT_MAX  4096
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Every scene draws an opaque panel over the whole screen plus, except for
+ * the "fill" scene, one layer on top of it.  The cost of the layer is the
+ * scene time minus the "fill" time.
+ */
+
+enum bench_scene_e
+{
+  BENCH_FILL = 0,
+  BENCH_BLEND,
+  BENCH_IMAGE,
+  BENCH_GLYPH,
+  BENCH_NSCENES
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_bench_names[BENCH_NSCENES] =
+{
+  "fill", "blend", "image", "glyph"
+};
+
+static lv_color_t g_bench_buf[CONFIG_LV_VDB_SIZE];
+static lv_color_t g_bench_pixels[BENCH_IMG_W * BENCH_IMG_H];
+static char g_bench_text[BENCH_TEXT_MAX];
+
+static lv_disp_buf_t g_bench_disp_buf;
+static lv_disp_drv_t g_bench_disp_drv;
+static lv_img_dsc_t g_bench_img;
+
+static lv_style_t g_bench_bg_style;
+static lv_style_t g_bench_panel_style;
+static lv_style_t g_bench_img_style;
+static lv_style_t g_bench_text_style;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(BENCH_CLOCK, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Nothing leaves the render buffer, so only the drawing is measured */
+
+static void bench_flush(FAR lv_disp_drv_t *drv, FAR const lv_area_t *area,
+                        FAR lv_color_t *color_p)
+{
+  lv_disp_flush_ready(drv);
+}
+
+static void bench_styles(void)
+{
+  int i;
+
+  lv_style_copy(&g_bench_bg_style, &lv_style_plain);
+  g_bench_bg_style.body.main_color   = LV_COLOR_NAVY;
+  g_bench_bg_style.body.grad_color   = LV_COLOR_NAVY;
+  g_bench_bg_style.body.opa          = LV_OPA_COVER;
+  g_bench_bg_style.body.radius       = 0;
+  g_bench_bg_style.body.border.width = 0;
+
+  lv_style_copy(&g_bench_panel_style, &g_bench_bg_style);
+  g_bench_panel_style.body.main_color = LV_COLOR_ORANGE;
+  g_bench_panel_style.body.grad_color = LV_COLOR_ORANGE;
+  g_bench_panel_style.body.opa        = LV_OPA_50;
+
+  lv_style_copy(&g_bench_img_style, &lv_style_plain);
+  g_bench_img_style.image.opa = LV_OPA_50;
+
+  lv_style_copy(&g_bench_text_style, &lv_style_plain);
+  g_bench_text_style.text.color = LV_COLOR_WHITE;
+
+  for (i = 0; i < BENCH_IMG_W * BENCH_IMG_H; i++)
+    {
+      g_bench_pixels[i] = LV_COLOR_MAKE((i % BENCH_IMG_W) * 4,
+                                        (i / BENCH_IMG_W) * 4, 0x80);
+    }
+
+  g_bench_img.header.always_zero = 0;
+  g_bench_img.header.w           = BENCH_IMG_W;
+  g_bench_img.header.h           = BENCH_IMG_H;
+  g_bench_img.header.cf          = LV_IMG_CF_TRUE_COLOR;
+  g_bench_img.data_size          = sizeof(g_bench_pixels);
+  g_bench_img.data               = (FAR const uint8_t *)g_bench_pixels;
+}
+
+/* Fill the text buffer with about as much text as fits on the screen and
+ * return the number of glyph pixels it draws.
+ */
+
+static uint32_t bench_text(lv_coord_t hor, lv_coord_t ver)
+{
+  static const char pangram[] =
+    "The quick brown fox jumps over the lazy dog. ";
+  FAR const lv_font_t *font = g_bench_text_style.text.font;
+  lv_font_glyph_dsc_t dsc;
+  uint32_t pixels = 0;
+  uint32_t nchars;
+  uint32_t lines;
+  uint32_t adv;
+  uint32_t i;
+
+  adv   = lv_font_get_glyph_width(font, 'n', 'n');
+  lines = ver / (lv_font_get_line_height(font) +
+                 g_bench_text_style.text.line_space);
+  if (adv == 0)
+    {
+      adv = 1;
+    }
+
+  nchars = lines * (hor / adv) * 3 / 4;
+  if (nchars >= BENCH_TEXT_MAX)
+    {
+      nchars = BENCH_TEXT_MAX - 1;
+    }
+
+  for (i = 0; i < nchars; i++)
+    {
+      g_bench_text[i] = pangram[i % (sizeof(pangram) - 1)];
+    }
+
+  g_bench_text[nchars] = '\0';
+
+  for (i = 0; i < nchars; i++)
+    {
+      if (lv_font_get_glyph_dsc(font, &dsc, g_bench_text[i],
+                                g_bench_text[i + 1]))
+        {
+          pixels += dsc.box_w * dsc.box_h;
+        }
+    }
+
+  return pixels;
+}
+
+static uint64_t bench_scene(FAR lv_disp_t *disp, int scene, int frames)
+{
+  FAR lv_obj_t *scr = lv_disp_get_scr_act(disp);
+  lv_coord_t hor = lv_disp_get_hor_res(disp);
+  lv_coord_t ver = lv_disp_get_ver_res(disp);
+  FAR lv_obj_t *bg;
+  FAR lv_obj_t *obj;
+  uint64_t start;
+  uint64_t usec;
+  int i;
+
+  bg = lv_obj_create(scr, NULL);
+  lv_obj_set_style(bg, &g_bench_bg_style);
+  lv_obj_set_pos(bg, 0, 0);
+  lv_obj_set_size(bg, hor, ver);
+
+  switch (scene)
+    {
+      case BENCH_BLEND:
+        obj = lv_obj_create(bg, NULL);
+        lv_obj_set_style(obj, &g_bench_panel_style);
+        lv_obj_set_pos(obj, 0, 0);
+        lv_obj_set_size(obj, hor, ver);
+        break;
+
+      case BENCH_IMAGE:
+        obj = lv_img_create(bg, NULL);
+        lv_img_set_src(obj, &g_bench_img);
+        lv_img_set_auto_size(obj, false);
+        lv_img_set_style(obj, LV_IMG_STYLE_MAIN, &g_bench_img_style);
+        lv_obj_set_pos(obj, 0, 0);
+        lv_obj_set_size(obj, hor, ver);
+        break;
+
+      case BENCH_GLYPH:
+        obj = lv_label_create(bg, NULL);
+        lv_label_set_style(obj, LV_LABEL_STYLE_MAIN, &g_bench_text_style);
+        lv_label_set_long_mode(obj, LV_LABEL_LONG_BREAK);
+        lv_obj_set_width(obj, hor);
+        lv_label_set_static_text(obj, g_bench_text);
+        lv_obj_set_pos(obj, 0, 0);
+        break;
+
+      default:
+        break;
+    }
+
+  /* One untimed frame to settle layouts and the image cache */
+
+  lv_obj_invalidate(scr);
+  lv_refr_now(disp);
+
+  start = bench_usec();
+  for (i = 0; i < frames; i++)
+    {
+      lv_obj_invalidate(scr);
+      lv_refr_now(disp);
+    }
+
+  usec = bench_usec() - start;
+
+  lv_obj_del(bg);
+  return usec > 0 ? usec : 1;
+}
+
+static void bench_report(FAR const char *name, uint64_t pixels,
+                         uint64_t usec, uint64_t frameus)
+{
+  /* Megapixels per second with two decimals */
+
+  uint64_t mps = usec > 0 ? pixels * 100 / usec : 0;
+
+  printf("%-6s %8llu.%02llu MP/s %8llu us/frame\n", name,
+         (unsigned long long)(mps / 100), (unsigned long long)(mps % 100),
+         (unsigned long long)frameus);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_run
+ ****************************************************************************/
+
+int bench_run(int argc, FAR char *argv[])
+{
+  uint64_t usec[BENCH_NSCENES];
+  FAR lv_disp_t *def;
+  FAR lv_disp_t *disp;
+  uint64_t area;
+  uint64_t layer;
+  uint32_t glyphs;
+  int frames = 20;
+  int option;
+  int i;
+
+  while ((option = getopt(argc, argv, "n:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'n':
+            frames = atoi(optarg);
+            break;
+
+          default:
+            printf("Usage: lvgldemo bench [-n <frames>]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (frames <= 0)
+    {
+      frames = 1;
+    }
+
+  def = lv_disp_get_default();
+
+  lv_disp_buf_init(&g_bench_disp_buf, g_bench_buf, NULL,
+                   CONFIG_LV_VDB_SIZE);
+  lv_disp_drv_init(&g_bench_disp_drv);
+  g_bench_disp_drv.flush_cb = bench_flush;
+  g_bench_disp_drv.buffer   = &g_bench_disp_buf;
+
+  disp = lv_disp_drv_register(&g_bench_disp_drv);
+  if (disp == NULL)
+    {
+      printf("Failed to register the benchmark display\n");
+      return EXIT_FAILURE;
+    }
+
+  bench_styles();
+  area   = (uint64_t)lv_disp_get_hor_res(disp) * lv_disp_get_ver_res(disp);
+  glyphs = bench_text(lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp));
+
+  printf("%dx%d, %d bit color, %d frames per scene\n",
+         lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp),
+         LV_COLOR_DEPTH, frames);
+
+  for (i = 0; i < BENCH_NSCENES; i++)
+    {
+      usec[i] = bench_scene(disp, i, frames);
+    }
+
+  bench_report(g_bench_names[BENCH_FILL], area * frames,
+               usec[BENCH_FILL], usec[BENCH_FILL] / frames);
+
+  for (i = BENCH_BLEND; i < BENCH_NSCENES; i++)
+    {
+      layer = usec[i] > usec[BENCH_FILL] ? usec[i] - usec[BENCH_FILL] : 1;
+      bench_report(g_bench_names[i],
+                   (i == BENCH_GLYPH ? glyphs : area) * frames,
+                   layer, usec[i] / frames);
+    }
+
+  lv_disp_remove(disp);
+  if (def != NULL)
+    {
+      lv_disp_set_default(def);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+#endif /* CONFIG_EXAMPLES_LVGLDEMO_BENCH */
@@ -0,0 +1,68 @@
+/****************************************************************************
+ * apps/examples/lvgldemo/bench.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_LVGLDEMO_BENCH_H
+#define __APPS_EXAMPLES_LVGLDEMO_BENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <graphics/lvgl.h>
+
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_BENCH
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Render fill, blend, image and glyph scenes into an off-screen display
+ *   and report the throughput in megapixels per second.  lv_init() must
+ *   have been called.
+ *
+ * Input Parameters:
+ *   argc, argv - "bench [-n <frames>]"
+ *
+ * Returned Value:
+ *   EXIT_SUCCESS or EXIT_FAILURE
+ *
+ ****************************************************************************/
+
+int bench_run(int argc, FAR char *argv[]);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_EXAMPLES_LVGLDEMO_BENCH */
+#endif /* __APPS_EXAMPLES_LVGLDEMO_BENCH_H */
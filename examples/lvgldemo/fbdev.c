@@ -44,11 +44,19 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <fcntl.h>
 #include <errno.h>
 
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+#  include <pthread.h>
+#  include <sched.h>
+#  include <semaphore.h>
+#endif
+
 #include <nuttx/nx/nx.h>
 #include <nuttx/nx/nxglib.h>
 #include <nuttx/video/fb.h>
@@ -62,16 +70,62 @@
 #  define FBDEV_PATH  "/dev/fb0"
 #endif
 
+#ifndef CONFIG_EXAMPLES_LVGLDEMO_FLUSH_PRIORITY
+#  define CONFIG_EXAMPLES_LVGLDEMO_FLUSH_PRIORITY 110
+#endif
+
+#ifndef CONFIG_EXAMPLES_LVGLDEMO_FLUSH_STACKSIZE
+#  define CONFIG_EXAMPLES_LVGLDEMO_FLUSH_STACKSIZE 2048
+#endif
+
+/* Number of framebuffer update rectangles collected per refresh cycle.
+ * When more are needed the two closest ones are merged.
+ */
+
+#define FBDEV_NDIRTY  8
+
+/* Depth of the flush queue.  LittlevGL has at most one buffer in flight,
+ * plus the end of frame marker queued by fbdev_monitor().
+ */
+
+#define FBDEV_NREQ    4
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+/* A request for the flush thread.  A NULL 'drv' marks the end of a
+ * refresh cycle.
+ */
+
+struct fb_req_s
+{
+  FAR lv_disp_drv_t *drv;
+  lv_area_t area;
+  FAR lv_color_t *color_p;
+};
+#endif
+
 struct fb_state_s
 {
   int fd;
   struct fb_videoinfo_s vinfo;
   struct fb_planeinfo_s pinfo;
   FAR void *fbmem;
+  bool rawcopy;                      /* lv_color_t matches the fb pixels */
+#ifdef CONFIG_LCD_UPDATE
+  struct nxgl_rect_s dirty[FBDEV_NDIRTY];
+  int ndirty;
+#endif
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  pthread_t thread;
+  sem_t reqsem;                      /* Counts queued requests */
+  sem_t freesem;                     /* Counts free queue entries */
+  struct fb_req_s req[FBDEV_NREQ];
+  int head;
+  int tail;
+#endif
 };
 
 /****************************************************************************
@@ -80,6 +134,352 @@ struct fb_state_s
 
 struct fb_state_s state;
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fbdev_clip
+ *
+ * Description:
+ *   Truncate an area to the screen.  Returns false if nothing is left.
+ *
+ ****************************************************************************/
+
+static bool fbdev_clip(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                       FAR struct nxgl_rect_s *rect)
+{
+  if (state.fbmem == NULL)
+    {
+      return false;
+    }
+
+  /* Return if the area is out the screen */
+
+  if (x2 < 0 || y2 < 0 ||
+      x1 > state.vinfo.xres - 1 || y1 > state.vinfo.yres - 1)
+    {
+      return false;
+    }
+
+  rect->pt1.x = x1 < 0 ? 0 : x1;
+  rect->pt1.y = y1 < 0 ? 0 : y1;
+  rect->pt2.x = x2 > state.vinfo.xres - 1 ? state.vinfo.xres - 1 : x2;
+  rect->pt2.y = y2 > state.vinfo.yres - 1 ? state.vinfo.yres - 1 : y2;
+  return true;
+}
+
+/****************************************************************************
+ * Name: fbdev_copy
+ *
+ * Description:
+ *   Copy the clipped part of a buffer of 'width' pixels per row, which
+ *   starts at 'x1, y1', to the frame buffer.
+ *
+ ****************************************************************************/
+
+static void fbdev_copy(FAR const struct nxgl_rect_s *rect, int32_t x1,
+                       int32_t y1, int32_t width,
+                       FAR const lv_color_t *color_p)
+{
+  FAR uint8_t *row;
+  uint32_t npixels = rect->pt2.x - rect->pt1.x + 1;
+  uint32_t x;
+  int32_t y;
+
+  color_p += (rect->pt1.y - y1) * width + (rect->pt1.x - x1);
+  row      = (FAR uint8_t *)state.fbmem + rect->pt1.y * state.pinfo.stride;
+
+  for (y = rect->pt1.y; y <= rect->pt2.y; y++)
+    {
+      if (state.rawcopy)
+        {
+          memcpy(row + rect->pt1.x * sizeof(lv_color_t), color_p,
+                 npixels * sizeof(lv_color_t));
+        }
+      else if (state.pinfo.bpp == 8)
+        {
+          FAR uint8_t *fbp8 = row + rect->pt1.x;
+
+          for (x = 0; x < npixels; x++)
+            {
+              fbp8[x] = color_p[x].full;
+            }
+        }
+      else if (state.pinfo.bpp == 16)
+        {
+          FAR uint16_t *fbp16 = (FAR uint16_t *)row + rect->pt1.x;
+
+          for (x = 0; x < npixels; x++)
+            {
+              fbp16[x] = color_p[x].full;
+            }
+        }
+      else if (state.pinfo.bpp == 24 || state.pinfo.bpp == 32)
+        {
+          FAR uint32_t *fbp32 = (FAR uint32_t *)row + rect->pt1.x;
+
+          for (x = 0; x < npixels; x++)
+            {
+              fbp32[x] = color_p[x].full;
+            }
+        }
+
+      color_p += width;
+      row     += state.pinfo.stride;
+    }
+}
+
+#ifdef CONFIG_LCD_UPDATE
+static void fbdev_rect_union(FAR struct nxgl_rect_s *dest,
+                             FAR const struct nxgl_rect_s *src1,
+                             FAR const struct nxgl_rect_s *src2)
+{
+  dest->pt1.x = src1->pt1.x < src2->pt1.x ? src1->pt1.x : src2->pt1.x;
+  dest->pt1.y = src1->pt1.y < src2->pt1.y ? src1->pt1.y : src2->pt1.y;
+  dest->pt2.x = src1->pt2.x > src2->pt2.x ? src1->pt2.x : src2->pt2.x;
+  dest->pt2.y = src1->pt2.y > src2->pt2.y ? src1->pt2.y : src2->pt2.y;
+}
+
+static uint32_t fbdev_rect_size(FAR const struct nxgl_rect_s *rect)
+{
+  return (uint32_t)(rect->pt2.x - rect->pt1.x + 1) *
+                   (rect->pt2.y - rect->pt1.y + 1);
+}
+
+/****************************************************************************
+ * Name: fbdev_dirty_add
+ *
+ * Description:
+ *   Add a flushed area to the set of rectangles sent with FBIO_UPDATE at
+ *   the end of the refresh cycle.  An area is merged with an existing
+ *   rectangle whenever their bounding box is no larger than the two of
+ *   them, so the bands of one invalidated area become a single update.
+ *
+ ****************************************************************************/
+
+static void fbdev_dirty_add(FAR const struct nxgl_rect_s *rect)
+{
+  struct nxgl_rect_s add = *rect;
+  struct nxgl_rect_s bound;
+  uint32_t best = UINT32_MAX;
+  uint32_t grow;
+  int merge = -1;
+  int i;
+
+  for (i = 0; i < state.ndirty; )
+    {
+      fbdev_rect_union(&bound, &add, &state.dirty[i]);
+      if (fbdev_rect_size(&bound) <=
+          fbdev_rect_size(&add) + fbdev_rect_size(&state.dirty[i]))
+        {
+          /* The union may now absorb rectangles already checked */
+
+          add            = bound;
+          state.dirty[i] = state.dirty[--state.ndirty];
+          i              = 0;
+          continue;
+        }
+
+      i++;
+    }
+
+  if (state.ndirty < FBDEV_NDIRTY)
+    {
+      state.dirty[state.ndirty++] = add;
+      return;
+    }
+
+  /* No room left, grow the rectangle that costs the fewest extra pixels */
+
+  for (i = 0; i < FBDEV_NDIRTY; i++)
+    {
+      fbdev_rect_union(&bound, &add, &state.dirty[i]);
+      grow = fbdev_rect_size(&bound) - fbdev_rect_size(&state.dirty[i]);
+      if (grow < best)
+        {
+          best  = grow;
+          merge = i;
+        }
+    }
+
+  fbdev_rect_union(&state.dirty[merge], &add, &state.dirty[merge]);
+}
+
+/****************************************************************************
+ * Name: fbdev_dirty_sync
+ *
+ * Description:
+ *   Send the collected rectangles to the display.
+ *
+ ****************************************************************************/
+
+static void fbdev_dirty_sync(void)
+{
+  int i;
+
+  for (i = 0; i < state.ndirty; i++)
+    {
+      ioctl(state.fd, FBIO_UPDATE,
+            (unsigned long)((uintptr_t)&state.dirty[i]));
+    }
+
+  state.ndirty = 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: fbdev_flush_area
+ *
+ * Description:
+ *   Copy one rendered area to the frame buffer.
+ *
+ ****************************************************************************/
+
+static void fbdev_flush_area(FAR const lv_area_t *area,
+                             FAR const lv_color_t *color_p)
+{
+  struct nxgl_rect_s rect;
+
+  if (fbdev_clip(area->x1, area->y1, area->x2, area->y2, &rect))
+    {
+      fbdev_copy(&rect, area->x1, area->y1, area->x2 - area->x1 + 1,
+                 color_p);
+#ifdef CONFIG_LCD_UPDATE
+      fbdev_dirty_add(&rect);
+#endif
+    }
+}
+
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+static void fbdev_semwait(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0)
+    {
+      /* Interrupted by a signal, wait again */
+    }
+}
+
+/****************************************************************************
+ * Name: fbdev_post
+ ****************************************************************************/
+
+static void fbdev_post(FAR lv_disp_drv_t *drv, FAR const lv_area_t *area,
+                       FAR lv_color_t *color_p)
+{
+  FAR struct fb_req_s *req;
+
+  fbdev_semwait(&state.freesem);
+
+  req          = &state.req[state.head];
+  req->drv     = drv;
+  req->color_p = color_p;
+  if (area != NULL)
+    {
+      req->area = *area;
+    }
+
+  state.head = (state.head + 1) % FBDEV_NREQ;
+  sem_post(&state.reqsem);
+}
+
+/****************************************************************************
+ * Name: fbdev_drain
+ *
+ * Description:
+ *   Wait until the flush thread has copied every queued area.  The entries
+ *   are freed only after their copy is complete.
+ *
+ ****************************************************************************/
+
+static void fbdev_drain(void)
+{
+  int i;
+
+  for (i = 0; i < FBDEV_NREQ; i++)
+    {
+      fbdev_semwait(&state.freesem);
+    }
+
+  for (i = 0; i < FBDEV_NREQ; i++)
+    {
+      sem_post(&state.freesem);
+    }
+}
+
+/****************************************************************************
+ * Name: fbdev_thread
+ *
+ * Description:
+ *   Copy rendered buffers to the frame buffer while LittlevGL renders the
+ *   next area into its other buffer.
+ *
+ ****************************************************************************/
+
+static FAR void *fbdev_thread(FAR void *arg)
+{
+  FAR struct fb_req_s *req;
+
+  for (; ; )
+    {
+      fbdev_semwait(&state.reqsem);
+
+      req = &state.req[state.tail];
+      if (req->drv != NULL)
+        {
+          fbdev_flush_area(&req->area, req->color_p);
+          lv_disp_flush_ready(req->drv);
+        }
+#ifdef CONFIG_LCD_UPDATE
+      else
+        {
+          fbdev_dirty_sync();
+        }
+#endif
+
+      state.tail = (state.tail + 1) % FBDEV_NREQ;
+      sem_post(&state.freesem);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: fbdev_start
+ ****************************************************************************/
+
+static int fbdev_start(void)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  sem_init(&state.reqsem, 0, 0);
+  sem_init(&state.freesem, 0, FBDEV_NREQ);
+
+  /* LittlevGL busy-waits for the other buffer, so the copy must be able
+   * to preempt the rendering task.
+   */
+
+  pthread_attr_init(&attr);
+  param.sched_priority = CONFIG_EXAMPLES_LVGLDEMO_FLUSH_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  pthread_attr_setstacksize(&attr, CONFIG_EXAMPLES_LVGLDEMO_FLUSH_STACKSIZE);
+
+  ret = pthread_create(&state.thread, &attr, fbdev_thread, NULL);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      fprintf(stderr, "ERROR: Failed to start the flush thread: %d\n", ret);
+      sem_destroy(&state.reqsem);
+      sem_destroy(&state.freesem);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -162,6 +562,12 @@ int fbdev_init(void)
       return EXIT_FAILURE;
     }
 
+  /* Rows can be copied as they are when the frame buffer pixel has the
+   * size of lv_color_t.
+   */
+
+  state.rawcopy = state.pinfo.bpp == sizeof(lv_color_t) * 8;
+
   /* mmap() the framebuffer.
    *
    * NOTE: In the FLAT build the frame buffer address returned by the
@@ -184,6 +590,17 @@ int fbdev_init(void)
 
   printf("Mapped FB: %p\n", state.fbmem);
 
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  ret = fbdev_start();
+  if (ret != EXIT_SUCCESS)
+    {
+      munmap(state.fbmem, state.pinfo.fblen);
+      state.fbmem = NULL;
+      close(state.fd);
+      return ret;
+    }
+#endif
+
   return EXIT_SUCCESS;
 }
 
@@ -191,14 +608,14 @@ int fbdev_init(void)
  * Name: fbdev_flush
  *
  * Description:
- *   Flush a buffer to the marked area
+ *   Flush a buffer to the marked area.  With
+ *   CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH the copy is done by the flush
+ *   thread and lv_disp_flush_ready() is called from there.
  *
  * Input Parameters:
- *   x1      - Left coordinate
- *   y1      - Top coordinate
- *   x2      - Right coordinate
- *   y2      - Bottom coordinate
- *   color_p - A n array of colors
+ *   disp_drv - The display driver
+ *   area     - The area to flush
+ *   color_p  - A n array of colors
  *
  * Returned Value:
  *   None
@@ -208,121 +625,44 @@ int fbdev_init(void)
 void fbdev_flush(struct _disp_drv_t *disp_drv, const lv_area_t *area,
                  lv_color_t *color_p)
 {
-#ifdef CONFIG_LCD_UPDATE
-  struct nxgl_rect_s rect;
-#endif
-  int32_t x1 = area->x1;
-  int32_t y1 = area->y1;
-  int32_t x2 = area->x2;
-  int32_t y2 = area->y2;
-  int32_t act_x1;
-  int32_t act_y1;
-  int32_t act_x2;
-  int32_t act_y2;
-  long int location = 0;
-
-  if (state.fbmem == NULL)
-    {
-      return;
-    }
-
-  /* Return if the area is out the screen */
-
-  if (x2 < 0)
-    {
-      return;
-    }
-
-  if (y2 < 0)
-    {
-      return;
-    }
-
-  if (x1 > state.vinfo.xres - 1)
-    {
-      return;
-    }
-
-  if (y1 > state.vinfo.yres - 1)
-    {
-      return;
-    }
-
-  /* Truncate the area to the screen */
-
-  act_x1 = x1 < 0 ? 0 : x1;
-  act_y1 = y1 < 0 ? 0 : y1;
-  act_x2 = x2 > state.vinfo.xres - 1 ? state.vinfo.xres - 1 : x2;
-  act_y2 = y2 > state.vinfo.yres - 1 ? state.vinfo.yres - 1 : y2;
-
-  if (state.pinfo.bpp == 8)
-    {
-      uint8_t *fbp8 = (uint8_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp8[location] = color_p->full;
-              color_p++;
-            }
-
-          color_p += x2 - act_x2;
-        }
-    }
-
-  if (state.pinfo.bpp == 16)
-    {
-      uint16_t *fbp16 = (uint16_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp16[location] = color_p->full;
-              color_p++;
-            }
-
-          color_p += x2 - act_x2;
-        }
-    }
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  fbdev_post(disp_drv, area, color_p);
+#else
+  fbdev_flush_area(area, color_p);
 
-  if (state.pinfo.bpp == 24 || state.pinfo.bpp == 32)
-    {
-      uint32_t *fbp32 = (uint32_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
+  /* Tell the flushing is ready */
 
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp32[location] = color_p->full;
-              color_p++;
-            }
+  lv_disp_flush_ready(disp_drv);
+#endif
+}
 
-          color_p += x2 - act_x2;
-        }
-    }
+/****************************************************************************
+ * Name: fbdev_monitor
+ *
+ * Description:
+ *   Called by LittlevGL at the end of every refresh cycle.  The areas
+ *   flushed during the cycle are sent to the display with as few
+ *   FBIO_UPDATE calls as possible, after the last copy is complete.
+ *
+ * Input Parameters:
+ *   disp_drv - The display driver
+ *   time     - Time spent in the refresh cycle
+ *   px       - Number of pixels refreshed
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
 
+void fbdev_monitor(struct _disp_drv_t *disp_drv, uint32_t time, uint32_t px)
+{
 #ifdef CONFIG_LCD_UPDATE
-  rect.pt1.x = act_x1;
-  rect.pt1.y = act_y1;
-  rect.pt2.x = act_x2;
-  rect.pt2.y = act_y2;
-  ioctl(state.fd, FBIO_UPDATE, (unsigned long)((uintptr_t)&rect));
+#  ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  fbdev_post(NULL, NULL, NULL);
+#  else
+  fbdev_dirty_sync();
+#  endif
 #endif
-
-  /* Tell the flushing is ready */
-
-  lv_disp_flush_ready(disp_drv);
 }
 
 /****************************************************************************
@@ -346,102 +686,55 @@ void fbdev_flush(struct _disp_drv_t *disp_drv, const lv_area_t *area,
 void fbdev_fill(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
                 lv_color_t color)
 {
-#ifdef CONFIG_LCD_UPDATE
   struct nxgl_rect_s rect;
-#endif
-  int32_t act_x1;
-  int32_t act_y1;
-  int32_t act_x2;
-  int32_t act_y2;
-  long int location = 0;
-
-  if (state.fbmem == NULL)
-    {
-      return;
-    }
-
-  /* Return if the area is out the screen */
-
-  if (x2 < 0)
-    {
-      return;
-    }
-
-  if (y2 < 0)
-    {
-      return;
-    }
+  FAR uint8_t *row;
+  uint32_t npixels;
+  uint32_t x;
+  int32_t y;
 
-  if (x1 > state.vinfo.xres - 1)
+  if (!fbdev_clip(x1, y1, x2, y2, &rect))
     {
       return;
     }
 
-  if (y1 > state.vinfo.yres - 1)
-    {
-      return;
-    }
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  /* Do not let an older area still in the queue overwrite these pixels */
 
-  /* Truncate the area to the screen */
+  fbdev_drain();
+#endif
 
-  act_x1 = x1 < 0 ? 0 : x1;
-  act_y1 = y1 < 0 ? 0 : y1;
-  act_x2 = x2 > state.vinfo.xres - 1 ? state.vinfo.xres - 1 : x2;
-  act_y2 = y2 > state.vinfo.yres - 1 ? state.vinfo.yres - 1 : y2;
+  npixels = rect.pt2.x - rect.pt1.x + 1;
+  row     = (FAR uint8_t *)state.fbmem + rect.pt1.y * state.pinfo.stride;
 
-  if (state.pinfo.bpp == 8)
+  for (y = rect.pt1.y; y <= rect.pt2.y; y++)
     {
-      uint8_t *fbp8 = (uint8_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
+      if (state.pinfo.bpp == 8)
         {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp8[location] = color.full;
-            }
+          memset(row + rect.pt1.x, color.full, npixels);
         }
-    }
-
-  if (state.pinfo.bpp == 16)
-    {
-      uint16_t *fbp16 = (uint16_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
+      else if (state.pinfo.bpp == 16)
         {
-          for (x = act_x1; x <= act_x2; x++)
+          FAR uint16_t *fbp16 = (FAR uint16_t *)row + rect.pt1.x;
+
+          for (x = 0; x < npixels; x++)
             {
-              location = x + (y * state.vinfo.xres);
-              fbp16[location] = color.full;
+              fbp16[x] = color.full;
             }
         }
-    }
-
-  if (state.pinfo.bpp == 24 || state.pinfo.bpp == 32)
-    {
-      uint32_t *fbp32 = (uint32_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
+      else if (state.pinfo.bpp == 24 || state.pinfo.bpp == 32)
         {
-          for (x = act_x1; x <= act_x2; x++)
+          FAR uint32_t *fbp32 = (FAR uint32_t *)row + rect.pt1.x;
+
+          for (x = 0; x < npixels; x++)
             {
-              location = x + (y * state.vinfo.xres);
-              fbp32[location] = color.full;
+              fbp32[x] = color.full;
             }
         }
+
+      row += state.pinfo.stride;
     }
 
 #ifdef CONFIG_LCD_UPDATE
-  rect.pt1.x = act_x1;
-  rect.pt1.y = act_y1;
-  rect.pt2.x = act_x2;
-  rect.pt2.y = act_y2;
   ioctl(state.fd, FBIO_UPDATE, (unsigned long)((uintptr_t)&rect));
 #endif
 }
@@ -467,111 +760,22 @@ void fbdev_fill(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
 void fbdev_map(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
                FAR const lv_color_t *color_p)
 {
-#ifdef CONFIG_LCD_UPDATE
   struct nxgl_rect_s rect;
-#endif
-  int32_t act_x1;
-  int32_t act_y1;
-  int32_t act_x2;
-  int32_t act_y2;
-  long int location = 0;
 
-  if (state.fbmem == NULL)
-    {
-      return;
-    }
-
-  /* Return if the area is out the screen */
-
-  if (x2 < 0)
-    {
-      return;
-    }
-
-  if (y2 < 0)
+  if (!fbdev_clip(x1, y1, x2, y2, &rect))
     {
       return;
     }
 
-  if (x1 > state.vinfo.xres - 1)
-    {
-      return;
-    }
-
-  if (y1 > state.vinfo.yres - 1)
-    {
-      return;
-    }
-
-  /* Truncate the area to the screen */
-
-  act_x1 = x1 < 0 ? 0 : x1;
-  act_y1 = y1 < 0 ? 0 : y1;
-  act_x2 = x2 > state.vinfo.xres - 1 ? state.vinfo.xres - 1 : x2;
-  act_y2 = y2 > state.vinfo.yres - 1 ? state.vinfo.yres - 1 : y2;
-
-  if (state.pinfo.bpp == 8)
-    {
-      uint8_t *fbp8 = (uint8_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp8[location] = color_p->full;
-              color_p++;
-            }
-
-          color_p += x2 - act_x2;
-        }
-    }
-
-  if (state.pinfo.bpp == 16)
-    {
-      uint16_t *fbp16 = (uint16_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp16[location] = color_p->full;
-              color_p++;
-            }
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  /* Do not let an older area still in the queue overwrite these pixels */
 
-          color_p += x2 - act_x2;
-        }
-    }
-
-  if (state.pinfo.bpp == 24 || state.pinfo.bpp == 32)
-    {
-      uint32_t *fbp32 = (uint32_t *)state.fbmem;
-      uint32_t x;
-      uint32_t y;
-
-      for (y = act_y1; y <= act_y2; y++)
-        {
-          for (x = act_x1; x <= act_x2; x++)
-            {
-              location = x + (y * state.vinfo.xres);
-              fbp32[location] = color_p->full;
-              color_p++;
-            }
+  fbdev_drain();
+#endif
 
-          color_p += x2 - act_x2;
-        }
-    }
+  fbdev_copy(&rect, x1, y1, x2 - x1 + 1, color_p);
 
 #ifdef CONFIG_LCD_UPDATE
-  rect.pt1.x = act_x1;
-  rect.pt1.y = act_y1;
-  rect.pt2.x = act_x2;
-  rect.pt2.y = act_y2;
   ioctl(state.fd, FBIO_UPDATE, (unsigned long)((uintptr_t)&rect));
 #endif
 }
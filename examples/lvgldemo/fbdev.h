@@ -55,6 +55,7 @@ extern "C"
 int fbdev_init(void);
 void fbdev_flush(struct _disp_drv_t *disp_drv, const lv_area_t *area,
                  lv_color_t *color_p);
+void fbdev_monitor(struct _disp_drv_t *disp_drv, uint32_t time, uint32_t px);
 void fbdev_fill(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
                 lv_color_t color);
 void fbdev_map(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
@@ -43,6 +43,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <pthread.h>
 #include <time.h>
 
@@ -52,6 +53,7 @@
 #include "tp.h"
 #include "tp_cal.h"
 #include "demo.h"
+#include "bench.h"
 #include "lv_test_theme_1.h"
 #include "lv_test_theme_2.h"
 
@@ -152,6 +154,11 @@ int main(int argc, FAR char *argv[])
 
   lv_disp_buf_t disp_buf;
   static lv_color_t buf[CONFIG_LV_VDB_SIZE];
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_ASYNC_FLUSH
+  static lv_color_t buf2[CONFIG_LV_VDB_SIZE];
+#else
+  FAR lv_color_t *buf2 = NULL;
+#endif
 
 #ifdef NEED_BOARDINIT
   /* Perform board-specific driver initialization */
@@ -169,15 +176,28 @@ int main(int argc, FAR char *argv[])
 
   lv_init();
 
+#ifdef CONFIG_EXAMPLES_LVGLDEMO_BENCH
+  /* "lvgldemo bench" renders off-screen, reports and exits */
+
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+      return bench_run(argc - 1, argv + 1);
+    }
+#endif
+
   /* Display interface initialization */
 
   fbdev_init();
 
-  /* Basic LittlevGL display driver initialization */
+  /* Basic LittlevGL display driver initialization.  With two buffers
+   * LittlevGL renders into one while the flush thread copies the other one
+   * to the frame buffer.
+   */
 
-  lv_disp_buf_init(&disp_buf, buf, NULL, LV_HOR_RES_MAX * 10);
+  lv_disp_buf_init(&disp_buf, buf, buf2, LV_HOR_RES_MAX * 10);
   lv_disp_drv_init(&disp_drv);
   disp_drv.flush_cb = fbdev_flush;
+  disp_drv.monitor_cb = fbdev_monitor;
   disp_drv.buffer = &disp_buf;
   lv_disp_drv_register(&disp_drv);
 
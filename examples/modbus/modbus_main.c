@@ -284,6 +284,10 @@ static void *modbus_pollthread(void *pvarg)
       /* Generate some random input */
 
       g_modbus.reginput[0] = (uint16_t)rand();
+#ifdef CONFIG_MB_REGMAP
+      eMBRegMapSetRegs(MB_REGMAP_INPUT, CONFIG_MB_REGMAP_INPUT_START, 1,
+                       g_modbus.reginput);
+#endif
     }
   while (g_modbus.threadstate != SHUTDOWN);
 
@@ -433,6 +437,9 @@ int main(int argc, FAR char *argv[])
   return EXIT_SUCCESS;
 }
 
+/* With CONFIG_MB_REGMAP the callbacks are provided by the register map */
+
+#ifndef CONFIG_MB_REGMAP
 /****************************************************************************
  * Name: eMBRegInputCB
  *
@@ -550,3 +557,5 @@ eMBErrorCode eMBRegDiscreteCB(uint8_t *buffer, uint16_t address, uint16_t ndiscr
 {
   return MB_ENOREG;
 }
+
+#endif /* CONFIG_MB_REGMAP */
@@ -39,11 +39,97 @@
 
 #include <nuttx/config.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "canutils/obd.h"
 #include "canutils/obd_pid.h"
 #include "canutils/obd_frame.h"
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_LIBOBD2_POLL
+static const uint8_t g_pids[] =
+{
+  OBD_PID_RPM,
+  OBD_PID_SPEED,
+  OBD_PID_ENGINE_TEMPERATURE,
+  OBD_PID_ENGINE_LOAD,
+  OBD_PID_THROTTLE_POSITION,
+  OBD_PID_INTAKE_AIR_TEMPERATURE,
+  OBD_PID_MASS_AIR_FLOW,
+  OBD_PID_FUEL_LEVEL_INPUT,
+};
+
+static struct obd_poll_s g_poll;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_LIBOBD2_POLL
+/****************************************************************************
+ * Name: obd2_poll
+ *
+ * Description:
+ *   Poll all PIDs in g_pids for about 10 seconds and show the latest
+ *   values once a second.
+ *
+ ****************************************************************************/
+
+static int obd2_poll(FAR struct obd_dev_s *dev)
+{
+  FAR const struct obd_pidval_s *value;
+  int ret;
+  int i;
+  int j;
+  int k;
+
+  ret = obd_poll_init(&g_poll, dev, g_pids, sizeof(g_pids), 100);
+  if (ret < 0)
+    {
+      printf("Failed to find the ECUs: %d\n", ret);
+      return ret;
+    }
+
+  printf("Found %d ECUs\n", ret);
+
+  for (i = 0; i < 10; i++)
+    {
+      ret = obd_poll_run(&g_poll, 1000);
+      if (ret < 0)
+        {
+          printf("Failed to poll the PIDs: %d\n", ret);
+          return ret;
+        }
+
+      for (j = 0; j < sizeof(g_pids); j++)
+        {
+          value = obd_poll_value(&g_poll, g_pids[j]);
+          if (value->len > 0)
+            {
+              printf("PID %02x:", value->pid);
+              for (k = 0; k < value->len; k++)
+                {
+                  printf(" %02x", value->data[k]);
+                }
+
+              printf(" (%lu)\n", (unsigned long)value->count);
+            }
+        }
+
+      printf("Requests: %lu Timeouts: %lu Errors: %lu\n",
+             (unsigned long)g_poll.nrequests,
+             (unsigned long)g_poll.ntimeouts,
+             (unsigned long)g_poll.nerrors);
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -64,6 +150,13 @@ int main(int argc, FAR char *argv[])
       return -1;
     }
 
+#ifdef CONFIG_LIBOBD2_POLL
+  if (argc > 1 && strcmp(argv[1], "-p") == 0)
+    {
+      return obd2_poll(dev) < 0 ? -1 : 0;
+    }
+#endif
+
   /* Request the RPM */
 
   ret = obd_send_request(dev, OBD_SHOW_DATA, OBD_PID_RPM);
@@ -0,0 +1,835 @@
+/****************************************************************************
+ * apps/fsutils/fsbench/fsbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <errno.h>
+
+#include "fsutils/fsbench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_FSUTILS_FSBENCH_FILESIZES
+#  define CONFIG_FSUTILS_FSBENCH_FILESIZES "4096,32768"
+#endif
+
+#ifndef CONFIG_FSUTILS_FSBENCH_IOSIZES
+#  define CONFIG_FSUTILS_FSBENCH_IOSIZES "64,512,4096"
+#endif
+
+#ifndef CONFIG_FSUTILS_FSBENCH_NFILES
+#  define CONFIG_FSUTILS_FSBENCH_NFILES 32
+#endif
+
+#ifndef CONFIG_FSUTILS_FSBENCH_MAXSAMPLES
+#  define CONFIG_FSUTILS_FSBENCH_MAXSAMPLES 256
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define FSBENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define FSBENCH_CLOCK CLOCK_REALTIME
+#endif
+
+/* Maximum number of entries in the file and I/O size lists */
+
+#define FSBENCH_MAXSIZES 8
+
+#define FSBENCH_PREFIX   "fsbench: "
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct fsbench_s
+{
+  FAR const char *label;           /* Value of the 'fs' column */
+  FAR const char *mountpt;         /* Directory holding the test files */
+  FAR FILE *csv;                   /* CSV output stream */
+  FAR uint8_t *buffer;             /* I/O buffer (largest I/O size) */
+  size_t filesizes[FSBENCH_MAXSIZES];
+  size_t iosizes[FSBENCH_MAXSIZES];
+  int nfilesizes;
+  int niosizes;
+  int nfiles;                      /* Files for the metadata tests */
+  int nloops;                      /* Repetitions of the whole suite */
+  uint32_t seed;                   /* Random offset generator state */
+
+  /* Latency samples of the test in progress */
+
+  uint32_t samples[CONFIG_FSUTILS_FSBENCH_MAXSAMPLES];
+  size_t nsamples;
+  size_t stride;
+  size_t nops;
+
+  char path[PATH_MAX];
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(FAR const char *progname)
+{
+  fprintf(stderr, "\nUsage: %s -b [-f <sizes>] [-i <sizes>] [-n <files>] "
+          "[-l <loops>] [-L <label>] [-o <csv-file>]\n", progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  -f Comma separated file sizes (default %s).\n",
+          CONFIG_FSUTILS_FSBENCH_FILESIZES);
+  fprintf(stderr, "  -i Comma separated I/O sizes (default %s).\n",
+          CONFIG_FSUTILS_FSBENCH_IOSIZES);
+  fprintf(stderr, "  -n Files for the metadata tests (default %d).\n",
+          CONFIG_FSUTILS_FSBENCH_NFILES);
+  fprintf(stderr, "  -l Number of times to run the suite (default 1).\n");
+  fprintf(stderr, "  -L Label written to the 'fs' column.\n");
+  fprintf(stderr, "  -o Write the CSV to a file instead of stdout.\n");
+}
+
+/****************************************************************************
+ * Name: fsbench_parsesizes
+ ****************************************************************************/
+
+static int fsbench_parsesizes(FAR const char *str, FAR size_t *sizes)
+{
+  FAR char *endptr;
+  int nsizes = 0;
+
+  while (*str != '\0')
+    {
+      unsigned long size = strtoul(str, &endptr, 0);
+
+      if (endptr == str || size == 0 || nsizes >= FSBENCH_MAXSIZES)
+        {
+          return -EINVAL;
+        }
+
+      /* Accept an optional k or K suffix */
+
+      if (*endptr == 'k' || *endptr == 'K')
+        {
+          size *= 1024;
+          endptr++;
+        }
+
+      sizes[nsizes++] = size;
+
+      if (*endptr == ',')
+        {
+          endptr++;
+        }
+      else if (*endptr != '\0')
+        {
+          return -EINVAL;
+        }
+
+      str = endptr;
+    }
+
+  return nsizes > 0 ? nsizes : -EINVAL;
+}
+
+/****************************************************************************
+ * Name: fsbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static uint64_t fsbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(FSBENCH_CLOCK, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: fsbench_rand
+ ****************************************************************************/
+
+static uint32_t fsbench_rand(FAR struct fsbench_s *bench)
+{
+  uint32_t x = bench->seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  bench->seed = x;
+  return x;
+}
+
+/****************************************************************************
+ * Name: fsbench_begin
+ *
+ * Description:
+ *   Prepare the latency sampler for a test of 'nops' operations.  If there
+ *   are more operations than sample slots, every 'stride'th operation is
+ *   kept.
+ *
+ ****************************************************************************/
+
+static void fsbench_begin(FAR struct fsbench_s *bench, size_t nops)
+{
+  bench->nsamples = 0;
+  bench->nops     = 0;
+  bench->stride   = (nops + CONFIG_FSUTILS_FSBENCH_MAXSAMPLES - 1) /
+                    CONFIG_FSUTILS_FSBENCH_MAXSAMPLES;
+
+  if (bench->stride == 0)
+    {
+      bench->stride = 1;
+    }
+}
+
+/****************************************************************************
+ * Name: fsbench_sample
+ ****************************************************************************/
+
+static void fsbench_sample(FAR struct fsbench_s *bench, uint64_t start)
+{
+  uint64_t usec = fsbench_now() - start;
+
+  if ((bench->nops++ % bench->stride) == 0 &&
+      bench->nsamples < CONFIG_FSUTILS_FSBENCH_MAXSAMPLES)
+    {
+      bench->samples[bench->nsamples++] =
+        usec > UINT32_MAX ? UINT32_MAX : (uint32_t)usec;
+    }
+}
+
+/****************************************************************************
+ * Name: fsbench_compare
+ ****************************************************************************/
+
+static int fsbench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t va = *(FAR const uint32_t *)a;
+  uint32_t vb = *(FAR const uint32_t *)b;
+
+  return va < vb ? -1 : va > vb ? 1 : 0;
+}
+
+/****************************************************************************
+ * Name: fsbench_emit
+ *
+ * Description:
+ *   Write one CSV row for the test just completed.
+ *
+ ****************************************************************************/
+
+static void fsbench_emit(FAR struct fsbench_s *bench, FAR const char *test,
+                         size_t filesize, size_t iosize, uint64_t bytes,
+                         uint64_t usec)
+{
+  FAR uint32_t *s = bench->samples;
+  size_t n = bench->nsamples;
+  unsigned long kbps = 0;
+
+  if (usec > 0)
+    {
+      kbps = (unsigned long)(bytes * 1000000 / 1024 / usec);
+    }
+
+  fprintf(bench->csv, "%s,%s,%lu,%lu,%lu,%llu,%llu,%lu",
+          bench->label, test, (unsigned long)filesize,
+          (unsigned long)iosize, (unsigned long)bench->nops,
+          (unsigned long long)bytes, (unsigned long long)usec, kbps);
+
+  if (n > 0)
+    {
+      qsort(s, n, sizeof(uint32_t), fsbench_compare);
+      fprintf(bench->csv, ",%lu,%lu,%lu,%lu,%lu\n",
+              (unsigned long)s[0],
+              (unsigned long)s[(n - 1) * 50 / 100],
+              (unsigned long)s[(n - 1) * 90 / 100],
+              (unsigned long)s[(n - 1) * 99 / 100],
+              (unsigned long)s[n - 1]);
+    }
+  else
+    {
+      fprintf(bench->csv, ",,,,,\n");
+    }
+
+  fflush(bench->csv);
+}
+
+/****************************************************************************
+ * Name: fsbench_filename
+ ****************************************************************************/
+
+static FAR const char *fsbench_filename(FAR struct fsbench_s *bench,
+                                        int index)
+{
+  snprintf(bench->path, sizeof(bench->path), "%s/fsbench%04d",
+           bench->mountpt, index);
+  return bench->path;
+}
+
+/****************************************************************************
+ * Name: fsbench_seqwrite
+ ****************************************************************************/
+
+static int fsbench_seqwrite(FAR struct fsbench_s *bench, size_t filesize,
+                            size_t iosize)
+{
+  FAR const char *path = fsbench_filename(bench, 0);
+  uint64_t start;
+  uint64_t t0;
+  size_t offset;
+  int ret = OK;
+  int fd;
+
+  fsbench_begin(bench, filesize / iosize + 1);
+  start = fsbench_now();
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: open %s failed: %d\n",
+              path, errno);
+      return -errno;
+    }
+
+  for (offset = 0; offset < filesize; offset += iosize)
+    {
+      size_t nbytes = filesize - offset < iosize ? filesize - offset : iosize;
+      ssize_t nwritten;
+
+      t0       = fsbench_now();
+      nwritten = write(fd, bench->buffer, nbytes);
+      fsbench_sample(bench, t0);
+
+      if (nwritten != (ssize_t)nbytes)
+        {
+          fprintf(stderr, FSBENCH_PREFIX "ERROR: write failed at %lu: %d\n",
+                  (unsigned long)offset, nwritten < 0 ? errno : ENOSPC);
+          ret = nwritten < 0 ? -errno : -ENOSPC;
+          break;
+        }
+    }
+
+  /* Include the time needed to commit the data in the throughput */
+
+  fsync(fd);
+  close(fd);
+
+  if (ret == OK)
+    {
+      fsbench_emit(bench, "seqwrite", filesize, iosize, filesize,
+                   fsbench_now() - start);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fsbench_seqread
+ ****************************************************************************/
+
+static int fsbench_seqread(FAR struct fsbench_s *bench, size_t filesize,
+                           size_t iosize)
+{
+  FAR const char *path = fsbench_filename(bench, 0);
+  uint64_t start;
+  uint64_t t0;
+  uint64_t total = 0;
+  ssize_t nread;
+  int fd;
+
+  fsbench_begin(bench, filesize / iosize + 1);
+  start = fsbench_now();
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: open %s failed: %d\n",
+              path, errno);
+      return -errno;
+    }
+
+  do
+    {
+      t0    = fsbench_now();
+      nread = read(fd, bench->buffer, iosize);
+      fsbench_sample(bench, t0);
+
+      if (nread > 0)
+        {
+          total += nread;
+        }
+    }
+  while (nread > 0);
+
+  close(fd);
+
+  if (nread < 0 || total != filesize)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: read %llu of %lu bytes: %d\n",
+              (unsigned long long)total, (unsigned long)filesize,
+              nread < 0 ? errno : 0);
+      return nread < 0 ? -errno : -EIO;
+    }
+
+  fsbench_emit(bench, "seqread", filesize, iosize, total,
+               fsbench_now() - start);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fsbench_random
+ *
+ * Description:
+ *   Read or overwrite 'filesize / iosize' randomly chosen, I/O size aligned
+ *   blocks of the existing test file.  Not every file system supports
+ *   writing into an existing file (NXFFS does not); in that case the test
+ *   is reported as skipped.
+ *
+ ****************************************************************************/
+
+static int fsbench_random(FAR struct fsbench_s *bench, size_t filesize,
+                          size_t iosize, bool overwrite)
+{
+  FAR const char *path = fsbench_filename(bench, 0);
+  FAR const char *test = overwrite ? "randwrite" : "randread";
+  uint64_t start;
+  uint64_t t0;
+  size_t nblocks;
+  size_t i;
+  int ret = OK;
+  int fd;
+
+  nblocks = filesize / iosize;
+  if (nblocks < 2)
+    {
+      return OK;
+    }
+
+  fsbench_begin(bench, nblocks);
+  start = fsbench_now();
+
+  fd = open(path, overwrite ? O_WRONLY : O_RDONLY);
+  if (fd < 0)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "%s skipped: open failed: %d\n",
+              test, errno);
+      return OK;
+    }
+
+  for (i = 0; i < nblocks; i++)
+    {
+      off_t offset = (off_t)(fsbench_rand(bench) % nblocks) * iosize;
+      ssize_t nbytes;
+
+      t0 = fsbench_now();
+      if (lseek(fd, offset, SEEK_SET) != offset)
+        {
+          ret = -errno;
+          break;
+        }
+
+      if (overwrite)
+        {
+          nbytes = write(fd, bench->buffer, iosize);
+        }
+      else
+        {
+          nbytes = read(fd, bench->buffer, iosize);
+        }
+
+      fsbench_sample(bench, t0);
+
+      if (nbytes != (ssize_t)iosize)
+        {
+          ret = nbytes < 0 ? -errno : -EIO;
+          break;
+        }
+    }
+
+  if (overwrite)
+    {
+      fsync(fd);
+    }
+
+  close(fd);
+
+  if (ret < 0)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "%s skipped: %d\n", test, -ret);
+      return OK;
+    }
+
+  fsbench_emit(bench, test, filesize, iosize, (uint64_t)nblocks * iosize,
+               fsbench_now() - start);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fsbench_throughput
+ ****************************************************************************/
+
+static int fsbench_throughput(FAR struct fsbench_s *bench)
+{
+  int ret = OK;
+  int i;
+  int j;
+
+  for (i = 0; i < bench->nfilesizes && ret == OK; i++)
+    {
+      for (j = 0; j < bench->niosizes && ret == OK; j++)
+        {
+          size_t filesize = bench->filesizes[i];
+          size_t iosize   = bench->iosizes[j];
+
+          if (iosize > filesize)
+            {
+              continue;
+            }
+
+          ret = fsbench_seqwrite(bench, filesize, iosize);
+          if (ret == OK)
+            {
+              ret = fsbench_seqread(bench, filesize, iosize);
+            }
+
+          if (ret == OK)
+            {
+              ret = fsbench_random(bench, filesize, iosize, false);
+            }
+
+          if (ret == OK)
+            {
+              ret = fsbench_random(bench, filesize, iosize, true);
+            }
+
+          unlink(fsbench_filename(bench, 0));
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fsbench_metadata
+ *
+ * Description:
+ *   Measure the latency of create, open, readdir and unlink over
+ *   'nfiles' small files.
+ *
+ ****************************************************************************/
+
+static int fsbench_metadata(FAR struct fsbench_s *bench)
+{
+  FAR struct dirent *entry;
+  FAR DIR *dirp;
+  uint64_t start;
+  uint64_t t0;
+  ssize_t nwritten;
+  int ncreated;
+  int ret = OK;
+  int fd;
+  int i;
+
+  /* Create: open(O_CREAT) + write of one byte + close */
+
+  fsbench_begin(bench, bench->nfiles);
+  start = fsbench_now();
+
+  for (ncreated = 0; ncreated < bench->nfiles; ncreated++)
+    {
+      FAR const char *path = fsbench_filename(bench, ncreated);
+
+      t0 = fsbench_now();
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          fprintf(stderr, FSBENCH_PREFIX "ERROR: create %s failed: %d\n",
+                  path, errno);
+          ret = -errno;
+          break;
+        }
+
+      nwritten = write(fd, bench->buffer, 1);
+      if (nwritten != 1)
+        {
+          fprintf(stderr, FSBENCH_PREFIX "ERROR: write %s failed: %d\n",
+                  path, nwritten < 0 ? errno : ENOSPC);
+          ret = nwritten < 0 ? -errno : -ENOSPC;
+          close(fd);
+          unlink(path);
+          break;
+        }
+
+      close(fd);
+      fsbench_sample(bench, t0);
+    }
+
+  if (ret < 0)
+    {
+      /* Do not report the timing of a failed run, only clean up */
+
+      for (i = 0; i < ncreated; i++)
+        {
+          unlink(fsbench_filename(bench, i));
+        }
+
+      return ret;
+    }
+
+  fsbench_emit(bench, "create", 1, 1, ncreated, fsbench_now() - start);
+
+  /* Open + close of the existing files */
+
+  fsbench_begin(bench, ncreated);
+  start = fsbench_now();
+
+  for (i = 0; i < ncreated; i++)
+    {
+      FAR const char *path = fsbench_filename(bench, i);
+
+      t0 = fsbench_now();
+      fd = open(path, O_RDONLY);
+      if (fd >= 0)
+        {
+          close(fd);
+        }
+
+      fsbench_sample(bench, t0);
+    }
+
+  fsbench_emit(bench, "open", 1, 1, ncreated, fsbench_now() - start);
+
+  /* One readdir() call per directory entry */
+
+  fsbench_begin(bench, ncreated + 1);
+  start = fsbench_now();
+
+  dirp = opendir(bench->mountpt);
+  if (dirp != NULL)
+    {
+      do
+        {
+          t0    = fsbench_now();
+          entry = readdir(dirp);
+          fsbench_sample(bench, t0);
+        }
+      while (entry != NULL);
+
+      closedir(dirp);
+      fsbench_emit(bench, "readdir", 0, 0, 0, fsbench_now() - start);
+    }
+  else
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: opendir %s failed: %d\n",
+              bench->mountpt, errno);
+    }
+
+  /* Unlink */
+
+  fsbench_begin(bench, ncreated);
+  start = fsbench_now();
+
+  for (i = 0; i < ncreated; i++)
+    {
+      FAR const char *path = fsbench_filename(bench, i);
+
+      t0 = fsbench_now();
+      unlink(path);
+      fsbench_sample(bench, t0);
+    }
+
+  fsbench_emit(bench, "unlink", 1, 1, ncreated, fsbench_now() - start);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fsbench_main
+ ****************************************************************************/
+
+int fsbench_main(FAR const char *label, FAR const char *mountpt,
+                 int argc, FAR char *argv[])
+{
+  FAR struct fsbench_s *bench;
+  FAR const char *csvpath = NULL;
+  FAR char *endptr;
+  size_t maxio = 0;
+  size_t n;
+  int option;
+  int ret = OK;
+  int loop;
+  int i;
+
+  bench = (FAR struct fsbench_s *)zalloc(sizeof(struct fsbench_s));
+  if (bench == NULL)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: Out of memory\n");
+      return EXIT_FAILURE;
+    }
+
+  bench->label      = label;
+  bench->mountpt    = mountpt;
+  bench->csv        = stdout;
+  bench->nfiles     = CONFIG_FSUTILS_FSBENCH_NFILES;
+  bench->nloops     = 1;
+  bench->seed       = 0x93846;
+  bench->nfilesizes = fsbench_parsesizes(CONFIG_FSUTILS_FSBENCH_FILESIZES,
+                                         bench->filesizes);
+  bench->niosizes   = fsbench_parsesizes(CONFIG_FSUTILS_FSBENCH_IOSIZES,
+                                         bench->iosizes);
+
+  while ((option = getopt(argc, argv, "bf:i:n:l:L:o:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'b':
+            break;
+
+          case 'f':
+            bench->nfilesizes = fsbench_parsesizes(optarg, bench->filesizes);
+            break;
+
+          case 'i':
+            bench->niosizes = fsbench_parsesizes(optarg, bench->iosizes);
+            break;
+
+          case 'n':
+            bench->nfiles = (int)strtol(optarg, &endptr, 0);
+            if (*endptr != '\0' || bench->nfiles < 0)
+              {
+                bench->nfiles = -1;
+              }
+            break;
+
+          case 'l':
+            bench->nloops = (int)strtol(optarg, &endptr, 0);
+            if (*endptr != '\0' || bench->nloops < 1)
+              {
+                bench->nloops = -1;
+              }
+            break;
+
+          case 'L':
+            bench->label = optarg;
+            break;
+
+          case 'o':
+            csvpath = optarg;
+            break;
+
+          default:
+            show_usage(argv[0]);
+            ret = -EINVAL;
+            goto errout;
+        }
+    }
+
+  if (bench->nfilesizes < 0 || bench->niosizes < 0 || bench->nfiles < 0 ||
+      bench->nloops < 0 || optind != argc)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "Invalid arguments\n");
+      show_usage(argv[0]);
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  for (i = 0; i < bench->niosizes; i++)
+    {
+      if (bench->iosizes[i] > maxio)
+        {
+          maxio = bench->iosizes[i];
+        }
+    }
+
+  bench->buffer = (FAR uint8_t *)malloc(maxio);
+  if (bench->buffer == NULL)
+    {
+      fprintf(stderr, FSBENCH_PREFIX "ERROR: No memory for %lu byte "
+              "buffer\n", (unsigned long)maxio);
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  for (n = 0; n < maxio; n++)
+    {
+      bench->buffer[n] = (uint8_t)n;
+    }
+
+  if (csvpath != NULL)
+    {
+      bench->csv = fopen(csvpath, "w");
+      if (bench->csv == NULL)
+        {
+          fprintf(stderr, FSBENCH_PREFIX "ERROR: Failed to create %s: %d\n",
+                  csvpath, errno);
+          ret = -errno;
+          goto errout_with_buffer;
+        }
+    }
+
+  fprintf(bench->csv, "fs,test,file_size,io_size,ops,bytes,usec,kbps,"
+          "min_us,p50_us,p90_us,p99_us,max_us\n");
+
+  for (loop = 0; loop < bench->nloops && ret == OK; loop++)
+    {
+      ret = fsbench_throughput(bench);
+      if (ret == OK && bench->nfiles > 0)
+        {
+          ret = fsbench_metadata(bench);
+        }
+    }
+
+  if (csvpath != NULL)
+    {
+      fclose(bench->csv);
+    }
+
+errout_with_buffer:
+  free(bench->buffer);
+
+errout:
+  free(bench);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,849 @@
+/****************************************************************************
+ * apps/gpsutils/minmea/minmea_stream.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "gpsutils/minmea.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Parser states */
+
+#define STREAM_IDLE       0  /* Waiting for '$' */
+#define STREAM_BODY       1  /* Between '$' and '*' */
+#define STREAM_CKSUM1     2  /* Upper checksum digit */
+#define STREAM_CKSUM2     3  /* Lower checksum digit */
+#define STREAM_END        4  /* Waiting for CR or LF */
+
+/* Field types.  These correspond to the minmea_scan() format characters
+ * used by the minmea_parse_*() functions.
+ */
+
+#define FIELD_IGNORE      0  /* '_' */
+#define FIELD_CHAR        1  /* 'c' */
+#define FIELD_VALID       2  /* 'c', stored as bool (true for 'A') */
+#define FIELD_DIR         3  /* 'd', applied to the float at 'aux' */
+#define FIELD_FLOAT       4  /* 'f' */
+#define FIELD_INT         5  /* 'i' */
+#define FIELD_TIME        6  /* 'T' */
+#define FIELD_DATE        7  /* 'D' */
+
+#define FIELD(t,s,m)      { t, offsetof(struct s, m), 0 }
+#define DIRFIELD(s,m)     { FIELD_DIR, 0, offsetof(struct s, m) }
+
+#define NFIELDS(a)        (sizeof(a) / sizeof(a[0]))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One field of a sentence, following the talker/type field */
+
+struct minmea_field_s
+{
+  uint8_t type;                     /* FIELD_* */
+  uint8_t offset;                   /* Offset of the value in the frame */
+  uint8_t aux;                      /* FIELD_DIR: offset of the float */
+};
+
+/* The layout of one supported sentence */
+
+struct minmea_format_s
+{
+  char name[4];                     /* Sentence type, e.g. "RMC" */
+  enum minmea_sentence_id id;
+  uint8_t nfields;                  /* Number of entries in 'fields' */
+  uint8_t nrequired;                /* Number of fields that must exist */
+  FAR const struct minmea_field_s *fields;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* $GPRMC,081836,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*62 */
+
+static const struct minmea_field_s g_rmc_fields[] =
+{
+  FIELD(FIELD_TIME,  minmea_sentence_rmc, time),
+  FIELD(FIELD_VALID, minmea_sentence_rmc, valid),
+  FIELD(FIELD_FLOAT, minmea_sentence_rmc, latitude),
+  DIRFIELD(minmea_sentence_rmc, latitude),
+  FIELD(FIELD_FLOAT, minmea_sentence_rmc, longitude),
+  DIRFIELD(minmea_sentence_rmc, longitude),
+  FIELD(FIELD_FLOAT, minmea_sentence_rmc, speed),
+  FIELD(FIELD_FLOAT, minmea_sentence_rmc, course),
+  FIELD(FIELD_DATE,  minmea_sentence_rmc, date),
+  FIELD(FIELD_FLOAT, minmea_sentence_rmc, variation),
+  DIRFIELD(minmea_sentence_rmc, variation),
+};
+
+/* $GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47 */
+
+static const struct minmea_field_s g_gga_fields[] =
+{
+  FIELD(FIELD_TIME,  minmea_sentence_gga, time),
+  FIELD(FIELD_FLOAT, minmea_sentence_gga, latitude),
+  DIRFIELD(minmea_sentence_gga, latitude),
+  FIELD(FIELD_FLOAT, minmea_sentence_gga, longitude),
+  DIRFIELD(minmea_sentence_gga, longitude),
+  FIELD(FIELD_INT,   minmea_sentence_gga, fix_quality),
+  FIELD(FIELD_INT,   minmea_sentence_gga, satellites_tracked),
+  FIELD(FIELD_FLOAT, minmea_sentence_gga, hdop),
+  FIELD(FIELD_FLOAT, minmea_sentence_gga, altitude),
+  FIELD(FIELD_CHAR,  minmea_sentence_gga, altitude_units),
+  FIELD(FIELD_FLOAT, minmea_sentence_gga, height),
+  FIELD(FIELD_CHAR,  minmea_sentence_gga, height_units),
+  FIELD(FIELD_INT,   minmea_sentence_gga, dgps_age),
+  { FIELD_IGNORE, 0, 0 },
+};
+
+/* $GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39 */
+
+static const struct minmea_field_s g_gsa_fields[] =
+{
+  FIELD(FIELD_CHAR,  minmea_sentence_gsa, mode),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, fix_type),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[0]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[1]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[2]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[3]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[4]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[5]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[6]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[7]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[8]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[9]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[10]),
+  FIELD(FIELD_INT,   minmea_sentence_gsa, sats[11]),
+  FIELD(FIELD_FLOAT, minmea_sentence_gsa, pdop),
+  FIELD(FIELD_FLOAT, minmea_sentence_gsa, hdop),
+  FIELD(FIELD_FLOAT, minmea_sentence_gsa, vdop),
+};
+
+/* $GPGLL,3723.2475,N,12158.3416,W,161229.487,A,A*41 */
+
+static const struct minmea_field_s g_gll_fields[] =
+{
+  FIELD(FIELD_FLOAT, minmea_sentence_gll, latitude),
+  DIRFIELD(minmea_sentence_gll, latitude),
+  FIELD(FIELD_FLOAT, minmea_sentence_gll, longitude),
+  DIRFIELD(minmea_sentence_gll, longitude),
+  FIELD(FIELD_TIME,  minmea_sentence_gll, time),
+  FIELD(FIELD_CHAR,  minmea_sentence_gll, status),
+  FIELD(FIELD_CHAR,  minmea_sentence_gll, mode),
+};
+
+/* $GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6,22.0*58 */
+
+static const struct minmea_field_s g_gst_fields[] =
+{
+  FIELD(FIELD_TIME,  minmea_sentence_gst, time),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, rms_deviation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, semi_major_deviation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, semi_minor_deviation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, semi_major_orientation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, latitude_error_deviation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, longitude_error_deviation),
+  FIELD(FIELD_FLOAT, minmea_sentence_gst, altitude_error_deviation),
+};
+
+/* $GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74 */
+
+static const struct minmea_field_s g_gsv_fields[] =
+{
+  FIELD(FIELD_INT,   minmea_sentence_gsv, total_msgs),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, msg_nr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, total_sats),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[0].nr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[0].elevation),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[0].azimuth),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[0].snr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[1].nr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[1].elevation),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[1].azimuth),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[1].snr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[2].nr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[2].elevation),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[2].azimuth),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[2].snr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[3].nr),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[3].elevation),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[3].azimuth),
+  FIELD(FIELD_INT,   minmea_sentence_gsv, sats[3].snr),
+};
+
+static const struct minmea_format_s g_formats[] =
+{
+  {
+    "RMC", MINMEA_SENTENCE_RMC, NFIELDS(g_rmc_fields),
+    NFIELDS(g_rmc_fields), g_rmc_fields
+  },
+  {
+    "GGA", MINMEA_SENTENCE_GGA, NFIELDS(g_gga_fields),
+    NFIELDS(g_gga_fields), g_gga_fields
+  },
+  {
+    "GSA", MINMEA_SENTENCE_GSA, NFIELDS(g_gsa_fields),
+    NFIELDS(g_gsa_fields), g_gsa_fields
+  },
+  {
+    "GLL", MINMEA_SENTENCE_GLL, NFIELDS(g_gll_fields),
+    NFIELDS(g_gll_fields) - 1, g_gll_fields
+  },
+  {
+    "GST", MINMEA_SENTENCE_GST, NFIELDS(g_gst_fields),
+    NFIELDS(g_gst_fields), g_gst_fields
+  },
+  {
+    "GSV", MINMEA_SENTENCE_GSV, NFIELDS(g_gsv_fields),
+    3, g_gsv_fields
+  },
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int minmea_hex2int(char c)
+{
+  if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+
+  if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+
+  if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+
+  return -1;
+}
+
+/* Start a new field.  Only the talker/type field and the fields of a
+ * supported sentence need to look at each character.
+ */
+
+static inline void minmea_field_begin(FAR struct minmea_stream *stream)
+{
+  FAR const struct minmea_format_s *format = stream->format;
+
+  stream->fpos  = 0;
+  stream->sign  = 0;
+  stream->value = -1;
+  stream->scale = 0;
+  stream->desc  = NULL;
+
+  if (format != NULL && stream->field > 0 &&
+      stream->field <= format->nfields)
+    {
+      stream->desc = &format->fields[stream->field - 1];
+    }
+
+  stream->decode = (stream->field == 0 || stream->desc != NULL);
+}
+
+/* Identify the sentence from its talker/type field */
+
+static bool minmea_field_type(FAR struct minmea_stream *stream)
+{
+  unsigned int i;
+
+  /* The talker and type are always five characters (longer types are
+   * truncated, just like minmea_scan() does).
+   */
+
+  if (stream->fpos < 5)
+    {
+      return false;
+    }
+
+  stream->type[5] = '\0';
+  stream->format  = NULL;
+
+  for (i = 0; i < NFIELDS(g_formats); i++)
+    {
+      if (stream->type[2] == g_formats[i].name[0] &&
+          stream->type[3] == g_formats[i].name[1] &&
+          stream->type[4] == g_formats[i].name[2])
+        {
+          /* Fields that are missing at the end of the sentence read as
+           * zero.
+           */
+
+          stream->format = &g_formats[i];
+          memset(&stream->frame, 0, sizeof(stream->frame));
+          break;
+        }
+    }
+
+  return true;
+}
+
+/* Handle one character of a field.  Returns false if the character is not
+ * valid for the field.
+ */
+
+static inline bool minmea_field_char(FAR struct minmea_stream *stream,
+                                     char c)
+{
+  FAR const struct minmea_field_s *desc;
+  FAR uint8_t *frame;
+  int digit;
+
+  /* The first field is the talker and sentence type */
+
+  if (stream->field == 0)
+    {
+      if (stream->fpos < 5)
+        {
+          stream->type[stream->fpos] = c;
+        }
+
+      stream->fpos++;
+      return true;
+    }
+
+  desc  = (FAR const struct minmea_field_s *)stream->desc;
+  frame = (FAR uint8_t *)&stream->frame;
+  digit = c - '0';
+
+  switch (desc->type)
+    {
+      case FIELD_CHAR:
+        if (stream->fpos == 0)
+          {
+            *(FAR char *)(frame + desc->offset) = c;
+          }
+        break;
+
+      case FIELD_VALID:
+        if (stream->fpos == 0)
+          {
+            *(FAR bool *)(frame + desc->offset) = (c == 'A');
+          }
+        break;
+
+      case FIELD_DIR:
+        if (stream->fpos == 0)
+          {
+            if (c == 'N' || c == 'E')
+              {
+                stream->sign = 1;
+              }
+            else if (c == 'S' || c == 'W')
+              {
+                stream->sign = -1;
+              }
+            else
+              {
+                return false;
+              }
+          }
+        break;
+
+      case FIELD_FLOAT:
+        if (c == '+' && !stream->sign && stream->value == -1)
+          {
+            stream->sign = 1;
+          }
+        else if (c == '-' && !stream->sign && stream->value == -1)
+          {
+            stream->sign = -1;
+          }
+        else if (digit >= 0 && digit <= 9)
+          {
+            if (stream->value == -1)
+              {
+                stream->value = 0;
+              }
+
+            if (stream->value > (INT_LEAST32_MAX - digit) / 10)
+              {
+                /* Out of bits: truncate extra precision, but an integer
+                 * overflow is an error.
+                 */
+
+                if (stream->scale == 0)
+                  {
+                    return false;
+                  }
+
+                stream->decode = false;
+                break;
+              }
+
+            stream->value = 10 * stream->value + digit;
+            if (stream->scale)
+              {
+                stream->scale *= 10;
+              }
+          }
+        else if (c == '.' && stream->scale == 0)
+          {
+            stream->scale = 1;
+          }
+        else if (c == ' ')
+          {
+            /* Allow spaces at the start of the field. Not NMEA conformant,
+             * but some modules do this.
+             */
+
+            if (stream->sign != 0 || stream->value != -1 ||
+                stream->scale != 0)
+              {
+                return false;
+              }
+          }
+        else
+          {
+            return false;
+          }
+        break;
+
+      case FIELD_INT:
+
+        /* Same as strtol(): leading spaces, an optional sign and digits,
+         * with nothing after the digits.
+         */
+
+        if (digit >= 0 && digit <= 9)
+          {
+            if (stream->value == -1)
+              {
+                stream->value = 0;
+              }
+
+            if (stream->value <= (INT_LEAST32_MAX - digit) / 10)
+              {
+                stream->value = 10 * stream->value + digit;
+              }
+          }
+        else if (stream->value != -1 || stream->sign != 0)
+          {
+            return false;
+          }
+        else if (c == '+' || c == '-')
+          {
+            stream->sign = (c == '-') ? -1 : 1;
+          }
+        else if (c != ' ')
+          {
+            return false;
+          }
+        break;
+
+      case FIELD_TIME:
+        if (stream->fpos < 6)
+          {
+            /* Always at least six digits: hhmmss */
+
+            if (digit < 0 || digit > 9)
+              {
+                return false;
+              }
+
+            stream->value = (stream->fpos == 0 ? 0 : 10 * stream->value) +
+                            digit;
+          }
+        else if (stream->fpos == 6)
+          {
+            /* Extra: fractional time.  Saved as microseconds. */
+
+            if (c == '.')
+              {
+                stream->scale = 1000000;
+                stream->frac  = 0;
+              }
+            else
+              {
+                stream->decode = false;
+              }
+          }
+        else if (digit >= 0 && digit <= 9 && stream->scale > 1)
+          {
+            stream->scale /= 10;
+            stream->frac   = 10 * stream->frac + digit;
+          }
+        else
+          {
+            stream->decode = false;
+          }
+        break;
+
+      case FIELD_DATE:
+        if (stream->fpos < 6)
+          {
+            /* Always six digits: ddmmyy */
+
+            if (digit < 0 || digit > 9)
+              {
+                return false;
+              }
+
+            stream->value = (stream->fpos == 0 ? 0 : 10 * stream->value) +
+                            digit;
+          }
+        break;
+
+      default:
+        break;
+    }
+
+  stream->fpos++;
+  return true;
+}
+
+/* Store the value of the field that has just ended.  Returns false if the
+ * field is not valid.
+ */
+
+static bool minmea_field_end(FAR struct minmea_stream *stream)
+{
+  FAR const struct minmea_field_s *desc;
+  FAR uint8_t *frame;
+
+  if (stream->field == 0)
+    {
+      return minmea_field_type(stream);
+    }
+
+  desc = (FAR const struct minmea_field_s *)stream->desc;
+  if (desc == NULL)
+    {
+      return true;
+    }
+
+  frame = (FAR uint8_t *)&stream->frame;
+
+  switch (desc->type)
+    {
+      case FIELD_DIR:
+        {
+          FAR struct minmea_float *f =
+            (FAR struct minmea_float *)(frame + desc->aux);
+
+          /* An empty direction makes the value zero, as in
+           * minmea_parse_*().
+           */
+
+          f->value *= stream->sign;
+        }
+        break;
+
+      case FIELD_FLOAT:
+        {
+          FAR struct minmea_float *f =
+            (FAR struct minmea_float *)(frame + desc->offset);
+
+          if ((stream->sign || stream->scale) && stream->value == -1)
+            {
+              return false;
+            }
+
+          if (stream->value == -1)
+            {
+              /* No digits were scanned. */
+
+              f->value = 0;
+              f->scale = 0;
+            }
+          else
+            {
+              f->value = stream->sign ? stream->value * stream->sign :
+                                        stream->value;
+              f->scale = stream->scale ? stream->scale : 1;
+            }
+        }
+        break;
+
+      case FIELD_INT:
+        if (stream->value == -1)
+          {
+            /* Only an empty field has no digits */
+
+            if (stream->fpos > 0)
+              {
+                return false;
+              }
+
+            stream->value = 0;
+          }
+
+        *(FAR int *)(frame + desc->offset) =
+          stream->sign < 0 ? -stream->value : stream->value;
+        break;
+
+      case FIELD_CHAR:
+        if (stream->fpos == 0)
+          {
+            *(FAR char *)(frame + desc->offset) = '\0';
+          }
+        break;
+
+      case FIELD_TIME:
+        {
+          FAR struct minmea_time *t =
+            (FAR struct minmea_time *)(frame + desc->offset);
+
+          if (stream->fpos == 0)
+            {
+              t->hours        = -1;
+              t->minutes      = -1;
+              t->seconds      = -1;
+              t->microseconds = -1;
+            }
+          else if (stream->fpos < 6)
+            {
+              return false;
+            }
+          else
+            {
+              t->hours        = stream->value / 10000;
+              t->minutes      = stream->value / 100 % 100;
+              t->seconds      = stream->value % 100;
+              t->microseconds = stream->scale ?
+                                stream->frac * stream->scale : 0;
+            }
+        }
+        break;
+
+      case FIELD_DATE:
+        {
+          FAR struct minmea_date *d =
+            (FAR struct minmea_date *)(frame + desc->offset);
+
+          if (stream->fpos == 0)
+            {
+              d->day   = -1;
+              d->month = -1;
+              d->year  = -1;
+            }
+          else if (stream->fpos < 6)
+            {
+              return false;
+            }
+          else
+            {
+              d->day   = stream->value / 10000;
+              d->month = stream->value / 100 % 100;
+              d->year  = stream->value % 100;
+            }
+        }
+        break;
+
+      default:
+        break;
+    }
+
+  return true;
+}
+
+/* A sentence has been received completely.  Returns the sentence ID. */
+
+static enum minmea_sentence_id
+minmea_sentence_end(FAR struct minmea_stream *stream)
+{
+  FAR const struct minmea_format_s *format = stream->format;
+
+  stream->state = STREAM_IDLE;
+
+  if (format == NULL)
+    {
+      stream->nsentences++;
+      return MINMEA_UNKNOWN;
+    }
+
+  /* Were all of the required fields present? */
+
+  if (stream->field < format->nrequired)
+    {
+      stream->nerrors++;
+      return MINMEA_INVALID;
+    }
+
+  stream->nsentences++;
+  return format->id;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+void minmea_stream_init(FAR struct minmea_stream *stream, bool strict)
+{
+  memset(stream, 0, sizeof(struct minmea_stream));
+  stream->id     = MINMEA_INVALID;
+  stream->strict = strict;
+  stream->state  = STREAM_IDLE;
+}
+
+size_t minmea_stream_feed(FAR struct minmea_stream *stream,
+                          FAR const char *buffer, size_t buflen)
+{
+  size_t i;
+
+  stream->id = MINMEA_INVALID;
+
+  for (i = 0; i < buflen; i++)
+    {
+      char c = buffer[i];
+      int digit;
+
+      /* A '$' always starts a new sentence */
+
+      if (c == '$')
+        {
+          if (stream->state != STREAM_IDLE)
+            {
+              stream->nerrors++;
+            }
+
+          stream->state    = STREAM_BODY;
+          stream->checksum = 0;
+          stream->length   = 1;
+          stream->field    = 0;
+          stream->format   = NULL;
+          minmea_field_begin(stream);
+          continue;
+        }
+
+      if (stream->state == STREAM_IDLE)
+        {
+          continue;
+        }
+
+      /* Sequence length is limited. */
+
+      if (++stream->length > MINMEA_MAX_LENGTH + 3 &&
+          stream->state != STREAM_END)
+        {
+          goto errout;
+        }
+
+      switch (stream->state)
+        {
+          case STREAM_BODY:
+            if (c == ',')
+              {
+                stream->checksum ^= c;
+                if (!minmea_field_end(stream))
+                  {
+                    goto errout;
+                  }
+
+                stream->field++;
+                minmea_field_begin(stream);
+              }
+            else if (c == '*')
+              {
+                if (!minmea_field_end(stream))
+                  {
+                    goto errout;
+                  }
+
+                stream->state = STREAM_CKSUM1;
+              }
+            else if (c == '\r' || c == '\n')
+              {
+                /* Discard non-checksummed frames in strict mode. */
+
+                if (stream->strict || !minmea_field_end(stream))
+                  {
+                    goto errout;
+                  }
+
+                stream->id = minmea_sentence_end(stream);
+                return i + 1;
+              }
+            else if (c >= 0x20 && c < 0x7f)
+              {
+                stream->checksum ^= c;
+                if (stream->decode && !minmea_field_char(stream, c))
+                  {
+                    goto errout;
+                  }
+              }
+            else
+              {
+                goto errout;
+              }
+            break;
+
+          case STREAM_CKSUM1:
+            digit = minmea_hex2int(c);
+            if (digit < 0)
+              {
+                goto errout;
+              }
+
+            stream->expected = digit << 4;
+            stream->state    = STREAM_CKSUM2;
+            break;
+
+          case STREAM_CKSUM2:
+            digit = minmea_hex2int(c);
+            if (digit < 0 || stream->checksum != (stream->expected | digit))
+              {
+                goto errout;
+              }
+
+            stream->state = STREAM_END;
+            break;
+
+          case STREAM_END:
+
+            /* The only stuff allowed at this point is a newline. */
+
+            if (c != '\r' && c != '\n')
+              {
+                goto errout;
+              }
+
+            stream->id = minmea_sentence_end(stream);
+            return i + 1;
+
+          default:
+            break;
+        }
+
+      continue;
+
+errout:
+      /* Discard the rest of the sentence */
+
+      stream->nerrors++;
+      stream->state = STREAM_IDLE;
+    }
+
+  return buflen;
+}
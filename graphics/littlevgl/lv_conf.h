@@ -147,7 +147,7 @@ typedef int16_t lv_coord_t;
 
 /* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB) */
 
-#  define LV_MEM_SIZE    (32U * 1024U)
+#  define LV_MEM_SIZE    CONFIG_LV_MEM_SIZE
 
 /* Complier prefix for a big array declaration */
 
@@ -164,6 +164,16 @@ typedef int16_t lv_coord_t;
  */
 
 #  define LV_MEM_AUTO_DEFRAG  1
+
+/* 1: Serve blocks up to 256 bytes from size class free lists in O(1),
+ * larger blocks are allocated from the end of the memory
+ */
+
+#  ifdef CONFIG_LV_MEM_POOL
+#    define LV_MEM_POOL       CONFIG_LV_MEM_POOL
+#  else
+#    define LV_MEM_POOL       0
+#  endif
 #else       /* LV_MEM_CUSTOM */
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /* Header for the dynamic memory function */
 #  define LV_MEM_CUSTOM_ALLOC   malloc       /* Wrapper to malloc */
@@ -267,6 +277,14 @@ typedef void * lv_group_user_data_t;
 #define LV_USE_GPU           0
 #endif
 
+/* 1: Use the word-wide/SIMD software fill and blend */
+
+#ifdef CONFIG_LV_DRAW_SIMD
+#define LV_DRAW_SIMD         CONFIG_LV_DRAW_SIMD
+#else
+#define LV_DRAW_SIMD         0
+#endif
+
 /* 1: Enable file system (might be required for images */
 
 #ifdef CONFIG_USE_LV_FILESYSTEM
@@ -317,7 +335,22 @@ typedef void * lv_fs_drv_user_data_t;
  * LV_IMG_CACHE_DEF_SIZE must be >= 1
  */
 
+#ifdef CONFIG_LV_IMG_CACHE_DEF_SIZE
+#define LV_IMG_CACHE_DEF_SIZE     CONFIG_LV_IMG_CACHE_DEF_SIZE
+#else
 #define LV_IMG_CACHE_DEF_SIZE     1
+#endif
+
+/* Bytes of RAM for images the cache decodes completely, so they don't have
+ * to be read line by line at every draw.  The least recently used images
+ * are dropped to stay within the budget.  0: keep images opened only.
+ */
+
+#ifdef CONFIG_LV_IMG_CACHE_BUDGET
+#define LV_IMG_CACHE_BUDGET       CONFIG_LV_IMG_CACHE_BUDGET
+#else
+#define LV_IMG_CACHE_BUDGET       0
+#endif
 
 /* Declare the type of the user data of image decoder
  * (can be e.g. `void *`, `int`, `struct`)
@@ -76,6 +76,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <cstring>
 #include <cerrno>
 #include <debug.h>
 
@@ -96,6 +97,32 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+#define NXWIDGETS_BYTESPP ((CONFIG_NXWIDGETS_BPP + 7) >> 3)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+/**
+ * Store one pixel in the off-screen copy of the window.
+ *
+ * @param dest The address of the pixel.
+ * @param color The color of the pixel.
+ */
+
+static inline void batchPutPixel(FAR uint8_t *dest, nxgl_mxpixel_t color)
+{
+#if CONFIG_NXWIDGETS_BPP == 24
+  dest[0] = (uint8_t)color;
+  dest[1] = (uint8_t)(color >> 8);
+  dest[2] = (uint8_t)(color >> 16);
+#else
+  *(FAR NXWidgets::nxwidget_pixel_t *)dest = (NXWidgets::nxwidget_pixel_t)color;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Method Implementations
  ****************************************************************************/
@@ -115,14 +142,26 @@ CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd, nxgl_mxpixel_t backColor)
 {
   m_pNxWnd    = pNxWnd;
   m_backColor = backColor;
-}
 #else
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd)
 {
   m_pNxWnd = pNxWnd;
-}
 #endif
 
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  m_batchBuffer       = (FAR uint8_t *)NULL;
+  m_batchSize.w       = 0;
+  m_batchSize.h       = 0;
+  m_batchStride       = 0;
+  m_batchNest         = 0;
+  m_batchValid        = false;
+  m_damage.pt1.x      = 0;
+  m_damage.pt1.y      = 0;
+  m_damage.pt2.x      = -1;
+  m_damage.pt2.y      = -1;
+#endif
+}
+
 /**
  * Destructor.
  */
@@ -132,8 +171,350 @@ CGraphicsPort::~CGraphicsPort(void)
   // m_pNxWnd is not deleted.  This is an abstract base class and
   // the caller of the CGraphicsPort instance is responsible for
   // the window destruction.
+
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (m_batchBuffer)
+    {
+      delete[] m_batchBuffer;
+    }
+#endif
 };
 
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+/**
+ * Start collecting drawing operations in an off-screen copy of the
+ * window.  Calls may be nested; nothing is sent to the window until
+ * the outermost endBatch().
+ */
+
+void CGraphicsPort::beginBatch(void)
+{
+  if (m_batchNest++ > 0)
+    {
+      return;
+    }
+
+  // (Re-)allocate the off-screen copy if the window size has changed
+
+  struct nxgl_size_s size;
+  if (!m_pNxWnd->getSize(&size))
+    {
+      size.w = 0;
+      size.h = 0;
+    }
+
+  if (size.w != m_batchSize.w || size.h != m_batchSize.h)
+    {
+      if (m_batchBuffer)
+        {
+          delete[] m_batchBuffer;
+          m_batchBuffer = (FAR uint8_t *)NULL;
+        }
+
+      m_batchSize.w = 0;
+      m_batchSize.h = 0;
+      m_batchValid  = false;
+
+      if (size.w > 0 && size.h > 0)
+        {
+          unsigned int stride = ((unsigned int)size.w * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+
+          m_batchBuffer = new uint8_t[stride * size.h];
+          if (m_batchBuffer)
+            {
+              m_batchSize   = size;
+              m_batchStride = stride;
+            }
+          else
+            {
+              gwarn("WARNING: No memory for the batch buffer\n");
+            }
+        }
+    }
+
+  m_damage.pt1.x = 0;
+  m_damage.pt1.y = 0;
+  m_damage.pt2.x = -1;
+  m_damage.pt2.y = -1;
+}
+
+/**
+ * Stop collecting drawing operations.  When the outermost batch ends,
+ * the damaged region is sent to the window as a single bitmap.
+ */
+
+void CGraphicsPort::endBatch(void)
+{
+  if (m_batchNest > 0 && --m_batchNest == 0)
+    {
+      batchFlush();
+    }
+}
+
+/**
+ * Make sure that the off-screen copy of the window holds the current
+ * window contents.
+ *
+ * @return True if drawing should go to the off-screen copy; false if
+ *   drawing should go directly to the window.
+ */
+
+bool CGraphicsPort::batchPrepare(void)
+{
+  if (m_batchNest == 0 || !m_batchBuffer)
+    {
+      // Anything drawn directly makes the off-screen copy stale
+
+      m_batchValid = false;
+      return false;
+    }
+
+  if (!m_batchValid)
+    {
+      // One read of the whole window, instead of one per transparent
+      // glyph or inverted region
+
+      struct nxgl_rect_s rect;
+      rect.pt1.x = 0;
+      rect.pt1.y = 0;
+      rect.pt2.x = m_batchSize.w - 1;
+      rect.pt2.y = m_batchSize.h - 1;
+
+      struct SBitmap bitmap;
+      bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
+      bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
+      bitmap.width  = m_batchSize.w;
+      bitmap.height = m_batchSize.h;
+      bitmap.stride = m_batchStride;
+      bitmap.data   = (FAR const nxgl_mxpixel_t *)m_batchBuffer;
+
+      m_pNxWnd->getRectangle(&rect, &bitmap);
+      m_batchValid = true;
+    }
+
+  return true;
+}
+
+/**
+ * Clip a window-relative rectangle to the off-screen copy and add it
+ * to the damaged region.
+ *
+ * @param rect The rectangle to be drawn.
+ * @param clipped The location to return the clipped rectangle.
+ * @return True if anything remains after clipping.
+ */
+
+bool CGraphicsPort::batchDamage(FAR const struct nxgl_rect_s *rect,
+                                FAR struct nxgl_rect_s *clipped)
+{
+  struct nxgl_rect_s bounds;
+  bounds.pt1.x = 0;
+  bounds.pt1.y = 0;
+  bounds.pt2.x = m_batchSize.w - 1;
+  bounds.pt2.y = m_batchSize.h - 1;
+
+  nxgl_rectintersect(clipped, rect, &bounds);
+  if (nxgl_nullrect(clipped))
+    {
+      return false;
+    }
+
+  if (nxgl_nullrect(&m_damage))
+    {
+      m_damage = *clipped;
+    }
+  else
+    {
+      nxgl_rectunion(&m_damage, &m_damage, clipped);
+    }
+
+  return true;
+}
+
+/**
+ * Push the damaged region of the off-screen copy to the window in
+ * one bitmap update.
+ */
+
+void CGraphicsPort::batchFlush(void)
+{
+  if (m_batchBuffer && !nxgl_nullrect(&m_damage))
+    {
+      struct nxgl_point_s origin;
+      origin.x = 0;
+      origin.y = 0;
+
+      if (!m_pNxWnd->bitmap(&m_damage, (FAR const void *)m_batchBuffer,
+                            &origin, m_batchStride))
+        {
+          gerr("ERROR: INxWindow::bitmap failed\n");
+        }
+    }
+
+  m_damage.pt1.x = 0;
+  m_damage.pt1.y = 0;
+  m_damage.pt2.x = -1;
+  m_damage.pt2.y = -1;
+}
+
+/**
+ * Prepare for a drawing operation that can only be performed by the
+ * window itself.  Pending damage is flushed first and the off-screen
+ * copy is marked stale.
+ */
+
+void CGraphicsPort::batchBypass(void)
+{
+  if (m_batchNest > 0)
+    {
+      batchFlush();
+    }
+
+  m_batchValid = false;
+}
+#endif
+
+/**
+ * Fill a rectangle, either in the off-screen copy or in the window.
+ *
+ * @param rect The window-relative rectangle to fill.
+ * @param color The fill color.
+ * @return True on success.
+ */
+
+bool CGraphicsPort::fill(FAR const struct nxgl_rect_s *rect,
+                         nxgl_mxpixel_t color)
+{
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (batchPrepare())
+    {
+      struct nxgl_rect_s clipped;
+      if (batchDamage(rect, &clipped))
+        {
+          // Fill the first row pixel by pixel, then replicate it
+
+          unsigned int  width = clipped.pt2.x - clipped.pt1.x + 1;
+          unsigned int  nbytes = width * NXWIDGETS_BYTESPP;
+          FAR uint8_t  *first = m_batchBuffer + clipped.pt1.y * m_batchStride +
+                                clipped.pt1.x * NXWIDGETS_BYTESPP;
+          FAR uint8_t  *dest  = first;
+
+          for (unsigned int i = 0; i < width; i++)
+            {
+              batchPutPixel(dest, color);
+              dest += NXWIDGETS_BYTESPP;
+            }
+
+          dest = first + m_batchStride;
+          for (nxgl_coord_t y = clipped.pt1.y + 1; y <= clipped.pt2.y; y++)
+            {
+              memcpy(dest, first, nbytes);
+              dest += m_batchStride;
+            }
+        }
+
+      return true;
+    }
+#endif
+
+  return m_pNxWnd->fill(rect, color);
+}
+
+/**
+ * Copy a rectangular region of a larger image, either into the
+ * off-screen copy or into the window.  The arguments are the same as
+ * for INxWindow::bitmap().
+ *
+ * @param dest The window-relative rectangle to receive the image.
+ * @param src The start of the source image.
+ * @param origin The window-relative position of the source image.
+ * @param stride The length of one source row in bytes.
+ * @return True on success.
+ */
+
+bool CGraphicsPort::blit(FAR const struct nxgl_rect_s *dest,
+                         FAR const void *src,
+                         FAR const struct nxgl_point_s *origin,
+                         unsigned int stride)
+{
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (batchPrepare())
+    {
+      struct nxgl_rect_s clipped;
+      if (batchDamage(dest, &clipped))
+        {
+          unsigned int  nbytes  = (clipped.pt2.x - clipped.pt1.x + 1) *
+                                  NXWIDGETS_BYTESPP;
+          FAR uint8_t  *destPtr = m_batchBuffer +
+                                  clipped.pt1.y * m_batchStride +
+                                  clipped.pt1.x * NXWIDGETS_BYTESPP;
+          FAR const uint8_t *srcPtr = (FAR const uint8_t *)src +
+                                  (clipped.pt1.y - origin->y) * stride +
+                                  (clipped.pt1.x - origin->x) * NXWIDGETS_BYTESPP;
+
+          for (nxgl_coord_t y = clipped.pt1.y; y <= clipped.pt2.y; y++)
+            {
+              memcpy(destPtr, srcPtr, nbytes);
+              destPtr += m_batchStride;
+              srcPtr  += stride;
+            }
+        }
+
+      return true;
+    }
+#endif
+
+  return m_pNxWnd->bitmap(dest, src, origin, stride);
+}
+
+/**
+ * Read a rectangular region, either from the off-screen copy or from
+ * the window.
+ *
+ * @param rect The window-relative rectangle to read.
+ * @param dest The bitmap that receives the data.
+ */
+
+void CGraphicsPort::read(FAR const struct nxgl_rect_s *rect,
+                         FAR struct SBitmap *dest)
+{
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (m_batchNest > 0 && m_batchBuffer && batchPrepare())
+    {
+      struct nxgl_rect_s bounds;
+      bounds.pt1.x = 0;
+      bounds.pt1.y = 0;
+      bounds.pt2.x = m_batchSize.w - 1;
+      bounds.pt2.y = m_batchSize.h - 1;
+
+      struct nxgl_rect_s clipped;
+      nxgl_rectintersect(&clipped, rect, &bounds);
+      if (!nxgl_nullrect(&clipped))
+        {
+          unsigned int  nbytes  = (clipped.pt2.x - clipped.pt1.x + 1) *
+                                  NXWIDGETS_BYTESPP;
+          FAR const uint8_t *srcPtr = m_batchBuffer +
+                                  clipped.pt1.y * m_batchStride +
+                                  clipped.pt1.x * NXWIDGETS_BYTESPP;
+          FAR uint8_t  *destPtr = (FAR uint8_t *)dest->data +
+                                  (clipped.pt1.y - rect->pt1.y) * dest->stride +
+                                  (clipped.pt1.x - rect->pt1.x) * NXWIDGETS_BYTESPP;
+
+          for (nxgl_coord_t y = clipped.pt1.y; y <= clipped.pt2.y; y++)
+            {
+              memcpy(destPtr, srcPtr, nbytes);
+              destPtr += dest->stride;
+              srcPtr  += m_batchStride;
+            }
+        }
+
+      return;
+    }
+#endif
+
+  m_pNxWnd->getRectangle(rect, dest);
+}
+
 /**
  * Return the absolute x coordinate of the upper left hand corner of the
  * underlying window.
@@ -173,6 +554,21 @@ const nxgl_coord_t CGraphicsPort::getY(void) const
 void CGraphicsPort::drawPixel(nxgl_coord_t x, nxgl_coord_t y,
                               nxgl_mxpixel_t color)
 {
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (m_batchNest > 0)
+    {
+      struct nxgl_rect_s rect;
+      rect.pt1.x = x;
+      rect.pt1.y = y;
+      rect.pt2.x = x;
+      rect.pt2.y = y;
+      fill(&rect, color);
+      return;
+    }
+
+  m_batchValid = false;
+#endif
+
   struct nxgl_point_s pos;
   pos.x = x;
   pos.y = y;
@@ -202,7 +598,7 @@ void CGraphicsPort::drawHorizLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (!fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -232,7 +628,7 @@ void CGraphicsPort::drawVertLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (!fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -261,6 +657,10 @@ void CGraphicsPort::drawLine(nxgl_coord_t x1, nxgl_coord_t y1,
   vector.pt2.x = x2;
   vector.pt2.y = y2;
 
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  batchBypass();
+#endif
+
   if (!m_pNxWnd->drawLine(&vector, 1, color, caps))
     {
       gerr("ERROR: INxWindow::drawLine failed\n");
@@ -286,7 +686,7 @@ void CGraphicsPort::drawFilledRect(nxgl_coord_t x, nxgl_coord_t y,
   rect.pt1.y = y;
   rect.pt2.x = x + width - 1;
   rect.pt2.y = y + height - 1;
-  m_pNxWnd->fill(&rect, color);
+  fill(&rect, color);
 }
 
 /**
@@ -331,6 +731,25 @@ void CGraphicsPort::drawBevelledRect(nxgl_coord_t x, nxgl_coord_t y,
   drawVertLine(x + width - 1, y + 1, height - 2, shadowColor);   // Right
 }
 
+/**
+ * Draw a filled circle at the specified position, size, and color.
+ *
+ * @param center The window-relative coordinates of the circle center.
+ * @param radius The radius of the rectangle in pixels.
+ * @param color The color of the rectangle.
+ */
+
+void CGraphicsPort::drawFilledCircle(struct nxgl_point_s *center,
+                                     nxgl_coord_t radius,
+                                     nxgl_mxpixel_t color)
+{
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  batchBypass();
+#endif
+
+  m_pNxWnd->drawFilledCircle(center, radius, color);
+}
+
 /**
  * Draw an opaque bitmap to the window.
  *
@@ -369,7 +788,7 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
 
   // Blit the bitmap
 
-  m_pNxWnd->bitmap(&dest, (FAR const void *)bitmap->data, &origin, bitmap->stride);
+  blit(&dest, (FAR const void *)bitmap->data, &origin, bitmap->stride);
 }
 
 /**
@@ -507,7 +926,7 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
 
       // Blit the bitmap
 
-      m_pNxWnd->bitmap(&dest, (FAR const void *)runPtr, &origin, bitmap->stride);
+      blit(&dest, (FAR const void *)runPtr, &origin, bitmap->stride);
     }
 }
 
@@ -582,7 +1001,7 @@ void CGraphicsPort::drawBitmapGreyScale(nxgl_coord_t x, nxgl_coord_t y,
 
       // Now blit the single row
 
-      m_pNxWnd->bitmap(&dest, run, &origin, bitmap->stride);
+      blit(&dest, run, &origin, bitmap->stride);
 
        // Setup for the next source row
 
@@ -796,7 +1215,25 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
           // Skip to the next character if this one is completely outside
           // the bounding box.
 
-          if (!nxgl_nullrect(&intersection))
+          // An opaque glyph may already be rendered in the font's glyph
+          // cache; then it can be sent as it is.
+
+          FAR const void *cached = (FAR const void *)NULL;
+          unsigned int cachedStride;
+
+          if (!transparent && !nxgl_nullrect(&intersection))
+            {
+              cached = font->getGlyph(letter, background, &cachedStride);
+            }
+
+          if (cached)
+            {
+              if (!blit(&intersection, cached, pos, cachedStride))
+                {
+                  ginfo("nx_bitmapwindow failed: %d\n", errno);
+                }
+            }
+          else if (!nxgl_nullrect(&intersection))
             {
               // If we have been given a background color, use it to fill the array.
               // Otherwise initialize the bitmap memory by reading from the display.
@@ -817,7 +1254,7 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
                 {
                   // Read the current contents of the destination into the glyph memory
 
-                  m_pNxWnd->getRectangle(&dest, &bitmap);
+                  read(&dest, &bitmap);
                 }
 
               // Render the font into the initialized bitmap
@@ -826,8 +1263,8 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
               // Then put the font on the display
 
-              if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)bitmap.data,
-                                   pos, bitmap.stride))
+              if (!blit(&intersection, (FAR const void *)bitmap.data,
+                        pos, bitmap.stride))
                 {
                   ginfo("nx_bitmapwindow failed: %d\n", errno);
                 }
@@ -858,18 +1295,7 @@ void CGraphicsPort::copy(nxgl_coord_t sourceX, nxgl_coord_t sourceY,
                          nxgl_coord_t destX, nxgl_coord_t destY,
                          nxgl_coord_t width, nxgl_coord_t height)
 {
-  struct nxgl_rect_s rect;
-  struct nxgl_point_s offset;
-
-  rect.pt1.x = sourceX;
-  rect.pt1.y = sourceY;
-  rect.pt1.x = sourceX + width - 1;
-  rect.pt1.y = sourceY + height - 1;
-
-  offset.x = destX - sourceX;
-  offset.y = destY - sourceY;
-
-  m_pNxWnd->move(&rect, &offset);
+  move(sourceX, sourceY, destX - sourceX, destY - sourceY, width, height);
 }
 
 /**
@@ -897,6 +1323,58 @@ void CGraphicsPort::move(nxgl_coord_t x, nxgl_coord_t y,
   offset.x = deltaX;
   offset.y = deltaY;
 
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+  if (batchPrepare())
+    {
+      // Clip the source so that both it and the destination lie within
+      // the off-screen copy
+
+      struct nxgl_rect_s bounds;
+      bounds.pt1.x = 0;
+      bounds.pt1.y = 0;
+      bounds.pt2.x = m_batchSize.w - 1;
+      bounds.pt2.y = m_batchSize.h - 1;
+
+      struct nxgl_rect_s src;
+      struct nxgl_rect_s dest;
+      nxgl_rectintersect(&src, &rect, &bounds);
+      nxgl_rectoffset(&dest, &src, offset.x, offset.y);
+
+      struct nxgl_rect_s clipped;
+      if (batchDamage(&dest, &clipped))
+        {
+          unsigned int nbytes = (clipped.pt2.x - clipped.pt1.x + 1) *
+                                NXWIDGETS_BYTESPP;
+          int          nrows  = clipped.pt2.y - clipped.pt1.y + 1;
+          int          step   = (int)m_batchStride;
+          FAR uint8_t *destPtr = m_batchBuffer +
+                                 clipped.pt1.y * m_batchStride +
+                                 clipped.pt1.x * NXWIDGETS_BYTESPP;
+
+          // Copy bottom-up when moving down so that the source rows are
+          // not overwritten before they are copied
+
+          if (offset.y > 0)
+            {
+              destPtr += (nrows - 1) * m_batchStride;
+              step     = -step;
+            }
+
+          FAR uint8_t *srcPtr = destPtr - offset.y * (int)m_batchStride -
+                                offset.x * NXWIDGETS_BYTESPP;
+
+          for (int row = 0; row < nrows; row++)
+            {
+              memmove(destPtr, srcPtr, nbytes);
+              destPtr += step;
+              srcPtr  += step;
+            }
+        }
+
+      return;
+    }
+#endif
+
   m_pNxWnd->move(&rect, &offset);
 }
 
@@ -949,7 +1427,7 @@ void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
       // Read the graphic memory corresponding to the row
 
       rect.pt1.y = rect.pt2.y = y + row;
-      m_pNxWnd->getRectangle(&rect, &rowBitmap);
+      read(&rect, &rowBitmap);
 
       // Convert each bit to  each bit
 
@@ -973,8 +1451,8 @@ void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
       // Then write the row back to graphics memory
 
       origin.y = rect.pt1.y;
-      m_pNxWnd->bitmap(&rect, (FAR const void *)rowBitmap.data,
-                       &origin, rowBitmap.stride) ;
+      blit(&rect, (FAR const void *)rowBitmap.data,
+           &origin, rowBitmap.stride);
     }
 
   delete rowBuffer;
@@ -1032,7 +1510,7 @@ void CGraphicsPort::invert(nxgl_coord_t x, nxgl_coord_t y,
       // Read the graphic memory corresponding to the row
 
       rect.pt1.y = rect.pt2.y = y + row;
-      m_pNxWnd->getRectangle(&rect, &rowBitmap);
+      read(&rect, &rowBitmap);
 
       // Invert each bit
 
@@ -1049,8 +1527,8 @@ void CGraphicsPort::invert(nxgl_coord_t x, nxgl_coord_t y,
       // Then write the row back to graphics memory
 
       origin.y = rect.pt1.y;
-      m_pNxWnd->bitmap(&rect, (FAR const void *)rowBitmap.data,
-                       &origin, rowBitmap.stride) ;
+      blit(&rect, (FAR const void *)rowBitmap.data,
+           &origin, rowBitmap.stride);
     }
 
   delete rowBuffer;
@@ -1021,21 +1021,19 @@ nxgl_coord_t CMultiLineTextBox::getRowX(int row) const
   CRect rect;
   getClientRect(rect);
 
-  uint8_t rowLength = m_text->getLineTrimmedLength(row);
-  uint8_t rowPixelWidth = m_text->getFont()->getStringWidth(*m_text, m_text->getLineStartIndex(row), rowLength);
-
-  // Calculate horizontal position
+  // Calculate horizontal position.  Left aligned rows do not need to be
+  // measured.
 
   switch (m_hAlignment)
     {
       case TEXT_ALIGNMENT_HORIZ_CENTER:
-        return (rect.getWidth() - rowPixelWidth) >> 1;
+        return (rect.getWidth() - m_text->getLineTrimmedPixelLength(row)) >> 1;
 
       case TEXT_ALIGNMENT_HORIZ_LEFT:
         return 0;
 
       case TEXT_ALIGNMENT_HORIZ_RIGHT:
-        return rect.getWidth() - rowPixelWidth;
+        return rect.getWidth() - m_text->getLineTrimmedPixelLength(row);
     }
 
   // Will never be reached
@@ -57,12 +57,74 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+#define NXWIDGETS_BYTESPP ((CONFIG_NXWIDGETS_BPP + 7) >> 3)
+
 /****************************************************************************
  * CNxFont Method Implementations
  ****************************************************************************/
 
 using namespace NXWidgets;
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+/**
+ * Copy the pixels of a cached glyph that differ from the transparent
+ * color.
+ *
+ * @param dest The first row of the destination.
+ * @param destStride The length of one destination row in bytes.
+ * @param src The first row of the cached glyph.
+ * @param srcStride The length of one glyph row in bytes.
+ * @param width The width of the glyph in pixels.
+ * @param height The height of the glyph in rows.
+ * @param transparent The color that is not copied.
+ */
+
+static void copyGlyph(FAR uint8_t *dest, unsigned int destStride,
+                      FAR const uint8_t *src, unsigned int srcStride,
+                      unsigned int width, unsigned int height,
+                      nxgl_mxpixel_t transparent)
+{
+  for (unsigned int row = 0; row < height; row++)
+    {
+#if CONFIG_NXWIDGETS_BPP == 24
+      FAR const uint8_t *srcPtr  = src;
+      FAR uint8_t       *destPtr = dest;
+
+      for (unsigned int col = 0; col < width; col++)
+        {
+          nxgl_mxpixel_t pixel = (nxgl_mxpixel_t)srcPtr[0] |
+                                 (nxgl_mxpixel_t)srcPtr[1] << 8 |
+                                 (nxgl_mxpixel_t)srcPtr[2] << 16;
+
+          if (pixel != transparent)
+            {
+              destPtr[0] = srcPtr[0];
+              destPtr[1] = srcPtr[1];
+              destPtr[2] = srcPtr[2];
+            }
+
+          srcPtr  += 3;
+          destPtr += 3;
+        }
+#else
+      FAR const nxwidget_pixel_t *srcPtr  = (FAR const nxwidget_pixel_t *)src;
+      FAR nxwidget_pixel_t       *destPtr = (FAR nxwidget_pixel_t *)dest;
+
+      for (unsigned int col = 0; col < width; col++)
+        {
+          if (srcPtr[col] != (nxwidget_pixel_t)transparent)
+            {
+              destPtr[col] = srcPtr[col];
+            }
+        }
+#endif
+
+      src  += srcStride;
+      dest += destStride;
+    }
+}
+#endif
+
 /**
  * CNxFont Constructor.
  *
@@ -80,8 +142,168 @@ CNxFont::CNxFont(enum nx_fontid_e fontid, nxgl_mxpixel_t fontColor,
   m_pFontSet         = nxf_getfontset(m_fontHandle);
   m_fontColor        = fontColor;
   m_transparentColor = transparentColor;
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // The pixel memory is allocated when the first glyph is cached
+
+  memset(m_glyphCache, 0, sizeof(m_glyphCache));
+  m_glyphSlab   = (FAR uint8_t *)NULL;
+  m_glyphStride = ((unsigned int)m_pFontSet->mxwidth * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  m_glyphClock  = 0;
+#endif
+}
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+/**
+ * CNxFont Destructor.
+ */
+
+CNxFont::~CNxFont()
+{
+  if (m_glyphSlab)
+    {
+      delete[] m_glyphSlab;
+    }
+}
+
+/**
+ * Find a glyph in the cache, rendering it into the least recently used
+ * entry if it is not there.
+ *
+ * @param letter The character.
+ * @param background The background color to render the glyph onto.
+ * @return The cache entry or NULL if the cache cannot be used.
+ */
+
+FAR const CNxFont::SGlyphCache *
+CNxFont::getCachedGlyph(nxwidget_char_t letter, nxgl_mxpixel_t background)
+{
+  unsigned int glyphSize = m_glyphStride * m_pFontSet->mxheight;
+
+  if (!m_glyphSlab)
+    {
+      m_glyphSlab = new uint8_t[glyphSize * CONFIG_NXWIDGETS_GLYPHCACHE_SIZE];
+      if (!m_glyphSlab)
+        {
+          return (FAR const struct SGlyphCache *)NULL;
+        }
+
+      for (int i = 0; i < CONFIG_NXWIDGETS_GLYPHCACHE_SIZE; i++)
+        {
+          m_glyphCache[i].bitmap = &m_glyphSlab[i * glyphSize];
+        }
+    }
+
+  // Look for the glyph, remembering the least recently used entry in case
+  // it is not there
+
+  FAR struct SGlyphCache *victim = &m_glyphCache[0];
+  m_glyphClock++;
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_GLYPHCACHE_SIZE; i++)
+    {
+      FAR struct SGlyphCache *entry = &m_glyphCache[i];
+      if (!entry->valid)
+        {
+          victim = entry;
+          continue;
+        }
+
+      if (entry->letter == letter && entry->color == m_fontColor &&
+          entry->background == background)
+        {
+          entry->lastUse = m_glyphClock;
+          return entry;
+        }
+
+      if (victim->valid && entry->lastUse < victim->lastUse)
+        {
+          victim = entry;
+        }
+    }
+
+  // Render the glyph onto the background color.  Characters without a
+  // glyph are rendered as spaces.
+
+  FAR const struct nx_fontbitmap_s *fbm = nxf_getbitmap(m_fontHandle, letter);
+  uint8_t fwidth;
+
+  if (fbm)
+    {
+      fwidth = fbm->metric.width + fbm->metric.xoffset;
+    }
+  else
+    {
+      fwidth = m_pFontSet->spwidth;
+    }
+
+  if (fwidth > m_pFontSet->mxwidth)
+    {
+      return (FAR const struct SGlyphCache *)NULL;
+    }
+
+  // Fill the first row with the background color, then replicate it
+
+  FAR uint8_t *dest = victim->bitmap;
+  for (unsigned int col = 0; col < fwidth; col++)
+    {
+#if CONFIG_NXWIDGETS_BPP == 24
+      dest[0] = (uint8_t)background;
+      dest[1] = (uint8_t)(background >> 8);
+      dest[2] = (uint8_t)(background >> 16);
+#else
+      *(FAR nxwidget_pixel_t *)dest = (nxwidget_pixel_t)background;
+#endif
+      dest += NXWIDGETS_BYTESPP;
+    }
+
+  for (unsigned int row = 1; row < m_pFontSet->mxheight; row++)
+    {
+      memcpy(victim->bitmap + row * m_glyphStride, victim->bitmap,
+             fwidth * NXWIDGETS_BYTESPP);
+    }
+
+  if (fbm)
+    {
+      FONT_RENDERER((FAR nxgl_mxpixel_t *)victim->bitmap,
+                    fbm->metric.height + fbm->metric.yoffset,
+                    fwidth, m_glyphStride, fbm, m_fontColor);
+    }
+
+  victim->letter     = letter;
+  victim->color      = m_fontColor;
+  victim->background = background;
+  victim->width      = fwidth;
+  victim->lastUse    = m_glyphClock;
+  victim->valid      = true;
+  return victim;
 }
 
+/**
+ * Get an individual character rendered in the current font color onto
+ * a solid background.
+ *
+ * @param letter The character to output.
+ * @param background The background color.
+ * @param stride The location to return the row length of the image.
+ * @return The rendered image or NULL if no glyph cache is available.
+ */
+
+FAR const void *CNxFont::getGlyph(nxwidget_char_t letter,
+                                  nxgl_mxpixel_t background,
+                                  FAR unsigned int *stride)
+{
+  FAR const struct SGlyphCache *entry = getCachedGlyph(letter, background);
+  if (!entry)
+    {
+      return (FAR const void *)NULL;
+    }
+
+  *stride = m_glyphStride;
+  return (FAR const void *)entry->bitmap;
+}
+#endif
+
 /**
  * Checks if supplied character is blank in the current font.
  *
@@ -117,6 +339,28 @@ void CNxFont::drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter)
 
   FAR const struct nx_fontbitmap_s *fbm;
   fbm = nxf_getbitmap(m_fontHandle, letter);
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Copy the glyph from the cache.  The transparent color marks the
+  // pixels that the glyph does not cover, so it cannot also be the font
+  // color.
+
+  if (fbm && m_fontColor != m_transparentColor)
+    {
+      FAR const struct SGlyphCache *entry =
+        getCachedGlyph(letter, m_transparentColor);
+
+      if (entry)
+        {
+          copyGlyph((FAR uint8_t *)bitmap->data, bitmap->stride,
+                    entry->bitmap, m_glyphStride, entry->width,
+                    fbm->metric.height + fbm->metric.yoffset,
+                    m_transparentColor);
+          return;
+        }
+    }
+#endif
+
   if (fbm)
     {
       // Get information about the font bitmap
@@ -141,6 +385,16 @@ void CNxFont::drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter)
 
 nxgl_coord_t CNxFont::getStringWidth(const CNxString &text) const
 {
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // The width depends only on the text and the font face, not on the
+  // color, so it is remembered by the string itself.
+
+  if (text.m_widthFont == (FAR const void *)m_fontHandle)
+    {
+      return text.m_width;
+    }
+#endif
+
   CStringIterator *iter = text.newStringIterator();
 
   // Get the width of the string of characters
@@ -166,6 +420,12 @@ nxgl_coord_t CNxFont::getStringWidth(const CNxString &text) const
   // Return the total width
 
   delete iter;
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  text.m_widthFont = (FAR const void *)m_fontHandle;
+  text.m_width     = width;
+#endif
+
   return width;
 }
 
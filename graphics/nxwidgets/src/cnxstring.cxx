@@ -99,6 +99,8 @@ CNxString::CNxString()
   m_stringLength  = 0;
   m_allocatedSize = 0;
   m_growAmount    = 16;
+
+  invalidateWidth();
 }
 
 /**
@@ -115,6 +117,8 @@ CNxString::CNxString(FAR const char *text)
   m_allocatedSize = 0;
   m_growAmount    = 16;
 
+  invalidateWidth();
+
   setText(text);
 }
 
@@ -130,6 +134,8 @@ CNxString::CNxString(const nxwidget_char_t text)
   m_allocatedSize = 0;
   m_growAmount    = 16;
 
+  invalidateWidth();
+
   setText(text);
 }
 
@@ -140,6 +146,8 @@ CNxString::CNxString(const CNxString &string)
   m_allocatedSize = 0;
   m_growAmount    = 16;
 
+  invalidateWidth();
+
   setText(string);
 }
 
@@ -182,6 +190,8 @@ void CNxString::copyToCharArray(FAR nxwidget_char_t *buffer) const
 
 void CNxString::setText(const CNxString &text)
 {
+  invalidateWidth();
+
   // Ensure we've got enough memory available
 
   allocateMemory(text.getLength(), false);
@@ -203,6 +213,8 @@ void CNxString::setText(const CNxString &text)
 
 void CNxString::setText(FAR const char *text)
 {
+  invalidateWidth();
+
   int length = strlen(text);
 
   // Ensure we've got enough memory available
@@ -228,6 +240,8 @@ void CNxString::setText(FAR const char *text)
 
 void CNxString::setText(FAR const nxwidget_char_t *text, int nchars)
 {
+  invalidateWidth();
+
   // Ensure we've got enough memory available
 
   allocateMemory(nchars, false);
@@ -246,6 +260,8 @@ void CNxString::setText(FAR const nxwidget_char_t *text, int nchars)
 
 void CNxString::setText(const nxwidget_char_t letter)
 {
+  invalidateWidth();
+
   // Ensure we've got enough memory available
 
   allocateMemory(1, false);
@@ -264,6 +280,8 @@ void CNxString::setText(const nxwidget_char_t letter)
 
 void CNxString::append(const CNxString &text)
 {
+  invalidateWidth();
+
   // Ensure we've got enough memory available
 
   allocateMemory(m_stringLength + text.getLength(), true);
@@ -292,6 +310,8 @@ void CNxString::append(const CNxString &text)
 
 void CNxString::insert(const CNxString &text, int index)
 {
+  invalidateWidth();
+
   // Early exit if the string is empty
 
   if (!hasData())
@@ -396,6 +416,8 @@ void CNxString::insert(const CNxString &text, int index)
 
 void CNxString::remove(const int startIndex)
 {
+  invalidateWidth();
+
   // Reject if requested operation makes no sense
 
   if (!hasData() || startIndex >= m_stringLength)
@@ -419,6 +441,8 @@ void CNxString::remove(const int startIndex)
 
 void CNxString::remove(const int startIndex, const int count)
 {
+  invalidateWidth();
+
   // Reject if requested operation makes no sense
 
   if (!hasData() || startIndex >= m_stringLength)
@@ -488,6 +488,11 @@ void CNxWidget::redraw(void)
 
       CGraphicsPort *port = m_widgetControl->getGraphicsPort();
 
+      // Collect the widget and its children into one update of the
+      // window (if batched drawing is enabled).
+
+      port->beginBatch();
+
       // Draw the Widget
 
       drawBorder(port);
@@ -500,6 +505,7 @@ void CNxWidget::redraw(void)
       // Draw the children of the widget
 
       drawChildren();
+      port->endBatch();
     }
 }
 
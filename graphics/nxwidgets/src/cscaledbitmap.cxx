@@ -51,6 +51,80 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+// Rows scaled horizontally hold 8:8:8 RGB.  Bit 24 marks pixels that were
+// taken from a transparent pixel; those are never blended.
+
+#define SCALED_TRANSPARENT 0x01000000
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/**
+ * Blend two 8:8:8 RGB colors.  Red and blue are interpolated together in
+ * one 32-bit multiply, green in another.
+ *
+ * @param color1 - The color at weight 0
+ * @param color2 - The color at weight 256
+ * @param weight - The weight of color2 (0-256)
+ */
+
+static inline uint32_t blendColor(uint32_t color1, uint32_t color2,
+                                  unsigned int weight)
+{
+  unsigned int remainder = 256 - weight;
+
+  uint32_t rb = ((color1 & 0xff00ff) * remainder +
+                 (color2 & 0xff00ff) * weight) >> 8;
+  uint32_t g  = ((color1 & 0x00ff00) * remainder +
+                 (color2 & 0x00ff00) * weight) >> 8;
+
+  return (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+/**
+ * Get one pixel of a row in the native format as 8:8:8 RGB, setting
+ * SCALED_TRANSPARENT if it is the transparent color.
+ *
+ * @param row - The row of native pixels
+ * @param col - The column number
+ */
+
+static inline uint32_t getColor(FAR const uint8_t *row, nxgl_coord_t col)
+{
+  uint32_t rgb;
+
+#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
+  uint8_t color = row[col];
+  rgb = (uint32_t)RGB8RED(color) << 16 | (uint32_t)RGB8GREEN(color) << 8 |
+        RGB8BLUE(color);
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
+  uint16_t color = ((FAR const uint16_t *)row)[col];
+  rgb = (uint32_t)RGB16RED(color) << 16 | (uint32_t)RGB16GREEN(color) << 8 |
+        RGB16BLUE(color);
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
+  FAR const uint8_t *ptr = &row[3 * col];
+  uint32_t color = RGBTO24(ptr[2], ptr[1], ptr[0]);
+  rgb = color;
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
+  uint32_t color = ((FAR const uint32_t *)row)[col] & 0x00ffffff;
+  rgb = color;
+
+#else
+#  error Unsupported, invalid, or undefined color format
+#endif
+
+  if (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR)
+    {
+      rgb |= SCALED_TRANSPARENT;
+    }
+
+  return rgb;
+}
+
 /****************************************************************************
  * Method Implementations
  ****************************************************************************/
@@ -83,11 +157,40 @@ CScaledBitmap::CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize)
 
   m_yScale = itob16((uint32_t)m_bitmap->getHeight()) / newSize.h;
 
-  // Allocate and initialize the row cache
+  // Allocate the row cache.  The source column and the interpolation
+  // weight of each scaled column never change, so they are computed once.
+
+  m_rowBuffer   = new uint8_t[bitmap->getStride()];
+  m_rowCache[0] = new uint32_t[newSize.w];
+  m_rowCache[1] = new uint32_t[newSize.w];
+  m_xIndex      = new nxgl_coord_t[newSize.w];
+  m_xWeight     = new uint8_t[newSize.w];
+
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+  m_scaled      = (FAR uint8_t *)NULL;
+  m_scaleFailed = false;
+#endif
+
+  if (m_xIndex && m_xWeight)
+    {
+      nxgl_coord_t bitmapWidth = m_bitmap->getWidth();
+
+      for (nxgl_coord_t x = 0; x < newSize.w; x++)
+        {
+          b16_t column = x * m_xScale;
 
-  size_t stride = bitmap->getStride();
-  m_rowCache[0] = new uint8_t[stride];
-  m_rowCache[1] = new uint8_t[stride];
+          m_xIndex[x]  = b16toi(column);
+          m_xWeight[x] = (uint8_t)(b16frac(column) >> 8);
+
+          // There is nothing to interpolate with after the last column
+
+          if (m_xIndex[x] >= bitmapWidth - 1)
+            {
+              m_xIndex[x]  = bitmapWidth - 1;
+              m_xWeight[x] = 0;
+            }
+        }
+    }
 
   // Read the first two rows into the cache
 
@@ -103,15 +206,37 @@ CScaledBitmap::~CScaledBitmap(void)
 {
   // Delete the allocated row cache memory
 
+  if (m_rowBuffer)
+    {
+      delete[] m_rowBuffer;
+    }
+
   if (m_rowCache[0])
     {
-      delete m_rowCache[0];
+      delete[] m_rowCache[0];
     }
 
   if (m_rowCache[1])
     {
-      delete m_rowCache[1];
-   }
+      delete[] m_rowCache[1];
+    }
+
+  if (m_xIndex)
+    {
+      delete[] m_xIndex;
+    }
+
+  if (m_xWeight)
+    {
+      delete[] m_xWeight;
+    }
+
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+  if (m_scaled)
+    {
+      delete[] m_scaled;
+    }
+#endif
 
   // We are also responsible for deleting the contained IBitmap
 
@@ -197,154 +322,155 @@ const size_t CScaledBitmap::getStride(void) const
 bool CScaledBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y,
                            nxgl_coord_t width, FAR void *data)
 {
-#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332 || CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-  FAR uint8_t  *dest = (FAR uint8_t *)data;
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-  FAR uint16_t *dest = (FAR uint16_t *)data;
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-  FAR uint32_t *dest = (FAR uint32_t *)data;
-#else
-#  error Unsupported, invalid, or undefined color format
-#endif
+  // Check ranges
 
-  // Check ranges.  Casts to unsigned int are ugly but permit one-sided comparisons
-
-  if (((unsigned int)x           >=  (unsigned int)m_size.w) &&
-      ((unsigned int)(x + width) > (unsigned int)m_size.w) &&
-      ((unsigned int)y           <= (unsigned int)m_size.h))
+  if (x < 0 || y < 0 || x >= m_size.w || y >= m_size.h)
     {
       return false;
     }
 
-  // Get the row number in the unscaled image corresponding to the
-  // requested y position.  This must be either the exact row or the
-  // closest row just before the requested position
-
-  b16_t row16      = y * m_yScale;
-  nxgl_coord_t row = b16toi(row16);
-
-  // Get that row and the one after it into the row cache. We know that
-  // the pixel value that we want is one between the two rows.  This
-  // may seem wasteful to read two entire rows.  However, in normal usage
-  // we will be traversal each image from top-left to bottom-right in
-  // order.  In that case, the caching is most efficient.
-
-  if (!cacheRows(row))
+  if (width > m_size.w - x)
     {
-      return false;
+      width = m_size.w - x;
     }
 
-  // Now scale and copy the data from the cached row data
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+  // Images are usually redrawn in full every time their widget is drawn.
+  // Scale the whole image once and copy from it after that.
 
-  for (int i = 0; i < width; i++, x++)
+  if (m_scaled || cacheImage())
     {
-      // Get the column number in the unscaled row corresponding to the
-      // requested x position.  This must be either the exact column or the
-      // closest column just before the requested position
+      unsigned int bpp = m_bitmap->getBitsPerPixel();
 
-      b16_t column = x * m_xScale;
+      memcpy(data, &m_scaled[y * getStride() + ((x * bpp) >> 3)],
+             (width * bpp + 7) >> 3);
+      return true;
+    }
+#endif
 
-      // Get the color at the position on the first row
+  return scaleRun(x, y, width, data);
+}
 
-      struct rgbcolor_s color1;
-      if (!rowColor(m_rowCache[0], column, color1))
-        {
-          gerr("ERROR: rowColor failed for the first row\n");
-          return false;
-        }
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+/**
+ * Scale the whole image into m_scaled.
+ *
+ * @return True if the scaled image is available in m_scaled.
+ */
+
+bool CScaledBitmap::cacheImage(void)
+{
+  size_t stride = getStride();
+  size_t size   = stride * m_size.h;
 
-      // Get the color at the position on the first row
+  if (m_scaleFailed || size > CONFIG_NXWIDGETS_SCALEDBITMAP_CACHESIZE)
+    {
+      return false;
+    }
 
-      struct rgbcolor_s color2;
-      if (!rowColor(m_rowCache[1], column, color2))
+  m_scaled = new uint8_t[size];
+  if (!m_scaled)
+    {
+      m_scaleFailed = true;
+      return false;
+    }
+
+  for (nxgl_coord_t y = 0; y < m_size.h; y++)
+    {
+      if (!scaleRun(0, y, m_size.w, &m_scaled[y * stride]))
         {
-          gerr("ERROR: rowColor failed for the second row\n");
+          delete[] m_scaled;
+          m_scaled      = (FAR uint8_t *)NULL;
+          m_scaleFailed = true;
           return false;
         }
+    }
 
-      // Check for transparent colors
-
-      bool transparent1;
-      bool transparent2;
-
-#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-      uint8_t color = RGBTO8(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  return true;
+}
+#endif
 
-      color = RGBTO8(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+/**
+ * Scale one row of the image in the native pixel format.
+ *
+ * @param x The offset into the row to get
+ * @param y The row number to get
+ * @param width The number of pixels to get from the row
+ * @param data The memory location in which to return the data.
+ */
 
+bool CScaledBitmap::scaleRun(nxgl_coord_t x, nxgl_coord_t y,
+                             nxgl_coord_t width, FAR void *data)
+{
+#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332 || CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
+  FAR uint8_t  *dest = (FAR uint8_t *)data;
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-      uint16_t color = RGBTO16(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  FAR uint16_t *dest = (FAR uint16_t *)data;
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
+  FAR uint32_t *dest = (FAR uint32_t *)data;
+#else
+#  error Unsupported, invalid, or undefined color format
+#endif
 
-      color = RGBTO16(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  // Get the row number in the unscaled image corresponding to the
+  // requested y position.  This must be either the exact row or the
+  // closest row just before the requested position
 
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24 || CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-      uint32_t color = RGBTO24(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  b16_t row16      = y * m_yScale;
+  nxgl_coord_t row = b16toi(row16);
 
-      color = RGBTO24(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  // Get that row and the one after it into the row cache, already
+  // scaled horizontally.  When an image is expanded, several output
+  // rows are interpolated from the same two cached rows.
 
-#else
-#  error Unsupported, invalid, or undefined color format
-#endif
+  if (!cacheRows(row))
+    {
+      return false;
+    }
 
-      // Is one of the colors transparent?
+  // Now interpolate between the two cached rows
 
-      struct rgbcolor_s scaledColor;
-      b16_t fraction b16frac(row16);
+  FAR const uint32_t *row1 = &m_rowCache[0][x];
+  FAR const uint32_t *row2 = &m_rowCache[1][x];
+  unsigned int weight      = (unsigned int)(b16frac(row16) >> 8);
 
-      if (transparent1 || transparent2)
-        {
-          // Yes.. don't interpolate within transparent regions or
-          // between transparent and opaque regions.
+  for (int i = 0; i < width; i++)
+    {
+      uint32_t color1 = row1[i];
+      uint32_t color2 = row2[i];
+      uint32_t scaled;
 
-          // Get the color closest to the requested position
+      if (((color1 | color2) & SCALED_TRANSPARENT) != 0)
+        {
+          // Don't interpolate within transparent regions or between
+          // transparent and opaque regions.  Use the closest color.
 
-          if (fraction < b16HALF)
-            {
-              scaledColor.r = color1.r;
-              scaledColor.g = color1.g;
-              scaledColor.b = color1.b;
-            }
-          else
-            {
-              scaledColor.r = color2.r;
-              scaledColor.g = color2.g;
-              scaledColor.b = color2.b;
-            }
+          scaled = weight < 128 ? color1 : color2;
         }
       else
         {
-          // No.. both colors are opaque
-
-          if (!scaleColor(color1, color2, fraction, scaledColor))
-            {
-              return false;
-            }
+          scaled = blendColor(color1, color2, weight);
         }
 
+      uint8_t r = (uint8_t)(scaled >> 16);
+      uint8_t g = (uint8_t)(scaled >> 8);
+      uint8_t b = (uint8_t)scaled;
+
       // Write the interpolated data to the user buffer
 
 #if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-      color = RGBTO8(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
+      *dest++ = RGBTO8(r, g, b);
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-      color = RGBTO16(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
+      *dest++ = RGBTO16(r, g, b);
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-      *dest++ = color2.b;
-      *dest++ = color2.r;
-      *dest++ = color2.g;
+      *dest++ = b;
+      *dest++ = g;
+      *dest++ = r;
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-      color = RGBTO24(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
+      *dest++ = RGBTO24(r, g, b);
 
 #else
 #  error Unsupported, invalid, or undefined color format
@@ -362,9 +488,14 @@ bool CScaledBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y,
 
 bool CScaledBitmap::cacheRows(unsigned int row)
 {
-  nxgl_coord_t bitmapWidth  = m_bitmap->getWidth();
   nxgl_coord_t bitmapHeight = m_bitmap->getHeight();
 
+  if (!m_rowBuffer || !m_rowCache[0] || !m_rowCache[1] ||
+      !m_xIndex || !m_xWeight)
+    {
+      return false;
+    }
+
   // A common case is to advance by one row.  In this case, we only
   // need to read one row
 
@@ -372,7 +503,7 @@ bool CScaledBitmap::cacheRows(unsigned int row)
     {
       // Swap rows
 
-      FAR uint8_t *saveRow = m_rowCache[0];
+      FAR uint32_t *saveRow = m_rowCache[0];
       m_rowCache[0] = m_rowCache[1];
       m_rowCache[1] = saveRow;
 
@@ -387,9 +518,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[1]))
+      if (!scaleRow(row, m_rowCache[1]))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
     }
@@ -406,9 +536,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[0]))
+      if (!scaleRow(row, m_rowCache[0]))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
 
@@ -423,9 +552,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[1]))
+      if (!scaleRow(row, m_rowCache[1]))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
     }
@@ -434,180 +562,51 @@ bool CScaledBitmap::cacheRows(unsigned int row)
 }
 
 /**
- * Given an two RGB colors and a fractional value, return the scaled
- * value between the two colors.
+ * Read one row of the unscaled image and scale it horizontally.
  *
- * @param incolor1 - The first color to be used
- * @param incolor2 - The second color to be used
- * @param fraction - The fractional value
- * @param outcolor - The returned, scaled color
+ * @param row - The row number in the unscaled image
+ * @param dest - The location to return the scaled row.  Each pixel is
+ *   returned as 8:8:8 RGB with a transparency flag in bit 24.
  */
 
-bool CScaledBitmap::scaleColor(FAR const struct rgbcolor_s &incolor1,
-                               FAR const struct rgbcolor_s &incolor2,
-                               b16_t fraction, FAR struct rgbcolor_s &outcolor)
+bool CScaledBitmap::scaleRow(unsigned int row, FAR uint32_t *dest)
 {
-  uint8_t component;
-  b16_t red;
-  b16_t green;
-  b16_t blue;
-
-  // A fraction of < 0.5 would mean to use use mostly color1; a fraction
-  // greater than 0.5 would men to use mostly color2
-
-  b16_t remainder = b16ONE - fraction;
-
-  // Interpolate each color value  (converting to b15)
-
-  red   = (b16_t)incolor1.r * remainder + (b16_t)incolor2.r * fraction;
-  green = (b16_t)incolor1.g * remainder + (b16_t)incolor2.g * fraction;
-  blue  = (b16_t)incolor1.b * remainder + (b16_t)incolor2.b * fraction;
-
-  // Return the integer, interpolated values, clipping to the range of
-  // uint8_t
-
-  component  = b16toi(red);
-  outcolor.r = component < 256 ? component : 255;
-
-  component  = b16toi(green);
-  outcolor.g = component < 256 ? component : 255;
-
-  component  = b16toi(blue);
-  outcolor.b = component < 256 ? component : 255;
-  return true;
-}
-
-/**
- * Given an image row and a non-integer column offset, return the
- * interpolated RGB color value corresponding to that position
- *
- * @param row - The pointer to the row in the row cache to use
- * @param column - The non-integer column offset
- * @param outcolor - The returned, interpolated color
- *
- */
-
-bool CScaledBitmap::rowColor(FAR uint8_t *row, b16_t column,
-                             FAR struct rgbcolor_s &outcolor)
-{
-  // This is the col at or just before the pixel of interest
-
-  nxgl_coord_t col1 = b16toi(column);
-  nxgl_coord_t col2 = col1 + 1;
-
-  nxgl_coord_t bitmapWidth  = m_bitmap->getWidth();
-  if (col2 >= bitmapWidth)
+  if (!m_bitmap->getRun(0, row, m_bitmap->getWidth(), m_rowBuffer))
     {
-      col2 = bitmapWidth - 1;
-    }
-
-  b16_t fraction = b16frac(column);
-
-  struct rgbcolor_s color1;
-  struct rgbcolor_s color2;
-
-  bool transparent1;
-  bool transparent2;
-
-#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-  uint8_t color = row[col1];
-  color1.r = RGB8RED(color);
-  color1.g = RGB8GREEN(color);
-  color1.b = RGB8BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  color = row[col2];
-  color2.r = RGB8RED(color);
-  color2.g = RGB8GREEN(color);
-  color2.b = RGB8BLUE(color);
-
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-  FAR uint16_t *row16 = (FAR uint16_t*)row;
-  uint16_t color = row16[col1];
-  color1.r = RGB16RED(color);
-  color1.g = RGB16GREEN(color);
-  color1.b = RGB16BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      gerr("ERROR: Failed to read bitmap row %d\n", row);
 
-  color = row16[col2];
-  color2.r = RGB16RED(color);
-  color2.g = RGB16GREEN(color);
-  color2.b = RGB16BLUE(color);
+      // Force both rows to be read again next time
 
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-  unsigned int ndx = 3*col1;
-  color1.r = row[ndx+2];
-  color1.g = row[ndx+1];
-  color1.b = row[ndx];
-
-  uint32_t color = RGBTO24(color1.r, color1.g, color1.b);
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  ndx      = 3*col2;
-  color2.r = row[ndx+2];
-  color2.g = row[ndx+1];
-  color2.b = row[ndx];
-
-  color = RGBTO24(color2.r, color2.g, color2.b);
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-  FAR uint32_t *row32 = (FAR uint32_t*)row;
-  uint32_t color = row32[col1];
-  color1.r = RGB24RED(color);
-  color1.g = RGB24GREEN(color);
-  color1.b = RGB24BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  color    = row32[col2];
-  color2.r = RGB24RED(color);
-  color2.g = RGB24GREEN(color);
-  color2.b = RGB24BLUE(color);
-
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#else
-#  error Unsupported, invalid, or undefined color format
-#endif
-
-  // Is one of the colors transparent?
+      m_row = m_bitmap->getWidth();
+      return false;
+    }
 
-  if (transparent1 || transparent2)
+  for (nxgl_coord_t x = 0; x < m_size.w; x++)
     {
-      // Yes.. don't interpolate within transparent regions or
-      // between transparent and opaque regions.
+      nxgl_coord_t col    = m_xIndex[x];
+      unsigned int weight = m_xWeight[x];
+      uint32_t     color1 = getColor(m_rowBuffer, col);
+
+      if (weight == 0)
+        {
+          dest[x] = color1;
+          continue;
+        }
 
-      // Return the color closest to the requested position
-      //
-      // A fraction of < 0.5 would mean to use use mostly color1; a fraction
-      // greater than 0.5 would men to use mostly color2
+      uint32_t color2 = getColor(m_rowBuffer, col + 1);
 
-      if (fraction < b16HALF)
+      if (((color1 | color2) & SCALED_TRANSPARENT) != 0)
         {
-          outcolor.r = color1.r;
-          outcolor.g = color1.b;
-          outcolor.g = color1.g;
+          // Don't interpolate within transparent regions or between
+          // transparent and opaque regions.  Use the closest color.
+
+          dest[x] = weight < 128 ? color1 : color2;
         }
       else
         {
-          outcolor.r = color2.r;
-          outcolor.g = color2.b;
-          outcolor.g = color2.g;
+          dest[x] = blendColor(color1, color2, weight);
         }
-
-      return true;
     }
-  else
-    {
-      // No.. both colors are opaque
 
-      return scaleColor(color1, color2, fraction, outcolor);
-    }
+  return true;
 }
@@ -182,6 +182,12 @@ void CScrollingPanel::scroll(int32_t dx, int32_t dy)
 
   if ((dx != 0) || (dy != 0))
     {
+      // The move and the redraw of the revealed regions go to the window
+      // as one update (if batched drawing is enabled).
+
+      CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+      port->beginBatch();
+
       // Only scroll if content scrolling is enabled
 
       if (m_isContentScrolled)
@@ -189,7 +195,6 @@ void CScrollingPanel::scroll(int32_t dx, int32_t dy)
           // Perform scroll
 
           TNxArray<CRect> revealedRects;
-          CGraphicsPort *port = m_widgetControl->getGraphicsPort();
 
           if (dx >= 0 && dy >= 0)
             {
@@ -278,6 +283,8 @@ void CScrollingPanel::scroll(int32_t dx, int32_t dy)
           scrollChildren(dx, dy, true);
         }
 
+      port->endBatch();
+
       // Notify event handlers
 
       m_widgetEventHandlers->raiseScrollEvent(dx, dy);
@@ -296,8 +296,19 @@ const int CText::getLineTrimmedLength(const int lineNumber) const
 
 const nxgl_coord_t CText::getLinePixelLength(const int lineNumber) const
 {
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  LineWidth &cache = getLineWidthCache(lineNumber);
+  if (cache.width < 0)
+    {
+      cache.width = m_font->getStringWidth(*this, getLineStartIndex(lineNumber),
+                                           getLineLength(lineNumber));
+    }
+
+  return cache.width;
+#else
   return m_font->getStringWidth(*this, getLineStartIndex(lineNumber),
                                 getLineLength(lineNumber));
+#endif
 }
 
 /**
@@ -310,10 +321,44 @@ const nxgl_coord_t CText::getLinePixelLength(const int lineNumber) const
 
 const nxgl_coord_t CText::getLineTrimmedPixelLength(const int lineNumber) const
 {
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  LineWidth &cache = getLineWidthCache(lineNumber);
+  if (cache.trimmedWidth < 0)
+    {
+      cache.trimmedWidth =
+        m_font->getStringWidth(*this, getLineStartIndex(lineNumber),
+                               getLineTrimmedLength(lineNumber));
+    }
+
+  return cache.trimmedWidth;
+#else
   return m_font->getStringWidth(*this, getLineStartIndex(lineNumber),
                                 getLineTrimmedLength(lineNumber));
+#endif
 }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+/**
+ * Get the cached widths of a line, adding unmeasured entries as needed.
+ *
+ * @param lineNumber The line number.
+ * @return The cache entry for the line.
+ */
+
+CText::LineWidth &CText::getLineWidthCache(const int lineNumber) const
+{
+  while (m_lineWidths.size() <= lineNumber)
+    {
+      LineWidth unmeasured;
+      unmeasured.width        = -1;
+      unmeasured.trimmedWidth = -1;
+      m_lineWidths.push_back(unmeasured);
+    }
+
+  return m_lineWidths[lineNumber];
+}
+#endif
+
 /**
  * Get a pointer to the CText object's font.
  *
@@ -421,6 +466,15 @@ void CText::wrap(int charIndex)
           m_linePositions.pop_back();
         }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+      // Forget the widths of the lines that will be re-wrapped
+
+      while (m_lineWidths.size() > lineIndex)
+        {
+          m_lineWidths.pop_back();
+        }
+#endif
+
       // Adjust start position of wrapping loop so that it starts with
       // the current line index
 
@@ -445,6 +499,10 @@ void CText::wrap(int charIndex)
 
       m_linePositions.clear();
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+      m_lineWidths.clear();
+#endif
+
       // Push first line start into vector
 
       m_linePositions.push_back(0);
@@ -119,10 +119,12 @@ EXTERN MOUSE_STATUS pdc_mouse_status;
  ****************************************************************************/
 
 void    PDC_beep(void);
+void    PDC_begin_update(bool);
 bool    PDC_can_change_color(void);
 int     PDC_color_content(short, short *, short *, short *);
 bool    PDC_check_key(void);
 int     PDC_curs_set(int);
+void    PDC_end_update(void);
 void    PDC_flushinp(void);
 int     PDC_get_columns(void);
 int     PDC_get_cursor_mode(void);
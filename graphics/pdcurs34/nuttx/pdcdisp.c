@@ -47,6 +47,21 @@
 #include <graphics/curses.h>
 #include "pdcnuttx.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The longest stretch of unchanged cells that is re-sent to a terminal
+ * rather than skipped with a cursor motion (which needs at least three
+ * bytes).
+ */
+
+#define PDC_TERM_MAXGAP     3
+
+/* A shadow screen value that never matches a real cell */
+
+#define PDC_SHADOW_INVALID  ((chtype)~0)
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -679,31 +694,19 @@ static void PDC_gotoyx_term(FAR SCREEN *sp, int row, int col)
 #endif
 
 /****************************************************************************
- * Name: PDC_set_char_attrib_term
+ * Name: PDC_set_attrib_term
  *
  * Description:
- *   Sets the specified character attributes.
+ *   Sends the display attributes (including the character set) to the
+ *   terminal if they differ from the last ones sent.
  *
  ****************************************************************************/
 
 #ifdef CONFIG_SYSTEM_TERMCURSES
-static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
-              chtype ch)
+static void PDC_set_attrib_term(FAR struct pdc_termstate_s *termstate,
+                                long attrib)
 {
-  FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
-  struct termcurses_colors_s   colors;
-  short fg;
-  short bg;
-  long  attrib;
-  long  term_attrib;
-
-  /* Handle the attributes */
-
-#ifdef CONFIG_PDCURSES_CHTYPE_LONG
-  attrib = ch & (A_BOLD | A_BLINK | A_UNDERLINE | A_INVIS);
-#else
-  attrib = ch & (A_BOLD | A_BLINK);
-#endif
+  long term_attrib;
 
   if (attrib != termstate->attrib)
     {
@@ -720,6 +723,11 @@ static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
           term_attrib |= TCURS_ATTRIB_BLINK;
         }
 
+      if (attrib & A_ALTCHARSET)
+        {
+          term_attrib |= TCURS_ATTRIB_ALTCHARSET;
+        }
+
 #ifdef CONFIG_PDCURSES_CHTYPE_LONG
       if (attrib & A_UNDERLINE)
         {
@@ -730,12 +738,39 @@ static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
         {
           term_attrib |= TCURS_ATTRIB_INVIS;
         }
-
-      termcurses_setattribute(termstate->tcurs, term_attrib);
 #endif
 
+      termcurses_setattribute(termstate->tcurs, term_attrib);
       termstate->attrib = attrib;
     }
+}
+#endif   /* CONFIG_SYSTEM_TERMCURSES */
+
+/****************************************************************************
+ * Name: PDC_set_char_attrib_term
+ *
+ * Description:
+ *   Sets the specified character attributes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_TERMCURSES
+static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
+              chtype ch)
+{
+  FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
+  struct termcurses_colors_s   colors;
+  short fg;
+  short bg;
+
+  /* Handle the attributes */
+
+#ifdef CONFIG_PDCURSES_CHTYPE_LONG
+  PDC_set_attrib_term(termstate, ch & (A_BOLD | A_BLINK | A_UNDERLINE |
+                                       A_INVIS | A_ALTCHARSET));
+#else
+  PDC_set_attrib_term(termstate, ch & (A_BOLD | A_BLINK | A_ALTCHARSET));
+#endif
 
   /* Get the character colors */
 
@@ -823,6 +858,10 @@ static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
  *   if they're flagged with A_ALTCHARSET in the attribute portion of the
  *   chtype.
  *
+ *   Cells that the terminal already shows (according to the shadow screen)
+ *   are skipped.  Gaps of up to PDC_TERM_MAXGAP unchanged cells inside a
+ *   run are re-sent instead, since that is no longer than a cursor motion.
+ *
  ****************************************************************************/
 
 #ifdef CONFIG_SYSTEM_TERMCURSES
@@ -831,56 +870,75 @@ static void PDC_transform_line_term(FAR SCREEN *sp, int lineno, int x,
 {
   FAR struct pdc_termscreen_s *termscreen = (FAR struct pdc_termscreen_s *)sp;
   FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
+  FAR chtype *shadow = NULL;
+  chtype attrib;
   int   c;
   int   i;
-  char  ch;
+  int   end;
   char  buffer[128];
 
-  /* Move to the specified line / col */
-
-  PDC_gotoyx_term(sp, lineno, x);
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+  if (termstate->shadow != NULL)
+    {
+      shadow = &termstate->shadow[lineno * sp->cols + x];
+    }
+#endif
 
   /* Loop through all characters to be displayed */
 
   for (c = 0; c < len;)
     {
-      /* Get the foreground and background colors of the character */
+      /* Skip cells that are already on the screen */
 
-      PDC_set_char_attrib_term(termscreen, *srcp);
+      if (shadow != NULL && shadow[c] == srcp[c])
+        {
+          c++;
+          continue;
+        }
 
-      /* Write next character(s) */
+      /* Collect a run of cells with the same attributes, ending with the
+       * last changed cell.
+       */
 
-      ch = *srcp & 0x7F;
-      buffer[0] = ch;
+      attrib = srcp[c] & A_ATTRIBUTES;
+      end    = c + 1;
 
-      for (i = 1; i < sizeof(buffer) && c+i < len; i++)
+      for (i = c + 1; i < len && i - c < sizeof(buffer); i++)
         {
           /* Break if the attributes change */
 
-          if ((*(srcp + i) & A_ATTRIBUTES) != (*srcp & A_ATTRIBUTES))
+          if ((srcp[i] & A_ATTRIBUTES) != attrib)
             {
               break;
             }
 
-          ch = *(srcp + i) & 0x7F;
-          buffer[i] = ch;
+          if (shadow == NULL || shadow[i] != srcp[i])
+            {
+              end = i + 1;
+            }
+          else if (i + 1 - end > PDC_TERM_MAXGAP)
+            {
+              break;
+            }
         }
 
-      /* Update source pointer and write data */
-
-      if (*srcp & A_ALTCHARSET)
+      for (i = c; i < end; i++)
         {
-          write(termstate->out_fd, "\x1b(0", 3);
-          write(termstate->out_fd, buffer, i);
-          write(termstate->out_fd, "\x1b(B", 3);
+          buffer[i - c] = srcp[i] & 0x7f;
         }
-      else
+
+      /* Move to the first cell, set its attributes and write the run */
+
+      PDC_gotoyx_term(sp, lineno, x + c);
+      PDC_set_char_attrib_term(termscreen, srcp[c]);
+      termcurses_write(termstate->tcurs, buffer, end - c);
+
+      if (shadow != NULL)
         {
-          write(termstate->out_fd, buffer, i);
+          memcpy(&shadow[c], &srcp[c], (end - c) * sizeof(chtype));
         }
 
-      srcp += i;
-      c += i;
+      c = end;
     }
 }
 #endif   /* CONFIG_SYSTEM_TERMCURSES */
@@ -1002,6 +1060,86 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
   PDC_update(fbstate, lineno, x, nextx - x);
 }
 
+/****************************************************************************
+ * Name: PDC_invalidate_shadow
+ *
+ * Description:
+ *   Forget what the terminal shows, so that every cell is sent again.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+void PDC_invalidate_shadow(FAR struct pdc_termstate_s *termstate, int ncells)
+{
+  int i;
+
+  if (termstate->shadow != NULL)
+    {
+      for (i = 0; i < ncells; i++)
+        {
+          termstate->shadow[i] = PDC_SHADOW_INVALID;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: PDC_begin_update
+ *
+ * Description:
+ *   Called from doupdate() before any PDC_transform_line() calls of a
+ *   screen update.  redraw is true if the whole screen is being repainted,
+ *   in which case nothing may be assumed about what is on it.
+ *
+ ****************************************************************************/
+
+void PDC_begin_update(bool redraw)
+{
+#if defined(CONFIG_PDCURSES_TERMSHADOW) && defined(CONFIG_PDCURSES_MULTITHREAD)
+  FAR struct pdc_context_s *ctx = PDC_ctx();
+#endif
+
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+  if (!graphic_screen && redraw)
+    {
+      FAR struct pdc_termscreen_s *termscreen =
+        (FAR struct pdc_termscreen_s *)SP;
+
+      PDC_invalidate_shadow(&termscreen->termstate, SP->lines * SP->cols);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: PDC_end_update
+ *
+ * Description:
+ *   Called from doupdate() when a screen update is complete.  Terminal
+ *   output is buffered by termcurses until this point.
+ *
+ ****************************************************************************/
+
+void PDC_end_update(void)
+{
+#if defined(CONFIG_SYSTEM_TERMCURSES) && defined(CONFIG_PDCURSES_MULTITHREAD)
+  FAR struct pdc_context_s *ctx = PDC_ctx();
+#endif
+
+#ifdef CONFIG_SYSTEM_TERMCURSES
+  if (!graphic_screen)
+    {
+      FAR struct pdc_termscreen_s *termscreen =
+        (FAR struct pdc_termscreen_s *)SP;
+      FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
+
+      /* Leave the terminal in the ASCII character set */
+
+      PDC_set_attrib_term(termstate, termstate->attrib & ~A_ALTCHARSET);
+      termcurses_flush(termstate->tcurs);
+    }
+#endif
+}
+
 /****************************************************************************
  * Name: PDC_clear_screen
  *
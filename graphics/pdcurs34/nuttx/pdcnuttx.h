@@ -326,6 +326,12 @@ struct pdc_termstate_s
 #endif
 
   FAR struct termcurses_s *tcurs;
+
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+  /* The cells as last sent to the terminal (lines * cols) */
+
+  FAR chtype *shadow;
+#endif
 };
 
 /* This structure contains the termstate structure and is a cast
@@ -364,6 +370,18 @@ EXTERN struct pdc_fbstate_s g_pdc_fbstate;
 
 void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate);
 
+/****************************************************************************
+ * Name: PDC_invalidate_shadow
+ *
+ * Description:
+ *   Forget what the terminal shows, so that every cell is sent again.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+void PDC_invalidate_shadow(FAR struct pdc_termstate_s *termstate, int ncells);
+#endif
+
 /****************************************************************************
  * Name: PDC_input_open
  *
@@ -85,6 +85,13 @@ static void PDC_scr_free_term(FAR SCREEN *sp)
 
   /* Free the memory */
 
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+  if (termstate->shadow != NULL)
+    {
+      free(termstate->shadow);
+    }
+#endif
+
   free(termscreen);
 #ifdef CONFIG_PDCURSES_MULTITHREAD
   PDC_ctx_free();
@@ -175,6 +182,16 @@ static int PDC_scr_open_term(int argc, char **argv)
   termscreen->termstate.bg_red = 0xFFFE;
   termstate                    = &termscreen->termstate;
 
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+  /* Allocate the shadow screen.  Without it, every changed line is sent in
+   * full.
+   */
+
+  termstate->shadow = (FAR chtype *)
+    malloc(SP->lines * SP->cols * sizeof(chtype));
+  PDC_invalidate_shadow(termstate, SP->lines * SP->cols);
+#endif
+
   /* Setup initial RGB colors */
 
   for (i = 0; i < 8; i++)
@@ -207,6 +224,13 @@ static int PDC_scr_open_term(int argc, char **argv)
     {
       /* Free the memory ... can't open input */
 
+#ifdef CONFIG_PDCURSES_TERMSHADOW
+      if (termstate->shadow != NULL)
+        {
+          free(termstate->shadow);
+        }
+#endif
+
       PDC_ctx_free();
       free(termscreen);
     }
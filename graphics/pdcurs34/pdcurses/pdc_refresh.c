@@ -209,6 +209,8 @@ int doupdate(void)
       clearall = curscr->_clear;
     }
 
+  PDC_begin_update(clearall);
+
   for (y = 0; y < SP->lines; y++)
     {
       PDC_LOG(("doupdate() - Transforming line %d of %d: %s\n",
@@ -289,6 +291,7 @@ int doupdate(void)
   SP->cursrow = curscr->_cury;
   SP->curscol = curscr->_curx;
 
+  PDC_end_update();
   return OK;
 }
 
@@ -69,6 +69,20 @@
 #  define CONFIG_SCREENSHOT_FORMAT FB_FMT_RGB16_565
 #endif
 
+#ifndef CONFIG_SCREENSHOT_ROWSPERSTRIP
+#  define CONFIG_SCREENSHOT_ROWSPERSTRIP 8
+#endif
+
+#if defined(CONFIG_SCREENSHOT_LZW)
+#  define SCREENSHOT_COMPRESSION TAG_COMP_LZW
+#elif defined(CONFIG_SCREENSHOT_PACKBITS)
+#  define SCREENSHOT_COMPRESSION TAG_COMP_PACKBITS
+#else
+#  define SCREENSHOT_COMPRESSION TAG_COMP_NONE
+#endif
+
+#define SCREENSHOT_IOBUFSIZE 1024
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -85,24 +99,25 @@
  * Private Functions
  ****************************************************************************/
 
-static void replace_extension(FAR const char *filename, FAR const char *newext,
-                              FAR char *dest, size_t size)
+static size_t screenshot_stride(nxgl_coord_t width)
 {
-  FAR char *p = strrchr(filename, '.');
-  int len = strlen(filename);
-
-  if (p != NULL)
+  switch (CONFIG_SCREENSHOT_FORMAT)
     {
-      len = p - filename;
-    }
+      case FB_FMT_Y1:
+        return (width + 7) >> 3;
 
-  if (len > size)
-    {
-      len = size - strlen(newext);
-    }
+      case FB_FMT_Y4:
+        return (width + 1) >> 1;
 
-  strncpy(dest, filename, size);
-  strncpy(dest + len, newext, size - len);
+      case FB_FMT_Y8:
+        return width;
+
+      case FB_FMT_RGB16_565:
+        return 2 * width;
+
+      default:
+        return 3 * width;
+    }
 }
 
 /****************************************************************************
@@ -128,14 +143,10 @@ int save_screenshot(FAR const char *filename)
   FAR uint8_t *strip;
   NXHANDLE server;
   NXWINDOW window;
-  char tempf1[64];
-  char tempf2[64];
+  size_t stride;
   int row;
   int ret;
 
-  replace_extension(filename, ".tm1", tempf1, sizeof(tempf1));
-  replace_extension(filename, ".tm2", tempf2, sizeof(tempf2));
-
   /* Connect to NX server */
 
   server = nx_connect();
@@ -181,18 +192,19 @@ int save_screenshot(FAR const char *filename)
 
   nx_setsize(window, &size);
 
-  /* Configure the TIFF structure */
+  /* Configure the TIFF structure.  Without temporary files, the strips are
+   * written straight to the output file.
+   */
 
   memset(&info, 0, sizeof(struct tiff_info_s));
-  info.outfile   = filename;
-  info.tmpfile1  = tempf1;
-  info.tmpfile2  = tempf2;
-  info.colorfmt  = CONFIG_SCREENSHOT_FORMAT;
-  info.rps       = 1;
-  info.imgwidth  = size.w;
-  info.imgheight = size.h;
-  info.iobuffer  = (uint8_t *)malloc(300);
-  info.iosize    = 300;
+  info.outfile     = filename;
+  info.colorfmt    = CONFIG_SCREENSHOT_FORMAT;
+  info.compression = SCREENSHOT_COMPRESSION;
+  info.rps         = CONFIG_SCREENSHOT_ROWSPERSTRIP;
+  info.imgwidth    = size.w;
+  info.imgheight   = size.h;
+  info.iobuffer    = (uint8_t *)malloc(SCREENSHOT_IOBUFSIZE);
+  info.iosize      = SCREENSHOT_IOBUFSIZE;
 
   /* Initialize the TIFF library */
 
@@ -203,14 +215,24 @@ int save_screenshot(FAR const char *filename)
       return 1;
     }
 
-  /* Add each strip to the TIFF file */
+  /* Add each strip to the TIFF file.  Rows of the last strip that are
+   * below the screen are left zero.
+   */
 
-  strip = malloc(size.w * 3);
+  stride = screenshot_stride(size.w);
+  strip  = calloc(info.rps, stride);
 
-  for (row = 0; row < size.h; row++)
+  for (row = 0; row < size.h; row += info.rps)
   {
-    struct nxgl_rect_s rect = {{0, row}, {size.w - 1, row}};
-    nx_getrectangle(window, &rect, 0, strip, 0);
+    struct nxgl_rect_s rect = {{0, row}, {size.w - 1, row + info.rps - 1}};
+
+    if (rect.pt2.y >= size.h)
+      {
+        rect.pt2.y = size.h - 1;
+        memset(strip, 0, info.rps * stride);
+      }
+
+    nx_getrectangle(window, &rect, 0, strip, stride);
 
     ret = tiff_addstrip(&info, strip);
     if (ret < 0)
@@ -51,6 +51,10 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* Number of RGB565 pixels converted at a time */
+
+#define TIFF_CONVPIXELS 32
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -68,86 +72,138 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: tiff_addstrip
+ * Name: tiff_convrow
  *
  * Description:
- *   Convert an RGB565 strip to an RGB888 strip and write it to tmpfile2.
- *
- *   Add an image data strip.  The size of the strip in pixels must be equal
- *   to the RowsPerStrip x ImageWidth values that were provided to
- *   tiff_initialize().
+ *   Convert RGB565 pixels to RGB888 and pass them to the encoder.
  *
  * Input Parameters:
- *   info    - A pointer to the caller allocated parameter passing/TIFF state instance.
- *   buffer  - A buffer containing a single row of data.
+ *   info    - A pointer to the caller allocated parameter passing/TIFF state
+ *             instance.
+ *   src     - The RGB565 pixels
+ *   npixels - The number of pixels to convert
  *
  * Returned Value:
  *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
-int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
+
+static int tiff_convrow(FAR struct tiff_info_s *info,
+                        FAR const uint16_t *src, size_t npixels)
 {
-#ifdef CONFIG_DEBUG_GRAPHICS
-  size_t ntotal;
-#endif
-  size_t nbytes;
-  FAR uint16_t *src;
+  uint8_t rgb[3 * TIFF_CONVPIXELS];
   FAR uint8_t *dest;
   uint16_t rgb565;
+  size_t nconv;
+  size_t i;
   int ret;
-  int i;
 
-  DEBUGASSERT(info->iobuffer != NULL);
+  while (npixels > 0)
+    {
+      nconv = npixels < TIFF_CONVPIXELS ? npixels : TIFF_CONVPIXELS;
+
+      /* Convert RGB565 to RGB888 */
+
+      for (i = 0, dest = rgb; i < nconv; i++)
+        {
+          rgb565  = *src++;
+          *dest++ = (rgb565 >> (11-3)) & 0xf8; /* Move bits 11-15 to 3-7 */
+          *dest++ = (rgb565 >> ( 5-2)) & 0xfc; /* Move bits  5-10 to 2-7 */
+          *dest++ = (rgb565 << (   3)) & 0xf8; /* Move bits  0- 4 to 3-7 */
+        }
+
+      ret = tiff_encode(info, rgb, 3 * nconv);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      npixels -= nconv;
+    }
 
-  /* Convert each RGB565 pixel to RGB888 */
+  return OK;
+}
 
-  src    = (FAR uint16_t *)strip;
-  dest   = info->iobuffer;
-  nbytes = 0;
-#ifdef CONFIG_DEBUG_GRAPHICS
-  ntotal = 0;
-#endif
+/****************************************************************************
+ * Name: tiff_rowsize
+ *
+ * Description:
+ *   Return the size of one row of the image in the file, in bytes.
+ *
+ ****************************************************************************/
 
-  for (i = 0; i < info->pps; i++)
+static size_t tiff_rowsize(FAR struct tiff_info_s *info)
+{
+  switch (info->colorfmt)
     {
-      /* Convert RGB565 to RGB888 */
+      case FB_FMT_Y1:
+        return (info->imgwidth + 7) >> 3;
+
+      case FB_FMT_Y4:
+        return (info->imgwidth + 1) >> 1;
+
+      case FB_FMT_Y8:
+        return info->imgwidth;
+
+      default:
+        return 3 * info->imgwidth;
+    }
+}
+
+/****************************************************************************
+ * Name: tiff_putstrip
+ *
+ * Description:
+ *   Convert and compress a strip, one row at a time.  On return,
+ *   info->stripsize holds the number of bytes added to the strip data.
+ *
+ ****************************************************************************/
 
-      rgb565  = *src++;
-      *dest++ = (rgb565 >> (11-3)) & 0xf8; /* Move bits 11-15 to 3-7 */
-      *dest++ = (rgb565 >> ( 5-2)) & 0xfc; /* Move bits  5-10 to 2-7 */
-      *dest++ = (rgb565 << (   3)) & 0xf8; /* Move bits  0- 4 to 3-7 */
+static int tiff_putstrip(FAR struct tiff_info_s *info,
+                         FAR const uint8_t *strip)
+{
+  size_t rowsize = tiff_rowsize(info);
+  size_t remaining;
+  size_t nbytes;
+  int ret;
 
-      /* Update the byte count */
+  ret = tiff_encode_begin(info);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
-      nbytes += 3;
-#ifdef CONFIG_DEBUG_GRAPHICS
-      ntotal += 3;
-#endif
+  for (remaining = info->bps; remaining > 0; remaining -= nbytes)
+    {
+      nbytes = remaining < rowsize ? remaining : rowsize;
 
-      /* Flush the conversion buffer to tmpfile2 when it becomes full */
+      /* For FB_FMT_RGB16_565, will have to perform a conversion to
+       * RGB888.
+       */
 
-      if (nbytes > (info->iosize-3))
+      if (info->colorfmt == FB_FMT_RGB16_565)
+        {
+          ret = tiff_convrow(info, (FAR const uint16_t *)strip, nbytes / 3);
+          strip += 2 * (nbytes / 3);
+        }
+      else
         {
-          ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
-          if (ret < 0)
-            {
-              return ret;
-            }
+          ret = tiff_encode(info, strip, nbytes);
+          strip += nbytes;
+        }
 
-          /* Reset to refill the conversion buffer */
+      if (ret == OK)
+        {
+          ret = tiff_encode_endrow(info);
+        }
 
-          dest   = info->iobuffer;
-          nbytes = 0;
+      if (ret < 0)
+        {
+          return ret;
         }
     }
 
-  /* Flush any buffer data to tmpfile2 */
-
-  ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
-#ifdef CONFIG_DEBUG_GRAPHICS
-  DEBUGASSERT(ntotal == info->bps);
-#endif
-  return ret;
+  return tiff_encode_end(info);
 }
 
 /****************************************************************************
@@ -173,59 +229,77 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 
 int tiff_addstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 {
-  ssize_t newsize;
+  static const uint8_t zeros[3] =
+  {
+    0, 0, 0
+  };
+
+  uint32_t offset;
+  uint32_t count;
+  unsigned int pad;
   int ret;
 
-  /* Add the new strip based on the color format.  For FB_FMT_RGB16_565,
-   * will have to perform a conversion to RGB888.
-   */
-
-  if (info->colorfmt == FB_FMT_RGB16_565)
+  if (TIFF_ISSINGLEPASS(info) && info->nstrips >= info->maxstrips)
     {
-      ret = tiff_convstrip(info, strip);
+      gerr("ERROR: More than %d strips\n", info->maxstrips);
+      ret = -ENOSPC;
+      goto errout;
     }
 
-  /* For other formats, it is a simple write using the number of bytes per strip */
-
-  else
-    {
-      ret = tiff_write(info->tmp2fd, strip, info->bps);
-    }
+  /* Add the new strip, converted and compressed as necessary */
 
+  ret = tiff_putstrip(info, strip);
   if (ret < 0)
     {
       goto errout;
     }
 
-  /* Write the byte count to the outfile and the offset to tmpfile1 */
+  /* Pad the strip data as necessary to achieve word alignment */
+
+  count  = info->stripsize;
+  offset = TIFF_ISSINGLEPASS(info) ? info->outsize : info->tmp2size;
+  pad    = (4 - ((offset + count) & 3)) & 3;
 
-  ret = tiff_putint32(info->outfd, info->bps);
+  ret = tiff_putdata(info, zeros, pad);
   if (ret < 0)
     {
       goto errout;
     }
-  info->outsize += 4;
 
-  ret = tiff_putint32(info->tmp1fd, info->tmp2size);
-  if (ret < 0)
+  if (TIFF_ISSINGLEPASS(info))
     {
-      goto errout;
+      /* Record the byte count and the offset in the strip table.  They are
+       * written to the outfile by tiff_finalize().
+       */
+
+      tiff_put32(&info->strips[4 * info->nstrips], count);
+      tiff_put32(&info->strips[4 * (info->maxstrips + info->nstrips)],
+                 offset);
+
+      info->outsize += count + pad;
     }
-  info->tmp1size += 4;
+  else
+    {
+      /* Write the byte count to the outfile and the offset to tmpfile1 */
 
-  /* Increment the size of tmp2file. */
+      ret = tiff_putint32(info->outfd, count);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+      info->outsize += 4;
 
-  info->tmp2size += info->bps;
+      ret = tiff_putint32(info->tmp1fd, offset);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+      info->tmp1size += 4;
 
-  /* Pad tmpfile2 as necessary achieve word alignment */
+      /* Increment the size of tmp2file. */
 
-  newsize = tiff_wordalign(info->tmp2fd, info->tmp2size);
-  if (newsize < 0)
-    {
-      ret = (int)newsize;
-      goto errout;
+      info->tmp2size += count + pad;
     }
-  info->tmp2size = (size_t)newsize;
 
   /* Increment the number of strips in the TIFF file */
 
@@ -0,0 +1,623 @@
+/****************************************************************************
+ * apps/graphics/tiff/tiff_encode.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "graphics/tiff.h"
+
+#include "tiff_internal.h"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* PackBits: Runs shorter than this are sent as part of a literal packet */
+
+#define TIFF_PACKBITS_MINRUN  3
+#define TIFF_PACKBITS_MAXLEN  128
+
+/* LZW: Codes are 9 to 12 bits wide and written MSB first.  The string
+ * table is a hash table keyed by (prefix code << 8 | next byte).  The upper
+ * key bits hold a generation number so that the table can be emptied
+ * without clearing it.
+ */
+
+#define TIFF_LZW_CLEAR        256     /* ClearCode */
+#define TIFF_LZW_EOI          257     /* EndOfInformation */
+#define TIFF_LZW_FIRST        258     /* First string code */
+#define TIFF_LZW_LIMIT        4094    /* Clear the table at this code */
+#define TIFF_LZW_MINBITS      9
+#define TIFF_LZW_MAXBITS      12
+#define TIFF_LZW_HSIZE        5003    /* Prime, at most 82% occupied */
+#define TIFF_LZW_KEYMASK      0x000fffff
+#define TIFF_LZW_GENINCR      0x00100000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_PACKBITS
+struct tiff_packbits_s
+{
+  uint8_t  lit[TIFF_PACKBITS_MAXLEN]; /* Pending literal bytes */
+  uint8_t  nlit;                      /* Number of pending literal bytes */
+  uint8_t  last;                      /* Value of the pending run */
+  uint8_t  run;                       /* Length of the pending run */
+};
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+struct tiff_lzw_s
+{
+  uint32_t accum;                     /* Output bits not yet written */
+  uint8_t  nbits;                     /* Number of bits in accum */
+  uint8_t  width;                     /* Current code width */
+  uint16_t nextcode;                  /* Next string code to assign */
+  int16_t  prefix;                    /* Code of the current string */
+  uint32_t gen;                       /* Current table generation */
+  uint32_t key[TIFF_LZW_HSIZE];       /* Generation | prefix | byte */
+  uint16_t code[TIFF_LZW_HSIZE];      /* String code of each key */
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_putbyte
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_LZW
+static inline int tiff_putbyte(FAR struct tiff_info_s *info, uint8_t value)
+{
+  info->iobuffer[info->iolen++] = value;
+  info->stripsize++;
+
+  if (info->iolen >= info->iosize)
+    {
+      return tiff_flushdata(info);
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: tiff_packbits_*
+ *
+ * Description:
+ *   PackBits compression.  A packet is a header byte n followed by n + 1
+ *   literal bytes (n = 0..127) or by a single byte that is repeated 1 - n
+ *   times (n = -1..-127).  Runs never cross rows.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_PACKBITS
+static int tiff_packbits_literal(FAR struct tiff_info_s *info,
+                                 FAR struct tiff_packbits_s *pb)
+{
+  uint8_t hdr;
+  int ret;
+
+  if (pb->nlit == 0)
+    {
+      return OK;
+    }
+
+  hdr = pb->nlit - 1;
+  ret = tiff_putdata(info, &hdr, 1);
+  if (ret == OK)
+    {
+      ret = tiff_putdata(info, pb->lit, pb->nlit);
+    }
+
+  pb->nlit = 0;
+  return ret;
+}
+
+static int tiff_packbits_run(FAR struct tiff_info_s *info,
+                             FAR struct tiff_packbits_s *pb)
+{
+  uint8_t packet[2];
+  int ret = OK;
+
+  if (pb->run >= TIFF_PACKBITS_MINRUN)
+    {
+      ret = tiff_packbits_literal(info, pb);
+      if (ret == OK)
+        {
+          packet[0] = (uint8_t)(1 - pb->run);
+          packet[1] = pb->last;
+          ret = tiff_putdata(info, packet, 2);
+        }
+    }
+  else
+    {
+      /* Too short to be worth a packet of its own */
+
+      for (; pb->run > 0 && ret == OK; pb->run--)
+        {
+          pb->lit[pb->nlit++] = pb->last;
+          if (pb->nlit >= TIFF_PACKBITS_MAXLEN)
+            {
+              ret = tiff_packbits_literal(info, pb);
+            }
+        }
+    }
+
+  pb->run = 0;
+  return ret;
+}
+
+static int tiff_packbits_encode(FAR struct tiff_info_s *info,
+                                FAR const uint8_t *buffer, size_t count)
+{
+  FAR struct tiff_packbits_s *pb = info->encoder;
+  uint8_t value;
+  int ret;
+
+  while (count-- > 0)
+    {
+      value = *buffer++;
+      if (pb->run > 0 && value == pb->last &&
+          pb->run < TIFF_PACKBITS_MAXLEN)
+        {
+          pb->run++;
+          continue;
+        }
+
+      ret = tiff_packbits_run(info, pb);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      pb->last = value;
+      pb->run  = 1;
+    }
+
+  return OK;
+}
+
+static int tiff_packbits_endrow(FAR struct tiff_info_s *info)
+{
+  FAR struct tiff_packbits_s *pb = info->encoder;
+  int ret;
+
+  ret = tiff_packbits_run(info, pb);
+  if (ret == OK)
+    {
+      ret = tiff_packbits_literal(info, pb);
+    }
+
+  return ret;
+}
+#endif /* CONFIG_TIFF_PACKBITS */
+
+/****************************************************************************
+ * Name: tiff_lzw_*
+ *
+ * Description:
+ *   LZW compression as described in section 13 of the TIFF 6.0
+ *   specification.  Each strip starts with a ClearCode and ends with an
+ *   EndOfInformation code.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_LZW
+static int tiff_lzw_putcode(FAR struct tiff_info_s *info,
+                            FAR struct tiff_lzw_s *lzw, uint16_t code)
+{
+  int ret;
+
+  lzw->accum  = (lzw->accum << lzw->width) | code;
+  lzw->nbits += lzw->width;
+
+  while (lzw->nbits >= 8)
+    {
+      lzw->nbits -= 8;
+      ret = tiff_putbyte(info, (uint8_t)(lzw->accum >> lzw->nbits));
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+static void tiff_lzw_reset(FAR struct tiff_lzw_s *lzw)
+{
+  /* Start a new generation instead of clearing the table.  Only when the
+   * generation number wraps around do the stale keys have to go.
+   */
+
+  lzw->gen += TIFF_LZW_GENINCR;
+  if (lzw->gen == 0)
+    {
+      memset(lzw->key, 0, sizeof(lzw->key));
+      lzw->gen = TIFF_LZW_GENINCR;
+    }
+
+  lzw->width    = TIFF_LZW_MINBITS;
+  lzw->nextcode = TIFF_LZW_FIRST;
+}
+
+/* Account for a new string code.  The decoder adds its table entries one
+ * code later than the encoder, so the code width grows only once the code
+ * that no longer fits has been assigned.
+ */
+
+static int tiff_lzw_nextcode(FAR struct tiff_info_s *info,
+                             FAR struct tiff_lzw_s *lzw)
+{
+  int ret;
+
+  lzw->nextcode++;
+  if (lzw->nextcode >= TIFF_LZW_LIMIT)
+    {
+      ret = tiff_lzw_putcode(info, lzw, TIFF_LZW_CLEAR);
+      tiff_lzw_reset(lzw);
+      return ret;
+    }
+
+  if (lzw->nextcode >= (1 << lzw->width) &&
+      lzw->width < TIFF_LZW_MAXBITS)
+    {
+      lzw->width++;
+    }
+
+  return OK;
+}
+
+static int tiff_lzw_begin(FAR struct tiff_info_s *info)
+{
+  FAR struct tiff_lzw_s *lzw = info->encoder;
+
+  lzw->accum  = 0;
+  lzw->nbits  = 0;
+  lzw->prefix = -1;
+  tiff_lzw_reset(lzw);
+
+  return tiff_lzw_putcode(info, lzw, TIFF_LZW_CLEAR);
+}
+
+static int tiff_lzw_encode(FAR struct tiff_info_s *info,
+                           FAR const uint8_t *buffer, size_t count)
+{
+  FAR struct tiff_lzw_s *lzw = info->encoder;
+  uint32_t key;
+  int hash;
+  int step;
+  int ret;
+
+  if (count > 0 && lzw->prefix < 0)
+    {
+      lzw->prefix = *buffer++;
+      count--;
+    }
+
+  for (; count > 0; count--)
+    {
+      key  = ((uint32_t)lzw->prefix << 8 | *buffer) | lzw->gen;
+      hash = (((uint32_t)*buffer << 4) ^ lzw->prefix) % TIFF_LZW_HSIZE;
+      step = hash != 0 ? TIFF_LZW_HSIZE - hash : 1;
+
+      /* Look for the current string plus this byte in the table */
+
+      while ((lzw->key[hash] & ~TIFF_LZW_KEYMASK) == lzw->gen &&
+             lzw->key[hash] != key)
+        {
+          hash -= step;
+          if (hash < 0)
+            {
+              hash += TIFF_LZW_HSIZE;
+            }
+        }
+
+      if (lzw->key[hash] == key)
+        {
+          lzw->prefix = lzw->code[hash];
+          buffer++;
+          continue;
+        }
+
+      /* Not found:  Send the current string and add the new one */
+
+      ret = tiff_lzw_putcode(info, lzw, lzw->prefix);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      lzw->key[hash]  = key;
+      lzw->code[hash] = lzw->nextcode;
+      lzw->prefix     = *buffer++;
+
+      ret = tiff_lzw_nextcode(info, lzw);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+static int tiff_lzw_end(FAR struct tiff_info_s *info)
+{
+  FAR struct tiff_lzw_s *lzw = info->encoder;
+  int ret;
+
+  if (lzw->prefix >= 0)
+    {
+      ret = tiff_lzw_putcode(info, lzw, lzw->prefix);
+      if (ret == OK)
+        {
+          ret = tiff_lzw_nextcode(info, lzw);
+        }
+
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  ret = tiff_lzw_putcode(info, lzw, TIFF_LZW_EOI);
+  if (ret == OK && lzw->nbits > 0)
+    {
+      ret = tiff_putbyte(info, (uint8_t)(lzw->accum << (8 - lzw->nbits)));
+    }
+
+  return ret;
+}
+#endif /* CONFIG_TIFF_LZW */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_putdata
+ *
+ * Description:
+ *   Add strip data to the I/O buffer, writing the buffer to the strip data
+ *   file whenever it fills up.
+ *
+ ****************************************************************************/
+
+int tiff_putdata(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                 size_t count)
+{
+  size_t nbytes;
+  int ret;
+
+  DEBUGASSERT(info->iobuffer != NULL && info->iosize > 0);
+
+  info->stripsize += count;
+  while (count > 0)
+    {
+      /* Blocks at least as large as the buffer bypass it */
+
+      if (info->iolen == 0 && count >= info->iosize)
+        {
+          return tiff_write(TIFF_DATAFD(info), buffer, count);
+        }
+
+      nbytes = info->iosize - info->iolen;
+      if (nbytes > count)
+        {
+          nbytes = count;
+        }
+
+      memcpy(&info->iobuffer[info->iolen], buffer, nbytes);
+      info->iolen += nbytes;
+      buffer      += nbytes;
+      count       -= nbytes;
+
+      if (info->iolen >= info->iosize)
+        {
+          ret = tiff_flushdata(info);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_flushdata
+ *
+ * Description:
+ *   Write any strip data pending in the I/O buffer.
+ *
+ ****************************************************************************/
+
+int tiff_flushdata(FAR struct tiff_info_s *info)
+{
+  size_t nbytes = info->iolen;
+
+  info->iolen = 0;
+  return tiff_write(TIFF_DATAFD(info), info->iobuffer, nbytes);
+}
+
+/****************************************************************************
+ * Name: tiff_encoder_create
+ *
+ * Description:
+ *   Allocate the compression state for info->compression.
+ *
+ ****************************************************************************/
+
+int tiff_encoder_create(FAR struct tiff_info_s *info)
+{
+  size_t size;
+
+  switch (info->compression)
+    {
+      case TAG_COMP_NONE:
+        info->encoder = NULL;
+        return OK;
+
+#ifdef CONFIG_TIFF_PACKBITS
+      case TAG_COMP_PACKBITS:
+        size = sizeof(struct tiff_packbits_s);
+        break;
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+      case TAG_COMP_LZW:
+        size = sizeof(struct tiff_lzw_s);
+        break;
+#endif
+
+      default:
+        gerr("ERROR: Unsupported compression: %d\n", info->compression);
+        return -EINVAL;
+    }
+
+  info->encoder = calloc(1, size);
+  if (info->encoder == NULL)
+    {
+      gerr("ERROR: Failed to allocate %u byte compression state\n",
+           (unsigned int)size);
+      return -ENOMEM;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_encoder_destroy
+ *
+ * Description:
+ *   Free the compression state.
+ *
+ ****************************************************************************/
+
+void tiff_encoder_destroy(FAR struct tiff_info_s *info)
+{
+  free(info->encoder);
+  info->encoder = NULL;
+}
+
+/****************************************************************************
+ * Name: tiff_encode_begin
+ *
+ * Description:
+ *   Start a new strip.
+ *
+ ****************************************************************************/
+
+int tiff_encode_begin(FAR struct tiff_info_s *info)
+{
+  info->stripsize = 0;
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compression == TAG_COMP_LZW)
+    {
+      return tiff_lzw_begin(info);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_encode
+ *
+ * Description:
+ *   Compress the next part of a row.
+ *
+ ****************************************************************************/
+
+int tiff_encode(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                size_t count)
+{
+  switch (info->compression)
+    {
+#ifdef CONFIG_TIFF_PACKBITS
+      case TAG_COMP_PACKBITS:
+        return tiff_packbits_encode(info, buffer, count);
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+      case TAG_COMP_LZW:
+        return tiff_lzw_encode(info, buffer, count);
+#endif
+
+      default:
+        return tiff_putdata(info, buffer, count);
+    }
+}
+
+/****************************************************************************
+ * Name: tiff_encode_endrow
+ *
+ * Description:
+ *   Mark the end of a row.
+ *
+ ****************************************************************************/
+
+int tiff_encode_endrow(FAR struct tiff_info_s *info)
+{
+#ifdef CONFIG_TIFF_PACKBITS
+  if (info->compression == TAG_COMP_PACKBITS)
+    {
+      return tiff_packbits_endrow(info);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_encode_end
+ *
+ * Description:
+ *   Complete the strip.
+ *
+ ****************************************************************************/
+
+int tiff_encode_end(FAR struct tiff_info_s *info)
+{
+#ifdef CONFIG_TIFF_LZW
+  if (info->compression == TAG_COMP_LZW)
+    {
+      return tiff_lzw_end(info);
+    }
+#endif
+
+  return OK;
+}
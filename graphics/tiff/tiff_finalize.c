@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdlib.h>
 #include <unistd.h>
 #include <assert.h>
 #include <errno.h>
@@ -140,6 +141,101 @@ static int tiff_writeifdentry(int fd, off_t offset,
    return tiff_write(fd, ifdentry, SIZEOF_IFD_ENTRY);
 }
 
+/****************************************************************************
+ * Name: tiff_putstripifd
+ *
+ * Description:
+ *   Update the StripOffsets or StripByteCounts IFD entry of a single pass
+ *   file.  A single value is stored in the IFD entry itself.
+ *
+ * Input Parameters:
+ *   info   - A pointer to the caller allocated parameter passing/TIFF
+ *            state instance.
+ *   ifdoffset - Offset to the IFD entry in the outfile
+ *   tag    - The value for the IFD tag field
+ *   values - Offset to the values in the outfile
+ *   table  - The values in the strip table
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int tiff_putstripifd(FAR struct tiff_info_s *info, off_t ifdoffset,
+                            uint16_t tag, uint32_t values,
+                            FAR uint8_t *table)
+{
+  struct tiff_ifdentry_s ifdentry;
+
+  tiff_put16(ifdentry.tag, tag);
+  tiff_put16(ifdentry.type, IFD_FIELD_LONG);
+  tiff_put32(ifdentry.count, info->nstrips);
+  tiff_put32(ifdentry.offset,
+             info->nstrips == 1 ? tiff_get32(table) : values);
+
+  return tiff_writeifdentry(info->outfd, ifdoffset, &ifdentry);
+}
+
+/****************************************************************************
+ * Name: tiff_finalize_singlepass
+ *
+ * Description:
+ *   Finalize a single pass file:  Only the strip table and the IFD entries
+ *   that refer to it have to be written.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF
+ *          state instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int tiff_finalize_singlepass(FAR struct tiff_info_s *info)
+{
+  FAR const struct tiff_filefmt_s *filefmt = info->filefmt;
+  uint32_t sooffset;
+  off_t offset;
+  int ret;
+
+  /* Write the last of the strip data */
+
+  ret = tiff_flushdata(info);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* The StripByteCounts come first, followed by the StripOffsets */
+
+  sooffset = filefmt->sbcoffset + 4 * info->maxstrips;
+
+  ret = tiff_putstripifd(info, filefmt->sbcifdoffset, IFD_TAG_STRIPCOUNTS,
+                         filefmt->sbcoffset, info->strips);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = tiff_putstripifd(info, filefmt->soifdoffset, IFD_TAG_STRIPOFFSETS,
+                         sooffset, &info->strips[4 * info->maxstrips]);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Then replace the space reserved for the strip table */
+
+  offset = lseek(info->outfd, filefmt->sbcoffset, SEEK_SET);
+  if (offset == (off_t)-1)
+    {
+      return -errno;
+    }
+
+  return tiff_write(info->outfd, info->strips, 8 * info->maxstrips);
+}
+
 /****************************************************************************
  * Name: tiff_cleanup
  *
@@ -179,8 +275,21 @@ static void tiff_cleanup(FAR struct tiff_info_s *info)
 
   /* And remove the temporary files */
 
-  unlink(info->tmpfile1);
-  unlink(info->tmpfile2);
+  if (info->tmpfile1 != NULL)
+    {
+      unlink(info->tmpfile1);
+    }
+
+  if (info->tmpfile2 != NULL)
+    {
+      unlink(info->tmpfile2);
+    }
+
+  /* Free the strip table and the compression state */
+
+  free(info->strips);
+  info->strips = NULL;
+  tiff_encoder_destroy(info);
 }
 
 /****************************************************************************
@@ -215,8 +324,24 @@ int tiff_finalize(FAR struct tiff_info_s *info)
   int i;
   int j;
 
-  /* Put all of the pieces together to create the final output file.  There
-   * are three pieces:
+  /* A single pass file only needs its strip table */
+
+  if (TIFF_ISSINGLEPASS(info))
+    {
+      DEBUGASSERT(info->outfd >= 0);
+
+      ret = tiff_finalize_singlepass(info);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      tiff_cleanup(info);
+      return OK;
+    }
+
+  /* Otherwise, put all of the pieces together to create the final output
+   * file.  There are three pieces:
    *
    * 1) outfile: The partial output file containing the header, IFD and strip
    *    counts. This includes the StripOffsets and StripByteCounts that need
@@ -231,6 +356,14 @@ int tiff_finalize(FAR struct tiff_info_s *info)
   DEBUGASSERT(info && info->outfd >= 0 && info->tmp1fd >= 0 && info->tmp2fd >= 0);
   DEBUGASSERT((info->outsize & 3) == 0 && (info->tmp1size & 3) == 0);
 
+  /* Write the strip data still in the I/O buffer to tmpfile2 */
+
+  ret = tiff_flushdata(info);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
   /* Fix-up the count value in the StripByteCounts IFD entry in the outfile.
    * The actual number of strips was unknown at the time that the IFD entry
    * was written.
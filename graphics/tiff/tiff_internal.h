@@ -76,6 +76,13 @@
 #define IMGFLAGS_ISRGB(f) \
   (((f) & IMGFLAGS_FMT_RGB24) != 0)
 
+/* Single pass files keep the strip table in memory and the strip data in
+ * the output file.
+ */
+
+#define TIFF_ISSINGLEPASS(i)   ((i)->strips != NULL)
+#define TIFF_DATAFD(i)         (TIFF_ISSINGLEPASS(i) ? (i)->outfd : (i)->tmp2fd)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -203,6 +210,91 @@ int tiff_putstring(int fd, FAR const char *string, int len);
 
 ssize_t tiff_wordalign(int fd, size_t size);
 
+/****************************************************************************
+ * Name: tiff_putdata
+ *
+ * Description:
+ *   Add strip data to the I/O buffer, writing the buffer to the strip data
+ *   file (the outfile in single pass mode, otherwise tmpfile2) whenever it
+ *   fills up.  The data is counted in info->stripsize.
+ *
+ * Input Parameters:
+ *   info   - A pointer to the caller allocated parameter passing/TIFF state
+ *            instance.
+ *   buffer - The data to be written
+ *   count  - The number of bytes to write
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_putdata(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                 size_t count);
+
+/****************************************************************************
+ * Name: tiff_flushdata
+ *
+ * Description:
+ *   Write any strip data pending in the I/O buffer.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_flushdata(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_encoder_create / tiff_encoder_destroy
+ *
+ * Description:
+ *   Allocate and free the compression state for info->compression.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  -EINVAL if the compression is not supported and
+ *   -ENOMEM if the state could not be allocated.
+ *
+ ****************************************************************************/
+
+int tiff_encoder_create(FAR struct tiff_info_s *info);
+void tiff_encoder_destroy(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_encode_begin / tiff_encode / tiff_encode_endrow /
+ *       tiff_encode_end
+ *
+ * Description:
+ *   Compress one strip.  tiff_encode_begin() starts a strip,
+ *   tiff_encode() compresses the next part of the data of a row,
+ *   tiff_encode_endrow() marks the end of each row and tiff_encode_end()
+ *   completes the strip.  The compressed data is passed to tiff_putdata().
+ *
+ * Input Parameters:
+ *   info   - A pointer to the caller allocated parameter passing/TIFF state
+ *            instance.
+ *   buffer - The uncompressed data (tiff_encode only)
+ *   count  - The number of uncompressed bytes (tiff_encode only)
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_encode_begin(FAR struct tiff_info_s *info);
+int tiff_encode(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                size_t count);
+int tiff_encode_endrow(FAR struct tiff_info_s *info);
+int tiff_encode_end(FAR struct tiff_info_s *info);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -40,6 +40,7 @@
 
 #include <nuttx/config.h>
 
+#include <cstdio>
 #include <cfcntl>
 #include <cerrno>
 
@@ -51,10 +52,15 @@
 #include "graphics/nxwidgets/crlepalettebitmap.hxx"
 #include "graphics/nxwidgets/crect.hxx"
 #include "graphics/nxwidgets/cimage.hxx"
+#include "graphics/nxwidgets/cgraphicsport.hxx"
+#include "graphics/nxwidgets/cnxstring.hxx"
+#include "graphics/nxwidgets/cnxfont.hxx"
+#include "graphics/nxwidgets/ibitmap.hxx"
 
 #include "graphics/twm4nx/twm4nx_config.hxx"
 #include "graphics/twm4nx/cwindowevent.hxx"
 #include "graphics/twm4nx/cwindowfactory.hxx"
+#include "graphics/twm4nx/cfonts.hxx"
 #include "graphics/twm4nx/cmainmenu.hxx"
 #include "graphics/twm4nx/cbackground.hxx"
 
@@ -78,6 +84,16 @@ CBackground::CBackground(FAR CTwm4Nx *twm4nx)
 #ifdef CONFIG_TWM4NX_BACKGROUND_HASIMAGE
   m_backImage   = (NXWidgets::CImage *)0;    // No background image yet
 #endif
+#ifdef CONFIG_TWM4NX_FRAMETIME
+  m_frameRect.pt1.x = 0;                     // No frame time overlay yet
+  m_frameRect.pt1.y = 0;
+  m_frameRect.pt2.x = -1;
+  m_frameRect.pt2.y = -1;
+  m_frameLast   = 0;
+  m_frameMax    = 0;
+  m_frameShown  = 0;
+  m_maxShown    = 0;
+#endif
 }
 
 /**
@@ -218,6 +234,115 @@ bool CBackground::redrawBackgroundWindow(FAR const struct nxgl_rect_s *rect,
 {
   twminfo("Redrawing..\n");
 
+  if (!redrawBackgroundRegion(*rect))
+    {
+      return false;
+    }
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+  // Restore the frame time overlay if it was damaged
+
+  if (nxgl_intersecting(rect, &m_frameRect))
+    {
+      drawFrameTime();
+    }
+#endif
+
+  return true;
+}
+
+/**
+ * Redraw the part of the background that was uncovered when an object
+ * on the background (such as an icon) moved from 'oldBounds' to
+ * 'newBounds'.  The region still covered by the object is not redrawn.
+ *
+ * @param oldBounds The region previously occupied by the object
+ * @param newBounds The region now occupied by the object
+ * @return true on success
+ */
+
+bool CBackground::
+  redrawExposedBackground(FAR const struct nxgl_rect_s &oldBounds,
+                          FAR const struct nxgl_rect_s &newBounds)
+{
+  // If the regions do not overlap, the whole old region is exposed
+
+  if (!nxgl_intersecting(&oldBounds, &newBounds))
+    {
+      return redrawBackgroundWindow(&oldBounds, false);
+    }
+
+  // Otherwise, only the (up to four) strips of the old region that lie
+  // outside of the new region need to be redrawn
+
+  struct nxgl_rect_s exposed[4];
+  nxgl_nonintersecting(exposed, &oldBounds, &newBounds);
+
+  for (int i = 0; i < 4; i++)
+    {
+      if (!nxgl_nullrect(&exposed[i]) &&
+          !redrawBackgroundWindow(&exposed[i], false))
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+/**
+ * Report the time needed to handle one event.  The overlay shows the
+ * last and the worst time and is only redrawn when the displayed
+ * values change.
+ *
+ * @param usecs The event handling time in microseconds
+ */
+
+void CBackground::showFrameTime(uint32_t usecs)
+{
+  m_frameLast = usecs;
+  if (usecs > m_frameMax)
+    {
+      m_frameMax = usecs;
+    }
+
+  // The overlay shows tenths of milliseconds.  Redrawing it for every
+  // event would make it measure mostly itself.
+
+  uint32_t last  = m_frameLast / 100;
+  uint32_t worst = m_frameMax / 100;
+
+  if (last > UINT16_MAX)
+    {
+      last = UINT16_MAX;
+    }
+
+  if (worst > UINT16_MAX)
+    {
+      worst = UINT16_MAX;
+    }
+
+  if (last != m_frameShown || worst != m_maxShown ||
+      nxgl_nullrect(&m_frameRect))
+    {
+      m_frameShown = (uint16_t)last;
+      m_maxShown   = (uint16_t)worst;
+      drawFrameTime();
+    }
+}
+#endif
+
+/**
+ * Redraw the background color, the background image and the icons
+ * within one region of the background window.
+ *
+ * @param rect The region in the window to be redrawn
+ * @return true on success
+ */
+
+bool CBackground::redrawBackgroundRegion(FAR const struct nxgl_rect_s &rect)
+{
   // Get the widget control from the background window
 
   NXWidgets::CWidgetControl *control = m_backWindow->getWidgetControl();
@@ -226,17 +351,14 @@ bool CBackground::redrawBackgroundWindow(FAR const struct nxgl_rect_s *rect,
 
   NXWidgets::CGraphicsPort *port = control->getGraphicsPort();
 
-  // Get the size of the region to redraw
-
-  struct nxgl_size_s redrawSize;
-  redrawSize.w = rect->pt2.x - rect->pt1.x + 1;
-  redrawSize.h = rect->pt2.y - rect->pt1.y + 1;
+  // This is the region that must be filled with the background color.
+  // The part covered by the background image is not filled because the
+  // image is drawn over it anyway.
 
-  // Fill the redraw region with the background color
+  struct nxgl_rect_s fill[4];
+  int nfill = 1;
 
-  port->drawFilledRect(rect->pt1.x, rect->pt1.y,
-                       redrawSize.w, redrawSize.h,
-                       CONFIG_TWM4NX_DEFAULT_BACKGROUNDCOLOR);
+  fill[0] = rect;
 
 #ifdef CONFIG_TWM4NX_BACKGROUND_HASIMAGE
   if (m_backImage != (NXWidgets::CImage *)0)
@@ -249,26 +371,171 @@ bool CBackground::redrawBackgroundWindow(FAR const struct nxgl_rect_s *rect,
       cimageRect.getNxRect(&imageRect);
 
       struct nxgl_rect_s intersection;
-      nxgl_rectintersect(&intersection, rect, &imageRect);
+      nxgl_rectintersect(&intersection, &rect, &imageRect);
 
       if (!nxgl_nullrect(&intersection))
         {
-          // Then re-draw the background image on the window
+          // Yes.. fill only the parts of the region around the image and
+          // then re-draw just the damaged part of the image.
+
+          nxgl_nonintersecting(fill, &rect, &imageRect);
+          nfill = 4;
 
-          m_backImage->enableDrawing();
-          m_backImage->redraw();
+          drawBackgroundImage(port, intersection);
         }
     }
 #endif
 
+  // Fill the rest of the redraw region with the background color
+
+  for (int i = 0; i < nfill; i++)
+    {
+      if (!nxgl_nullrect(&fill[i]))
+        {
+          port->drawFilledRect(fill[i].pt1.x, fill[i].pt1.y,
+                               fill[i].pt2.x - fill[i].pt1.x + 1,
+                               fill[i].pt2.y - fill[i].pt1.y + 1,
+                               CONFIG_TWM4NX_DEFAULT_BACKGROUNDCOLOR);
+        }
+    }
+
   // Now redraw any background icons that need to be redrawn
 
   FAR CWindowFactory *factory = m_twm4nx->getWindowFactory();
-  factory->redrawIcons(rect);
+  factory->redrawIcons(&rect);
 
   return true;
 }
 
+#ifdef CONFIG_TWM4NX_BACKGROUND_HASIMAGE
+/**
+ * Draw the part of the background image that lies within a region of
+ * the background window.  Only the rows and columns of the image that
+ * fall within the region are decoded and sent to NX.
+ *
+ * @param port The graphics port of the background window
+ * @param rect The region to draw, already clipped to the image
+ */
+
+void CBackground::drawBackgroundImage(FAR NXWidgets::CGraphicsPort *port,
+                                      FAR const struct nxgl_rect_s &rect)
+{
+  FAR NXWidgets::IBitmap *bitmap = m_backImage->getBitmap();
+
+  struct nxgl_point_s imagePos;
+  m_backImage->getPos(imagePos);
+
+  // Allocate a buffer to hold one row of the damaged region
+
+  nxgl_coord_t width = rect.pt2.x - rect.pt1.x + 1;
+  FAR nxwidget_pixel_t *buffer = new nxwidget_pixel_t[width];
+  if (buffer == (FAR nxwidget_pixel_t *)0)
+    {
+      twmerr("ERROR: Failed to allocate a row buffer\n");
+      return;
+    }
+
+  // Describe the row buffer as a bitmap
+
+  struct NXWidgets::SBitmap row;
+  row.bpp    = bitmap->getBitsPerPixel();
+  row.fmt    = bitmap->getColorFormat();
+  row.width  = width;
+  row.height = 1;
+  row.stride = (width * row.bpp) >> 3;
+  row.data   = (FAR const void *)buffer;
+
+  // Select the same palette that the image widget would use
+
+  bitmap->setSelected(m_backImage->isClicked());
+  nxwidget_pixel_t backColor = m_backImage->getBackgroundColor();
+
+  nxgl_coord_t imageX = rect.pt1.x - imagePos.x;
+  for (nxgl_coord_t y = rect.pt1.y; y <= rect.pt2.y; y++)
+    {
+      // Read just the damaged columns of this image row
+
+      if (!bitmap->getRun(imageX, y - imagePos.y, width, buffer))
+        {
+          twmerr("ERROR: getRun failed at image row %d\n", y - imagePos.y);
+          break;
+        }
+
+      // Replace any transparent pixels with the background color
+
+      for (nxgl_coord_t i = 0; i < width; i++)
+        {
+          if (buffer[i] == CONFIG_NXWIDGETS_TRANSPARENT_COLOR)
+            {
+              buffer[i] = backColor;
+            }
+        }
+
+      port->drawBitmap(rect.pt1.x, y, width, 1, &row, 0, 0);
+    }
+
+  delete[] buffer;
+}
+#endif
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+/**
+ * Draw the frame time overlay in the lower right corner of the
+ * background.
+ */
+
+void CBackground::drawFrameTime(void)
+{
+  FAR CFonts *fonts = m_twm4nx->getFonts();
+  FAR NXWidgets::CNxFont *font = fonts->getIconFont();
+
+  // Reserve a fixed region, wide enough for the widest text, the first
+  // time that the overlay is drawn
+
+  if (nxgl_nullrect(&m_frameRect))
+    {
+      struct nxgl_size_s displaySize;
+      getDisplaySize(displaySize);
+
+      NXWidgets::CNxString widest("6553.5/6553.5 ms");
+      nxgl_coord_t width  = font->getStringWidth(widest);
+      nxgl_coord_t height = font->getHeight();
+
+      m_frameRect.pt2.x = displaySize.w - 3;
+      m_frameRect.pt2.y = displaySize.h - 3;
+      m_frameRect.pt1.x = m_frameRect.pt2.x - width + 1;
+      m_frameRect.pt1.y = m_frameRect.pt2.y - height + 1;
+    }
+
+  // Erase the previous text
+
+  if (!redrawBackgroundRegion(m_frameRect))
+    {
+      return;
+    }
+
+  char buffer[24];
+  std::snprintf(buffer, sizeof(buffer), "%u.%u/%u.%u ms",
+                m_frameShown / 10, m_frameShown % 10,
+                m_maxShown / 10, m_maxShown % 10);
+
+  NXWidgets::CNxString text(buffer);
+
+  // Right-justify the text in the overlay region
+
+  struct nxgl_point_s pos;
+  pos.x = m_frameRect.pt2.x - font->getStringWidth(text) + 1;
+  pos.y = m_frameRect.pt1.y;
+
+  NXWidgets::CWidgetControl *control = m_backWindow->getWidgetControl();
+  NXWidgets::CGraphicsPort *port = control->getGraphicsPort();
+
+  NXWidgets::CRect bound(&m_frameRect);
+  port->drawText(&pos, &bound, font, text, 0, text.getLength(),
+                 CONFIG_TWM4NX_ICON_FONTCOLOR);
+}
+#endif
+
 /**
  * Handle EVENT_BACKGROUND events.
  *
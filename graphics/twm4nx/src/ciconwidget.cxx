@@ -731,22 +731,29 @@ bool CIconWidget::iconDrag(FAR struct SEventMsg *eventmsg)
               return false;
             }
 
-          // Redraw the background window in the rectangle previously occupied by
+          // Redraw the background window in the part of the rectangle
+          // previously occupied by the widget that is no longer covered by
           // the widget.
 
           struct nxgl_size_s widgetSize;
           getSize(widgetSize);
 
+          struct nxgl_rect_s oldBounds;
+          oldBounds.pt1.x = oldpos.x;
+          oldBounds.pt1.y = oldpos.y;
+          oldBounds.pt2.x = oldpos.x + widgetSize.w - 1;
+          oldBounds.pt2.y = oldpos.y + widgetSize.h - 1;
+
           struct nxgl_rect_s bounds;
-          bounds.pt1.x = oldpos.x;
-          bounds.pt1.y = oldpos.y;
-          bounds.pt2.x = oldpos.x + widgetSize.w - 1;
-          bounds.pt2.y = oldpos.y + widgetSize.h - 1;
+          bounds.pt1.x = newpos.x;
+          bounds.pt1.y = newpos.y;
+          bounds.pt2.x = newpos.x + widgetSize.w - 1;
+          bounds.pt2.y = newpos.y + widgetSize.h - 1;
 
           FAR CBackground *backgd = m_twm4nx->getBackground();
-          if (!backgd->redrawBackgroundWindow(&bounds, false))
+          if (!backgd->redrawExposedBackground(oldBounds, bounds))
             {
-              twmerr("ERROR: redrawBackgroundWindow() failed\n");
+              twmerr("ERROR: redrawExposedBackground() failed\n");
               return false;
             }
 
@@ -759,12 +766,6 @@ bool CIconWidget::iconDrag(FAR struct SEventMsg *eventmsg)
           // region on the background.  If not, check if some other icon is
           // already occupying this position
 
-
-          bounds.pt1.x = newpos.x;
-          bounds.pt1.y = newpos.y;
-          bounds.pt2.x = newpos.x + widgetSize.w - 1;
-          bounds.pt2.y = newpos.y + widgetSize.h - 1;
-
           struct nxgl_rect_s collision;
           if (backgd->checkCollision(bounds, collision))
             {
@@ -868,22 +869,29 @@ bool CIconWidget::iconUngrab(FAR struct SEventMsg *eventmsg)
         }
       else
         {
-          // Redraw the background window in the rectangle previously occupied
-          // by the widget.
+          // Redraw the background window in the part of the rectangle
+          // previously occupied by the widget that is no longer covered by
+          // the widget.
 
           struct nxgl_size_s widgetSize;
           getSize(widgetSize);
 
+          struct nxgl_rect_s oldBounds;
+          oldBounds.pt1.x = oldpos.x;
+          oldBounds.pt1.y = oldpos.y;
+          oldBounds.pt2.x = oldpos.x + widgetSize.w - 1;
+          oldBounds.pt2.y = oldpos.y + widgetSize.h - 1;
+
           struct nxgl_rect_s bounds;
-          bounds.pt1.x = oldpos.x;
-          bounds.pt1.y = oldpos.y;
-          bounds.pt2.x = oldpos.x + widgetSize.w - 1;
-          bounds.pt2.y = oldpos.y + widgetSize.h - 1;
+          bounds.pt1.x = m_dragPos.x;
+          bounds.pt1.y = m_dragPos.y;
+          bounds.pt2.x = m_dragPos.x + widgetSize.w - 1;
+          bounds.pt2.y = m_dragPos.y + widgetSize.h - 1;
 
           FAR CBackground *backgd = m_twm4nx->getBackground();
-          if (!backgd->redrawBackgroundWindow(&bounds, false))
+          if (!backgd->redrawExposedBackground(oldBounds, bounds))
             {
-              twmerr("ERROR: redrawBackgroundWindow() failed\n");
+              twmerr("ERROR: redrawExposedBackground() failed\n");
               return false;
             }
 
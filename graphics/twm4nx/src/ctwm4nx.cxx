@@ -56,6 +56,7 @@
 #include <cfcntl>
 #include <cstring>
 #include <cerrno>
+#include <ctime>
 
 #include <semaphore.h>
 
@@ -343,6 +344,10 @@ bool CTwm4Nx::eventLoop(void)
 
       if (!m_resize->resizing() || EVENT_ISCRITICAL(u.eventmsg.eventID))
         {
+#ifdef CONFIG_TWM4NX_FRAMETIME
+          struct timespec start;
+          clock_gettime(CLOCK_REALTIME, &start);
+#endif
           // Dispatch the new event
 
           if (!dispatchEvent(&u.eventmsg))
@@ -352,6 +357,18 @@ bool CTwm4Nx::eventLoop(void)
               cleanup();
               return false;
             }
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+          // Show how long it took to handle the event, including any
+          // redrawing that it caused
+
+          struct timespec end;
+          clock_gettime(CLOCK_REALTIME, &end);
+
+          int32_t usecs = (end.tv_sec - start.tv_sec) * 1000000 +
+                          (end.tv_nsec - start.tv_nsec) / 1000;
+          m_background->showFrameTime(usecs > 0 ? (uint32_t)usecs : 0);
+#endif
         }
     }
 
@@ -43,12 +43,50 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <nuttx/can/can.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The smallest "nframes" accepted by canlib_readv(): the read() buffer
+ * must hold one frame of any length.
+ */
+
+#define CANLIB_READV_MINFRAMES \
+  ((sizeof(struct can_msg_s) + CAN_MSGLEN(0) - 1) / CAN_MSGLEN(0))
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One CAN frame as used by canlib_readv() and canlib_writev() */
+
+struct canlib_frame_s
+{
+  struct timespec ts;            /* Receive time (ignored for TX) */
+  uint32_t id;                   /* 11- or 29-bit CAN ID */
+  bool     extended;             /* The ID is a 29-bit ID */
+  bool     rtr;                  /* Remote transmission request */
+  bool     error;                /* Error report (CONFIG_CAN_ERRORS) */
+  uint8_t  dlc;                  /* Data length code */
+  uint8_t  data[CAN_MAXDATALEN]; /* Frame data */
+};
+
+/* A frame is accepted when (frame ID & mask) == (id & mask) */
+
+struct canlib_filter_s
+{
+  uint32_t id;                   /* ID to match */
+  uint32_t mask;                 /* ID bits that must match */
+  bool     extended;             /* Match 29-bit IDs */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -182,6 +220,121 @@ int canlib_setsilent(int fd, bool silent);
 
 int canlib_getsilent(int fd, FAR bool *silent);
 
+/****************************************************************************
+ * Name: canlib_addfilter
+ *
+ * Description:
+ *   Wrapper for CANIOC_ADD_STDFILTER and CANIOC_ADD_EXTFILTER.  Sets up an
+ *   ID/mask acceptance filter in the driver (and so in the hardware if the
+ *   CAN peripheral has filters), so that the frames that do not match are
+ *   dropped before they reach the application.
+ *
+ * Input Parameter:
+ *   fd     - file descriptor of an opened can device
+ *   filter - the filter to add
+ *
+ * Returned Value:
+ *   A non-negative filter ID is returned on success.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the nature of the
+ *   error (ENOTTY if the driver does not support filters).
+ *
+ ****************************************************************************/
+
+int canlib_addfilter(int fd, FAR const struct canlib_filter_s *filter);
+
+/****************************************************************************
+ * Name: canlib_delfilter
+ *
+ * Description:
+ *   Wrapper for CANIOC_DEL_STDFILTER and CANIOC_DEL_EXTFILTER.
+ *
+ * Input Parameter:
+ *   fd       - file descriptor of an opened can device
+ *   extended - the filter matches 29-bit IDs
+ *   filterid - the filter ID returned by canlib_addfilter()
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the
+ *   nature of the error.
+ *
+ ****************************************************************************/
+
+int canlib_delfilter(int fd, bool extended, int filterid);
+
+/****************************************************************************
+ * Name: canlib_filter
+ *
+ * Description:
+ *   Software version of the ID/mask filters, for drivers without filter
+ *   support.  The frames that match none of the filters are removed.
+ *
+ * Input Parameter:
+ *   frames   - the frames to filter
+ *   nframes  - the number of frames
+ *   filters  - the filters
+ *   nfilters - the number of filters
+ *
+ * Returned Value:
+ *   The number of frames kept at the start of "frames".
+ *
+ ****************************************************************************/
+
+size_t canlib_filter(FAR struct canlib_frame_s *frames, size_t nframes,
+                     FAR const struct canlib_filter_s *filters,
+                     int nfilters);
+
+/****************************************************************************
+ * Name: canlib_readv
+ *
+ * Description:
+ *   Read the frames pending in the driver with a single read() and time
+ *   stamp them.  The timestamp is the one of the driver with
+ *   CONFIG_CAN_TIMESTAMP, otherwise the time of the read().
+ *
+ *   The driver packs the frames by length: one read() takes up to
+ *   "nframes" (and CONFIG_CANUTILS_CANLIB_NBATCH) frames without data but
+ *   only about 2/5 as many frames with 8 data bytes.
+ *
+ * Input Parameter:
+ *   fd      - file descriptor of an opened can device
+ *   frames  - buffer for the received frames
+ *   nframes - the size of the buffer in frames, at least
+ *             CANLIB_READV_MINFRAMES
+ *   timeout - the time to wait for a frame in ms (-1 waits forever)
+ *
+ * Returned Value:
+ *   The number of frames received, zero on timeout.  Otherwise -1 (ERROR)
+ *   is returned with the errno variable set to indicate the nature of the
+ *   error: EINVAL if "nframes" is less than CANLIB_READV_MINFRAMES.
+ *
+ ****************************************************************************/
+
+ssize_t canlib_readv(int fd, FAR struct canlib_frame_s *frames,
+                     size_t nframes, int timeout);
+
+/****************************************************************************
+ * Name: canlib_writev
+ *
+ * Description:
+ *   Queue several frames for transmission with a single write().
+ *
+ * Input Parameter:
+ *   fd      - file descriptor of an opened can device
+ *   frames  - the frames to send
+ *   nframes - the number of frames
+ *
+ * Returned Value:
+ *   The number of frames queued (less than "nframes" if the device is
+ *   non-blocking and the TX FIFO is full).  Otherwise -1 (ERROR) is
+ *   returned with the errno variable set to indicate the nature of the
+ *   error.
+ *
+ ****************************************************************************/
+
+ssize_t canlib_writev(int fd, FAR const struct canlib_frame_s *frames,
+                      size_t nframes);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -47,9 +47,22 @@
 #include <stdlib.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <time.h>
 
 #include <nuttx/can/can.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_LIBOBD2_POLL
+#  define OBD_POLL_MAXBATCH  6   /* Max. PIDs in one mode 01 request       */
+#  define OBD_POLL_MAXDATA   8   /* Max. data bytes kept for a PID         */
+#  define OBD_POLL_RXSIZE    64  /* Max. size of a reassembled response    */
+#  define OBD_POLL_NOECU     0xff
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -78,6 +91,54 @@ struct obd_dev_s
 #endif
 };
 
+#ifdef CONFIG_LIBOBD2_POLL
+/* Latest value of a PID polled by obd_poll_run() */
+
+struct obd_pidval_s
+{
+  struct  timespec ts;               /* Time the value was received         */
+  uint32_t count;                    /* Number of values received           */
+  uint8_t pid;                       /* Mode 01 PID                         */
+  uint8_t ecu;                       /* ECU polled for this PID             */
+  uint8_t len;                       /* Data length (0 = no value yet)      */
+  uint8_t data[OBD_POLL_MAXDATA];    /* Data bytes A, B, C, ...             */
+};
+
+/* State of one ECU found by obd_poll_init() */
+
+struct obd_ecu_s
+{
+  uint32_t rxid;                     /* CAN ID of the ECU responses         */
+  uint32_t txid;                     /* CAN ID of the physical requests     */
+  struct  timespec deadline;         /* Timeout of the pending request      */
+  uint8_t supported[32];             /* Bitmap of the supported PIDs 01-ff  */
+  uint8_t inflight[OBD_POLL_MAXBATCH]; /* Values of the pending request     */
+  uint8_t ninflight;                 /* Number of PIDs requested (0 = idle) */
+  uint8_t next;                      /* Next value to request               */
+  bool    nobatch;                   /* ECU rejects multi-PID requests      */
+  uint8_t rxseq;                     /* Next ISO-TP sequence number         */
+  uint16_t rxlen;                    /* Length of the multi-frame response  */
+  uint16_t rxpos;                    /* Bytes received so far               */
+  uint8_t rxbuf[OBD_POLL_RXSIZE];    /* Multi-frame reassembly buffer       */
+};
+
+/* OBD-II polling engine */
+
+struct obd_poll_s
+{
+  FAR struct obd_dev_s *dev;         /* OBD-II device                       */
+  struct  obd_ecu_s ecus[CONFIG_LIBOBD2_POLL_MAXECUS];
+  struct  obd_pidval_s values[CONFIG_LIBOBD2_POLL_MAXPIDS];
+  uint8_t necus;                     /* Number of ECUs found                */
+  uint8_t npids;                     /* Number of PIDs polled               */
+  bool    discover;                  /* obd_poll_init() is running          */
+  int     timeout;                   /* Response timeout (ms)               */
+  uint32_t nrequests;                /* Requests sent                       */
+  uint32_t ntimeouts;                /* Requests not answered in time       */
+  uint32_t nerrors;                  /* Negative or malformed responses     */
+};
+#endif
+
 /****************************************************************************
  * Name: obd_init
  *
@@ -129,4 +190,50 @@ int obd_wait_response(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid,
 
 FAR char *obd_decode_pid(FAR struct obd_dev_s *dev, uint8_t pid);
 
+#ifdef CONFIG_LIBOBD2_POLL
+/****************************************************************************
+ * Name: obd_poll_init
+ *
+ * Description:
+ *   Prepare the polling of the mode 01 PIDs in "pids".  A functional
+ *   request asks every ECU for its supported PIDs and each PID is then
+ *   assigned to the first ECU that supports it.  "timeout" is the time
+ *   (in ms) given to the ECUs to answer any request.
+ *
+ *   It will return the number of ECUs found, -ENODEV if no ECU answered or
+ *   a negated errno value if error.
+ *
+ ****************************************************************************/
+
+int obd_poll_init(FAR struct obd_poll_s *poller, FAR struct obd_dev_s *dev,
+                  FAR const uint8_t *pids, int npids, int timeout);
+
+/****************************************************************************
+ * Name: obd_poll_run
+ *
+ * Description:
+ *   Keep one request in flight to every ECU, each one asking for up to six
+ *   of the PIDs of that ECU, and collect the responses for up to "timeout"
+ *   ms.  A new request is sent as soon as an ECU answers the previous one.
+ *
+ *   It will return the number of PID values updated or a negated errno
+ *   value if error.
+ *
+ ****************************************************************************/
+
+int obd_poll_run(FAR struct obd_poll_s *poller, int timeout);
+
+/****************************************************************************
+ * Name: obd_poll_value
+ *
+ * Description:
+ *   Return the latest value received for a polled PID or NULL if the PID
+ *   is not polled.  The value is not valid while its "len" is zero.
+ *
+ ****************************************************************************/
+
+FAR const struct obd_pidval_s *obd_poll_value(FAR struct obd_poll_s *poller,
+                                              uint8_t pid);
+#endif
+
 #endif /*__APPS_INCLUDE_CANUTILS_OBD_H */
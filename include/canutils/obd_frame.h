@@ -70,4 +70,8 @@
 
 #define OBD_FC_FLOW_STATUS(x)    (x & 0xf) /* Flow Control Status */
 
+#define OBD_FC_CTS               0         /* Continue to send */
+#define OBD_FC_WAIT              1         /* Wait */
+#define OBD_FC_OVERFLOW          2         /* Overflow, abort the message */
+
 #endif /* __APPS_INCLUDE_CANUTILS_OBD_FRAME_H */
@@ -0,0 +1,78 @@
+/****************************************************************************
+ * apps/include/fsutils/fsbench.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_FSUTILS_FSBENCH_H
+#define __APPS_INCLUDE_FSUTILS_FSBENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: fsbench_main
+ *
+ * Description:
+ *   Run the file system benchmark on an already mounted file system.  The
+ *   remaining command line arguments select the file sizes, I/O sizes and
+ *   the CSV output:
+ *
+ *     [-b] [-f <size>[,<size>...]] [-i <size>[,<size>...]] [-n <files>]
+ *     [-l <loops>] [-L <label>] [-o <csv-file>]
+ *
+ *   One CSV row is emitted per test with the columns:
+ *
+ *     fs,test,file_size,io_size,ops,bytes,usec,kbps,
+ *     min_us,p50_us,p90_us,p99_us,max_us
+ *
+ * Input Parameters:
+ *   label   - Default file system label written to the 'fs' column.
+ *   mountpt - The directory in which the test files are created.
+ *   argc    - Command line argument count.
+ *   argv    - Command line arguments.
+ *
+ * Returned Value:
+ *   EXIT_SUCCESS if all tests could run; EXIT_FAILURE otherwise.
+ *
+ ****************************************************************************/
+
+int fsbench_main(FAR const char *label, FAR const char *mountpt,
+                 int argc, FAR char *argv[]);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __APPS_INCLUDE_FSUTILS_FSBENCH_H */
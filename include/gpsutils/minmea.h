@@ -42,6 +42,7 @@
  ****************************************************************************/
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
@@ -191,6 +192,54 @@ struct minmea_sentence_gsv
   struct minmea_sat_info  sats[4];
 };
 
+/* State of the streaming parser.  minmea_stream_feed() frames, checks and
+ * decodes sentences in a single pass over the received bytes and leaves
+ * the last decoded sentence in 'frame'.
+ */
+
+struct minmea_stream
+{
+  /* The sentence completed by the last minmea_stream_feed() call:
+   * MINMEA_INVALID if none, MINMEA_UNKNOWN if the sentence is valid but not
+   * decoded.
+   */
+
+  enum minmea_sentence_id id;
+  char type[6];                     /* Talker and sentence type, e.g. "GPRMC" */
+
+  union
+  {
+    struct minmea_sentence_rmc rmc;
+    struct minmea_sentence_gga gga;
+    struct minmea_sentence_gsa gsa;
+    struct minmea_sentence_gll gll;
+    struct minmea_sentence_gst gst;
+    struct minmea_sentence_gsv gsv;
+  } frame;
+
+  /* Statistics */
+
+  uint32_t nsentences;              /* Valid sentences */
+  uint32_t nerrors;                 /* Discarded sentences */
+
+  /* Parser state (private) */
+
+  FAR const void *format;           /* Layout of the current sentence */
+  FAR const void *desc;             /* Layout of the current field */
+  int_least32_t value;              /* Field value being accumulated */
+  int_least32_t scale;              /* Field scale being accumulated */
+  int_least32_t frac;               /* Fractional seconds of a time field */
+  bool strict;                      /* Checksum required */
+  bool decode;                      /* Decode the rest of the field */
+  int8_t sign;                      /* Sign or direction of the field */
+  uint8_t state;                    /* Framing state */
+  uint8_t checksum;                 /* XOR of the sentence body */
+  uint8_t expected;                 /* Received checksum */
+  uint8_t length;                   /* Sentence length so far */
+  uint8_t field;                    /* Index of the current field */
+  uint8_t fpos;                     /* Characters in the current field */
+};
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -239,6 +288,21 @@ bool minmea_parse_gll(struct minmea_sentence_gll *frame, const char *sentence);
 bool minmea_parse_gst(struct minmea_sentence_gst *frame, const char *sentence);
 bool minmea_parse_gsv(struct minmea_sentence_gsv *frame, const char *sentence);
 
+/* Initialize a streaming parser.  In strict mode, sentences without a
+ * checksum are discarded.
+ */
+
+void minmea_stream_init(FAR struct minmea_stream *stream, bool strict);
+
+/* Pass received bytes to a streaming parser.  Parsing stops after the
+ * first sentence that completes; stream->id then tells whether it was
+ * valid and which member of stream->frame holds it.  Returns the number of
+ * bytes consumed: call again with the remaining bytes.
+ */
+
+size_t minmea_stream_feed(FAR struct minmea_stream *stream,
+                          FAR const char *buffer, size_t buflen);
+
 /* Convert GPS UTC date/time representation to a UNIX timestamp. */
 
 int minmea_gettime(FAR struct timespec *ts,
@@ -110,6 +110,86 @@ namespace NXWidgets
 #ifdef CONFIG_NX_WRITEONLY
     nxgl_mxpixel_t m_backColor;  /**< The background color to use */
 #endif
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+    FAR uint8_t   *m_batchBuffer; /**< Off-screen copy of the window */
+    struct nxgl_size_s m_batchSize; /**< Size of the off-screen copy */
+    unsigned int   m_batchStride; /**< Row length of the off-screen copy */
+    struct nxgl_rect_s m_damage;  /**< Region changed since the last flush */
+    uint8_t        m_batchNest;   /**< beginBatch() nesting level */
+    bool           m_batchValid;  /**< True: copy matches the window */
+
+    /**
+     * Make sure that the off-screen copy of the window holds the current
+     * window contents.
+     *
+     * @return True if drawing should go to the off-screen copy; false if
+     *   drawing should go directly to the window.
+     */
+
+    bool batchPrepare(void);
+
+    /**
+     * Clip a window-relative rectangle to the off-screen copy and add it
+     * to the damaged region.
+     *
+     * @param rect The rectangle to be drawn.
+     * @param clipped The location to return the clipped rectangle.
+     * @return True if anything remains after clipping.
+     */
+
+    bool batchDamage(FAR const struct nxgl_rect_s *rect,
+                     FAR struct nxgl_rect_s *clipped);
+
+    /**
+     * Push the damaged region of the off-screen copy to the window in
+     * one bitmap update.
+     */
+
+    void batchFlush(void);
+
+    /**
+     * Prepare for a drawing operation that can only be performed by the
+     * window itself.  Pending damage is flushed first and the off-screen
+     * copy is marked stale.
+     */
+
+    void batchBypass(void);
+#endif
+
+    /**
+     * Fill a rectangle, either in the off-screen copy or in the window.
+     *
+     * @param rect The window-relative rectangle to fill.
+     * @param color The fill color.
+     * @return True on success.
+     */
+
+    bool fill(FAR const struct nxgl_rect_s *rect, nxgl_mxpixel_t color);
+
+    /**
+     * Copy a rectangular region of a larger image, either into the
+     * off-screen copy or into the window.  The arguments are the same as
+     * for INxWindow::bitmap().
+     *
+     * @param dest The window-relative rectangle to receive the image.
+     * @param src The start of the source image.
+     * @param origin The window-relative position of the source image.
+     * @param stride The length of one source row in bytes.
+     * @return True on success.
+     */
+
+    bool blit(FAR const struct nxgl_rect_s *dest, FAR const void *src,
+              FAR const struct nxgl_point_s *origin, unsigned int stride);
+
+    /**
+     * Read a rectangular region, either from the off-screen copy or from
+     * the window.
+     *
+     * @param rect The window-relative rectangle to read.
+     * @param dest The bitmap that receives the data.
+     */
+
+    void read(FAR const struct nxgl_rect_s *rect, FAR struct SBitmap *dest);
 
     /**
      * The underlying implementation for drawText functions
@@ -150,6 +230,47 @@ namespace NXWidgets
 
     virtual ~CGraphicsPort();
 
+#ifdef CONFIG_NXWIDGETS_BATCHDRAW
+    /**
+     * Start collecting drawing operations in an off-screen copy of the
+     * window.  Calls may be nested; nothing is sent to the window until
+     * the outermost endBatch().
+     */
+
+    void beginBatch(void);
+
+    /**
+     * Stop collecting drawing operations.  When the outermost batch ends,
+     * the damaged region is sent to the window as a single bitmap.
+     */
+
+    void endBatch(void);
+
+    /**
+     * Return true if drawing operations are currently being batched.
+     *
+     * @return True if batching.
+     */
+
+    inline bool isBatching(void) const
+    {
+      return m_batchNest > 0;
+    }
+#else
+    inline void beginBatch(void)
+    {
+    }
+
+    inline void endBatch(void)
+    {
+    }
+
+    inline bool isBatching(void) const
+    {
+      return false;
+    }
+#endif
+
     /**
      * Return the absolute x coordinate of the upper left hand corner of the
      * underlying window.
@@ -301,11 +422,8 @@ namespace NXWidgets
      * @param color The color of the rectangle.
      */
 
-    inline void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
-                                 nxgl_mxpixel_t color)
-    {
-      m_pNxWnd->drawFilledCircle(center, radius, color);
-    }
+    void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
+                          nxgl_mxpixel_t color);
 
     /**
      * Draw a string to the window.
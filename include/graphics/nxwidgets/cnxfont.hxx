@@ -78,6 +78,50 @@ namespace NXWidgets
     nxgl_mxpixel_t m_fontColor;             /**< Color to draw the font with when rendering. */
     nxgl_mxpixel_t m_transparentColor;      /**< Background color that should not be rendered. */
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    /**
+     * One rendered glyph.  A glyph is rendered with one foreground color
+     * onto one background color; the same letter drawn in another color
+     * occupies another entry.
+     */
+
+    struct SGlyphCache
+    {
+      FAR uint8_t    *bitmap;               /**< Rendered pixels (in m_glyphSlab) */
+      uint32_t        lastUse;              /**< m_glyphClock at the last lookup */
+      nxgl_mxpixel_t  color;                /**< Foreground color of the glyph */
+      nxgl_mxpixel_t  background;           /**< Background color of the glyph */
+      nxwidget_char_t letter;               /**< The character */
+      uint8_t         width;                /**< Width including the X offset */
+      bool            valid;                /**< True: the entry is in use */
+    };
+
+    struct SGlyphCache m_glyphCache[CONFIG_NXWIDGETS_GLYPHCACHE_SIZE];
+    FAR uint8_t   *m_glyphSlab;             /**< Pixel memory for all entries */
+    unsigned int   m_glyphStride;           /**< Row length of a cached glyph */
+    uint32_t       m_glyphClock;            /**< Lookup counter for LRU replacement */
+
+    /**
+     * Find a glyph in the cache, rendering it into the least recently used
+     * entry if it is not there.
+     *
+     * @param letter The character.
+     * @param background The background color to render the glyph onto.
+     * @return The cache entry or NULL if the cache cannot be used.
+     */
+
+    FAR const struct SGlyphCache *getCachedGlyph(nxwidget_char_t letter,
+                                                 nxgl_mxpixel_t background);
+
+    /**
+     * Copy constructor and assignment are not supported; the glyph cache
+     * memory belongs to one instance.
+     */
+
+    CNxFont(const CNxFont &font);
+    CNxFont &operator=(const CNxFont &font);
+#endif
+
   public:
 
     /**
@@ -96,7 +140,11 @@ namespace NXWidgets
      * CNxFont Destructor.
      */
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    ~CNxFont();
+#else
     ~CNxFont() { }
+#endif
 
     /**
      * Checks if supplied character is blank in the current font.
@@ -160,6 +208,32 @@ namespace NXWidgets
 
     void drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter);
 
+    /**
+     * Get an individual character rendered in the current font color onto
+     * a solid background.  The image is getHeight() rows high and as wide
+     * as the character (including the X offset).  The returned memory
+     * stays valid until the next call to getGlyph() or drawChar().
+     *
+     * @param letter The character to output.
+     * @param background The background color.
+     * @param stride The location to return the row length of the image.
+     * @return The rendered image or NULL if no glyph cache is available;
+     *   the caller should then render with drawChar().
+     */
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    FAR const void *getGlyph(nxwidget_char_t letter,
+                             nxgl_mxpixel_t background,
+                             FAR unsigned int *stride);
+#else
+    inline FAR const void *getGlyph(nxwidget_char_t letter,
+                                    nxgl_mxpixel_t background,
+                                    FAR unsigned int *stride)
+    {
+      return (FAR const void *)0;
+    }
+#endif
+
     /**
      * Get the width of a string in pixels when drawn with this font.
      *
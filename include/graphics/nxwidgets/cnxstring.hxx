@@ -81,6 +81,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <nuttx/nx/nxglib.h>
+
 #include "graphics/nxwidgets/nxconfig.hxx"
 
 /****************************************************************************
@@ -96,6 +98,7 @@
 namespace NXWidgets
 {
   class CStringIterator;
+  class CNxFont;
 
   /**
    * Unicode string class.  Uses 16-bt wide-character encoding.  For optimal
@@ -122,11 +125,32 @@ namespace NXWidgets
   {
   private:
     friend class CStringIterator;
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    friend class CNxFont;
+#endif
 
     int m_stringLength;  /**< Number of characters in the string */
     int m_allocatedSize; /**< Number of bytes allocated for this string */
     int m_growAmount;    /**< Number of chars that the string grows by
                               whenever it needs to get larger */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    mutable FAR const void *m_widthFont; /**< Font that m_width was measured
+                                              with (NULL: not measured) */
+    mutable nxgl_coord_t m_width;        /**< Cached width of the string in
+                                              pixels */
+#endif
+
+    /**
+     * Forget the cached pixel width of the string.  Called whenever the
+     * text changes.
+     */
+
+    inline void invalidateWidth(void)
+    {
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+      m_widthFont = (FAR const void *)0;
+#endif
+    }
 
 
   protected:
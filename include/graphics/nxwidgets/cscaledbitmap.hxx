@@ -74,10 +74,17 @@ namespace NXWidgets
   protected:
     FAR IBitmap       *m_bitmap;      /**< The bitmap that is being scaled */
     struct nxgl_size_s m_size;        /**< Scaled size of the image */
-    FAR uint8_t       *m_rowCache[2]; /**< Two cached rows of the image */
+    FAR uint8_t       *m_rowBuffer;   /**< One unscaled row of the image */
+    FAR uint32_t      *m_rowCache[2]; /**< Two rows scaled horizontally */
+    FAR nxgl_coord_t  *m_xIndex;      /**< Source column of each column */
+    FAR uint8_t       *m_xWeight;     /**< Weight of the next source column */
     unsigned int       m_row;         /**< Row number of the first cached row */
     b16_t              m_xScale;      /**< X scale factor */
     b16_t              m_yScale;      /**< Y scale factor */
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+    FAR uint8_t       *m_scaled;      /**< The whole scaled image (or NULL) */
+    bool               m_scaleFailed; /**< True: don't try to cache again */
+#endif
 
     /**
      * Read two rows into the row cache
@@ -88,31 +95,36 @@ namespace NXWidgets
     bool cacheRows(unsigned int row);
 
     /**
-     * Given an two RGB colors and a fractional value, return the scaled
-     * value between the two colors.
+     * Read one row of the unscaled image and scale it horizontally.
      *
-     * @param incolor1 - The first color to be used
-     * @param incolor2 - The second color to be used
-     * @param fraction - The fractional value
-     * @param outcolor - The returned, scaled color
+     * @param row - The row number in the unscaled image
+     * @param dest - The location to return the scaled row.  Each pixel is
+     *   returned as 8:8:8 RGB with a transparency flag in bit 24.
      */
 
-    bool scaleColor(FAR const struct rgbcolor_s &incolor1,
-                    FAR const struct rgbcolor_s &incolor2,
-                    b16_t fraction, FAR struct rgbcolor_s &outcolor);
+    bool scaleRow(unsigned int row, FAR uint32_t *dest);
 
     /**
-     * Given an image row and a non-integer column offset, return the
-     * interpolated RGB color value corresponding to that position
+     * Scale one row of the image in the native pixel format.
      *
-     * @param row - The pointer to the row in the row cache to use
-     * @param column - The non-integer column offset
-     * @param outcolor - The returned, interpolated color
+     * @param x The offset into the row to get
+     * @param y The row number to get
+     * @param width The number of pixels to get from the row
+     * @param data The memory location in which to return the data.
+     */
+
+    bool scaleRun(nxgl_coord_t x, nxgl_coord_t y, nxgl_coord_t width,
+                  FAR void *data);
+
+#ifdef CONFIG_NXWIDGETS_SCALEDBITMAP_CACHE
+    /**
+     * Scale the whole image into m_scaled.
      *
+     * @return True if the scaled image is available in m_scaled.
      */
 
-    bool rowColor(FAR uint8_t *row, b16_t column,
-                  FAR struct rgbcolor_s &outcolor);
+    bool cacheImage(void);
+#endif
 
     /**
      * Copy constructor is protected to prevent usage.
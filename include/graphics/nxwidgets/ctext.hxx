@@ -133,6 +133,30 @@ namespace NXWidgets
                                                   in pixels */
     nxgl_coord_t          m_width;           /**< Width in pixels available t
                                                   the text */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+    /**
+     * Struct holding the measured pixel widths of one wrapped line.  A
+     * negative value means that the width has not been measured yet.
+     */
+
+    typedef struct
+    {
+      nxgl_coord_t width;                    /**< Width of the whole line */
+      nxgl_coord_t trimmedWidth;             /**< Width without trailing blanks */
+    } LineWidth;
+
+    mutable TNxArray<LineWidth> m_lineWidths; /**< Cached widths of the wrapped
+                                                   lines */
+
+    /**
+     * Get the cached widths of a line, adding unmeasured entries as needed.
+     *
+     * @param lineNumber The line number.
+     * @return The cache entry for the line.
+     */
+
+    LineWidth &getLineWidthCache(const int lineNumber) const;
+#endif
 
   public:
 
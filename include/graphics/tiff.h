@@ -291,11 +291,18 @@ struct tiff_info_s
   /* The first fields are used to pass information to the TIFF file creation
    * logic via tiff_initialize().
    *
-   * Filenames.  Three file names are required.  (1) path to the final
+   * Filenames.  Three file names may be provided.  (1) path to the final
    * output file and (2) two paths to temporary files.  One temporary file
    * (tmpfile1) will be used to hold the strip image data and the other
    * (tmpfile2) will be used to hold strip offset and count information.
    *
+   * If tmpfile1 and tmpfile2 are both NULL, the file is written in a
+   * single pass:  Space for the strip offsets and counts of all
+   * imgheight / rps strips is reserved after the IFD, the strip data is
+   * written directly to the output file and the offsets and counts are
+   * filled in by tiff_finalize().  This avoids copying all of the image
+   * data at finalize time but needs 8 bytes of RAM per strip.
+   *
    * colorfmt  - Specifies the form of the color data that will be provided
    *             in the strip data.  These are the FB_FMT_* definitions
    *             provided in include/nuttx/video/fb.h.  Only the following values
@@ -310,6 +317,12 @@ struct tiff_info_s
    * rps       - TIFF RowsPerStrip
    * imgwidth  - TIFF ImageWidth, Number of columns in the image
    * imgheight - TIFF ImageLength, Number of rows in the image
+   *
+   * compression - TIFF Compression of the strip data.  Zero or
+   *             TAG_COMP_NONE selects uncompressed strips.  TAG_COMP_PACKBITS
+   *             (CONFIG_TIFF_PACKBITS) and TAG_COMP_LZW (CONFIG_TIFF_LZW)
+   *             compress each strip as it is added.  The compressors work
+   *             best with several rows per strip.
    */
 
   FAR const char *outfile;  /* Full path to the final output file name */
@@ -320,10 +333,12 @@ struct tiff_info_s
   nxgl_coord_t rps;         /* TIFF RowsPerStrip */
   nxgl_coord_t imgwidth;    /* TIFF ImageWidth, Number of columns in the image */
   nxgl_coord_t imgheight;   /* TIFF ImageLength, Number of rows in the image */
+  uint16_t     compression; /* TIFF Compression, TAG_COMP_* or zero */
 
   /* The caller must provide an I/O buffer as well.  This I/O buffer will
-   * used for color conversions and as the intermediate buffer for copying
-   * files.  The larger the buffer, the better the performance.
+   * used to collect converted and compressed strip data before it is
+   * written and as the intermediate buffer for copying files.  The larger
+   * the buffer, the better the performance.
    */
 
   FAR uint8_t *iobuffer;    /* IO buffer allocated by the caller */
@@ -347,6 +362,11 @@ struct tiff_info_s
   off_t        outsize;     /* Current size of outfile */
   off_t        tmp1size;    /* Current size of tmpfile1 */
   off_t        tmp2size;    /* Current size of tmpfile2 */
+  size_t       iolen;       /* Number of bytes pending in iobuffer */
+  size_t       stripsize;   /* Bytes written for the current strip */
+  nxgl_coord_t maxstrips;   /* Number of strips reserved (single pass) */
+  FAR uint8_t *strips;      /* Strip byte counts and offsets (single pass) */
+  FAR void    *encoder;     /* Compression state */
 
   /* Points to an internal constant structure of file offsets */
 
@@ -60,6 +60,7 @@
 namespace NXWidgets
 {
   class  CBgWindow;                               // Forward reference
+  class  CGraphicsPort;                           // Forward reference
   class  CImage;                                  // Forward reference
   class  CWidgetControl;                          // Forward reference
   struct SRlePaletteBitmap;                       // Forward reference
@@ -82,6 +83,13 @@ namespace Twm4Nx
 #ifdef CONFIG_TWM4NX_BACKGROUND_HASIMAGE
       FAR NXWidgets::CImage        *m_backImage;  /**< The background image */
 #endif
+#ifdef CONFIG_TWM4NX_FRAMETIME
+      struct nxgl_rect_s            m_frameRect;  /**< Frame time overlay region */
+      uint32_t                      m_frameLast;  /**< Last frame time (usec) */
+      uint32_t                      m_frameMax;   /**< Worst frame time (usec) */
+      uint16_t                      m_frameShown; /**< Displayed last time (100 usec) */
+      uint16_t                      m_maxShown;   /**< Displayed worst time (100 usec) */
+#endif
 
       /**
        * Create the background window.
@@ -107,6 +115,37 @@ namespace Twm4Nx
        */
 
       bool createBackgroundImage(FAR const struct NXWidgets::SRlePaletteBitmap *sbitmap);
+
+      /**
+       * Draw the part of the background image that lies within a region of
+       * the background window.  Only the rows and columns of the image that
+       * fall within the region are decoded and sent to NX.
+       *
+       * @param port The graphics port of the background window
+       * @param rect The region to draw, already clipped to the image
+       */
+
+      void drawBackgroundImage(FAR NXWidgets::CGraphicsPort *port,
+                               FAR const struct nxgl_rect_s &rect);
+#endif
+
+      /**
+       * Redraw the background color, the background image and the icons
+       * within one region of the background window.
+       *
+       * @param rect The region in the window to be redrawn
+       * @return true on success
+       */
+
+      bool redrawBackgroundRegion(FAR const struct nxgl_rect_s &rect);
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+      /**
+       * Draw the frame time overlay in the lower right corner of the
+       * background.
+       */
+
+      void drawFrameTime(void);
 #endif
 
       /**
@@ -179,6 +218,31 @@ namespace Twm4Nx
 
       bool redrawBackgroundWindow(FAR const struct nxgl_rect_s *rect, bool more);
 
+      /**
+       * Redraw the part of the background that was uncovered when an object
+       * on the background (such as an icon) moved from 'oldBounds' to
+       * 'newBounds'.  The region still covered by the object is not redrawn.
+       *
+       * @param oldBounds The region previously occupied by the object
+       * @param newBounds The region now occupied by the object
+       * @return true on success
+       */
+
+      bool redrawExposedBackground(FAR const struct nxgl_rect_s &oldBounds,
+                                   FAR const struct nxgl_rect_s &newBounds);
+
+#ifdef CONFIG_TWM4NX_FRAMETIME
+      /**
+       * Report the time needed to handle one event.  The overlay shows the
+       * last and the worst time and is only redrawn when the displayed
+       * values change.
+       *
+       * @param usecs The event handling time in microseconds
+       */
+
+      void showFrameTime(uint32_t usecs);
+#endif
+
       /**
        * Check if the region within 'bounds' collides with any other reserved
        * region on the desktop.  This is used for icon placement.
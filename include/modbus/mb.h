@@ -130,6 +130,16 @@ typedef enum
   MB_ETIMEDOUT                /* timeout error occurred. */
 } eMBErrorCode;
 
+/* Register tables of the built-in register map (CONFIG_MB_REGMAP). */
+
+typedef enum
+{
+  MB_REGMAP_COILS,            /* Coils. */
+  MB_REGMAP_DISCRETE,         /* Discrete inputs. */
+  MB_REGMAP_INPUT,            /* Input registers. */
+  MB_REGMAP_HOLDING           /* Holding registers. */
+} eMBRegMapTable;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -438,6 +448,39 @@ eMBErrorCode eMBRegCoilsCB(uint8_t *pucRegBuffer, uint16_t usAddress,
 eMBErrorCode eMBRegDiscreteCB(uint8_t *pucRegBuffer, uint16_t usAddress,
                               uint16_t usNDiscrete);
 
+#ifdef CONFIG_MB_REGMAP
+/* Copy values from or to the built-in register map.
+ *
+ * The register map provides the register callbacks above from static
+ * tables.  These functions are how the application reads the values
+ * written by the master and publishes its own values.  They do not block
+ * and may be called from any thread; each call copies a consistent
+ * snapshot or updates the range at once.  The application may update any
+ * table, the master can only write coils and holding registers.
+ *
+ * Input Parameters:
+ *   eTable The register table.
+ *   usAddr The first register or bit (0 based, as on the wire).
+ *   usNRegs, usNBits The number of registers or bits.
+ *   pusBuffer Registers, in host byte order.
+ *   pucBuffer Bits, packed as in a Modbus frame (first bit in the LSB).
+ *
+ * Returned Value:
+ *   - eMBErrorCode::MB_ENOERR If no error occurred.
+ *   - eMBErrorCode::MB_ENOREG If the range is not in the table.
+ *   - eMBErrorCode::MB_EINVAL If eTable is of the wrong type.
+ */
+
+eMBErrorCode eMBRegMapGetRegs(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNRegs, uint16_t *pusBuffer);
+eMBErrorCode eMBRegMapSetRegs(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNRegs, const uint16_t *pusBuffer);
+eMBErrorCode eMBRegMapGetBits(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNBits, uint8_t *pucBuffer);
+eMBErrorCode eMBRegMapSetBits(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNBits, const uint8_t *pucBuffer);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -98,6 +98,16 @@ typedef enum
     MB_MRE_EXE_FUN                  /* execute function error. */
 } eMBMasterReqErrCode;
 
+/* Register tables polled by the Master scheduler. */
+
+typedef enum
+{
+    MB_SCHED_COILS,                 /* Coils (read coils). */
+    MB_SCHED_DISCRETE,              /* Discrete inputs. */
+    MB_SCHED_INPUT,                 /* Input registers. */
+    MB_SCHED_HOLDING                /* Holding registers. */
+} eMBMasterSchedTable;
+
 /* TimerMode is Master 3 kind of Timer modes. */
 
 typedef enum
@@ -445,6 +455,85 @@ eMBException eMBMasterFuncReadDiscreteInputs(uint8_t *pucFrame,
 eMBException eMBMasterFuncReadWriteMultipleHoldingRegister(uint8_t *pucFrame,
   uint16_t *usLen);
 
+#ifdef CONFIG_MB_MASTER_SCHED
+/****************************************************************************
+ * Description:
+ *   Add a periodic poll job to the Master scheduler.  Jobs for the same
+ *   slave and table that overlap or are close to each other are merged
+ *   into one read request, polled at the shortest of their periods.  Jobs
+ *   can only be added before eMBMasterSchedStart().
+ *   The scheduler implements the eMBMasterReg*CB() callbacks, the
+ *   application must not define them.
+ * Input Parameters:
+ *   ucSlave The slave address (1 - CONFIG_MB_MASTER_TOTAL_SLAVE_NUM).
+ *   eTable The register table to read.
+ *   usAddr The first register or bit (0 based, as on the wire).
+ *   usNum The number of registers (max. 125) or bits (max. 2000).
+ *   ulPeriod The poll period in milliseconds.
+ * Returned Value:
+ *   eMBErrorCode::MB_ENOERR on success, MB_EINVAL for an invalid job,
+ *   MB_ENORES if the request table is full and MB_EILLSTATE if the
+ *   scheduler was already started.
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterSchedAddJob(uint8_t ucSlave, eMBMasterSchedTable eTable,
+                                  uint16_t usAddr, uint16_t usNum,
+                                  uint32_t ulPeriod);
+
+/****************************************************************************
+ * Description:
+ *   Lay out the register image and start polling.
+ * Returned Value:
+ *   eMBErrorCode::MB_ENOERR on success, MB_ENORES if the register image
+ *   is too small for the jobs.
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterSchedStart(void);
+
+/****************************************************************************
+ * Description:
+ *   Run the Master protocol stack and the scheduler.  This function
+ *   replaces eMBMasterPoll() in the poll thread.  It issues the next due
+ *   request as soon as the previous one has finished, without blocking.
+ *   Requests of the application (eMBMasterReq*()) from other threads are
+ *   interleaved with the scheduled ones.
+ * Returned Value:
+ *   As eMBMasterPoll().
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterSchedPoll(void);
+
+/****************************************************************************
+ * Description:
+ *   Copy polled values from the register image.  These functions do not
+ *   block and may be called from any thread.  The range must be covered by
+ *   one poll job (or by jobs that were merged).
+ * Input Parameters:
+ *   ucSlave The slave address.
+ *   eTable The register table.
+ *   usAddr The first register or bit (0 based).
+ *   usNRegs, usNBits The number of registers or bits.
+ *   pusBuffer Registers, in host byte order.
+ *   pucBuffer Bits, packed as in a Modbus frame (first bit in the LSB).
+ *   pulAge If not NULL, the age of the values in milliseconds.
+ * Returned Value:
+ *   - eMBErrorCode::MB_ENOERR If the values are from the last poll.
+ *   - eMBErrorCode::MB_ETIMEDOUT If the last poll failed.  The values
+ *       are from an earlier poll, see pulAge.
+ *   - eMBErrorCode::MB_EIO If the range was never read successfully.
+ *   - eMBErrorCode::MB_ENOREG If the range is not polled.
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterSchedGetRegs(uint8_t ucSlave,
+                                   eMBMasterSchedTable eTable,
+                                   uint16_t usAddr, uint16_t usNRegs,
+                                   uint16_t *pusBuffer, uint32_t *pulAge);
+eMBErrorCode eMBMasterSchedGetBits(uint8_t ucSlave,
+                                   eMBMasterSchedTable eTable,
+                                   uint16_t usAddr, uint16_t usNBits,
+                                   uint8_t *pucBuffer, uint32_t *pulAge);
+#endif
+
 /* These functions are interface for Modbus Master */
 
 void vMBMasterGetPDUSndBuf(uint8_t **pucFrame);
@@ -459,6 +548,8 @@ bool xMBMasterRequestIsBroadcast(void);
 eMBMasterErrorEventType eMBMasterGetErrorType(void);
 void vMBMasterSetErrorType(eMBMasterErrorEventType errorType);
 eMBMasterReqErrCode eMBMasterWaitRequestFinish(void);
+void vMBMasterPollRequestStart(void);
+bool xMBMasterRequestFinished(eMBMasterReqErrCode *peErrStatus);
 
 #ifdef __cplusplus
 }
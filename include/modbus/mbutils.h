@@ -104,6 +104,24 @@ void xMBUtilSetBits(uint8_t *ucByteBuf, uint16_t usBitOffset,
 
 uint8_t xMBUtilGetBits(uint8_t *ucByteBuf, uint16_t usBitOffset, uint8_t ucNBits);
 
+/* Function to copy a range of bits between byte buffers.
+ *
+ * Byte aligned ranges are copied with memcpy(), other ranges up to eight
+ * bits at a time.  The bits outside of the destination range are left
+ * unchanged and no byte beyond either range is accessed.
+ *
+ * Input Parameters:
+ *  pucDst The destination buffer.
+ *  usDstOff The offset of the first destination bit.
+ *  pucSrc The source buffer.
+ *  usSrcOff The offset of the first source bit.
+ *  usNBits Number of bits to copy.
+ */
+
+void xMBUtilCopyBits(uint8_t *pucDst, uint16_t usDstOff,
+                     const uint8_t *pucSrc, uint16_t usSrcOff,
+                     uint16_t usNBits);
+
 #ifdef __cplusplus
 }
 #endif
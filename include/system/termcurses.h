@@ -70,6 +70,7 @@
 #define TCURS_ATTRIB_INVIS      0x0008
 #define TCURS_ATTRIB_CURS_HIDE  0x0010
 #define TCURS_ATTRIB_CURS_SHOW  0x0020
+#define TCURS_ATTRIB_ALTCHARSET 0x0040
 
 /********************************************************************************************
  * Public Type Definitions
@@ -121,6 +122,15 @@ struct termcurses_ops_s
   /* Check for cached keycode value */
 
   CODE bool (*checkkey)(FAR struct termcurses_s *dev);
+
+  /* Write text at the cursor position */
+
+  CODE int (*write)(FAR struct termcurses_s *dev, FAR const char *buffer,
+                    size_t buflen);
+
+  /* Send any buffered output to the terminal */
+
+  CODE int (*flush)(FAR struct termcurses_s *dev);
 };
 
 struct termcurses_dev_s
@@ -243,6 +253,28 @@ int termcurses_getkeycode(FAR struct termcurses_s *term, FAR int *specialkey,
 
 bool termcurses_checkkey(FAR struct termcurses_s *term);
 
+/************************************************************************************
+ * Name: termcurses_write
+ *
+ * Description:
+ *   Write text at the current cursor position.  Like the other output
+ *   operations, the text may be buffered until termcurses_flush() is called.
+ *
+ ************************************************************************************/
+
+int termcurses_write(FAR struct termcurses_s *term, FAR const char *buffer,
+                     size_t buflen);
+
+/************************************************************************************
+ * Name: termcurses_flush
+ *
+ * Description:
+ *   Send all buffered output to the terminal.
+ *
+ ************************************************************************************/
+
+int termcurses_flush(FAR struct termcurses_s *term);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -53,6 +53,7 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <net/ethernet.h>
@@ -66,6 +67,12 @@
 
 #define WAPI_ESSID_MAX_SIZE IW_ESSID_MAX_SIZE
 
+/* Number of BSS kept by a scan result cache. */
+
+#ifndef CONFIG_WIRELESS_WAPI_SCAN_CACHE_SIZE
+#  define CONFIG_WIRELESS_WAPI_SCAN_CACHE_SIZE 16
+#endif
+
 /* Buffer size while reading lines from PROC_NET_ files. */
 
 #define WAPI_PROC_LINE_SIZE  1024
@@ -191,6 +198,42 @@ struct wapi_scan_info_s
   int rssi;
 };
 
+/* Scan result cache, see wapi_scan_cache_update().  Results are merged
+ * into the cache by BSSID, so that partial (e.g. single channel) scans
+ * refresh the matching entries only, and entries that are not reported
+ * any more are dropped after maxage milliseconds.
+ */
+
+enum wapi_scan_change_e
+{
+  WAPI_SCAN_NEW,                      /* BSS reported for the first time */
+  WAPI_SCAN_UPDATED,                  /* BSS reported again */
+  WAPI_SCAN_EXPIRED                   /* BSS dropped from the cache */
+};
+
+typedef CODE void (*wapi_scan_cb_t)(FAR void *arg,
+                                    enum wapi_scan_change_e change,
+                                    FAR const struct wapi_scan_info_s *info);
+
+struct wapi_scan_entry_s
+{
+  struct wapi_scan_info_s info;       /* Merged results (next is unused) */
+  uint32_t seen;                      /* Time of the last result (ms) */
+  uint32_t count;                     /* Number of results merged */
+};
+
+struct wapi_scan_cache_s
+{
+  struct wapi_scan_entry_s entries[CONFIG_WIRELESS_WAPI_SCAN_CACHE_SIZE];
+  int nentries;
+  uint32_t maxage;                    /* Entry lifetime (ms), 0: forever */
+  wapi_scan_cb_t cb;                  /* Change notification or NULL */
+  FAR void *arg;                      /* Argument of cb */
+  FAR char *buf;                      /* SIOCGIWSCAN buffer, kept between
+                                       * updates */
+  size_t buflen;
+};
+
 /* Linked list container for routing table rows. */
 
 struct wapi_route_info_s
@@ -643,6 +686,24 @@ int wapi_make_socket(void);
 
 int wapi_scan_init(int sock, FAR const char *ifname, FAR const char *essid);
 
+/****************************************************************************
+ * Name: wapi_scan_channel_init
+ *
+ * Description:
+ *   Starts a scan of the given channels only.  A partial scan completes
+ *   much faster than a full one and is meant to refresh a scan cache.
+ *
+ * Input Parameters:
+ *   essid     - Scan for this ESSID only, NULL for any
+ *   channels  - IEEE 802.11 channel numbers to scan
+ *   nchannels - Number of channels, at most IW_MAX_FREQUENCIES
+ *
+ ****************************************************************************/
+
+int wapi_scan_channel_init(int sock, FAR const char *ifname,
+                           FAR const char *essid,
+                           FAR const uint8_t *channels, int nchannels);
+
 /****************************************************************************
  * Name: wapi_scan_stat
  *
@@ -656,6 +717,20 @@ int wapi_scan_init(int sock, FAR const char *ifname, FAR const char *essid);
 
 int wapi_scan_stat(int sock, FAR const char *ifname);
 
+/****************************************************************************
+ * Name: wapi_scan_wait
+ *
+ * Description:
+ *   Waits for the completion of a scan started with wapi_scan_init() or
+ *   wapi_scan_channel_init().
+ *
+ * Returned Value:
+ *   Zero, if data is ready; -ETIMEDOUT or another negated errno on failure.
+ *
+ ****************************************************************************/
+
+int wapi_scan_wait(int sock, FAR const char *ifname, int timeout_ms);
+
 /****************************************************************************
  * Name: wapi_scan_coll
  *
@@ -683,6 +758,77 @@ int wapi_scan_coll(int sock, FAR const char *ifname,
 
 void wapi_scan_coll_free(FAR struct wapi_list_s *aps);
 
+/****************************************************************************
+ * Name: wapi_scan_cache_init
+ *
+ * Description:
+ *   Initializes an empty scan result cache.
+ *
+ * Input Parameters:
+ *   cache  - The cache to initialize
+ *   maxage - Drop the entries not reported for maxage ms, 0 to keep them
+ *   cb     - Called on each new, updated and dropped entry, may be NULL
+ *   arg    - Argument of cb
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_init(FAR struct wapi_scan_cache_s *cache,
+                          uint32_t maxage, wapi_scan_cb_t cb,
+                          FAR void *arg);
+
+/****************************************************************************
+ * Name: wapi_scan_cache_update
+ *
+ * Description:
+ *   Collects the results of a scan process and merges them into the cache,
+ *   then drops the entries that have expired.  Unlike wapi_scan_coll(),
+ *   nothing is allocated once the cache buffer has grown to the size of
+ *   the scan results.
+ *
+ * Returned Value:
+ *   The number of results merged; a negated errno on failure (-EAGAIN if
+ *   the scan is not completed).
+ *
+ ****************************************************************************/
+
+int wapi_scan_cache_update(int sock, FAR const char *ifname,
+                           FAR struct wapi_scan_cache_s *cache);
+
+/****************************************************************************
+ * Name: wapi_scan_cache_expire
+ *
+ * Description:
+ *   Drops the cache entries not reported for cache->maxage ms.
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_expire(FAR struct wapi_scan_cache_s *cache);
+
+/****************************************************************************
+ * Name: wapi_scan_cache_find
+ *
+ * Description:
+ *   Looks up a BSS in the cache.
+ *
+ * Returned Value:
+ *   The cached entry, NULL if the BSS is not in the cache.
+ *
+ ****************************************************************************/
+
+FAR const struct wapi_scan_entry_s *
+wapi_scan_cache_find(FAR const struct wapi_scan_cache_s *cache,
+                     FAR const struct ether_addr *bssid);
+
+/****************************************************************************
+ * Name: wapi_scan_cache_free
+ *
+ * Description:
+ *   Releases the buffer of the cache and empties it.
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_free(FAR struct wapi_scan_cache_s *cache);
+
 #ifdef CONFIG_WIRELESS_WAPI_INITCONF
 /****************************************************************************
  * Name: wapi_load_config
@@ -100,7 +100,7 @@ eMBException eMBFuncReadCoils(uint8_t *pucFrame, uint16_t *usLen)
        */
 
       if ((usCoilCount >= 1) &&
-          (usCoilCount < MB_PDU_FUNC_READ_COILCNT_MAX))
+          (usCoilCount <= MB_PDU_FUNC_READ_COILCNT_MAX))
         {
           /* Set the current PDU data pointer to the beginning. */
 
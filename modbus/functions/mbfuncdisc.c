@@ -87,7 +87,7 @@ eMBException eMBFuncReadDiscreteInputs(uint8_t *pucFrame, uint16_t *usLen)
        */
 
       if ((usDiscreteCnt >= 1) &&
-          (usDiscreteCnt < MB_PDU_FUNC_READ_DISCCNT_MAX))
+          (usDiscreteCnt <= MB_PDU_FUNC_READ_DISCCNT_MAX))
         {
           /* Set the current PDU data pointer to the beginning. */
 
@@ -88,7 +88,7 @@ eMBException eMBFuncReadInputRegister(uint8_t *pucFrame, uint16_t *usLen)
        */
 
       if ((usRegCount >= 1) &&
-          (usRegCount < MB_PDU_FUNC_READ_REGCNT_MAX))
+          (usRegCount <= MB_PDU_FUNC_READ_REGCNT_MAX))
         {
           /* Set the current PDU data pointer to the beginning. */
 
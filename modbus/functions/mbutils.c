@@ -42,6 +42,7 @@
 
 #include "modbus/mb.h"
 #include "modbus/mbproto.h"
+#include "modbus/mbutils.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -135,6 +136,62 @@ uint8_t xMBUtilGetBits(uint8_t *ucByteBuf, uint16_t usBitOffset, uint8_t ucNBits
   return (uint8_t) usWordBuf;
 }
 
+void xMBUtilCopyBits(uint8_t *pucDst, uint16_t usDstOff,
+                     const uint8_t *pucSrc, uint16_t usSrcOff,
+                     uint16_t usNBits)
+{
+  uint16_t usValue;
+  uint16_t usMask;
+  uint16_t usByte;
+  uint16_t usShift;
+  uint8_t ucNBits;
+
+  /* Whole bytes of a byte aligned copy are copied as they are. */
+
+  if ((usDstOff & 7) == 0 && (usSrcOff & 7) == 0)
+    {
+      memcpy(pucDst + usDstOff / 8, pucSrc + usSrcOff / 8, usNBits / 8);
+      usDstOff += usNBits & ~7;
+      usSrcOff += usNBits & ~7;
+      usNBits  &= 7;
+    }
+
+  /* Otherwise up to eight bits at a time.  Unlike xMBUtilGetBits() and
+   * xMBUtilSetBits() only the bytes holding the bits are accessed, so the
+   * buffers need not be padded.
+   */
+
+  while (usNBits > 0)
+    {
+      ucNBits = usNBits > BITS_uint8_t ? BITS_uint8_t : usNBits;
+      usMask  = (uint16_t)((1 << ucNBits) - 1);
+
+      usByte  = usSrcOff / BITS_uint8_t;
+      usShift = usSrcOff % BITS_uint8_t;
+      usValue = pucSrc[usByte] >> usShift;
+      if (usShift + ucNBits > BITS_uint8_t)
+        {
+          usValue |= pucSrc[usByte + 1] << (BITS_uint8_t - usShift);
+        }
+
+      usByte  = usDstOff / BITS_uint8_t;
+      usShift = usDstOff % BITS_uint8_t;
+      usValue = (usValue & usMask) << usShift;
+      usMask <<= usShift;
+      pucDst[usByte] = (uint8_t)((pucDst[usByte] & ~usMask) | usValue);
+      if (usShift + ucNBits > BITS_uint8_t)
+        {
+          usByte++;
+          pucDst[usByte] = (uint8_t)((pucDst[usByte] & ~(usMask >> 8)) |
+                                     (usValue >> 8));
+        }
+
+      usDstOff += ucNBits;
+      usSrcOff += ucNBits;
+      usNBits  -= ucNBits;
+    }
+}
+
 eMBException prveMBError2Exception(eMBErrorCode eErrorCode)
 {
   eMBException eStatus;
@@ -0,0 +1,330 @@
+/****************************************************************************
+ * apps/modbus/mbregmap.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Slave register map.
+ *
+ * The four register tables are static arrays that the slave register
+ * callbacks copy from and to.  The registers are kept in wire (big endian)
+ * byte order and the bits packed as in a frame, first bit in the LSB, so a
+ * request for 125 registers or 2000 coils is one memcpy().  Only bit ranges
+ * that do not start on a byte boundary are shifted.
+ *
+ * The application side converts to host byte order in bulk when it takes
+ * a snapshot or updates a range.  Each table has a sequence counter which
+ * is odd while the table is updated, either by the application or by a
+ * write request of the master, so the readers on both sides copy a
+ * consistent range without taking a lock.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <sched.h>
+#include <string.h>
+
+#include "port.h"
+
+#include "modbus/mb.h"
+#include "modbus/mbutils.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_REGMAP_COILS_START
+#  define CONFIG_MB_REGMAP_COILS_START    0
+#endif
+
+#ifndef CONFIG_MB_REGMAP_COILS_NUM
+#  define CONFIG_MB_REGMAP_COILS_NUM      256
+#endif
+
+#ifndef CONFIG_MB_REGMAP_DISCRETE_START
+#  define CONFIG_MB_REGMAP_DISCRETE_START 0
+#endif
+
+#ifndef CONFIG_MB_REGMAP_DISCRETE_NUM
+#  define CONFIG_MB_REGMAP_DISCRETE_NUM   256
+#endif
+
+#ifndef CONFIG_MB_REGMAP_INPUT_START
+#  define CONFIG_MB_REGMAP_INPUT_START    0
+#endif
+
+#ifndef CONFIG_MB_REGMAP_INPUT_NUM
+#  define CONFIG_MB_REGMAP_INPUT_NUM      128
+#endif
+
+#ifndef CONFIG_MB_REGMAP_HOLDING_START
+#  define CONFIG_MB_REGMAP_HOLDING_START  0
+#endif
+
+#ifndef CONFIG_MB_REGMAP_HOLDING_NUM
+#  define CONFIG_MB_REGMAP_HOLDING_NUM    128
+#endif
+
+#if CONFIG_MB_REGMAP_COILS_START + CONFIG_MB_REGMAP_COILS_NUM > 65536 || \
+    CONFIG_MB_REGMAP_DISCRETE_START + CONFIG_MB_REGMAP_DISCRETE_NUM > 65536
+#  error "Bit table beyond the Modbus address range"
+#endif
+
+#if CONFIG_MB_REGMAP_INPUT_START + CONFIG_MB_REGMAP_INPUT_NUM > 65536 || \
+    CONFIG_MB_REGMAP_HOLDING_START + CONFIG_MB_REGMAP_HOLDING_NUM > 65536
+#  error "Register table beyond the Modbus address range"
+#endif
+
+/* Storage size of a table, at least one element for an empty table */
+
+#define MB_REGMAP_NBYTES(n)       ((n) > 0 ? ((n) + 7) / 8 : 1)
+#define MB_REGMAP_NREGS(n)        ((n) > 0 ? (n) : 1)
+
+#define MB_REGMAP_ISBITS(t) \
+  ((t) == MB_REGMAP_COILS || (t) == MB_REGMAP_DISCRETE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mb_regmap_table_s
+{
+  uint8_t *pucData;             /* Bits or big endian registers */
+  uint32_t ulStart;             /* First address, 0 based */
+  uint32_t ulNum;               /* Number of bits or registers */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t ucCoils[MB_REGMAP_NBYTES(CONFIG_MB_REGMAP_COILS_NUM)];
+static uint8_t ucDiscrete[MB_REGMAP_NBYTES(CONFIG_MB_REGMAP_DISCRETE_NUM)];
+static uint16_t usInput[MB_REGMAP_NREGS(CONFIG_MB_REGMAP_INPUT_NUM)];
+static uint16_t usHolding[MB_REGMAP_NREGS(CONFIG_MB_REGMAP_HOLDING_NUM)];
+
+static const struct mb_regmap_table_s xTables[] =
+{
+  {
+    ucCoils,
+    CONFIG_MB_REGMAP_COILS_START,
+    CONFIG_MB_REGMAP_COILS_NUM
+  },
+  {
+    ucDiscrete,
+    CONFIG_MB_REGMAP_DISCRETE_START,
+    CONFIG_MB_REGMAP_DISCRETE_NUM
+  },
+  {
+    (uint8_t *)usInput,
+    CONFIG_MB_REGMAP_INPUT_START,
+    CONFIG_MB_REGMAP_INPUT_NUM
+  },
+  {
+    (uint8_t *)usHolding,
+    CONFIG_MB_REGMAP_HOLDING_START,
+    CONFIG_MB_REGMAP_HOLDING_NUM
+  }
+};
+
+/* Odd while the table is updated */
+
+static volatile uint32_t ulSeq[MB_REGMAP_HOLDING + 1];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Convert registers between host and big endian byte order.  The same
+ * operation works in both directions.
+ */
+
+static void prvvMBRegMapSwap(uint16_t *pusDst, const uint16_t *pusSrc,
+                             uint16_t usNRegs)
+{
+#ifdef CONFIG_ENDIAN_BIG
+  memcpy(pusDst, pusSrc, usNRegs * sizeof(uint16_t));
+#else
+  uint16_t i;
+
+  for (i = 0; i < usNRegs; i++)
+    {
+      pusDst[i] = (uint16_t)(pusSrc[i] << 8 | pusSrc[i] >> 8);
+    }
+#endif
+}
+
+/* Copy a range of a table from (xWrite false) or to the buffer.  pvBuffer
+ * holds big endian registers if xWire is true, else host order registers.
+ * The bits are packed in both cases.
+ */
+
+static eMBErrorCode prveMBRegMapAccess(eMBRegMapTable eTable,
+                                       uint16_t usAddr, uint16_t usNum,
+                                       void *pvBuffer, bool xWrite,
+                                       bool xWire)
+{
+  const struct mb_regmap_table_s *pxTable = &xTables[eTable];
+  uint16_t *pusRegs;
+  uint32_t ulSeqStart;
+  uint16_t usOff;
+
+  if (usNum == 0 || usAddr < pxTable->ulStart ||
+      (uint32_t)usAddr + usNum > pxTable->ulStart + pxTable->ulNum)
+    {
+      return MB_ENOREG;
+    }
+
+  usOff   = usAddr - pxTable->ulStart;
+  pusRegs = (uint16_t *)pxTable->pucData + usOff;
+
+  if (xWrite)
+    {
+      /* Readers retry while the sequence is odd.  They cannot preempt the
+       * update.
+       */
+
+      sched_lock();
+      ulSeq[eTable]++;
+
+      if (MB_REGMAP_ISBITS(eTable))
+        {
+          xMBUtilCopyBits(pxTable->pucData, usOff, pvBuffer, 0, usNum);
+        }
+      else if (xWire)
+        {
+          memcpy(pusRegs, pvBuffer, usNum * sizeof(uint16_t));
+        }
+      else
+        {
+          prvvMBRegMapSwap(pusRegs, pvBuffer, usNum);
+        }
+
+      ulSeq[eTable]++;
+      sched_unlock();
+      return MB_ENOERR;
+    }
+
+  do
+    {
+      ulSeqStart = ulSeq[eTable];
+
+      if (MB_REGMAP_ISBITS(eTable))
+        {
+          /* The unused bits of the last byte are sent as zero */
+
+          memset(pvBuffer, 0, (usNum + 7) / 8);
+          xMBUtilCopyBits(pvBuffer, 0, pxTable->pucData, usOff, usNum);
+        }
+      else if (xWire)
+        {
+          memcpy(pvBuffer, pusRegs, usNum * sizeof(uint16_t));
+        }
+      else
+        {
+          prvvMBRegMapSwap(pvBuffer, pusRegs, usNum);
+        }
+    }
+  while ((ulSeqStart & 1) != 0 || ulSeqStart != ulSeq[eTable]);
+
+  return MB_ENOERR;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+eMBErrorCode eMBRegMapGetRegs(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNRegs, uint16_t *pusBuffer)
+{
+  if (eTable > MB_REGMAP_HOLDING || MB_REGMAP_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBRegMapAccess(eTable, usAddr, usNRegs, pusBuffer, false,
+                            false);
+}
+
+eMBErrorCode eMBRegMapSetRegs(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNRegs, const uint16_t *pusBuffer)
+{
+  if (eTable > MB_REGMAP_HOLDING || MB_REGMAP_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBRegMapAccess(eTable, usAddr, usNRegs, (void *)pusBuffer,
+                            true, false);
+}
+
+eMBErrorCode eMBRegMapGetBits(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNBits, uint8_t *pucBuffer)
+{
+  if (!MB_REGMAP_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBRegMapAccess(eTable, usAddr, usNBits, pucBuffer, false,
+                            false);
+}
+
+eMBErrorCode eMBRegMapSetBits(eMBRegMapTable eTable, uint16_t usAddr,
+                              uint16_t usNBits, const uint8_t *pucBuffer)
+{
+  if (!MB_REGMAP_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBRegMapAccess(eTable, usAddr, usNBits, (void *)pucBuffer,
+                            true, false);
+}
+
+/* The slave register callbacks are passed 1 based addresses */
+
+eMBErrorCode eMBRegInputCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                           uint16_t usNRegs)
+{
+  return prveMBRegMapAccess(MB_REGMAP_INPUT, usAddress - 1, usNRegs,
+                            pucRegBuffer, false, true);
+}
+
+eMBErrorCode eMBRegHoldingCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                             uint16_t usNRegs, eMBRegisterMode eMode)
+{
+  return prveMBRegMapAccess(MB_REGMAP_HOLDING, usAddress - 1, usNRegs,
+                            pucRegBuffer, eMode == MB_REG_WRITE, true);
+}
+
+eMBErrorCode eMBRegCoilsCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                           uint16_t usNCoils, eMBRegisterMode eMode)
+{
+  return prveMBRegMapAccess(MB_REGMAP_COILS, usAddress - 1, usNCoils,
+                            pucRegBuffer, eMode == MB_REG_WRITE, true);
+}
+
+eMBErrorCode eMBRegDiscreteCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                              uint16_t usNDiscrete)
+{
+  return prveMBRegMapAccess(MB_REGMAP_DISCRETE, usAddress - 1, usNDiscrete,
+                            pucRegBuffer, false, true);
+}
@@ -0,0 +1,658 @@
+/****************************************************************************
+ * apps/modbus/mbsched_m.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Master poll scheduler.
+ *
+ * The poll jobs added by the application are merged into read requests:
+ * jobs for the same slave and table whose ranges overlap or lie within
+ * CONFIG_MB_MASTER_SCHED_MERGE_GAP of each other become one request, as
+ * long as it stays within the protocol limit.  The merged request is polled
+ * at the shortest period of its jobs.
+ *
+ * eMBMasterSchedPoll() replaces eMBMasterPoll() in the poll thread.  When
+ * the stack is idle it issues the most overdue request right away, without
+ * waiting in another thread, so the line is reused as soon as the previous
+ * response has been received (i.e. after the T3.5 frame end).
+ *
+ * A slave that does not respond is skipped for a back-off time, doubled on
+ * each timeout up to CONFIG_MB_MASTER_SCHED_BACKOFF_MAX, so that it costs
+ * one response timeout per back-off instead of one per poll.
+ *
+ * The responses are stored in a register image through the master register
+ * callbacks.  Each request has a sequence counter which is odd while its
+ * part of the image is updated, so the readers copy a consistent snapshot
+ * without taking a lock.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#include "port.h"
+
+#include "modbus/mb.h"
+#include "modbus/mb_m.h"
+#include "modbus/mbframe.h"
+#include "modbus/mbproto.h"
+#include "modbus/mbutils.h"
+
+#if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_MASTER_SCHED_BLOCKS
+#  define CONFIG_MB_MASTER_SCHED_BLOCKS      32
+#endif
+
+#ifndef CONFIG_MB_MASTER_SCHED_IMAGE_SIZE
+#  define CONFIG_MB_MASTER_SCHED_IMAGE_SIZE  1024
+#endif
+
+#ifndef CONFIG_MB_MASTER_SCHED_MERGE_GAP
+#  define CONFIG_MB_MASTER_SCHED_MERGE_GAP   8
+#endif
+
+#ifndef CONFIG_MB_MASTER_SCHED_BACKOFF_MIN
+#  define CONFIG_MB_MASTER_SCHED_BACKOFF_MIN 1000
+#endif
+
+#ifndef CONFIG_MB_MASTER_SCHED_BACKOFF_MAX
+#  define CONFIG_MB_MASTER_SCHED_BACKOFF_MAX 30000
+#endif
+
+/* All of the read requests have the same layout */
+
+#define MB_PDU_REQ_READ_ADDR_OFF    (MB_PDU_DATA_OFF + 0)
+#define MB_PDU_REQ_READ_NUM_OFF     (MB_PDU_DATA_OFF + 2)
+#define MB_PDU_REQ_READ_SIZE        (4)
+
+#define MB_SCHED_REGS_MAX           (0x007D)
+#define MB_SCHED_BITS_MAX           (0x07D0)
+
+#define MB_SCHED_ISBITS(t) \
+  ((t) == MB_SCHED_COILS || (t) == MB_SCHED_DISCRETE)
+#define MB_SCHED_MAX(t) \
+  (MB_SCHED_ISBITS(t) ? MB_SCHED_BITS_MAX : MB_SCHED_REGS_MAX)
+#define MB_SCHED_WORDS(t, n) \
+  (MB_SCHED_ISBITS(t) ? ((n) + 15) / 16 : (n))
+
+/* Time comparison, safe across the wrap-around of the ms counter */
+
+#define MB_SCHED_BEFORE(a, b)       ((int32_t)((a) - (b)) < 0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One read request, made of one or more poll jobs */
+
+struct mb_sched_block_s
+{
+  uint8_t  ucSlave;
+  uint8_t  eTable;              /* eMBMasterSchedTable */
+  uint16_t usAddr;              /* First register or bit, 0 based */
+  uint16_t usNum;               /* Number of registers or bits */
+  uint16_t usOffset;            /* Position in the image (words) */
+  uint32_t ulPeriod;            /* Poll period (ms) */
+  uint32_t ulDue;               /* Time of the next poll (ms) */
+  uint32_t ulUpdated;           /* Time of the last response (ms) */
+  volatile uint32_t ulSeq;      /* Odd while the image is updated */
+  eMBMasterReqErrCode eStatus;  /* Result of the last poll */
+  bool     xValid;              /* The image holds a response */
+};
+
+struct mb_sched_slave_s
+{
+  uint32_t ulRetry;             /* No poll before this time (ms) */
+  uint32_t ulBackoff;           /* Current back-off, 0 if responding */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mb_sched_block_s xBlocks[CONFIG_MB_MASTER_SCHED_BLOCKS];
+static struct mb_sched_slave_s xSlaves[CONFIG_MB_MASTER_TOTAL_SLAVE_NUM + 1];
+static uint16_t usImage[CONFIG_MB_MASTER_SCHED_IMAGE_SIZE];
+static uint16_t usNBlocks;
+static bool xStarted;
+
+/* The request the scheduler has on the line */
+
+static struct mb_sched_block_s *pxActive;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t prvulMBSchedNow(void)
+{
+  struct timespec ts;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Merge block j into block i if they are for the same slave and table and
+ * the result is within the protocol limit.
+ */
+
+static bool prvxMBSchedMerge(int i, int j)
+{
+  struct mb_sched_block_s *a = &xBlocks[i];
+  struct mb_sched_block_s *b = &xBlocks[j];
+  uint32_t ulStart;
+  uint32_t ulEnd;
+
+  if (a->ucSlave != b->ucSlave || a->eTable != b->eTable)
+    {
+      return false;
+    }
+
+  ulStart = a->usAddr < b->usAddr ? a->usAddr : b->usAddr;
+  ulEnd   = (uint32_t)a->usAddr + a->usNum;
+
+  if ((uint32_t)b->usAddr + b->usNum > ulEnd)
+    {
+      ulEnd = (uint32_t)b->usAddr + b->usNum;
+    }
+
+  /* The gap between the two ranges, zero if they overlap or touch */
+
+  if ((uint32_t)a->usNum + b->usNum + CONFIG_MB_MASTER_SCHED_MERGE_GAP <
+      ulEnd - ulStart || ulEnd - ulStart > MB_SCHED_MAX(a->eTable))
+    {
+      return false;
+    }
+
+  a->usAddr = ulStart;
+  a->usNum  = ulEnd - ulStart;
+
+  if (b->ulPeriod < a->ulPeriod)
+    {
+      a->ulPeriod = b->ulPeriod;
+    }
+
+  usNBlocks--;
+  memmove(b, b + 1, (usNBlocks - j) * sizeof(struct mb_sched_block_s));
+  return true;
+}
+
+/* Find the request that holds the given range */
+
+static struct mb_sched_block_s *
+prvpxMBSchedFind(uint8_t ucSlave, eMBMasterSchedTable eTable,
+                 uint16_t usAddr, uint16_t usNum)
+{
+  struct mb_sched_block_s *pxBlock;
+  int i;
+
+  if (pxActive != NULL && pxActive->ucSlave == ucSlave &&
+      pxActive->eTable == eTable && pxActive->usAddr <= usAddr &&
+      (uint32_t)usAddr + usNum <=
+      (uint32_t)pxActive->usAddr + pxActive->usNum)
+    {
+      return pxActive;
+    }
+
+  for (i = 0; i < usNBlocks; i++)
+    {
+      pxBlock = &xBlocks[i];
+      if (pxBlock->ucSlave == ucSlave && pxBlock->eTable == eTable &&
+          pxBlock->usAddr <= usAddr &&
+          (uint32_t)usAddr + usNum <=
+          (uint32_t)pxBlock->usAddr + pxBlock->usNum)
+        {
+          return pxBlock;
+        }
+    }
+
+  return NULL;
+}
+
+/* Store the values of a response (or of a write request) in the image */
+
+static eMBErrorCode prveMBSchedStore(eMBMasterSchedTable eTable,
+                                     uint8_t *pucBuffer, uint16_t usAddress,
+                                     uint16_t usNum, bool xRead)
+{
+  struct mb_sched_block_s *pxBlock;
+  uint16_t *pusDst;
+  uint16_t usOff;
+  uint16_t i;
+
+  /* The register callbacks are passed 1 based addresses */
+
+  usAddress--;
+
+  pxBlock = prvpxMBSchedFind(ucMBMasterGetDestAddress(), eTable,
+                             usAddress, usNum);
+  if (pxBlock == NULL)
+    {
+      /* Nothing to do for a write to registers that are not polled */
+
+      return xRead ? MB_ENOREG : MB_ENOERR;
+    }
+
+  usOff = usAddress - pxBlock->usAddr;
+
+  /* Readers retry while the sequence is odd.  They cannot preempt the
+   * update.
+   */
+
+  sched_lock();
+  pxBlock->ulSeq++;
+
+  if (MB_SCHED_ISBITS(eTable))
+    {
+      xMBUtilCopyBits((uint8_t *)&usImage[pxBlock->usOffset], usOff,
+                      pucBuffer, 0, usNum);
+    }
+  else
+    {
+      pusDst = &usImage[pxBlock->usOffset + usOff];
+      for (i = 0; i < usNum; i++, pucBuffer += 2)
+        {
+          pusDst[i] = (uint16_t)pucBuffer[0] << 8 | pucBuffer[1];
+        }
+    }
+
+  if (pxBlock == pxActive && usOff == 0 && usNum == pxBlock->usNum)
+    {
+      pxBlock->ulUpdated = prvulMBSchedNow();
+      pxBlock->xValid    = true;
+    }
+
+  pxBlock->ulSeq++;
+  sched_unlock();
+
+  return MB_ENOERR;
+}
+
+/* Account the result of the request on the line */
+
+static void prvvMBSchedDone(struct mb_sched_block_s *pxBlock,
+                            eMBMasterReqErrCode eStatus, uint32_t ulNow)
+{
+  struct mb_sched_slave_s *pxSlave = &xSlaves[pxBlock->ucSlave];
+
+  pxBlock->eStatus = eStatus;
+
+  if (eStatus == MB_MRE_TIMEDOUT)
+    {
+      if (pxSlave->ulBackoff == 0)
+        {
+          pxSlave->ulBackoff = CONFIG_MB_MASTER_SCHED_BACKOFF_MIN;
+        }
+      else if (pxSlave->ulBackoff < CONFIG_MB_MASTER_SCHED_BACKOFF_MAX / 2)
+        {
+          pxSlave->ulBackoff *= 2;
+        }
+      else
+        {
+          pxSlave->ulBackoff = CONFIG_MB_MASTER_SCHED_BACKOFF_MAX;
+        }
+
+      pxSlave->ulRetry = ulNow + pxSlave->ulBackoff;
+    }
+  else
+    {
+      pxSlave->ulBackoff = 0;
+    }
+}
+
+/* Return the most overdue request of a slave which is not backing off */
+
+static struct mb_sched_block_s *prvpxMBSchedNext(uint32_t ulNow)
+{
+  struct mb_sched_block_s *pxNext = NULL;
+  struct mb_sched_block_s *pxBlock;
+  struct mb_sched_slave_s *pxSlave;
+  int i;
+
+  for (i = 0; i < usNBlocks; i++)
+    {
+      pxBlock = &xBlocks[i];
+      pxSlave = &xSlaves[pxBlock->ucSlave];
+
+      if (MB_SCHED_BEFORE(ulNow, pxBlock->ulDue) ||
+          (pxSlave->ulBackoff != 0 &&
+           MB_SCHED_BEFORE(ulNow, pxSlave->ulRetry)))
+        {
+          continue;
+        }
+
+      if (pxNext == NULL || MB_SCHED_BEFORE(pxBlock->ulDue, pxNext->ulDue))
+        {
+          pxNext = pxBlock;
+        }
+    }
+
+  return pxNext;
+}
+
+static uint8_t prvucMBSchedFunction(uint8_t eTable)
+{
+  switch (eTable)
+    {
+      case MB_SCHED_COILS:
+        return MB_FUNC_READ_COILS;
+
+      case MB_SCHED_DISCRETE:
+        return MB_FUNC_READ_DISCRETE_INPUTS;
+
+      case MB_SCHED_INPUT:
+        return MB_FUNC_READ_INPUT_REGISTER;
+
+      default:
+        return MB_FUNC_READ_HOLDING_REGISTER;
+    }
+}
+
+/* Take a consistent copy of a block's state and image range */
+
+static eMBErrorCode prveMBSchedGet(uint8_t ucSlave,
+                                   eMBMasterSchedTable eTable,
+                                   uint16_t usAddr, uint16_t usNum,
+                                   void *pvBuffer, uint32_t *pulAge)
+{
+  struct mb_sched_block_s *pxBlock;
+  eMBMasterReqErrCode eStatus;
+  uint32_t ulUpdated;
+  uint32_t ulSeq;
+  uint16_t usOff;
+  bool xValid;
+
+  if (!xStarted)
+    {
+      return MB_EILLSTATE;
+    }
+
+  pxBlock = prvpxMBSchedFind(ucSlave, eTable, usAddr, usNum);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  usOff = usAddr - pxBlock->usAddr;
+
+  do
+    {
+      ulSeq = pxBlock->ulSeq;
+
+      if (MB_SCHED_ISBITS(eTable))
+        {
+          memset(pvBuffer, 0, (usNum + 7) / 8);
+          xMBUtilCopyBits(pvBuffer, 0,
+                          (uint8_t *)&usImage[pxBlock->usOffset],
+                          usOff, usNum);
+        }
+      else
+        {
+          memcpy(pvBuffer, &usImage[pxBlock->usOffset + usOff],
+                 usNum * sizeof(uint16_t));
+        }
+
+      eStatus   = pxBlock->eStatus;
+      ulUpdated = pxBlock->ulUpdated;
+      xValid    = pxBlock->xValid;
+    }
+  while ((ulSeq & 1) != 0 || ulSeq != pxBlock->ulSeq);
+
+  if (!xValid)
+    {
+      if (pulAge != NULL)
+        {
+          *pulAge = UINT32_MAX;
+        }
+
+      return MB_EIO;
+    }
+
+  if (pulAge != NULL)
+    {
+      *pulAge = prvulMBSchedNow() - ulUpdated;
+    }
+
+  return eStatus == MB_MRE_NO_ERR ? MB_ENOERR : MB_ETIMEDOUT;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterSchedAddJob(uint8_t ucSlave, eMBMasterSchedTable eTable,
+                                  uint16_t usAddr, uint16_t usNum,
+                                  uint32_t ulPeriod)
+{
+  struct mb_sched_block_s *pxBlock;
+  bool xMerged;
+  int i;
+  int j;
+
+  if (xStarted)
+    {
+      return MB_EILLSTATE;
+    }
+
+  if (ucSlave == 0 || ucSlave > CONFIG_MB_MASTER_TOTAL_SLAVE_NUM ||
+      eTable > MB_SCHED_HOLDING || usNum == 0 ||
+      usNum > MB_SCHED_MAX(eTable) || (uint32_t)usAddr + usNum > 0x10000 ||
+      ulPeriod == 0)
+    {
+      return MB_EINVAL;
+    }
+
+  if (usNBlocks >= CONFIG_MB_MASTER_SCHED_BLOCKS)
+    {
+      return MB_ENORES;
+    }
+
+  pxBlock = &xBlocks[usNBlocks++];
+  memset(pxBlock, 0, sizeof(*pxBlock));
+  pxBlock->ucSlave  = ucSlave;
+  pxBlock->eTable   = eTable;
+  pxBlock->usAddr   = usAddr;
+  pxBlock->usNum    = usNum;
+  pxBlock->ulPeriod = ulPeriod;
+
+  /* Merge until no two requests can be merged any more.  Extending one
+   * request may bring it close enough to another one.
+   */
+
+  do
+    {
+      xMerged = false;
+      for (i = 0; i < usNBlocks && !xMerged; i++)
+        {
+          for (j = i + 1; j < usNBlocks && !xMerged; j++)
+            {
+              xMerged = prvxMBSchedMerge(i, j);
+            }
+        }
+    }
+  while (xMerged);
+
+  return MB_ENOERR;
+}
+
+eMBErrorCode eMBMasterSchedStart(void)
+{
+  uint32_t ulNow = prvulMBSchedNow();
+  uint32_t ulWords = 0;
+  int i;
+
+  if (xStarted)
+    {
+      return MB_EILLSTATE;
+    }
+
+  for (i = 0; i < usNBlocks; i++)
+    {
+      xBlocks[i].usOffset = ulWords;
+      xBlocks[i].ulDue    = ulNow;
+      ulWords += MB_SCHED_WORDS(xBlocks[i].eTable, xBlocks[i].usNum);
+    }
+
+  if (ulWords > CONFIG_MB_MASTER_SCHED_IMAGE_SIZE)
+    {
+      return MB_ENORES;
+    }
+
+  memset(usImage, 0, sizeof(usImage));
+  memset(xSlaves, 0, sizeof(xSlaves));
+  pxActive = NULL;
+  xStarted = true;
+  return MB_ENOERR;
+}
+
+eMBErrorCode eMBMasterSchedPoll(void)
+{
+  struct mb_sched_block_s *pxBlock;
+  eMBMasterReqErrCode eReqStatus;
+  eMBErrorCode eStatus;
+  uint8_t *ucMBFrame;
+  uint32_t ulNow;
+
+  eStatus = eMBMasterPoll();
+  if (eStatus != MB_ENOERR || !xStarted)
+    {
+      return eStatus;
+    }
+
+  ulNow = prvulMBSchedNow();
+
+  if (pxActive != NULL)
+    {
+      if (!xMBMasterRequestFinished(&eReqStatus))
+        {
+          return MB_ENOERR;
+        }
+
+      prvvMBSchedDone(pxActive, eReqStatus, ulNow);
+      pxActive = NULL;
+    }
+
+  pxBlock = prvpxMBSchedNext(ulNow);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOERR;
+    }
+
+  /* Leave the line to a request of the application */
+
+  if (xMBMasterRunResTake(0) == false)
+    {
+      return MB_ENOERR;
+    }
+
+  vMBMasterGetPDUSndBuf(&ucMBFrame);
+  vMBMasterSetDestAddress(pxBlock->ucSlave);
+  ucMBFrame[MB_PDU_FUNC_OFF] = prvucMBSchedFunction(pxBlock->eTable);
+  ucMBFrame[MB_PDU_REQ_READ_ADDR_OFF] = pxBlock->usAddr >> 8;
+  ucMBFrame[MB_PDU_REQ_READ_ADDR_OFF + 1] = pxBlock->usAddr;
+  ucMBFrame[MB_PDU_REQ_READ_NUM_OFF] = pxBlock->usNum >> 8;
+  ucMBFrame[MB_PDU_REQ_READ_NUM_OFF + 1] = pxBlock->usNum;
+  vMBMasterSetPDUSndLength(MB_PDU_SIZE_MIN + MB_PDU_REQ_READ_SIZE);
+
+  pxActive = pxBlock;
+  vMBMasterPollRequestStart();
+  xMBMasterPortEventPost(EV_MASTER_FRAME_SENT);
+
+  /* Keep the phase of the period unless the request fell behind */
+
+  pxBlock->ulDue += pxBlock->ulPeriod;
+  if (MB_SCHED_BEFORE(pxBlock->ulDue, ulNow))
+    {
+      pxBlock->ulDue = ulNow + pxBlock->ulPeriod;
+    }
+
+  return MB_ENOERR;
+}
+
+eMBErrorCode eMBMasterSchedGetRegs(uint8_t ucSlave, eMBMasterSchedTable eTable,
+                                   uint16_t usAddr, uint16_t usNRegs,
+                                   uint16_t *pusBuffer, uint32_t *pulAge)
+{
+  if (MB_SCHED_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBSchedGet(ucSlave, eTable, usAddr, usNRegs, pusBuffer,
+                        pulAge);
+}
+
+eMBErrorCode eMBMasterSchedGetBits(uint8_t ucSlave, eMBMasterSchedTable eTable,
+                                   uint16_t usAddr, uint16_t usNBits,
+                                   uint8_t *pucBuffer, uint32_t *pulAge)
+{
+  if (!MB_SCHED_ISBITS(eTable))
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBSchedGet(ucSlave, eTable, usAddr, usNBits, pucBuffer,
+                        pulAge);
+}
+
+/* The master register callbacks store the responses in the image */
+
+eMBErrorCode eMBMasterRegInputCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                                 uint16_t usNRegs)
+{
+  return prveMBSchedStore(MB_SCHED_INPUT, pucRegBuffer, usAddress, usNRegs,
+                          true);
+}
+
+eMBErrorCode eMBMasterRegHoldingCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                                   uint16_t usNRegs, eMBRegisterMode eMode)
+{
+  return prveMBSchedStore(MB_SCHED_HOLDING, pucRegBuffer, usAddress, usNRegs,
+                          eMode == MB_REG_READ);
+}
+
+eMBErrorCode eMBMasterRegCoilsCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                                 uint16_t usNCoils, eMBRegisterMode eMode)
+{
+  return prveMBSchedStore(MB_SCHED_COILS, pucRegBuffer, usAddress, usNCoils,
+                          eMode == MB_REG_READ);
+}
+
+eMBErrorCode eMBMasterRegDiscreteCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                                    uint16_t usNDiscrete)
+{
+  return prveMBSchedStore(MB_SCHED_DISCRETE, pucRegBuffer, usAddress,
+                          usNDiscrete, true);
+}
+
+#endif /* defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER) */
@@ -63,6 +63,21 @@ static sem_t bussysem;
 static sem_t waitersem;
 static eMBMasterEventType eQueuedEvent;
 
+/* Request issued by the thread that runs eMBMasterPoll() itself.  Its
+ * result is kept here instead of waking up the waiters, so that it is not
+ * taken by a request of another thread.
+ */
+
+static bool xPollRequest;
+static bool xPollFinished;
+static eMBMasterReqErrCode ePollResult;
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static eMBMasterReqErrCode prveMBMasterRequestResult(void);
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -76,21 +91,35 @@ bool xMBMasterPortEventInit(void)
   /* No event in queue */
 
   eQueuedEvent = 0;
+  xPollRequest = false;
+  xPollFinished = false;
 
   return true;
 }
 
 bool xMBMasterPortEventPost(eMBMasterEventType eEvent)
 {
-  /* Post waiter sem, if event belongs to one of waiter events */
+  eQueuedEvent |= eEvent;
+
+  /* Post waiter sem, if event belongs to one of waiter events.  The result
+   * of a request of the poll thread is taken right away, before the
+   * running resource is released to the other threads.
+   */
 
   if (eEvent & WAITER_EVENTS)
     {
-      sem_post(&waitersem);
+      if (xPollRequest)
+        {
+          ePollResult = prveMBMasterRequestResult();
+          xPollRequest = false;
+          xPollFinished = true;
+        }
+      else
+        {
+          sem_post(&waitersem);
+        }
     }
 
-  eQueuedEvent |= eEvent;
-
   return true;
 }
 
@@ -274,17 +303,12 @@ void vMBMasterCBRequestSuccess(void)
   xMBMasterPortEventPost(EV_MASTER_PROCESS_SUCCESS);
 }
 
-/* This function will wait for Modbus Master request finish and return result.
- */
+/* Return the result of the finished request. */
 
-eMBMasterReqErrCode eMBMasterWaitRequestFinish(void)
+static eMBMasterReqErrCode prveMBMasterRequestResult(void)
 {
   eMBMasterReqErrCode eErrStatus = MB_MRE_NO_ERR;
 
-  /* wait forever for OS event */
-
-  sem_wait(&waitersem);
-
   if (eQueuedEvent & WAITER_EVENTS)
     {
       if (eQueuedEvent & EV_MASTER_PROCESS_SUCCESS)
@@ -309,4 +333,50 @@ eMBMasterReqErrCode eMBMasterWaitRequestFinish(void)
   return eErrStatus;
 }
 
+/* This function will wait for Modbus Master request finish and return result.
+ */
+
+eMBMasterReqErrCode eMBMasterWaitRequestFinish(void)
+{
+  /* wait forever for OS event */
+
+  sem_wait(&waitersem);
+
+  return prveMBMasterRequestResult();
+}
+
+/* This function marks the next request as issued by the thread that runs
+ * eMBMasterPoll() itself.  Its result is collected with
+ * xMBMasterRequestFinished() and never posted to the waiters.  It must be
+ * called with the running resource taken, before the request is sent.
+ */
+
+void vMBMasterPollRequestStart(void)
+{
+  xPollFinished = false;
+  xPollRequest = true;
+}
+
+/* This function checks without waiting if the Modbus Master request started
+ * with vMBMasterPollRequestStart() has finished.
+ *
+ * Input Parameters:
+ *   peErrStatus the result, if the request has finished
+ *
+ * Returned Value:
+ *   true if the request has finished
+ */
+
+bool xMBMasterRequestFinished(eMBMasterReqErrCode *peErrStatus)
+{
+  if (!xPollFinished)
+    {
+      return false;
+    }
+
+  xPollFinished = false;
+  *peErrStatus = ePollResult;
+  return true;
+}
+
 #endif /* defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER) */
@@ -103,6 +103,24 @@
 #define lespCON_USED_MASK(idx)      (1<<(idx))
 #define lespPOLLING_TIME_MS         1000
 
+/* Largest payload of one AT+CIPSEND / AT+CIPRECVDATA */
+
+#define lespSEND_MAX_LEN            2048
+#define lespRECV_MAX_LEN            2048
+
+/* In passive mode, don't fetch less than this unless it is all the data
+ * held by the module; wait for the application to read the socket instead.
+ */
+
+#define lespRECV_MIN_LEN            (SOCKET_FIFO_SIZE / 4)
+
+/* Time to transfer len bytes on the serial port (10 bits a byte) */
+
+#define lespXFER_MS(len) \
+  ((int)(((len) * 10000ll) / CONFIG_NETUTILS_ESP8266_BAUDRATE))
+
+#define lespCMD_LEN                 32
+
 /* Must be a power of 2 */
 
 #define SOCKET_FIFO_SIZE            2048
@@ -127,6 +145,33 @@ typedef enum
   lesp_eOK   =  1
 }lesp_ans_t;
 
+/* Commands queued for the AT channel.  The module handles one command at a
+ * time, so the worker writes the next queued command as soon as the
+ * previous one is answered, without a round trip through the caller.
+ */
+
+typedef enum
+{
+  lesp_eCMD_SYNC = 0, /* Channel owned by a caller using lesp_read() */
+  lesp_eCMD_SEND,     /* AT+CIPSEND, caller writes payload on '>' prompt */
+  lesp_eCMD_RECVDATA, /* AT+CIPRECVDATA, queued by the worker */
+  lesp_eCMD_RESYNC    /* Drain, then "AT" up to "OK", after a timeout */
+} lesp_cmd_type_t;
+
+typedef struct lesp_cmd_s
+{
+  struct lesp_cmd_s *flink;
+  lesp_cmd_type_t    type;
+  int                sockfd;
+  FAR const uint8_t *data;     /* AT+CIPSEND payload */
+  int                len;      /* Payload or requested length */
+  bool               prompt;   /* AT+CIPSEND '>' or resync "AT" written */
+  bool               writing;  /* AT+CIPSEND payload being written */
+  lesp_ans_t         ans;      /* lesp_eNONE while pending */
+  uint32_t           started;  /* lesp_time_ms() when it got the channel */
+  sem_t              sem;      /* Posted on completion (not RECVDATA) */
+} lesp_cmd_t;
+
 typedef struct
 {
   sem_t          *sem;
@@ -134,6 +179,9 @@ typedef struct
   uint16_t        inndx;
   uint16_t        outndx;
   struct timespec rcv_timeo;
+  int             pending;     /* Passive mode: data held by the module */
+  bool            fetching;    /* Passive mode: fetch command queued */
+  lesp_cmd_t      fetch;       /* Passive mode: AT+CIPRECVDATA command */
   uint8_t         rxbuf[SOCKET_FIFO_SIZE];
 } lesp_socket_t;
 
@@ -142,7 +190,19 @@ typedef struct
   bool            running;
   pthread_t       thread;
 
-  char            rxbuf[BUF_WORKER_LEN];
+  uint8_t         rxchunk[BUF_WORKER_LEN]; /* Raw data from the module */
+  char            rxbuf[BUF_WORKER_LEN];   /* Line being received */
+  int             rxlen;
+  int             datasock;         /* Socket of the data being received */
+  int             datalen;          /* Data left to receive */
+
+  FAR lesp_cmd_t *active;           /* Command owning the AT channel */
+  uint32_t        deadline;         /* Timeout of a worker command (ms) */
+  lesp_cmd_t      resync;           /* Owns the channel after a timeout */
+  FAR lesp_cmd_t *head;             /* Commands waiting for the channel */
+  FAR lesp_cmd_t *tail;
+  bool            passive;          /* AT+CIPRECVMODE=1 accepted */
+  char            cmd[lespCMD_LEN]; /* Last queued command written */
 
   sem_t           sem;              /* Inform that something is received */
   char            buf[BUF_ANS_LEN]; /* Last complete line received */
@@ -157,6 +217,7 @@ typedef struct
   int             fd;
   lesp_worker_t   worker;
   lesp_socket_t   sockets[SOCKET_NBR];
+  lesp_cmd_t      sync;   /* Channel request of lesp_lock() */
   lesp_ans_t      and;
   char            bufans[BUF_ANS_LEN];
   char            bufcmd[BUF_CMD_LEN];
@@ -174,8 +235,8 @@ typedef struct
  ****************************************************************************/
 
 static int lesp_low_level_read(uint8_t *buf, int size);
-static inline int lesp_read_ipd(int sockfd, int len);
 static lesp_socket_t *get_sock(int sockfd);
+static void lesp_fetch_schedule(void);
 
 /****************************************************************************
  * Private Data
@@ -230,6 +291,28 @@ static inline void lesp_clear_read_ans(void)
   g_lesp_state.and = lesp_eNONE;
 }
 
+/****************************************************************************
+ * Name: lesp_time_ms
+ *
+ * Description:
+ *   Current time in millisecond, for the timeouts of the worker.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   Time in millisecond (wraps around).
+ *
+ ****************************************************************************/
+
+static uint32_t lesp_time_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 /****************************************************************************
  * Name: lesp_str_to_unsigned
  *
@@ -396,6 +479,7 @@ static void set_sock_closed(int sockfd)
   sock->flags  = 0;
   sock->inndx  = 0;
   sock->outndx = 0;
+  sock->pending = 0;
 
   ninfo("Socket %d closed\n", sockfd);
 
@@ -458,113 +542,612 @@ static int lesp_low_level_read(uint8_t *buf, int size)
 }
 
 /****************************************************************************
- * Name: lesp_read_ipd
+ * Name: lesp_write
  *
  * Description:
- *   Try to treat an '+IPD' command in worker buffer.  Worker buffer should
- *   already contain '+IPD,<id>,<len>:'
+ *   Write all of buf to esp8266.
+ *
+ * Input Parameters:
+ *   buf  : data to write
+ *   len  : size of data
+ *
+ * Returned Value:
+ *   0 on success, -1 in case of error.
+ *
+ ****************************************************************************/
+
+static int lesp_write(FAR const void *buf, size_t len)
+{
+  FAR const uint8_t *ptr = buf;
+  ssize_t ret;
+
+  while (len > 0)
+    {
+      ret = write(g_lesp_state.fd, ptr, len);
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          nerr("ERROR: write failed (errno %d)\n", errno);
+          return -1;
+        }
+
+      ptr += ret;
+      len -= ret;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: lesp_fifo_used / lesp_fifo_put
+ *
+ * Description:
+ *   Socket receive FIFO helpers.  lesp_fifo_put() copies len bytes into the
+ *   FIFO of sock and wakes up its reader.  Data that does not fit is lost.
  *
  * Note:
  *  g_lesp_state.worker.mutex should be locked.
  *
- * Input Parameters:
- *   sockfd : socker number to put received data.
- *   len : data size to read on serial port.
+ ****************************************************************************/
+
+static inline int lesp_fifo_used(FAR lesp_socket_t *sock)
+{
+  return (sock->inndx - sock->outndx) & (SOCKET_FIFO_SIZE - 1);
+}
+
+static void lesp_fifo_put(FAR lesp_socket_t *sock, FAR const uint8_t *data,
+                          int len)
+{
+  int space;
+  int size;
+
+  space = SOCKET_FIFO_SIZE - 1 - lesp_fifo_used(sock);
+  if (len > space)
+    {
+      nwarn("overflow socket: %d bytes lost\n", len - space);
+      len = space;
+    }
+
+  size = SOCKET_FIFO_SIZE - sock->inndx;
+  if (size > len)
+    {
+      size = len;
+    }
+
+  memcpy(&sock->rxbuf[sock->inndx], data, size);
+  memcpy(sock->rxbuf, data + size, len - size);
+  sock->inndx = (sock->inndx + len) & (SOCKET_FIFO_SIZE - 1);
+
+  if (sock->sem != NULL && len > 0)
+    {
+      sem_post(sock->sem);
+    }
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_queue
+ *
+ * Description:
+ *   Append cmd to the AT channel queue.  lesp_cmd_start() must be called to
+ *   write it if the channel is idle.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_cmd_queue(FAR lesp_cmd_t *cmd)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+
+  cmd->flink = NULL;
+  cmd->ans   = lesp_eNONE;
+
+  if (worker->tail == NULL)
+    {
+      worker->head = cmd;
+    }
+  else
+    {
+      worker->tail->flink = cmd;
+    }
+
+  worker->tail = cmd;
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_unlink
+ *
+ * Description:
+ *   Remove cmd from the AT channel queue if it is still there.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
  *
  * Returned Value:
- *   1 was an IPD, 0 is not an IPD, -1 on error.
+ *   true if cmd was found in the queue.
  *
  ****************************************************************************/
 
-static inline int lesp_read_ipd(int sockfd, int len)
+static bool lesp_cmd_unlink(FAR lesp_cmd_t *cmd)
 {
-  lesp_socket_t *sock;
+  lesp_worker_t *worker = &g_lesp_state.worker;
+  FAR lesp_cmd_t *prev = NULL;
+  FAR lesp_cmd_t *curr;
 
-  sock = get_sock(sockfd);
+  for (curr = worker->head; curr != NULL; prev = curr, curr = curr->flink)
+    {
+      if (curr == cmd)
+        {
+          if (prev == NULL)
+            {
+              worker->head = cmd->flink;
+            }
+          else
+            {
+              prev->flink = cmd->flink;
+            }
 
-  ninfo("Read %d bytes for socket %d \n", len, sockfd);
+          if (worker->tail == cmd)
+            {
+              worker->tail = prev;
+            }
 
-  if (sock == NULL)
+          cmd->flink = NULL;
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_done
+ *
+ * Description:
+ *   Complete cmd with answer ans and release the AT channel.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_cmd_done(FAR lesp_cmd_t *cmd, lesp_ans_t ans)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+
+  /* A payload being written keeps the channel until lesp_cmd_submit() is
+   * done with it.
+   */
+
+  if (worker->active == cmd && !cmd->writing)
     {
-      nwarn("socket not opened: drop all data.\n");
+      worker->active = NULL;
     }
 
-  while (len)
+  cmd->ans = ans;
+
+  if (cmd->type == lesp_eCMD_RECVDATA)
     {
-      int size;
-      uint8_t *buf = (uint8_t *)g_lesp_state.worker.rxbuf;
+      lesp_socket_t *sock = &g_lesp_state.sockets[cmd->sockfd];
 
-      size = len;
-      if (size >= BUF_WORKER_LEN)
+      sock->fetching = false;
+      if (ans != lesp_eOK)
+        {
+          sock->pending = 0;
+        }
+
+      lesp_fetch_schedule();
+    }
+  else if (cmd->type != lesp_eCMD_RESYNC)
+    {
+      sem_post(&cmd->sem);
+    }
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_resync
+ *
+ * Description:
+ *   Take the AT channel away from a command that timed out.  The module may
+ *   still be busy with it (e.g. waiting for AT+CIPSEND data), so the queue
+ *   only restarts once the line has been silent for lespTIMEOUT_FLUSH_MS
+ *   and "AT" has been answered with "OK".  See lesp_cmd_timeout().
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_cmd_resync(void)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+
+  worker->resync.ans    = lesp_eNONE;
+  worker->resync.prompt = false;
+  worker->active        = &worker->resync;
+  worker->deadline      = lesp_time_ms() + lespTIMEOUT_FLUSH_MS;
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_start
+ *
+ * Description:
+ *   If the AT channel is idle, write the next queued command.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_cmd_start(void)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+  FAR lesp_cmd_t *cmd;
+  int len;
+
+  while (worker->active == NULL && worker->head != NULL)
+    {
+      cmd = worker->head;
+      worker->head = cmd->flink;
+      if (worker->head == NULL)
         {
-          size = BUF_WORKER_LEN;
+          worker->tail = NULL;
         }
 
-      size = lesp_low_level_read(buf, size);
-      if (size <= 0)
+      cmd->flink = NULL;
+      cmd->started = lesp_time_ms();
+      worker->active = cmd;
+
+      if (cmd->type == lesp_eCMD_SYNC)
         {
-          return -1;
+          /* The caller writes its commands itself */
+
+          cmd->ans = lesp_eOK;
+          sem_post(&cmd->sem);
+          break;
+        }
+
+      len = snprintf(worker->cmd, lespCMD_LEN, "AT+%s=%d,%d\r\n",
+                     cmd->type == lesp_eCMD_SEND ? "CIPSEND" :
+                     "CIPRECVDATA", cmd->sockfd, cmd->len);
+
+      ninfo("Write:%s", worker->cmd);
+
+      if (cmd->type == lesp_eCMD_RECVDATA)
+        {
+          /* Nobody waits for a fetch: the worker times it out itself */
+
+          worker->deadline = lesp_time_ms() + lespTIMEOUT_MS +
+                             lespXFER_MS(cmd->len);
+        }
+
+      if (lesp_write(worker->cmd, len) < 0)
+        {
+          if (cmd->type == lesp_eCMD_RECVDATA)
+            {
+              g_lesp_state.sockets[cmd->sockfd].pending = 0;
+            }
+
+          lesp_cmd_done(cmd, lesp_eERR);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_timeout
+ *
+ * Description:
+ *   Run the timeouts of the commands owned by the worker: abandon the
+ *   active AT+CIPRECVDATA if its answer did not come in time, as
+ *   lesp_cmd_submit() does for the commands of the callers, and step the
+ *   resynchronisation that follows.
+ *
+ * Input Parameters:
+ *   rx : data was received since the last call.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_cmd_timeout(bool rx)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+  FAR lesp_cmd_t *cmd = worker->active;
+  uint32_t now = lesp_time_ms();
+
+  if (cmd == NULL)
+    {
+      return;
+    }
+
+  if (cmd->type == lesp_eCMD_RECVDATA &&
+      (int32_t)(now - worker->deadline) >= 0)
+    {
+      nerr("ERROR: AT+CIPRECVDATA timeout on socket %d\n", cmd->sockfd);
+      lesp_cmd_done(cmd, lesp_eERR);
+      lesp_cmd_resync();
+    }
+  else if (cmd->type == lesp_eCMD_RESYNC)
+    {
+      if (!cmd->prompt && rx)
+        {
+          /* Still draining: wait for the line to be silent */
+
+          worker->deadline = now + lespTIMEOUT_FLUSH_MS;
+        }
+      else if ((int32_t)(now - worker->deadline) >= 0)
+        {
+          if (!cmd->prompt)
+            {
+              ninfo("Write:AT\n");
+
+              cmd->prompt      = true;
+              worker->deadline = now + lespTIMEOUT_MS;
+              lesp_write("AT\r\n", 4);
+            }
+          else
+            {
+              /* No answer: drain again and retry */
+
+              cmd->prompt      = false;
+              worker->deadline = now + lespTIMEOUT_FLUSH_MS;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: lesp_fetch_schedule
+ *
+ * Description:
+ *   Passive receive mode: queue an AT+CIPRECVDATA for each socket that has
+ *   data waiting in the module and room for it in its FIFO.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_fetch_schedule(void)
+{
+  lesp_socket_t *sock;
+  int len;
+  int i;
+
+  for (i = 0; i < SOCKET_NBR; i++)
+    {
+      sock = &g_lesp_state.sockets[i];
+
+      if ((sock->flags & FLAGS_SOCK_USED) == 0 || sock->pending <= 0 ||
+          sock->fetching)
+        {
+          continue;
+        }
+
+      len = SOCKET_FIFO_SIZE - 1 - lesp_fifo_used(sock);
+      if (len > lespRECV_MAX_LEN)
+        {
+          len = lespRECV_MAX_LEN;
         }
 
-      len -= size;
+      if (len < sock->pending && len < lespRECV_MIN_LEN)
+        {
+          continue;
+        }
+
+      if (len > sock->pending)
+        {
+          len = sock->pending;
+        }
+
+      sock->fetch.type   = lesp_eCMD_RECVDATA;
+      sock->fetch.sockfd = i;
+      sock->fetch.len    = len;
+      sock->fetching     = true;
+      lesp_cmd_queue(&sock->fetch);
+    }
+}
+
+/****************************************************************************
+ * Name: lesp_cmd_submit
+ *
+ * Description:
+ *   Queue cmd and wait for its completion.  The timeout only runs while the
+ *   command owns the AT channel, from the time lesp_cmd_start() gave it the
+ *   channel; a command that times out on the channel is abandoned.  The
+ *   payload of AT+CIPSEND is written from here on the prompt, so that the
+ *   worker keeps reading the module meanwhile.
+ *
+ * Input Parameters:
+ *   cmd        : command to run, cmd->sem must be initialized.
+ *   timeout_ms : timeout in millisecond, negative to wait forever.
+ *
+ * Returned Value:
+ *   0 on success, -1 on error.
+ *
+ ****************************************************************************/
+
+static int lesp_cmd_submit(FAR lesp_cmd_t *cmd, int timeout_ms)
+{
+  lesp_worker_t *worker = &g_lesp_state.worker;
+  struct timespec ts;
+  uint32_t elapsed;
+  int wait_ms = timeout_ms;
+  int errcode;
+  int ret;
 
-      if (sock != NULL)
+  pthread_mutex_lock(&worker->mutex);
+  lesp_cmd_queue(cmd);
+  lesp_cmd_start();
+  pthread_mutex_unlock(&worker->mutex);
+
+  for (; ; )
+    {
+      if (timeout_ms < 0)
+        {
+          ret = sem_wait(&cmd->sem);
+        }
+      else if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
+        {
+          ret = -1;
+        }
+      else
         {
-          while (size--)
+          ts.tv_sec  += wait_ms / 1000;
+          ts.tv_nsec += (wait_ms % 1000) * 1000000;
+          if (ts.tv_nsec >= 1000000000)
             {
-              int next;
-              uint8_t b;
+              ts.tv_nsec -= 1000000000;
+              ts.tv_sec  += 1;
+            }
+
+          ret = sem_timedwait(&cmd->sem, &ts);
+        }
 
-              /* Read the next byte from the buffer */
+      if (ret >= 0)
+        {
+          pthread_mutex_lock(&worker->mutex);
+          if (cmd->ans != lesp_eNONE || !cmd->prompt)
+            {
+              pthread_mutex_unlock(&worker->mutex);
+              break;
+            }
 
-              b = *buf++;
+          /* AT+CIPSEND prompt: the module waits for the payload */
 
-              /* Pre-calculate the next 'inndx'.  We do this so that we can
-               * check if the FIFO is full.
+          ninfo("Sending in socket %d, %d bytes\n", cmd->sockfd,
+                cmd->len);
+
+          cmd->writing = true;
+          pthread_mutex_unlock(&worker->mutex);
+          ret = lesp_write(cmd->data, cmd->len);
+          pthread_mutex_lock(&worker->mutex);
+          cmd->writing = false;
+
+          if (cmd->ans != lesp_eNONE)
+            {
+              /* Answered before we got the mutex back: take the post of
+               * lesp_cmd_done(), which left the channel to us.
                */
 
-              next = sock->inndx + 1;
-              if (next >= SOCKET_FIFO_SIZE)
-                {
-                  next -= SOCKET_FIFO_SIZE;
-                }
+              sem_trywait(&cmd->sem);
+            }
+
+          if (ret < 0)
+            {
+              /* The module may still wait for the rest of the payload */
+
+              cmd->ans = lesp_eERR;
+              lesp_cmd_resync();
+            }
+          else if (cmd->ans != lesp_eNONE)
+            {
+              worker->active = NULL;
+              lesp_cmd_start();
+            }
+          else
+            {
+              pthread_mutex_unlock(&worker->mutex);
+              continue;
+            }
+
+          pthread_mutex_unlock(&worker->mutex);
+          break;
+        }
+
+      errcode = errno;
+      if (errcode == EINTR)
+        {
+          continue;
+        }
+
+      pthread_mutex_lock(&worker->mutex);
+      if (cmd->ans == lesp_eNONE && worker->active != cmd &&
+          errcode == ETIMEDOUT)
+        {
+          /* Still waiting for the channel */
+
+          wait_ms = timeout_ms;
+          pthread_mutex_unlock(&worker->mutex);
+          continue;
+        }
+
+      if (cmd->ans == lesp_eNONE && worker->active == cmd &&
+          errcode == ETIMEDOUT)
+        {
+          /* The channel was given to cmd while it waited: its timeout runs
+           * from then on.
+           */
+
+          elapsed = lesp_time_ms() - cmd->started;
+          if (elapsed < (uint32_t)timeout_ms)
+            {
+              wait_ms = timeout_ms - elapsed;
+              pthread_mutex_unlock(&worker->mutex);
+              continue;
+            }
+        }
+
+      if (cmd->ans == lesp_eNONE)
+        {
+          nerr("ERROR: command timeout\n");
+
+          if (worker->active == cmd)
+            {
+              lesp_cmd_resync();
+            }
+          else
+            {
+              lesp_cmd_unlink(cmd);
+            }
 
-              /* Is there space in the circular buffer for another byte?  If
-               * the next 'inndx' would be equal to the 'outndx', then the
-               * circular buffer is full.
-               */
+          cmd->ans = lesp_eERR;
+          lesp_cmd_start();
+        }
 
-              if (next == sock->outndx)
-                {
-                  pthread_mutex_unlock(&g_lesp_state.worker.mutex);
-                  usleep(100); /* leave time of aplicative to read buffer */
-                  pthread_mutex_lock(&g_lesp_state.worker.mutex);
-                }
+      pthread_mutex_unlock(&worker->mutex);
+      break;
+    }
 
-              if (next != sock->outndx)
-                {
-                  /* Yes.. add the byte to the circular buffer */
+  return cmd->ans == lesp_eOK ? 0 : -1;
+}
 
-                  sock->rxbuf[sock->inndx] = b;
-                  sock->inndx = next;
-                }
-              else
-                {
-                  /* No.. the we have lost data */
+/****************************************************************************
+ * Name: lesp_lock / lesp_unlock
+ *
+ * Description:
+ *   Get and release exclusive use of the AT channel for the commands sent
+ *   with lesp_send_cmd() and read with lesp_read().
+ *
+ ****************************************************************************/
 
-                  nwarn("overflow socket 0x%02X\n", b);
-                }
-            }
+static void lesp_lock(void)
+{
+  pthread_mutex_lock(&g_lesp_state.mutex);
 
-          if (sock->sem)
-            {
-              ninfo("post %p \n", sock->sem);
-              sem_post(sock->sem);
-            }
-        }
+  if (g_lesp_state.is_initialized)
+    {
+      lesp_cmd_submit(&g_lesp_state.sync, -1);
+    }
+}
+
+static void lesp_unlock(void)
+{
+  pthread_mutex_lock(&g_lesp_state.worker.mutex);
+  if (g_lesp_state.worker.active == &g_lesp_state.sync)
+    {
+      g_lesp_state.worker.active = NULL;
+      lesp_cmd_start();
     }
 
-  return 1;
+  pthread_mutex_unlock(&g_lesp_state.worker.mutex);
+  pthread_mutex_unlock(&g_lesp_state.mutex);
 }
 
 /****************************************************************************
@@ -1114,129 +1697,432 @@ static int lesp_parse_cwjap_ans_line(char *ptr, lesp_ap_t *ap)
               break;
         }
 
-      ptr = ptr_next + 1;
+      ptr = ptr_next + 1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: lesp_parse_cwlap_ans_line
+ *
+ * Description:
+ *   Try to decode @b +CWLAP line.
+ *   see in:
+ *   https://room-15.github.io/blog/2015/03/26/esp8266-at-command-reference/
+ *
+ *    +CWLAP:(0,"FreeWifi",-90,"00:07:cb:07:b6:00",1)
+ *    0 => security
+ *    "FreeWifi" => ssid
+ *    -90 => rssi
+ *    "00:07:cb:07:b6:00" => mac
+ *
+ *   Note: Content of ptr is modified and string in ap point into ptr string.
+ *
+ * Input Parameters:
+ *   ptr   : +CWLAP line null terminated string pointer.
+ *   ap    : ap result of parsing.
+ *
+ * Returned Value:
+ *   0 on success, -1 in case of error.
+ *
+ ****************************************************************************/
+
+static int lesp_parse_cwlap_ans_line(char *ptr, lesp_ap_t *ap)
+{
+  int field_idx;
+  char *ptr_next;
+
+  for (field_idx = 0; field_idx <= 5; field_idx++)
+    {
+      if (field_idx == 0)
+        {
+          ptr_next = strchr(ptr, '(');
+        }
+      else if (field_idx == 5)
+        {
+          ptr_next = strchr(ptr, ')');
+        }
+      else
+        {
+          ptr_next = strchr(ptr, ',');
+        }
+
+      if (ptr_next == NULL)
+        {
+          return -1;
+        }
+
+      *ptr_next = '\0';
+
+      switch (field_idx)
+        {
+          case 0:
+              if (strcmp(ptr, "+CWLAP:") != 0)
+                {
+                  return -1;
+                }
+              break;
+
+          case 1:
+                {
+                  int i = *ptr - '0';
+
+                  if ((i < 0) || (i >= lesp_eSECURITY_NBR))
+                    {
+                      return -1;
+                    }
+
+                  ap->security = i;
+                }
+              break;
+
+          case 2:
+              ptr++; /* Remove first '"' */
+              *(ptr_next - 1) = '\0';
+              strncpy(ap->ssid, ptr, lespSSID_SIZE);
+              ap->ssid[lespSSID_SIZE] = '\0';
+              break;
+
+          case 3:
+                {
+                  int i = atoi(ptr);
+
+                  if (i > 0)
+                    {
+                      i = -i;
+                    }
+
+                  ap->rssi = i;
+                }
+              break;
+
+          case 4:
+                {
+                  int i;
+
+                  ptr++; /* Remove first '"' */
+                  *(ptr_next - 1) = '\0';
+
+                  for (i = 0; i < lespBSSID_SIZE ; i++)
+                    {
+                      ap->bssid[i] = strtol(ptr, &ptr, 16);
+                      if (*ptr == ':')
+                        {
+                          ptr++;
+                        }
+                    }
+                }
+              break;
+        }
+
+      ptr = ptr_next + 1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: lesp_worker_data
+ *
+ * Description:
+ *   Check if the worker line buffer holds the header of binary data:
+ *      +IPD,<id>,<len>:          (active receive mode)
+ *      +CIPRECVDATA,<len>:       (passive receive mode, AT 1.x)
+ *      +CIPRECVDATA:<len>,       (passive receive mode, AT 2.x)
+ *   and if so, switch the worker to data reception.
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ * Input Parameters:
+ *   worker : worker whose rxbuf ends with ':' or ','.
+ *
+ * Returned Value:
+ *   true if a data header was found.
+ *
+ ****************************************************************************/
+
+static bool lesp_worker_data(lesp_worker_t *worker)
+{
+  FAR lesp_cmd_t *cmd = worker->active;
+  char end = worker->rxbuf[worker->rxlen - 1];
+  char *ptr;
+  int sockfd;
+  int len;
+
+  worker->rxbuf[worker->rxlen] = '\0';
+
+  if (end == ':' && memcmp(worker->rxbuf, "+IPD,", 5) == 0)
+    {
+      ptr = worker->rxbuf + 5;
+      sockfd = lesp_str_to_unsigned(&ptr, ',');
+      if (sockfd < 0)
+        {
+          return false;
+        }
+
+      len = lesp_str_to_unsigned(&ptr, ':');
+    }
+  else if ((end == ':' && memcmp(worker->rxbuf, "+CIPRECVDATA,", 13) == 0) ||
+           (end == ',' && memcmp(worker->rxbuf, "+CIPRECVDATA:", 13) == 0))
+    {
+      ptr = worker->rxbuf + 13;
+      len = lesp_str_to_unsigned(&ptr, end);
+      sockfd = -1;
+
+      if (len >= 0 && cmd != NULL && cmd->type == lesp_eCMD_RECVDATA)
+        {
+          lesp_socket_t *sock = &g_lesp_state.sockets[cmd->sockfd];
+
+          /* Less than asked: the module has nothing more */
+
+          sockfd = cmd->sockfd;
+          if (len < cmd->len || len >= sock->pending)
+            {
+              sock->pending = 0;
+            }
+          else
+            {
+              sock->pending -= len;
+            }
+        }
+    }
+  else
+    {
+      return false;
+    }
+
+  if (len < 0)
+    {
+      return false;
+    }
+
+  if (((unsigned int)sockfd) >= SOCKET_NBR ||
+      (g_lesp_state.sockets[sockfd].flags & FLAGS_SOCK_USED) == 0)
+    {
+      nwarn("socket %d not opened: drop %d bytes.\n", sockfd, len);
+      sockfd = -1;
+    }
+
+  ninfo("Read %d bytes for socket %d\n", len, sockfd);
+
+  worker->datasock = sockfd;
+  worker->datalen  = len;
+  worker->rxlen    = 0;
+  return true;
+}
+
+/****************************************************************************
+ * Name: lesp_worker_line
+ *
+ * Description:
+ *   Dispatch a complete line received from esp8266: socket events are
+ *   handled here, answers to queued commands complete them and anything
+ *   else is passed to lesp_read().
+ *
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
+ *
+ ****************************************************************************/
+
+static void lesp_worker_line(lesp_worker_t *worker)
+{
+  FAR lesp_cmd_t *cmd = worker->active;
+  char *line = worker->rxbuf;
+  int rxlen = worker->rxlen;
+  char *ptr;
+
+  if (memcmp(line, "+IPD,", 5) == 0)
+    {
+      int sockfd;
+      int len;
+
+      /* Passive mode notification: +IPD,<id>,<len> */
+
+      ptr = line + 5;
+      sockfd = lesp_str_to_unsigned(&ptr, ',');
+      len = (sockfd < 0) ? -1 : lesp_str_to_unsigned(&ptr, '\0');
+
+      if (len > 0 && ((unsigned int)sockfd) < SOCKET_NBR &&
+          (g_lesp_state.sockets[sockfd].flags & FLAGS_SOCK_USED) != 0)
+        {
+          g_lesp_state.sockets[sockfd].pending += len;
+          lesp_fetch_schedule();
+        }
+
+      return;
+    }
+
+  if ((rxlen == 8) && (memcmp(line + 1, ",CLOSED", 7) == 0))
+    {
+      unsigned int sockid = line[0] - '0';
+      if (sockid < SOCKET_NBR)
+        {
+          set_sock_closed(sockid);
+        }
+
+      return;
+    }
+
+  if (cmd != NULL && cmd->type == lesp_eCMD_RESYNC)
+    {
+      /* Anything before the answer to "AT" belongs to the abandoned
+       * command.
+       */
+
+      if (cmd->prompt && strcmp(line, "OK") == 0)
+        {
+          ninfo("AT channel resynchronised\n");
+          lesp_cmd_done(cmd, lesp_eOK);
+        }
+
+      return;
+    }
+
+  if (cmd != NULL && cmd->type != lesp_eCMD_SYNC)
+    {
+      /* The "OK" of AT+CIPSEND, "Recv <n> bytes", etc. are ignored */
+
+      if ((strcmp(line, "SEND OK") == 0) ||
+          (cmd->type == lesp_eCMD_RECVDATA && strcmp(line, "OK") == 0))
+        {
+          lesp_cmd_done(cmd, lesp_eOK);
+        }
+      else if ((strcmp(line, "ERROR") == 0) ||
+               (strcmp(line, "FAIL") == 0) ||
+               (strcmp(line, "SEND FAIL") == 0))
+        {
+          nerr("ERROR: %s on socket %d\n", line, cmd->sockfd);
+          lesp_cmd_done(cmd, lesp_eERR);
+        }
+
+      return;
+    }
+
+  if (strcmp(line, "OK") == 0)
+    {
+      worker->and = lesp_eOK;
+    }
+  else if ((strcmp(line, "FAIL") == 0) ||
+           (strcmp(line, "ERROR") == 0))
+    {
+      worker->and = lesp_eERR;
+    }
+  else
+    {
+      if (worker->buf[0] != '\0')
+        {
+          pthread_mutex_unlock(&(worker->mutex));
+          usleep(100); /* leave time of aplicative to read buffer */
+          pthread_mutex_lock(&(worker->mutex));
+        }
+
+      if (rxlen + 1 <= BUF_ANS_LEN)
+        {
+          memcpy(worker->buf, line, rxlen + 1);
+        }
+      else
+        {
+          nerr("Worker and line is too long:%s\n", line);
+        }
     }
 
-  return 0;
+  sem_post(&worker->sem);
 }
 
 /****************************************************************************
- * Name: lesp_parse_cwlap_ans_line
+ * Name: lesp_worker_parse
  *
  * Description:
- *   Try to decode @b +CWLAP line.
- *   see in:
- *   https://room-15.github.io/blog/2015/03/26/esp8266-at-command-reference/
- *
- *    +CWLAP:(0,"FreeWifi",-90,"00:07:cb:07:b6:00",1)
- *    0 => security
- *    "FreeWifi" => ssid
- *    -90 => rssi
- *    "00:07:cb:07:b6:00" => mac
- *
- *   Note: Content of ptr is modified and string in ap point into ptr string.
- *
- * Input Parameters:
- *   ptr   : +CWLAP line null terminated string pointer.
- *   ap    : ap result of parsing.
+ *   Parse a chunk of data received from esp8266.
  *
- * Returned Value:
- *   0 on success, -1 in case of error.
+ * Note:
+ *  g_lesp_state.worker.mutex should be locked.
  *
  ****************************************************************************/
 
-static int lesp_parse_cwlap_ans_line(char *ptr, lesp_ap_t *ap)
+static void lesp_worker_parse(lesp_worker_t *worker, int len)
 {
-  int field_idx;
-  char *ptr_next;
+  FAR const uint8_t *ptr = worker->rxchunk;
+  FAR lesp_cmd_t *cmd;
+  int size;
+  uint8_t c;
 
-  for (field_idx = 0; field_idx <= 5; field_idx++)
+  while (len > 0)
     {
-      if (field_idx == 0)
-        {
-          ptr_next = strchr(ptr, '(');
-        }
-      else if (field_idx == 5)
-        {
-          ptr_next = strchr(ptr, ')');
-        }
-      else
-        {
-          ptr_next = strchr(ptr, ',');
-        }
+      /* Binary data goes to the socket FIFO as a whole */
 
-      if (ptr_next == NULL)
+      if (worker->datalen > 0)
         {
-          return -1;
+          size = len < worker->datalen ? len : worker->datalen;
+          if (worker->datasock >= 0)
+            {
+              lesp_fifo_put(&g_lesp_state.sockets[worker->datasock], ptr,
+                            size);
+            }
+
+          worker->datalen -= size;
+          ptr += size;
+          len -= size;
+          continue;
         }
 
-      *ptr_next = '\0';
+      c = *ptr++;
+      len--;
 
-      switch (field_idx)
+      if (c == '\n')
         {
-          case 0:
-              if (strcmp(ptr, "+CWLAP:") != 0)
-                {
-                  return -1;
-                }
-              break;
-
-          case 1:
-                {
-                  int i = *ptr - '0';
-
-                  if ((i < 0) || (i >= lesp_eSECURITY_NBR))
-                    {
-                      return -1;
-                    }
-
-                  ap->security = i;
-                }
-              break;
-
-          case 2:
-              ptr++; /* Remove first '"' */
-              *(ptr_next - 1) = '\0';
-              strncpy(ap->ssid, ptr, lespSSID_SIZE);
-              ap->ssid[lespSSID_SIZE] = '\0';
-              break;
+          if (worker->rxlen > 0 && worker->rxbuf[worker->rxlen - 1] == '\r')
+            {
+              worker->rxlen--;
+            }
 
-          case 3:
-                {
-                  int i = atoi(ptr);
+          if (worker->rxlen != 0)
+            {
+              worker->rxbuf[worker->rxlen] = '\0';
+              lesp_worker_line(worker);
+              worker->rxlen = 0;
+            }
 
-                  if (i > 0)
-                    {
-                      i = -i;
-                    }
+          continue;
+        }
 
-                  ap->rssi = i;
-                }
-              break;
+      if (worker->rxlen == 0)
+        {
+          cmd = worker->active;
 
-          case 4:
-                {
-                  int i;
+          if (c == '>' && cmd != NULL && cmd->type == lesp_eCMD_SEND &&
+              !cmd->prompt)
+            {
+              /* AT+CIPSEND prompt: lesp_cmd_submit() writes the payload
+               * while the worker keeps draining the module.
+               */
 
-                  ptr++; /* Remove first '"' */
-                  *(ptr_next - 1) = '\0';
+              cmd->prompt = true;
+              sem_post(&cmd->sem);
+              continue;
+            }
 
-                  for (i = 0; i < lespBSSID_SIZE ; i++)
-                    {
-                      ap->bssid[i] = strtol(ptr, &ptr, 16);
-                      if (*ptr == ':')
-                        {
-                          ptr++;
-                        }
-                    }
-                }
-              break;
+          if (c == ' ')
+            {
+              continue;
+            }
         }
 
-      ptr = ptr_next + 1;
+      if (worker->rxlen < BUF_WORKER_LEN - 1)
+        {
+          worker->rxbuf[worker->rxlen++] = c;
+          if ((c == ':' || c == ',') && worker->rxbuf[0] == '+')
+            {
+              lesp_worker_data(worker);
+            }
+        }
+      else
+        {
+          nerr("Read char overflow:%c\n", c);
+        }
     }
-
-  return 0;
 }
 
 /****************************************************************************
@@ -1256,7 +2142,6 @@ static int lesp_parse_cwlap_ans_line(char *ptr, lesp_ap_t *ap)
 static void *lesp_worker(void *args)
 {
   int ret = 0;
-  int rxlen = 0;
 
   lesp_worker_t *worker = &g_lesp_state.worker;
 
@@ -1266,107 +2151,24 @@ static void *lesp_worker(void *args)
 
   while (worker->running)
     {
-      uint8_t c;
-
-      ret = lesp_low_level_read(&c, 1);
+      ret = lesp_low_level_read(worker->rxchunk, BUF_WORKER_LEN);
 
       if (ret < 0)
         {
           nerr("ERROR: worker read data Error %d\n", ret);
         }
-      else if (ret > 0)
-        {
-          /* ninfo("c:0x%02X (%c)\n", c); */
-
-          pthread_mutex_lock(&(worker->mutex));
-          if (c == '\n')
-            {
-              if (worker->rxbuf[rxlen-1] == '\r')
-                {
-                  rxlen--;
-                }
-
-              DEBUGASSERT(rxlen >= 0);
-              DEBUGASSERT(rxlen < BUF_WORKER_LEN);
-
-              worker->rxbuf[rxlen] = '\0';
-
-              if (rxlen != 0)
-                {
-                  if (strcmp(worker->rxbuf, "OK") == 0)
-                    {
-                      worker->and = lesp_eOK;
-                    }
-                  else if ((strcmp(worker->rxbuf, "FAIL") == 0) ||
-                           (strcmp(worker->rxbuf, "ERROR") == 0)
-                          )
-                    {
-                      worker->and = lesp_eERR;
-                    }
-                  else if ((rxlen == 8) &&
-                            (memcmp(worker->rxbuf+1, ",CLOSED", 7) == 0))
-                    {
-                      unsigned int sockid = worker->rxbuf[0] - '0';
-                      if (sockid < SOCKET_NBR)
-                        {
-                          set_sock_closed(sockid);
-                        }
-                    }
-                  else
-                    {
-                      if (worker->buf[0] != '\0')
-                        {
-                          pthread_mutex_unlock(&(worker->mutex));
-                          usleep(100); /* leave time of aplicative to read buffer */
-                          pthread_mutex_lock(&(worker->mutex));
-                        }
-
-                      /* ninfo("Worker Read data:%s\n", worker->rxbuf); */
-
-                      if (rxlen+1 <= BUF_ANS_LEN)
-                        {
-                          memcpy(worker->buf, worker->rxbuf, rxlen+1);
-                        }
-                      else
-                        {
-                          nerr("Worker and line is too long:%s\n", worker->rxbuf);
-                        }
-                    }
-
-                  sem_post(&worker->sem);
-                  worker->rxbuf[0] = '\0';
-                  rxlen = 0;
-                }
-            }
-          else if (rxlen < BUF_WORKER_LEN - 1)
-            {
-              worker->rxbuf[rxlen++] = c;
-              if ((c == ':') && (memcmp(worker->rxbuf, "+IPD,", 5) == 0))
-                {
-                  int sockfd;
-                  int len;
-                  char *ptr = worker->rxbuf+5;
 
-                  sockfd = lesp_str_to_unsigned(&ptr, ',');
-                  if (sockfd >= 0)
-                    {
-                      len = lesp_str_to_unsigned(&ptr, ':');
-                      if (len >= 0)
-                        {
-                          lesp_read_ipd(sockfd, len);
-                        }
-                    }
+      pthread_mutex_lock(&(worker->mutex));
+      if (ret > 0)
+        {
+          lesp_worker_parse(worker, ret);
+        }
 
-                  rxlen = 0;
-                }
-            }
-          else
-            {
-              nerr("Read char overflow:%c\n", c);
-            }
+      /* Answers or a timeout may have released the AT channel */
 
-          pthread_mutex_unlock(&(worker->mutex));
-        }
+      lesp_cmd_timeout(ret > 0);
+      lesp_cmd_start();
+      pthread_mutex_unlock(&(worker->mutex));
     }
 
   return NULL;
@@ -1483,7 +2285,17 @@ int lesp_initialize(void)
 
   memset(g_lesp_state.sockets, 0, SOCKET_NBR * sizeof(lesp_socket_t));
 
-  if (sem_init(&g_lesp_state.worker.sem, 0, 0) < 0)
+  g_lesp_state.worker.active  = NULL;
+  g_lesp_state.worker.head    = NULL;
+  g_lesp_state.worker.tail    = NULL;
+  g_lesp_state.worker.rxlen   = 0;
+  g_lesp_state.worker.datalen = 0;
+  g_lesp_state.worker.passive = false;
+  g_lesp_state.sync.type      = lesp_eCMD_SYNC;
+  g_lesp_state.worker.resync.type = lesp_eCMD_RESYNC;
+
+  if (sem_init(&g_lesp_state.worker.sem, 0, 0) < 0 ||
+      sem_init(&g_lesp_state.sync.sem, 0, 0) < 0)
     {
       ninfo("Cannot create semaphore\n");
       ret = -1;
@@ -1549,12 +2361,14 @@ int lesp_soft_reset(void)
   int ret = 0;
   int i;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   /* Rry to close opened reset */
 
   pthread_mutex_lock(&g_lesp_state.worker.mutex);
 
+  g_lesp_state.worker.passive = false;
+
   for (i = 0; i < SOCKET_NBR; i++)
     {
       if ((g_lesp_state.sockets[i].flags & FLAGS_SOCK_USED) != 0)
@@ -1604,12 +2418,27 @@ int lesp_soft_reset(void)
       ret = lesp_ask_ans_ok(lespTIMEOUT_MS, "AT+CIPMUX=1\r\n");
     }
 
+#ifdef CONFIG_NETUTILS_ESP8266_PASSIVE_RECV
+  /* Keep received data in the module up to AT+CIPRECVDATA, if the firmware
+   * knows it (AT 1.7 and later).
+   */
+
+  if (ret >= 0 &&
+      lesp_ask_ans_ok(lespTIMEOUT_MS, "AT+CIPRECVMODE=1\r\n") >= 0)
+    {
+      pthread_mutex_lock(&g_lesp_state.worker.mutex);
+      g_lesp_state.worker.passive = true;
+      pthread_mutex_unlock(&g_lesp_state.worker.mutex);
+      ninfo("Passive receive mode\n");
+    }
+#endif
+
   if (ret < 0)
     {
       ret = -1;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   return 0;
 }
@@ -1634,7 +2463,7 @@ int lesp_ap_connect(const char *ssid_name, const char *ap_key, int timeout_s)
 
   ninfo("Starting manual connect...\n");
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ret = lesp_check();
 
@@ -1644,7 +2473,7 @@ int lesp_ap_connect(const char *ssid_name, const char *ap_key, int timeout_s)
                             ssid_name, ap_key);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -1677,7 +2506,7 @@ int lesp_ap_get(lesp_ap_t *ap)
   int ret = 0;
   ninfo("Get Access Point info...\n");
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ret = lesp_check();
 
@@ -1706,7 +2535,7 @@ int lesp_ap_get(lesp_ap_t *ap)
       ret = lesp_read_ans_ok(lespTIMEOUT_MS);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -1742,7 +2571,7 @@ int lesp_get_net(lesp_mode_t mode, in_addr_t *ip, in_addr_t *mask, in_addr_t *gw
   int ret = 0;
   ninfo("Get IP info...\n");
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ret = lesp_check();
 
@@ -1804,7 +2633,7 @@ int lesp_get_net(lesp_mode_t mode, in_addr_t *ip, in_addr_t *mask, in_addr_t *gw
       ret = lesp_read_ans_ok(lespTIMEOUT_MS);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -1837,7 +2666,7 @@ int lesp_set_net(lesp_mode_t mode, in_addr_t ip, in_addr_t mask, in_addr_t gatew
 {
   int ret = 0;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ret = lesp_check();
 
@@ -1856,7 +2685,7 @@ int lesp_set_net(lesp_mode_t mode, in_addr_t ip, in_addr_t mask, in_addr_t gatew
                             *((uint8_t *)&(mask)+2), *((uint8_t *)&(mask)+3));
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -1885,7 +2714,7 @@ int lesp_set_dhcp(lesp_mode_t mode, bool enable)
 {
   int ret = 0;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ret = lesp_check();
 
@@ -1895,7 +2724,7 @@ int lesp_set_dhcp(lesp_mode_t mode, bool enable)
                             mode, (enable)?'1':'0');
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -1924,7 +2753,7 @@ int lesp_get_dhcp(bool *ap_enable, bool *sta_enable)
 {
   int ret = 0;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Get DHCP State...\n");
 
@@ -1977,7 +2806,7 @@ int lesp_get_dhcp(bool *ap_enable, bool *sta_enable)
       ret = lesp_read_ans_ok(lespTIMEOUT_MS);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -2008,7 +2837,7 @@ int lesp_list_access_points(lesp_cb_t cb)
   int ret = 0;
   int number = 0;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("List access point(s)...\n");
 
@@ -2049,7 +2878,7 @@ int lesp_list_access_points(lesp_cb_t cb)
       number++;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -2196,7 +3025,7 @@ int lesp_closesocket(int sockfd)
   int ret = 0;
   lesp_socket_t *sock = NULL;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("List access point(s)...\n");
 
@@ -2220,7 +3049,7 @@ int lesp_closesocket(int sockfd)
       pthread_mutex_unlock(&g_lesp_state.worker.mutex);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -2250,7 +3079,7 @@ int lesp_closesocket(int sockfd)
 int lesp_bind(int sockfd, FAR const struct sockaddr *addr, socklen_t addrlen)
 {
   int ret = 0;
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Bind socket %d...\n", sockfd);
 
@@ -2263,7 +3092,7 @@ int lesp_bind(int sockfd, FAR const struct sockaddr *addr, socklen_t addrlen)
       ret = -1;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   return ret;
 }
@@ -2300,7 +3129,7 @@ int lesp_connect(int sockfd, FAR const struct sockaddr *addr, socklen_t addrlen)
   DEBUGASSERT(in->sin_family == AF_INET);
   DEBUGASSERT(addrlen == sizeof(struct sockaddr_in));
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Connect %d...\n", sockfd);
 
@@ -2349,7 +3178,7 @@ int lesp_connect(int sockfd, FAR const struct sockaddr *addr, socklen_t addrlen)
         }
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
@@ -2382,7 +3211,7 @@ int lesp_connect(int sockfd, FAR const struct sockaddr *addr, socklen_t addrlen)
 int lesp_listen(int sockfd, int backlog)
 {
   int ret = 0;
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Connect %d...\n", sockfd);
 
@@ -2395,7 +3224,7 @@ int lesp_listen(int sockfd, int backlog)
       ret = -1;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   return ret;
 }
@@ -2419,7 +3248,7 @@ int lesp_listen(int sockfd, int backlog)
 int lesp_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
 {
   int ret = 0;
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Connect %d...\n", sockfd);
 
@@ -2432,7 +3261,7 @@ int lesp_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
       ret = -1;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   return ret;
 }
@@ -2450,71 +3279,74 @@ int lesp_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
  *   flags    Send flags
  *
  * Returned Value:
- *   A 0 on success; -1 on error.
+ *   The number of bytes sent; -1 on error.
  *
  ****************************************************************************/
 
 ssize_t lesp_send(int sockfd, FAR const uint8_t *buf, size_t len, int flags)
 {
   int ret = 0;
-  lesp_socket_t *sock = NULL;
+  size_t sent = 0;
+  lesp_cmd_t cmd;
 
   UNUSED(flags);
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
-
   ninfo("Send %d bytes in %d socket...\n", len, sockfd);
 
-  ret = lesp_check();
-
-  if (ret >= 0)
+  if (get_sock_protected(sockfd) == NULL)
     {
-      sock = get_sock_protected(sockfd);
-      if (sock == NULL)
-        {
-          ret = -1;
-        }
+      return -1;
     }
 
-  if (ret >= 0)
+  if (sem_init(&cmd.sem, 0, 0) < 0)
     {
-      ret = lesp_ask_ans_ok(lespTIMEOUT_MS, "AT+CIPSEND=%d,%d\r\n", sockfd, len);
+      ninfo("Cannot create semaphore\n");
+      return -1;
     }
 
-  if (ret >= 0)
-    {
-      ninfo("Sending in socket %d, %d bytes\n", sockfd, len);
-      ret = write(g_lesp_state.fd, buf, len);
-    }
+  cmd.type   = lesp_eCMD_SEND;
+  cmd.sockfd = sockfd;
 
-  while (ret >= 0)
+  /* The worker writes AT+CIPSEND as soon as the channel is free, wakes us
+   * up on the '>' prompt to write the payload and completes the command on
+   * "SEND OK", so the sends of all sockets follow each other on the AT
+   * channel.
+   */
+
+  while (sent < len)
     {
-      char * ptr = g_lesp_state.bufans;
-      ret = lesp_read(lespTIMEOUT_MS);
+      cmd.data    = buf + sent;
+      cmd.len     = len - sent;
+      cmd.prompt  = false;
+      cmd.writing = false;
 
-      if (ret < 0)
+      if (cmd.len > lespSEND_MAX_LEN)
         {
-          break;
+          cmd.len = lespSEND_MAX_LEN;
         }
 
-      while ((*ptr != 0) && (*ptr != 'S'))
+      ret = lesp_cmd_submit(&cmd, lespTIMEOUT_MS_SEND +
+                            lespXFER_MS(cmd.len));
+      if (ret < 0)
         {
-          ptr++;
+          break;
         }
 
-      if (*ptr == 'S')
-        {
-          if (strcmp(ptr, "SEND OK") == 0)
-              break;
-        }
+      sent += cmd.len;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  sem_destroy(&cmd.sem);
 
   if (ret < 0)
     {
       nerr("ERROR: Cannot send in socket %d, %d bytes\n", sockfd, len);
-      return -1;
+      if (sent == 0)
+        {
+          errno = EIO;
+          return -1;
+        }
+
+      return sent;
     }
 
   ninfo("Sent\n");
@@ -2594,26 +3426,32 @@ ssize_t lesp_recv(int sockfd, FAR uint8_t *buf, size_t len, int flags)
 
   if (ret >= 0)
     {
-      ret = 0;
-      while (ret < len && sock->outndx != sock->inndx)
-        {
-          /* Remove one byte from the circular buffer */
+      int size;
 
-          int ndx = sock->outndx;
-          *buf++  = sock->rxbuf[ndx];
+      /* Copy the data out of the circular buffer in up to two parts */
 
-          /* Increment the circular buffer 'outndx' */
+      ret = lesp_fifo_used(sock);
+      if ((size_t)ret > len)
+        {
+          ret = len;
+        }
 
-          if (++ndx >= SOCKET_FIFO_SIZE)
-            {
-              ndx -= SOCKET_FIFO_SIZE;
-            }
+      size = SOCKET_FIFO_SIZE - sock->outndx;
+      if (size > ret)
+        {
+          size = ret;
+        }
 
-          sock->outndx = ndx;
+      memcpy(buf, &sock->rxbuf[sock->outndx], size);
+      memcpy(buf + size, sock->rxbuf, ret - size);
+      sock->outndx = (sock->outndx + ret) & (SOCKET_FIFO_SIZE - 1);
 
-          /* Increment the count of bytes returned */
+      /* Room was made for the data held by the module */
 
-          ret++;
+      if (g_lesp_state.worker.passive)
+        {
+          lesp_fetch_schedule();
+          lesp_cmd_start();
         }
     }
 
@@ -2719,7 +3557,7 @@ int lesp_getsockopt(int sockfd, int level, int option, FAR void *value,
                     FAR socklen_t *value_len)
 {
   int ret = 0;
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("getsockopt on %d socket...\n", sockfd);
 
@@ -2732,7 +3570,7 @@ int lesp_getsockopt(int sockfd, int level, int option, FAR void *value,
       ret = -1;
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   return ret;
 }
@@ -2769,7 +3607,7 @@ FAR struct hostent *lesp_gethostbyname(FAR const char *hostname)
   g_lesp_state.h_addr_list_buf[0] = &g_lesp_state.in_addr;
   g_lesp_state.h_addr_list_buf[1] = NULL;
 
-  pthread_mutex_lock(&g_lesp_state.mutex);
+  lesp_lock();
 
   ninfo("Get host by name '%s' ...\n", hostname);
 
@@ -2803,7 +3641,7 @@ FAR struct hostent *lesp_gethostbyname(FAR const char *hostname)
       ret = lesp_read_ans_ok(lespTIMEOUT_MS);
     }
 
-  pthread_mutex_unlock(&g_lesp_state.mutex);
+  lesp_unlock();
 
   if (ret < 0)
     {
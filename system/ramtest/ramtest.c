@@ -45,13 +45,20 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sched.h>
 #include <syslog.h>
+#include <time.h>
 #include <errno.h>
 
 #include <nuttx/usb/usbdev_trace.h>
 
+#if defined(CONFIG_ARCH_DCACHE) && defined(CONFIG_BUILD_FLAT)
+#  include <nuttx/cache.h>
+#  define RAMTEST_HAVE_DCACHE 1
+#endif
+
 #ifdef CONFIG_SYSTEM_RAMTEST
 
 /****************************************************************************
@@ -60,10 +67,23 @@
 
 #define RAMTEST_PREFIX "RAMTest: "
 
+/* Burst kernels access memory with the widest native word */
+
+#define RAMTEST_WORDSIZE sizeof(ramtest_word_t)
+#define RAMTEST_UNROLL   8
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define RAMTEST_CLOCK  CLOCK_MONOTONIC
+#else
+#  define RAMTEST_CLOCK  CLOCK_REALTIME
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+typedef uintptr_t ramtest_word_t;
+
 struct ramtest_s
 {
   uint8_t width;
@@ -71,12 +91,20 @@ struct ramtest_s
   size_t size;
   size_t nxfrs;
   uint32_t mask;
+  bool burst;          /* Use the word-wide burst kernels */
+  bool cache;          /* Clean/invalidate the D-cache around each pass */
+  bool bandwidth;      /* Measure bandwidth instead of testing */
+  int repeat;          /* Passes per bandwidth measurement */
 };
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+/* Keeps the result of the read bandwidth kernel alive */
+
+static volatile ramtest_word_t g_sink;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -87,13 +115,24 @@ struct ramtest_s
 
 static void show_usage(FAR const char *progname, int exitcode)
 {
-  printf("\nUsage: %s [-w|h|b] <hex-address> <decimal-size>\n", progname);
+  printf("\nUsage: %s [-w|h|b] [-f] [-c] [-m [-r <repeat>]] "
+         "<hex-address> <decimal-size>\n", progname);
   printf("\nWhere:\n");
   printf("  <hex-address> starting address of the test.\n");
   printf("  <decimal-size> number of memory locations (in bytes).\n");
   printf("  -w Sets the width of a memory location to 32-bits.\n");
   printf("  -h Sets the width of a memory location to 16-bits (default).\n");
   printf("  -b Sets the width of a memory location to 8-bits.\n");
+  printf("  -f Fast burst mode: access memory %d bytes at a time with\n"
+         "     unrolled loops.  Address and size must be word aligned.\n",
+         (int)RAMTEST_WORDSIZE);
+#ifdef RAMTEST_HAVE_DCACHE
+  printf("  -c Clean and invalidate the D-cache around each pass so that\n"
+         "     data is verified in (and measured from) memory.\n");
+#endif
+  printf("  -m Measure read, write and copy bandwidth in MB/s instead of\n"
+         "     testing.\n");
+  printf("  -r Number of passes per bandwidth measurement (default 4).\n");
   exit(exitcode);
 }
 
@@ -107,9 +146,35 @@ static void parse_commandline(int argc, char **argv,
   FAR char *ptr;
   int option;
 
-  while ((option = getopt(argc, argv, "whb")) != ERROR)
+  while ((option = getopt(argc, argv, "whbfcmr:")) != ERROR)
     {
-      if (option == 'w')
+      if (option == 'f')
+        {
+          info->burst = true;
+        }
+      else if (option == 'c')
+        {
+#ifdef RAMTEST_HAVE_DCACHE
+          info->cache = true;
+#else
+          printf(RAMTEST_PREFIX "No D-cache support, -c ignored\n");
+#endif
+        }
+      else if (option == 'm')
+        {
+          info->bandwidth = true;
+          info->burst     = true;
+        }
+      else if (option == 'r')
+        {
+          info->repeat = (int)strtol(optarg, &ptr, 10);
+          if (*ptr != '\0' || info->repeat < 1)
+            {
+              printf(RAMTEST_PREFIX "Invalid <repeat>: %s\n", optarg);
+              show_usage(argv[0], EXIT_FAILURE);
+            }
+        }
+      else if (option == 'w')
         {
           info->width = 32;
           info->mask  = 0xffffffff;
@@ -186,6 +251,163 @@ static void parse_commandline(int argc, char **argv,
       printf(RAMTEST_PREFIX "Too many arguments\n");
       show_usage(argv[0], EXIT_FAILURE);
     }
+
+  if (info->burst && ((info->start | info->size) & (RAMTEST_WORDSIZE - 1)))
+    {
+      printf(RAMTEST_PREFIX "-f and -m need a %d byte aligned address and "
+             "size\n", (int)RAMTEST_WORDSIZE);
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+}
+
+/****************************************************************************
+ * Name: ramtest_sync
+ *
+ * Description:
+ *   Write back and invalidate the D-cache lines of the test region so that
+ *   the following reads come from memory rather than from the cache.
+ *
+ ****************************************************************************/
+
+static void ramtest_sync(FAR struct ramtest_s *info)
+{
+#ifdef RAMTEST_HAVE_DCACHE
+  if (info->cache)
+    {
+      up_flush_dcache(info->start, info->start + info->size);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: ramtest_pattern
+ *
+ * Description:
+ *   Build the two words that, stored alternately, reproduce the element
+ *   pattern value_1, value_2, value_1, ... of the selected width.  Building
+ *   the words through element-sized stores keeps this endian neutral.
+ *
+ ****************************************************************************/
+
+static void ramtest_pattern(FAR struct ramtest_s *info, uint32_t value_1,
+                            uint32_t value_2, FAR ramtest_word_t *pattern)
+{
+  size_t nelem = 2 * RAMTEST_WORDSIZE / (info->width / 8);
+  size_t i;
+
+  for (i = 0; i < nelem; i++)
+    {
+      uint32_t value = (i & 1) != 0 ? value_2 : value_1;
+
+      if (info->width == 32)
+        {
+          ((FAR uint32_t *)pattern)[i] = value;
+        }
+      else if (info->width == 16)
+        {
+          ((FAR uint16_t *)pattern)[i] = (uint16_t)value;
+        }
+      else
+        {
+          ((FAR uint8_t *)pattern)[i] = (uint8_t)value;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: burst_write
+ *
+ * Description:
+ *   Fill the region with word_1, word_2, word_1, ...  The loop is unrolled
+ *   so that the compiler can emit multi-word stores.
+ *
+ ****************************************************************************/
+
+static void burst_write(FAR struct ramtest_s *info, ramtest_word_t word_1,
+                        ramtest_word_t word_2)
+{
+  FAR ramtest_word_t *ptr = (FAR ramtest_word_t *)info->start;
+  size_t nwords = info->size / RAMTEST_WORDSIZE;
+  FAR ramtest_word_t *end = ptr + (nwords & ~(RAMTEST_UNROLL - 1));
+  size_t i;
+
+  while (ptr < end)
+    {
+      ptr[0] = word_1;
+      ptr[1] = word_2;
+      ptr[2] = word_1;
+      ptr[3] = word_2;
+      ptr[4] = word_1;
+      ptr[5] = word_2;
+      ptr[6] = word_1;
+      ptr[7] = word_2;
+      ptr   += RAMTEST_UNROLL;
+    }
+
+  for (i = 0; i < (nwords & (RAMTEST_UNROLL - 1)); i++)
+    {
+      *ptr++ = (i & 1) != 0 ? word_2 : word_1;
+    }
+}
+
+/****************************************************************************
+ * Name: burst_report
+ ****************************************************************************/
+
+static void burst_report(FAR ramtest_word_t *ptr, size_t nwords,
+                         ramtest_word_t word_1, ramtest_word_t word_2)
+{
+  size_t i;
+
+  for (i = 0; i < nwords; i++)
+    {
+      ramtest_word_t expected = (i & 1) != 0 ? word_2 : word_1;
+
+      if (ptr[i] != expected)
+        {
+          printf(RAMTEST_PREFIX
+                 "ERROR: Address %p Found: %0*lx Expected %0*lx\n",
+                 &ptr[i], (int)(2 * RAMTEST_WORDSIZE),
+                 (unsigned long)ptr[i], (int)(2 * RAMTEST_WORDSIZE),
+                 (unsigned long)expected);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: burst_verify
+ *
+ * Description:
+ *   Verify a region written by burst_write().  Eight words are checked with
+ *   a single branch; only a failing group is examined word by word.
+ *
+ ****************************************************************************/
+
+static void burst_verify(FAR struct ramtest_s *info, ramtest_word_t word_1,
+                         ramtest_word_t word_2)
+{
+  FAR ramtest_word_t *ptr = (FAR ramtest_word_t *)info->start;
+  size_t nwords = info->size / RAMTEST_WORDSIZE;
+  FAR ramtest_word_t *end = ptr + (nwords & ~(RAMTEST_UNROLL - 1));
+
+  ramtest_sync(info);
+
+  while (ptr < end)
+    {
+      ramtest_word_t diff = (ptr[0] ^ word_1) | (ptr[1] ^ word_2) |
+                            (ptr[2] ^ word_1) | (ptr[3] ^ word_2) |
+                            (ptr[4] ^ word_1) | (ptr[5] ^ word_2) |
+                            (ptr[6] ^ word_1) | (ptr[7] ^ word_2);
+
+      if (diff != 0)
+        {
+          burst_report(ptr, RAMTEST_UNROLL, word_1, word_2);
+        }
+
+      ptr += RAMTEST_UNROLL;
+    }
+
+  burst_report(ptr, nwords & (RAMTEST_UNROLL - 1), word_1, word_2);
 }
 
 /****************************************************************************
@@ -196,6 +418,15 @@ static void write_memory(FAR struct ramtest_s *info, uint32_t value)
 {
   size_t i;
 
+  if (info->burst)
+    {
+      ramtest_word_t pattern[2];
+
+      ramtest_pattern(info, value, value, pattern);
+      burst_write(info, pattern[0], pattern[1]);
+      return;
+    }
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -230,6 +461,17 @@ static void verify_memory(FAR struct ramtest_s *info, uint32_t value)
 {
   size_t i;
 
+  if (info->burst)
+    {
+      ramtest_word_t pattern[2];
+
+      ramtest_pattern(info, value, value, pattern);
+      burst_verify(info, pattern[0], pattern[1]);
+      return;
+    }
+
+  ramtest_sync(info);
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -330,6 +572,15 @@ static void write_memory2(FAR struct ramtest_s *info, uint32_t value_1,
   size_t even_nxfrs = info->nxfrs & ~1;
   size_t i;
 
+  if (info->burst)
+    {
+      ramtest_word_t pattern[2];
+
+      ramtest_pattern(info, value_1, value_2, pattern);
+      burst_write(info, pattern[0], pattern[1]);
+      return;
+    }
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -369,6 +620,17 @@ static void verify_memory2(FAR struct ramtest_s *info, uint32_t value_1,
   size_t even_nxfrs = info->nxfrs & ~1;
   size_t i;
 
+  if (info->burst)
+    {
+      ramtest_word_t pattern[2];
+
+      ramtest_pattern(info, value_1, value_2, pattern);
+      burst_verify(info, pattern[0], pattern[1]);
+      return;
+    }
+
+  ramtest_sync(info);
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -451,6 +713,19 @@ static void write_addrinaddr(FAR struct ramtest_s *info)
 {
   size_t i;
 
+  if (info->burst)
+    {
+      FAR ramtest_word_t *ptr = (FAR ramtest_word_t *)info->start;
+      size_t nwords = info->size / RAMTEST_WORDSIZE;
+
+      for (i = 0; i < nwords; i++, ptr++)
+        {
+          *ptr = (ramtest_word_t)ptr;
+        }
+
+      return;
+    }
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -488,6 +763,25 @@ static void verify_addrinaddr(FAR struct ramtest_s *info)
 {
   size_t i;
 
+  if (info->burst)
+    {
+      FAR ramtest_word_t *ptr = (FAR ramtest_word_t *)info->start;
+      size_t nwords = info->size / RAMTEST_WORDSIZE;
+
+      ramtest_sync(info);
+      for (i = 0; i < nwords; i++, ptr++)
+        {
+          if (*ptr != (ramtest_word_t)ptr)
+            {
+              burst_report(ptr, 1, (ramtest_word_t)ptr, 0);
+            }
+        }
+
+      return;
+    }
+
+  ramtest_sync(info);
+
   if (info->width == 32)
     {
       uint32_t *ptr = (uint32_t*)info->start;
@@ -551,6 +845,181 @@ static void addr_in_addr(FAR struct ramtest_s *info)
   verify_addrinaddr(info);
 }
 
+/****************************************************************************
+ * Name: bandwidth_elapsed
+ ****************************************************************************/
+
+static uint64_t bandwidth_elapsed(FAR const struct timespec *start)
+{
+  struct timespec end;
+
+  clock_gettime(RAMTEST_CLOCK, &end);
+  return (uint64_t)(end.tv_sec - start->tv_sec) * 1000000 +
+         (end.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Name: bandwidth_report
+ ****************************************************************************/
+
+static void bandwidth_report(FAR const char *name, uint64_t bytes,
+                             uint64_t usec)
+{
+  uint64_t rate;
+
+  if (usec == 0)
+    {
+      usec = 1;
+    }
+
+  /* Bytes per microsecond is MB/s; keep two decimals */
+
+  rate = bytes * 100 / usec;
+  printf(RAMTEST_PREFIX "  %-14s %6lu.%02lu MB/s\n", name,
+         (unsigned long)(rate / 100), (unsigned long)(rate % 100));
+}
+
+/****************************************************************************
+ * Name: burst_read
+ ****************************************************************************/
+
+static ramtest_word_t burst_read(FAR struct ramtest_s *info)
+{
+  FAR const ramtest_word_t *ptr = (FAR const ramtest_word_t *)info->start;
+  size_t nwords = info->size / RAMTEST_WORDSIZE;
+  FAR const ramtest_word_t *end = ptr + (nwords & ~(RAMTEST_UNROLL - 1));
+  ramtest_word_t acc_1 = 0;
+  ramtest_word_t acc_2 = 0;
+  size_t i;
+
+  while (ptr < end)
+    {
+      acc_1 ^= ptr[0] ^ ptr[2] ^ ptr[4] ^ ptr[6];
+      acc_2 ^= ptr[1] ^ ptr[3] ^ ptr[5] ^ ptr[7];
+      ptr   += RAMTEST_UNROLL;
+    }
+
+  for (i = 0; i < (nwords & (RAMTEST_UNROLL - 1)); i++)
+    {
+      acc_1 ^= *ptr++;
+    }
+
+  return acc_1 ^ acc_2;
+}
+
+/****************************************************************************
+ * Name: burst_copy
+ ****************************************************************************/
+
+static void burst_copy(FAR ramtest_word_t *dest,
+                       FAR const ramtest_word_t *src, size_t nwords)
+{
+  FAR const ramtest_word_t *end = src + (nwords & ~(RAMTEST_UNROLL - 1));
+  size_t i;
+
+  while (src < end)
+    {
+      ramtest_word_t w0 = src[0];
+      ramtest_word_t w1 = src[1];
+      ramtest_word_t w2 = src[2];
+      ramtest_word_t w3 = src[3];
+      ramtest_word_t w4 = src[4];
+      ramtest_word_t w5 = src[5];
+      ramtest_word_t w6 = src[6];
+      ramtest_word_t w7 = src[7];
+
+      dest[0] = w0;
+      dest[1] = w1;
+      dest[2] = w2;
+      dest[3] = w3;
+      dest[4] = w4;
+      dest[5] = w5;
+      dest[6] = w6;
+      dest[7] = w7;
+
+      src    += RAMTEST_UNROLL;
+      dest   += RAMTEST_UNROLL;
+    }
+
+  for (i = 0; i < (nwords & (RAMTEST_UNROLL - 1)); i++)
+    {
+      *dest++ = *src++;
+    }
+}
+
+/****************************************************************************
+ * Name: bandwidth_test
+ *
+ * Description:
+ *   Measure write, read and copy bandwidth of the region.  Copies move the
+ *   lower half of the region into the upper half.  When -c is given the
+ *   cache maintenance is done outside of the timed sections so that every
+ *   pass starts with a cold cache; the lines left dirty by a pass are
+ *   written back by the flush before the next one.
+ *
+ ****************************************************************************/
+
+static void bandwidth_test(FAR struct ramtest_s *info)
+{
+  FAR ramtest_word_t *lower = (FAR ramtest_word_t *)info->start;
+  size_t half = (info->size / 2) & ~(RAMTEST_WORDSIZE - 1);
+  struct timespec start;
+  uint64_t usec;
+  int i;
+
+  printf(RAMTEST_PREFIX "Bandwidth: %08lx %lu x%d (%d byte words)\n",
+         (unsigned long)info->start, (unsigned long)info->size,
+         info->repeat, (int)RAMTEST_WORDSIZE);
+
+  /* Write */
+
+  for (usec = 0, i = 0; i < info->repeat; i++)
+    {
+      ramtest_sync(info);
+      clock_gettime(RAMTEST_CLOCK, &start);
+      burst_write(info, (ramtest_word_t)0x5a5a5a5a,
+                  (ramtest_word_t)0xa5a5a5a5);
+      usec += bandwidth_elapsed(&start);
+    }
+
+  bandwidth_report("write", (uint64_t)info->size * info->repeat, usec);
+
+  /* Read */
+
+  for (usec = 0, i = 0; i < info->repeat; i++)
+    {
+      ramtest_sync(info);
+      clock_gettime(RAMTEST_CLOCK, &start);
+      g_sink = burst_read(info);
+      usec += bandwidth_elapsed(&start);
+    }
+
+  bandwidth_report("read", (uint64_t)info->size * info->repeat, usec);
+
+  /* Copy using the word kernel and using the C library */
+
+  for (usec = 0, i = 0; i < info->repeat; i++)
+    {
+      ramtest_sync(info);
+      clock_gettime(RAMTEST_CLOCK, &start);
+      burst_copy(lower + half / RAMTEST_WORDSIZE, lower,
+                 half / RAMTEST_WORDSIZE);
+      usec += bandwidth_elapsed(&start);
+    }
+
+  bandwidth_report("copy (words)", (uint64_t)half * info->repeat, usec);
+
+  for (usec = 0, i = 0; i < info->repeat; i++)
+    {
+      ramtest_sync(info);
+      clock_gettime(RAMTEST_CLOCK, &start);
+      memcpy((FAR uint8_t *)lower + half, lower, half);
+      usec += bandwidth_elapsed(&start);
+    }
+
+  bandwidth_report("copy (memcpy)", (uint64_t)half * info->repeat, usec);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -561,10 +1030,18 @@ int main(int argc, FAR char *argv[])
 
   /* Setup defaults and parse the command line */
 
-  info.width = 16;
-  info.mask  = 0x0000ffff;
+  memset(&info, 0, sizeof(struct ramtest_s));
+  info.width  = 16;
+  info.mask   = 0x0000ffff;
+  info.repeat = 4;
   parse_commandline(argc, argv, &info);
 
+  if (info.bandwidth)
+    {
+      bandwidth_test(&info);
+      return 0;
+    }
+
   /* Perform the memory tests */
 
   marching_ones(&info);
@@ -75,6 +75,10 @@
 #define TINFO_ENTRY(n, d, c)  d, c
 #endif
 
+#ifndef CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE
+#  define CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE 0
+#endif
+
 /************************************************************************************
  * Private Types
  ************************************************************************************/
@@ -89,6 +93,25 @@ struct tcurses_vt100_s
   int    out_fd;
   int    keycount;
   char   keybuf[16];
+
+  /* Cursor position as last sent to the terminal (row < 0 if unknown) and
+   * the terminal width (0 if unknown).
+   */
+
+  int    row;
+  int    col;
+  int    cols;
+
+  /* True if the line drawing character set is selected */
+
+  bool   acs;
+
+#if CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE > 0
+  /* Output not yet written to out_fd */
+
+  int    outlen;
+  char   outbuf[CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE];
+#endif
 };
 
 /************************************************************************************
@@ -108,6 +131,9 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
 static int tcurses_vt100_getkeycode(FAR struct termcurses_s *dev,
               FAR int *specialkey, FAR int *keymodifers);
 static bool tcurses_vt100_checkkey(FAR struct termcurses_s *dev);
+static int tcurses_vt100_write(FAR struct termcurses_s *dev,
+              FAR const char *buffer, size_t buflen);
+static int tcurses_vt100_flush(FAR struct termcurses_s *dev);
 
 /************************************************************************************
  * Private Data
@@ -122,7 +148,9 @@ static const struct termcurses_ops_s g_vt100_ops =
   tcurses_vt100_setcolors,
   tcurses_vt100_setattributes,
   tcurses_vt100_getkeycode,
-  tcurses_vt100_checkkey
+  tcurses_vt100_checkkey,
+  tcurses_vt100_write,
+  tcurses_vt100_flush
 };
 
 /* VT100 terminal codes */
@@ -132,6 +160,8 @@ static const char *g_clreos         = "\033[J";       /* Clear to end of screen
 static const char *g_clreol         = "\033[K";       /* Clear to end of line */
 
 static const char *g_movecurs       = "\033[%d;%dH";  /* Move cursor to x,y */
+static const char *g_movestep       = "\033[%c";      /* Move cursor by one */
+static const char *g_movesteps      = "\033[%d%c";    /* Move cursor by n */
 static const char *g_getwinsize     = "\x1b[s\x1b[999;999H\x1b[6n\x1bu";
 static const char *g_setfgcolor     = "\x1b[38;5;%dm";
 static const char *g_setbgcolor     = "\x1b[48;5;%dm";
@@ -143,6 +173,8 @@ static const char *g_setblink       = ";5";
 static const char *g_setnoblink     = ";25";
 static const char *g_setunderline   = ";4";
 static const char *g_setnounderline = ";24";
+static const char *g_setacs         = "\x1b(0";
+static const char *g_setascii       = "\x1b(B";
 
 struct keycodes_s
 {
@@ -382,6 +414,186 @@ struct termcurses_dev_s g_vt100_tcurs =
  * Private Functions
  ************************************************************************************/
 
+/************************************************************************************
+ * Write all of a buffer to the terminal
+ ************************************************************************************/
+
+static int tcurses_vt100_writeall(int fd, FAR const char *buffer, size_t buflen)
+{
+  ssize_t nwritten;
+
+  while (buflen > 0)
+    {
+      nwritten = write(fd, buffer, buflen);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      buffer += nwritten;
+      buflen -= nwritten;
+    }
+
+  return OK;
+}
+
+/************************************************************************************
+ * Write any buffered output to the terminal
+ ************************************************************************************/
+
+static int tcurses_vt100_flushbuf(FAR struct tcurses_vt100_s *priv)
+{
+#if CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE > 0
+  int ret = OK;
+
+  if (priv->outlen > 0)
+    {
+      ret = tcurses_vt100_writeall(priv->out_fd, priv->outbuf, priv->outlen);
+      priv->outlen = 0;
+    }
+
+  return ret;
+#else
+  return OK;
+#endif
+}
+
+/************************************************************************************
+ * Queue output for the terminal.  Escape sequences and text are collected in the
+ * output buffer until it fills or the user flushes it, so that a whole screen
+ * update goes out in a few write() calls instead of one per sequence.
+ ************************************************************************************/
+
+static int tcurses_vt100_output(FAR struct tcurses_vt100_s *priv,
+                                FAR const char *buffer, size_t buflen)
+{
+#if CONFIG_SYSTEM_TERMCURSES_OUTBUFSIZE > 0
+  int ret;
+
+  if (priv->outlen + buflen > sizeof(priv->outbuf))
+    {
+      ret = tcurses_vt100_flushbuf(priv);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (buflen > sizeof(priv->outbuf))
+        {
+          return tcurses_vt100_writeall(priv->out_fd, buffer, buflen);
+        }
+    }
+
+  memcpy(&priv->outbuf[priv->outlen], buffer, buflen);
+  priv->outlen += buflen;
+  return OK;
+#else
+  return tcurses_vt100_writeall(priv->out_fd, buffer, buflen);
+#endif
+}
+
+/************************************************************************************
+ * Build a relative cursor motion of count rows or columns.  Positive counts move
+ * in the direction of fwd, negative ones in the direction of back.
+ ************************************************************************************/
+
+static int tcurses_vt100_step(FAR char *str, int count, char fwd, char back)
+{
+  char dir = fwd;
+
+  if (count == 0)
+    {
+      return 0;
+    }
+
+  if (count < 0)
+    {
+      dir   = back;
+      count = -count;
+    }
+
+  if (count == 1)
+    {
+      return sprintf(str, g_movestep, dir);
+    }
+
+  return sprintf(str, g_movesteps, count, dir);
+}
+
+/************************************************************************************
+ * Build a horizontal cursor motion within the current row
+ ************************************************************************************/
+
+static int tcurses_vt100_column(FAR char *str, int from, int to)
+{
+  /* A backspace is the cheapest way to move left by one */
+
+  if (to == from - 1)
+    {
+      str[0] = '\b';
+      return 1;
+    }
+
+  return tcurses_vt100_step(str, to - from, 'C', 'D');
+}
+
+/************************************************************************************
+ * Build the shortest sequence that moves the cursor from its last known position
+ * to row/col and return its length (zero if the cursor is already there).
+ ************************************************************************************/
+
+static int tcurses_vt100_motion(FAR struct tcurses_vt100_s *priv, int row,
+                                int col, FAR char *str)
+{
+  char alt[32];
+  int  len;
+  int  altlen;
+
+  /* An absolute move always works */
+
+  len = sprintf(str, g_movecurs, row + 1, col + 1);
+  if (priv->row < 0)
+    {
+      return len;
+    }
+
+  if (row == priv->row && col == priv->col)
+    {
+      return 0;
+    }
+
+  /* Move relative to the current position */
+
+  altlen  = tcurses_vt100_step(alt, row - priv->row, 'B', 'A');
+  altlen += tcurses_vt100_column(&alt[altlen], priv->col, col);
+  if (altlen < len)
+    {
+      memcpy(str, alt, altlen);
+      len = altlen;
+    }
+
+  /* Return to the first column and move right from there */
+
+  if (col < priv->col)
+    {
+      altlen        = tcurses_vt100_step(alt, row - priv->row, 'B', 'A');
+      alt[altlen++] = '\r';
+      altlen       += tcurses_vt100_column(&alt[altlen], 0, col);
+      if (altlen < len)
+        {
+          memcpy(str, alt, altlen);
+          len = altlen;
+        }
+    }
+
+  return len;
+}
+
 /************************************************************************************
  * Clear screen / line operations
  ************************************************************************************/
@@ -390,41 +602,32 @@ static int tcurses_vt100_clear(FAR struct termcurses_s *dev, int type)
 {
   FAR struct tcurses_vt100_s *priv;
   int ret = -ENOSYS;
-  int fd;
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd = priv->out_fd;
 
   /* Perform operation based on type */
 
   switch (type)
     {
       case TCURS_CLEAR_SCREEN:
-        ret = write(fd, g_clrscr, strlen(g_clrscr));
+        ret = tcurses_vt100_output(priv, g_clrscr, strlen(g_clrscr));
         break;
 
       case TCURS_CLEAR_LINE:
         break;
 
       case TCURS_CLEAR_EOS:
-        ret = write(fd, g_clrscr, strlen(g_clreos));
+        ret = tcurses_vt100_output(priv, g_clreos, strlen(g_clreos));
         break;
 
       case TCURS_CLEAR_EOL:
-        ret = write(fd, g_clrscr, strlen(g_clreol));
+        ret = tcurses_vt100_output(priv, g_clreol, strlen(g_clreol));
         break;
 
       default:
         return -ENOSYS;
     }
 
-  /* If data written successfully, return OK */
-
-  if (ret > 0)
-    {
-      ret = OK;
-    }
-
   return ret;
 }
 
@@ -436,33 +639,38 @@ static int tcurses_vt100_move(FAR struct termcurses_s *dev, int type, int col,
                               int row)
 {
   FAR struct tcurses_vt100_s *priv;
-  int   ret = -ENOSYS;
-  int   fd;
-  char  str[16];
+  int   ret = OK;
+  int   len;
+  char  str[32];
 
   priv = (FAR struct tcurses_vt100_s *)dev;
-  fd   = priv->out_fd;
 
   /* Perform operation based on type */
 
   switch (type)
     {
       case TCURS_MOVE_YX:
-        sprintf(str, g_movecurs, row+1, col+1);
-        ret = write(fd, str, strlen(str));
+        len = tcurses_vt100_motion(priv, row, col, str);
+        if (len > 0)
+          {
+            ret = tcurses_vt100_output(priv, str, len);
+          }
+
+        if (ret == OK)
+          {
+            priv->row = row;
+            priv->col = col;
+          }
+        else
+          {
+            priv->row = -1;
+          }
         break;
 
       default:
         return -ENOSYS;
     }
 
-  /* If bytes written, return OK */
-
-  if (ret > 0)
-    {
-      ret = OK;
-    }
-
   return ret;
 }
 
@@ -561,11 +769,9 @@ static int tcurses_vt100_setcolors(FAR struct termcurses_s *dev,
 {
   FAR struct tcurses_vt100_s *priv;
   int  ret = -ENOSYS;
-  int  fd;
   char str[48];
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd   = priv->out_fd;
 
   /* Test if FG color to be set */
 
@@ -574,7 +780,7 @@ static int tcurses_vt100_setcolors(FAR struct termcurses_s *dev,
       sprintf(str, g_setfgcolor,
               tcurses_vt100_getcolorindex(colors->fg_red, colors->fg_green,
                                           colors->fg_blue));
-      ret = write(fd, str, strlen(str));
+      ret = tcurses_vt100_output(priv, str, strlen(str));
     }
 
   /* Test if BG color to be set */
@@ -589,14 +795,7 @@ static int tcurses_vt100_setcolors(FAR struct termcurses_s *dev,
       sprintf(str, g_setbgcolor,
               tcurses_vt100_getcolorindex(colors->bg_red, colors->bg_green,
                                           colors->bg_blue));
-      ret = write(fd, str, strlen(str));
-    }
-
-  /* If bytes written, return OK */
-
-  if (ret > 0)
-    {
-      ret = OK;
+      ret = tcurses_vt100_output(priv, str, strlen(str));
     }
 
   return ret;
@@ -625,13 +824,24 @@ static int tcurses_vt100_getwinsize(FAR struct termcurses_s *dev,
   ret = ioctl(fd, TIOCGWINSZ, (unsigned long) winsz);
   if (ret == OK)
     {
+      priv->cols = winsz->ws_col;
       return OK;
     }
 
-  /* Write command to get window size */
+  /* Write command to get window size.  Any buffered output must reach the
+   * terminal first, and the query leaves the cursor somewhere unknown.
+   */
+
+  priv->row = -1;
 
-  ret = write(fd, g_getwinsize, strlen(g_getwinsize));
-  if (ret <= 0)
+  ret = tcurses_vt100_flushbuf(priv);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = tcurses_vt100_writeall(fd, g_getwinsize, strlen(g_getwinsize));
+  if (ret < 0)
     {
       return ret;
     }
@@ -682,6 +892,8 @@ static int tcurses_vt100_getwinsize(FAR struct termcurses_s *dev,
                   winsz->ws_col = atoi(&resp[x+1]);
                 }
 
+              priv->cols = winsz->ws_col;
+
               /* Change back to original block/non-block mode */
 
               fcntl(fd, F_SETFL, flags);
@@ -707,12 +919,10 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
                                        unsigned long attrib)
 {
   FAR struct tcurses_vt100_s *priv;
-  int ret;
-  int fd;
   char str[48];
+  bool acs;
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd   = priv->out_fd;
 
   /* Test for cursor hide */
 
@@ -720,16 +930,14 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
     {
       /* Send sequence to hide the cursor */
 
-      ret = write(fd, g_hidecursor, strlen(g_hidecursor));
-      return ret;
+      return tcurses_vt100_output(priv, g_hidecursor, strlen(g_hidecursor));
     }
 
   if (attrib & TCURS_ATTRIB_CURS_SHOW)
     {
       /* Send sequence to hide the cursor */
 
-      ret = write(fd, g_showcursor, strlen(g_showcursor));
-      return ret;
+      return tcurses_vt100_output(priv, g_showcursor, strlen(g_showcursor));
     }
 
   /* Build attribute string */
@@ -763,13 +971,16 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
 
   strcat(str, "m");
 
-  ret = write(fd, str, strlen(str));
-
-  /* If bytes written, return OK */
+  /* Select the line drawing or the ASCII character set */
 
-  ret = (ret > 0) ? OK : -ENOSYS;
+  acs = (attrib & TCURS_ATTRIB_ALTCHARSET) != 0;
+  if (acs != priv->acs)
+    {
+      strcat(str, acs ? g_setacs : g_setascii);
+      priv->acs = acs;
+    }
 
-  return ret;
+  return tcurses_vt100_output(priv, str, strlen(str));
 }
 
 /************************************************************************************
@@ -1104,6 +1315,42 @@ static bool tcurses_vt100_checkkey(FAR struct termcurses_s *dev)
   return false;
 }
 
+/************************************************************************************
+ * Write text at the cursor position
+ ************************************************************************************/
+
+static int tcurses_vt100_write(FAR struct termcurses_s *dev,
+                               FAR const char *buffer, size_t buflen)
+{
+  FAR struct tcurses_vt100_s *priv;
+
+  priv = (FAR struct tcurses_vt100_s *) dev;
+
+  /* The cursor advances with the text.  Once it reaches the right margin the
+   * terminal may or may not have wrapped, so its position is no longer known.
+   */
+
+  if (priv->row >= 0)
+    {
+      priv->col += buflen;
+      if (priv->cols <= 0 || priv->col >= priv->cols)
+        {
+          priv->row = -1;
+        }
+    }
+
+  return tcurses_vt100_output(priv, buffer, buflen);
+}
+
+/************************************************************************************
+ * Send buffered output to the terminal
+ ************************************************************************************/
+
+static int tcurses_vt100_flush(FAR struct termcurses_s *dev)
+{
+  return tcurses_vt100_flushbuf((FAR struct tcurses_vt100_s *) dev);
+}
+
 /************************************************************************************
  * Public Functions
  ************************************************************************************/
@@ -1137,6 +1384,7 @@ FAR struct termcurses_s *tcurses_vt100_initialize(int in_fd, int out_fd)
   priv->in_fd    = in_fd;
   priv->out_fd   = out_fd;
   priv->keycount = 0;
+  priv->row      = -1;
 
   return (FAR struct termcurses_s *) priv;
 }
@@ -153,6 +153,7 @@ int termcurses_deinitterm(FAR struct termcurses_s *dev)
   colors.bg_blue    = 0;
   colors.color_mask = 0xFF;
   termcurses_setcolors(dev, &colors);
+  termcurses_flush(dev);
 
   /* For now, simply free the memory */
 
@@ -294,3 +295,49 @@ bool termcurses_checkkey(FAR struct termcurses_s *term)
 
   return 0;
 }
+
+/************************************************************************************
+ * Name: termcurses_write
+ *
+ * Description:
+ *   Write text at the current cursor position.  Like the other output
+ *   operations, the text may be buffered until termcurses_flush() is called.
+ *
+ ************************************************************************************/
+
+int termcurses_write(FAR struct termcurses_s *term, FAR const char *buffer,
+                     size_t buflen)
+{
+  FAR struct termcurses_dev_s *dev = (FAR struct termcurses_dev_s *) term;
+
+  /* Call the dev function */
+
+  if (dev->ops->write)
+    {
+      return dev->ops->write(term, buffer, buflen);
+    }
+
+  return -ENOSYS;
+}
+
+/************************************************************************************
+ * Name: termcurses_flush
+ *
+ * Description:
+ *   Send all buffered output to the terminal.
+ *
+ ************************************************************************************/
+
+int termcurses_flush(FAR struct termcurses_s *term)
+{
+  FAR struct termcurses_dev_s *dev = (FAR struct termcurses_dev_s *) term;
+
+  /* Call the dev function */
+
+  if (dev->ops->flush)
+    {
+      return dev->ops->flush(term);
+    }
+
+  return OK;
+}
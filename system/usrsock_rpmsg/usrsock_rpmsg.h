@@ -48,8 +48,13 @@
 
 #define USRSOCK_RPMSG_EPT_NAME      "rpmsg-usrsock"
 
+#define USRSOCK_RPMSG_BATCH          126
 #define USRSOCK_RPMSG_DNS_EVENT      127
 
+/* Every message inside a batch starts on a 4 byte boundary */
+
+#define USRSOCK_RPMSG_ALIGN(x)       (((x) + 3) & ~3)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -63,4 +68,23 @@ begin_packed_struct struct usrsock_rpmsg_dns_event_s
   uint16_t addrlen;
 } end_packed_struct;
 
+/* Batch message, several requests, acks or events packed back to back in
+ * one rpmsg buffer.  The header is followed by 'count' records, each one is
+ * a usrsock_rpmsg_record_s and the message itself, padded with
+ * USRSOCK_RPMSG_ALIGN.
+ */
+
+begin_packed_struct struct usrsock_rpmsg_batch_s
+{
+  struct usrsock_message_common_s head;
+
+  uint16_t count;
+} end_packed_struct;
+
+begin_packed_struct struct usrsock_rpmsg_record_s
+{
+  uint16_t len;
+  uint16_t reserved;
+} end_packed_struct;
+
 #endif /* __SYSTEM_USRSOCK_RPMSG_H */
@@ -0,0 +1,397 @@
+/****************************************************************************
+ * apps/system/usrsock_rpmsg/usrsock_rpmsg_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSTEM_USRSOCK_RPMSG_BENCH_PORT
+#  define CONFIG_SYSTEM_USRSOCK_RPMSG_BENCH_PORT 5471
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define BENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define BENCH_CLOCK CLOCK_REALTIME
+#endif
+
+#define BENCH_MAXSIZE 1472
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Both ends of the loopback live on the companion core, every byte crosses
+ * the rpmsg link twice: once as a sendto request and once as a recvfrom
+ * ack.
+ */
+
+struct bench_s
+{
+  bool     tcp;
+  size_t   size;
+  uint32_t count;
+  uint16_t port;
+  int      txsd;
+  int      rxsd;
+  struct sockaddr_in addr;
+  uint32_t sent;
+  int      txerr;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(FAR const char *progname, int exitcode)
+{
+  printf("Usage: %s [-t tcp|udp] [-s <size>] [-n <count>] [-p <port>]\n",
+         progname);
+  printf("  -t  Socket type, default tcp\n");
+  printf("  -s  Bytes per send, default 1024, max %d for udp\n",
+         BENCH_MAXSIZE);
+  printf("  -n  Number of sends, default 1000\n");
+  printf("  -p  Loopback port, default %d\n",
+         CONFIG_SYSTEM_USRSOCK_RPMSG_BENCH_PORT);
+  exit(exitcode);
+}
+
+static uint64_t bench_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(BENCH_CLOCK, &ts);
+  return (uint64_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+
+static FAR void *bench_sender(FAR void *arg)
+{
+  FAR struct bench_s *bench = arg;
+  FAR uint8_t *buf;
+  ssize_t ret;
+  size_t done;
+
+  buf = malloc(bench->size);
+  if (buf == NULL)
+    {
+      bench->txerr = ENOMEM;
+      return NULL;
+    }
+
+  memset(buf, 0xa5, bench->size);
+
+  for (bench->sent = 0; bench->sent < bench->count; bench->sent++)
+    {
+      for (done = 0; done < bench->size; done += ret)
+        {
+          if (bench->tcp)
+            {
+              ret = send(bench->txsd, buf + done, bench->size - done, 0);
+            }
+          else
+            {
+              ret = sendto(bench->txsd, buf + done, bench->size - done, 0,
+                           (FAR struct sockaddr *)&bench->addr,
+                           sizeof(bench->addr));
+            }
+
+          if (ret < 0)
+            {
+              bench->txerr = errno;
+              goto out;
+            }
+        }
+    }
+
+out:
+  free(buf);
+  return NULL;
+}
+
+static int bench_setup(FAR struct bench_s *bench)
+{
+  int lsd = -1;
+  int ret;
+
+  bench->addr.sin_family      = AF_INET;
+  bench->addr.sin_port        = htons(bench->port);
+  bench->addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bench->tcp)
+    {
+      lsd = socket(AF_INET, SOCK_STREAM, 0);
+      if (lsd < 0)
+        {
+          return -errno;
+        }
+
+      ret = bind(lsd, (FAR struct sockaddr *)&bench->addr,
+                 sizeof(bench->addr));
+      if (ret < 0 || listen(lsd, 1) < 0)
+        {
+          goto errout;
+        }
+
+      bench->txsd = socket(AF_INET, SOCK_STREAM, 0);
+      if (bench->txsd < 0)
+        {
+          goto errout;
+        }
+
+      ret = connect(bench->txsd, (FAR struct sockaddr *)&bench->addr,
+                    sizeof(bench->addr));
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      bench->rxsd = accept(lsd, NULL, NULL);
+      if (bench->rxsd < 0)
+        {
+          goto errout;
+        }
+
+      close(lsd);
+    }
+  else
+    {
+      struct timeval tv;
+
+      bench->rxsd = socket(AF_INET, SOCK_DGRAM, 0);
+      bench->txsd = socket(AF_INET, SOCK_DGRAM, 0);
+      if (bench->rxsd < 0 || bench->txsd < 0)
+        {
+          goto errout;
+        }
+
+      ret = bind(bench->rxsd, (FAR struct sockaddr *)&bench->addr,
+                 sizeof(bench->addr));
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      /* Datagrams may be dropped, stop waiting after one idle second */
+
+      tv.tv_sec  = 1;
+      tv.tv_usec = 0;
+      setsockopt(bench->rxsd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+  return OK;
+
+errout:
+  ret = -errno;
+  if (lsd >= 0)
+    {
+      close(lsd);
+    }
+
+  return ret;
+}
+
+static int bench_run(FAR struct bench_s *bench)
+{
+  FAR uint8_t *buf;
+  pthread_t thread;
+  uint64_t total = (uint64_t)bench->size * bench->count;
+  uint64_t received = 0;
+  uint32_t nrecvs = 0;
+  uint64_t start;
+  uint64_t last;
+  uint64_t usec;
+  ssize_t ret = 0;
+
+  buf = malloc(bench->size);
+  if (buf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  start = bench_usec();
+  last  = start;
+
+  ret = pthread_create(&thread, NULL, bench_sender, bench);
+  if (ret != 0)
+    {
+      free(buf);
+      return -ret;
+    }
+
+  while (received < total)
+    {
+      ret = recv(bench->rxsd, buf, bench->size, 0);
+      if (ret <= 0)
+        {
+          break;
+        }
+
+      received += ret;
+      nrecvs++;
+      last = bench_usec();
+    }
+
+  /* Don't count the idle timeout which ends a lossy udp run */
+
+  usec = last - start;
+  pthread_join(thread, NULL);
+  free(buf);
+
+  if (usec == 0)
+    {
+      usec = 1;
+    }
+
+  printf("%s: %lu x %lu bytes, sent %lu, received %llu bytes "
+         "in %lu recvs\n",
+         bench->tcp ? "tcp" : "udp",
+         (unsigned long)bench->count, (unsigned long)bench->size,
+         (unsigned long)bench->sent, (unsigned long long)received,
+         (unsigned long)nrecvs);
+  printf("  %llu usec, %llu KB/s, %llu ops/s\n",
+         (unsigned long long)usec,
+         (unsigned long long)(received * USEC_PER_SEC / 1024 / usec),
+         (unsigned long long)nrecvs * USEC_PER_SEC / usec);
+
+  if (received < total)
+    {
+      printf("  lost %llu bytes%s\n",
+             (unsigned long long)(total - received),
+             bench->txerr ? "" : " (receive timeout)");
+    }
+
+  if (bench->txerr)
+    {
+      printf("  send failed: %d\n", bench->txerr);
+      return -bench->txerr;
+    }
+
+  return received == total || !bench->tcp ? OK : -EIO;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct bench_s bench;
+  int option;
+  int ret;
+
+  memset(&bench, 0, sizeof(bench));
+  bench.tcp   = true;
+  bench.size  = 1024;
+  bench.count = 1000;
+  bench.port  = CONFIG_SYSTEM_USRSOCK_RPMSG_BENCH_PORT;
+  bench.txsd  = -1;
+  bench.rxsd  = -1;
+
+  while ((option = getopt(argc, argv, "t:s:n:p:h")) != ERROR)
+    {
+      switch (option)
+        {
+          case 't':
+            if (strcmp(optarg, "tcp") == 0)
+              {
+                bench.tcp = true;
+              }
+            else if (strcmp(optarg, "udp") == 0)
+              {
+                bench.tcp = false;
+              }
+            else
+              {
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 's':
+            bench.size = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'n':
+            bench.count = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'p':
+            bench.port = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'h':
+            show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          default:
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  if (bench.size == 0 || bench.count == 0 ||
+      (!bench.tcp && bench.size > BENCH_MAXSIZE))
+    {
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+
+  ret = bench_setup(&bench);
+  if (ret < 0)
+    {
+      printf("setup failed: %d\n", ret);
+    }
+  else
+    {
+      ret = bench_run(&bench);
+    }
+
+  if (bench.txsd >= 0)
+    {
+      close(bench.txsd);
+    }
+
+  if (bench.rxsd >= 0)
+    {
+      close(bench.rxsd);
+    }
+
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
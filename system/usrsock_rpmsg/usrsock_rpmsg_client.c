@@ -69,6 +69,9 @@ struct usrsock_rpmsg_s
  * Private Function Prototypes
  ****************************************************************************/
 
+static int usrsock_rpmsg_batch_handler(struct rpmsg_endpoint *ept,
+                                       void *data, size_t len,
+                                       uint32_t src, void *priv);
 static int usrsock_rpmsg_dns_handler(struct rpmsg_endpoint *ept, void *data,
                                      size_t len, uint32_t src, void *priv);
 static int usrsock_rpmsg_default_handler(struct rpmsg_endpoint *ept, void *data,
@@ -117,6 +120,39 @@ static void usrsock_rpmsg_device_destroy(struct rpmsg_device *rdev,
     }
 }
 
+static int usrsock_rpmsg_batch_handler(struct rpmsg_endpoint *ept,
+                                       void *data, size_t len,
+                                       uint32_t src, void *priv)
+{
+  struct usrsock_rpmsg_batch_s *batch = data;
+  struct usrsock_rpmsg_record_s *record;
+  size_t offset = sizeof(*batch);
+  int ret;
+  int i;
+
+  /* Unpack the acks and events, the kernel takes them one by one */
+
+  for (i = 0; i < batch->count; i++)
+    {
+      record = data + offset;
+      if (offset + sizeof(*record) > len ||
+          offset + sizeof(*record) + record->len > len)
+        {
+          return -EINVAL;
+        }
+
+      ret = usrsock_rpmsg_ept_cb(ept, record + 1, record->len, src, priv);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      offset += USRSOCK_RPMSG_ALIGN(sizeof(*record) + record->len);
+    }
+
+  return 0;
+}
+
 static int usrsock_rpmsg_dns_handler(struct rpmsg_endpoint *ept, void *data,
                                      size_t len, uint32_t src, void *priv)
 {
@@ -158,6 +194,9 @@ static int usrsock_rpmsg_ept_cb(struct rpmsg_endpoint *ept, void *data,
 
   switch (common->msgid)
     {
+      case USRSOCK_RPMSG_BATCH:
+        ret = usrsock_rpmsg_batch_handler(ept, data, len, src, priv);
+        break;
       case USRSOCK_RPMSG_DNS_EVENT:
         ret = usrsock_rpmsg_dns_handler(ept, data, len, src, priv);
         break;
@@ -53,6 +53,42 @@
 
 #include "usrsock_rpmsg.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The payload room a stream recvfrom ack asks for at least.  Asking for the
+ * whole max_buflen would never fit behind the messages of an open batch and
+ * so flush it on every call.  A shorter stream read is fine, the rest of the
+ * data is reported by the next POLLIN event.  A datagram is consumed by one
+ * read, so its ack always asks for the whole max_buflen.
+ */
+
+#define USRSOCK_RPMSG_RECV_MIN  256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Per client endpoint.  The lock serializes the access to the TX buffer
+ * between the rpmsg callback, the poll thread and the DNS notifier.  While
+ * 'nesting' is non-zero every ack and event is appended to 'batch' instead
+ * of being sent on its own, the batch goes out when the last user ends it
+ * or when the next message doesn't fit.
+ */
+
+struct usrsock_rpmsg_ept_s
+{
+  struct rpmsg_endpoint         ept;
+  pthread_mutex_t               lock;
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+  int                           nesting;
+  struct usrsock_rpmsg_batch_s *batch;
+  uint32_t                      size;
+  uint32_t                      len;
+#endif
+};
+
 struct usrsock_rpmsg_s
 {
   pid_t                 pid;
@@ -67,6 +103,13 @@ struct usrsock_rpmsg_s
  * Private Function Prototypes
  ****************************************************************************/
 
+static void usrsock_rpmsg_batch_begin(struct rpmsg_endpoint *ept);
+static int usrsock_rpmsg_batch_end(struct rpmsg_endpoint *ept);
+static void *usrsock_rpmsg_get_tx_buffer(struct rpmsg_endpoint *ept,
+                                         uint32_t want, uint32_t *len);
+static int usrsock_rpmsg_send_nocopy(struct rpmsg_endpoint *ept,
+                                     void *data, uint32_t len);
+
 static int usrsock_rpmsg_send_ack(struct rpmsg_endpoint *ept,
                                   uint8_t xid, int32_t result);
 static int usrsock_rpmsg_send_data_ack(struct rpmsg_endpoint *ept,
@@ -119,6 +162,11 @@ static int usrsock_rpmsg_ioctl_handler(struct rpmsg_endpoint *ept,
 static void usrsock_rpmsg_ns_bind(struct rpmsg_device *rdev, void *priv_,
                                   const char *name, uint32_t dest);
 static void usrsock_rpmsg_ns_unbind(struct rpmsg_endpoint *ept);
+static int usrsock_rpmsg_dispatch(struct rpmsg_endpoint *ept, void *data,
+                                  size_t len, uint32_t src, void *priv);
+static int usrsock_rpmsg_batch_handler(struct rpmsg_endpoint *ept,
+                                       void *data, size_t len,
+                                       uint32_t src, void *priv);
 static int usrsock_rpmsg_ept_cb(struct rpmsg_endpoint *ept, void *data,
                                 size_t len, uint32_t src, void *priv);
 
@@ -152,18 +200,161 @@ static const rpmsg_ept_cb g_usrsock_rpmsg_handler[] =
  * Private Functions
  ****************************************************************************/
 
+static void usrsock_rpmsg_batch_begin(struct rpmsg_endpoint *ept)
+{
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+  struct usrsock_rpmsg_ept_s *uept = (struct usrsock_rpmsg_ept_s *)ept;
+
+  pthread_mutex_lock(&uept->lock);
+  uept->nesting++;
+  pthread_mutex_unlock(&uept->lock);
+#endif
+}
+
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+static int usrsock_rpmsg_batch_flush(struct usrsock_rpmsg_ept_s *uept)
+{
+  int ret = 0;
+
+  if (uept->batch != NULL)
+    {
+      ret = rpmsg_send_nocopy(&uept->ept, uept->batch, uept->len);
+      uept->batch = NULL;
+    }
+
+  return ret;
+}
+#endif
+
+static int usrsock_rpmsg_batch_end(struct rpmsg_endpoint *ept)
+{
+  int ret = 0;
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+  struct usrsock_rpmsg_ept_s *uept = (struct usrsock_rpmsg_ept_s *)ept;
+
+  pthread_mutex_lock(&uept->lock);
+  if (--uept->nesting == 0)
+    {
+      ret = usrsock_rpmsg_batch_flush(uept);
+    }
+
+  pthread_mutex_unlock(&uept->lock);
+#endif
+
+  return ret;
+}
+
+/* Reserve room for one outgoing message of at least 'want' bytes, '*len'
+ * returns the real room.  The lock is kept until the buffer is handed to
+ * usrsock_rpmsg_send_nocopy, so the caller can fill it in place without
+ * another message sneaking into the same batch.
+ */
+
+static void *usrsock_rpmsg_get_tx_buffer(struct rpmsg_endpoint *ept,
+                                         uint32_t want, uint32_t *len)
+{
+  struct usrsock_rpmsg_ept_s *uept = (struct usrsock_rpmsg_ept_s *)ept;
+  void *buf;
+
+  pthread_mutex_lock(&uept->lock);
+
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+  if (uept->nesting > 0)
+    {
+      struct usrsock_rpmsg_record_s *record;
+
+      want += sizeof(*record);
+      if (uept->batch != NULL && uept->len + want > uept->size)
+        {
+          usrsock_rpmsg_batch_flush(uept);
+        }
+
+      if (uept->batch == NULL)
+        {
+          uept->batch = rpmsg_get_tx_payload_buffer(ept, &uept->size, true);
+          if (uept->batch == NULL)
+            {
+              pthread_mutex_unlock(&uept->lock);
+              return NULL;
+            }
+
+          uept->batch->head.msgid = USRSOCK_RPMSG_BATCH;
+          uept->batch->head.flags = 0;
+          uept->batch->count      = 0;
+          uept->len               = sizeof(*uept->batch);
+        }
+
+      record = (void *)uept->batch + uept->len;
+      *len   = uept->size - uept->len - sizeof(*record);
+      return record + 1;
+    }
+#endif
+
+  buf = rpmsg_get_tx_payload_buffer(ept, len, true);
+  if (buf == NULL)
+    {
+      pthread_mutex_unlock(&uept->lock);
+    }
+
+  return buf;
+}
+
+static int usrsock_rpmsg_send_nocopy(struct rpmsg_endpoint *ept,
+                                     void *data, uint32_t len)
+{
+  struct usrsock_rpmsg_ept_s *uept = (struct usrsock_rpmsg_ept_s *)ept;
+  int ret;
+
+  if (data == NULL)
+    {
+      return -ENOMEM;
+    }
+
+#ifdef CONFIG_SYSTEM_USRSOCK_RPMSG_BATCH
+  if (uept->batch != NULL)
+    {
+      struct usrsock_rpmsg_record_s *record = data;
+
+      record--;
+      record->len      = len;
+      record->reserved = 0;
+
+      uept->len += USRSOCK_RPMSG_ALIGN(sizeof(*record) + len);
+      if (uept->len > uept->size)
+        {
+          uept->len = uept->size;
+        }
+
+      uept->batch->count++;
+      pthread_mutex_unlock(&uept->lock);
+      return len;
+    }
+#endif
+
+  ret = rpmsg_send_nocopy(ept, data, len);
+  pthread_mutex_unlock(&uept->lock);
+  return ret;
+}
+
 static int usrsock_rpmsg_send_ack(struct rpmsg_endpoint *ept,
                                   uint8_t xid, int32_t result)
 {
-  struct usrsock_message_req_ack_s ack;
+  struct usrsock_message_req_ack_s *ack;
+  uint32_t len;
 
-  ack.head.msgid = USRSOCK_MESSAGE_RESPONSE_ACK;
-  ack.head.flags = (result == -EINPROGRESS);
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack), &len);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack.xid    = xid;
-  ack.result = result;
+  ack->head.msgid = USRSOCK_MESSAGE_RESPONSE_ACK;
+  ack->head.flags = (result == -EINPROGRESS);
 
-  return rpmsg_send(ept, &ack, sizeof(ack));
+  ack->xid    = xid;
+  ack->result = result;
+
+  return usrsock_rpmsg_send_nocopy(ept, ack, sizeof(*ack));
 }
 
 static int usrsock_rpmsg_send_data_ack(struct rpmsg_endpoint *ept,
@@ -192,21 +383,29 @@ static int usrsock_rpmsg_send_data_ack(struct rpmsg_endpoint *ept,
   ack->valuelen          = valuelen;
   ack->valuelen_nontrunc = valuelen_nontrunc;
 
-  return rpmsg_send_nocopy(ept, ack, sizeof(*ack) + valuelen + result);
+  return usrsock_rpmsg_send_nocopy(ept, ack,
+                                   sizeof(*ack) + valuelen + result);
 }
 
 static int usrsock_rpmsg_send_event(struct rpmsg_endpoint *ept,
                                     int16_t usockid, uint16_t events)
 {
-  struct usrsock_message_socket_event_s event;
+  struct usrsock_message_socket_event_s *event;
+  uint32_t len;
+
+  event = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*event), &len);
+  if (event == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  event.head.msgid = USRSOCK_MESSAGE_SOCKET_EVENT;
-  event.head.flags = USRSOCK_MESSAGE_FLAG_EVENT;
+  event->head.msgid = USRSOCK_MESSAGE_SOCKET_EVENT;
+  event->head.flags = USRSOCK_MESSAGE_FLAG_EVENT;
 
-  event.usockid = usockid;
-  event.events  = events;
+  event->usockid = usockid;
+  event->events  = events;
 
-  return rpmsg_send(ept, &event, sizeof(event));
+  return usrsock_rpmsg_send_nocopy(ept, event, sizeof(*event));
 }
 
 static int usrsock_rpmsg_socket_handler(struct rpmsg_endpoint *ept,
@@ -381,13 +580,28 @@ static int usrsock_rpmsg_recvfrom_handler(struct rpmsg_endpoint *ept,
   socklen_t outaddrlen = req->max_addrlen;
   socklen_t inaddrlen = req->max_addrlen;
   size_t buflen = req->max_buflen;
+  size_t want = buflen;
   ssize_t ret = -EBADF;
+  uint32_t size;
   int retr;
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
-  if (sizeof(*ack) + inaddrlen + buflen > len)
+  if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS &&
+      priv->socks[req->usockid].s_type == SOCK_STREAM &&
+      want > USRSOCK_RPMSG_RECV_MIN)
     {
-      buflen = len - sizeof(*ack) - inaddrlen;
+      want = USRSOCK_RPMSG_RECV_MIN;
+    }
+
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack) + inaddrlen + want,
+                                    &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (sizeof(*ack) + inaddrlen + buflen > size)
+    {
+      buflen = size - sizeof(*ack) - inaddrlen;
     }
 
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
@@ -442,8 +656,14 @@ static int usrsock_rpmsg_getsockopt_handler(struct rpmsg_endpoint *ept,
   struct usrsock_rpmsg_s *priv = priv_;
   socklen_t optlen = req->max_valuelen;
   int ret = -EBADF;
+  uint32_t size;
+
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack) + optlen, &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
     {
       ret = psock_getsockopt(&priv->socks[req->usockid],
@@ -464,8 +684,14 @@ static int usrsock_rpmsg_getsockname_handler(struct rpmsg_endpoint *ept,
   socklen_t outaddrlen = req->max_addrlen;
   socklen_t inaddrlen = req->max_addrlen;
   int ret = -EBADF;
+  uint32_t size;
+
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack) + inaddrlen, &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
     {
       ret = psock_getsockname(&priv->socks[req->usockid],
@@ -486,8 +712,14 @@ static int usrsock_rpmsg_getpeername_handler(struct rpmsg_endpoint *ept,
   socklen_t outaddrlen = req->max_addrlen;
   socklen_t inaddrlen = req->max_addrlen;
   int ret = -EBADF;
+  uint32_t size;
+
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack) + inaddrlen, &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
     {
       ret = psock_getpeername(&priv->socks[req->usockid],
@@ -552,10 +784,17 @@ static int usrsock_rpmsg_accept_handler(struct rpmsg_endpoint *ept,
   socklen_t outaddrlen = req->max_addrlen;
   socklen_t inaddrlen = req->max_addrlen;
   int i = 0;
+  uint32_t size;
   int retr;
   int ret = -EBADF;
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
+  ack = usrsock_rpmsg_get_tx_buffer(ept,
+          sizeof(*ack) + inaddrlen + sizeof(int16_t), &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
+
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
     {
       ret = -ENFILE; /* Assume no free socket handler */
@@ -625,8 +864,14 @@ static int usrsock_rpmsg_ioctl_handler(struct rpmsg_endpoint *ept,
   struct usrsock_message_datareq_ack_s *ack;
   struct usrsock_rpmsg_s *priv = priv_;
   int ret = -EBADF;
+  uint32_t size;
+
+  ack = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*ack) + req->arglen, &size);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
   if (req->usockid >= 0 && req->usockid < CONFIG_NSOCKET_DESCRIPTORS)
     {
       memcpy(ack + 1, req + 1, req->arglen);
@@ -647,7 +892,11 @@ static int usrsock_rpmsg_send_dns_event(void *arg,
   struct usrsock_rpmsg_dns_event_s *dns;
   uint32_t len;
 
-  dns = rpmsg_get_tx_payload_buffer(ept, &len, true);
+  dns = usrsock_rpmsg_get_tx_buffer(ept, sizeof(*dns) + addrlen, &len);
+  if (dns == NULL)
+    {
+      return -ENOMEM;
+    }
 
   dns->head.msgid = USRSOCK_RPMSG_DNS_EVENT;
   dns->head.flags = USRSOCK_MESSAGE_FLAG_EVENT;
@@ -655,7 +904,7 @@ static int usrsock_rpmsg_send_dns_event(void *arg,
   dns->addrlen = addrlen;
   memcpy(dns + 1, addr, addrlen);
 
-  return rpmsg_send_nocopy(ept, dns, sizeof(*dns) + addrlen);
+  return usrsock_rpmsg_send_nocopy(ept, dns, sizeof(*dns) + addrlen);
 }
 #endif
 
@@ -663,6 +912,7 @@ static void usrsock_rpmsg_ns_bind(struct rpmsg_device *rdev, void *priv_,
                                   const char *name, uint32_t dest)
 {
   struct usrsock_rpmsg_s *priv = priv_;
+  struct usrsock_rpmsg_ept_s *uept;
   struct rpmsg_endpoint *ept;
   int ret;
 
@@ -671,12 +921,15 @@ static void usrsock_rpmsg_ns_bind(struct rpmsg_device *rdev, void *priv_,
       return;
     }
 
-  ept = zalloc(sizeof(struct rpmsg_endpoint));
-  if (!ept)
+  uept = zalloc(sizeof(struct usrsock_rpmsg_ept_s));
+  if (!uept)
     {
       return;
     }
 
+  pthread_mutex_init(&uept->lock, NULL);
+
+  ept = &uept->ept;
   ept->priv = priv;
 
   ret = rpmsg_create_ept(ept, rdev, USRSOCK_RPMSG_EPT_NAME,
@@ -684,7 +937,8 @@ static void usrsock_rpmsg_ns_bind(struct rpmsg_device *rdev, void *priv_,
                          usrsock_rpmsg_ept_cb, usrsock_rpmsg_ns_unbind);
   if (ret)
     {
-      free(ept);
+      pthread_mutex_destroy(&uept->lock);
+      free(uept);
       return;
     }
 
@@ -695,6 +949,7 @@ static void usrsock_rpmsg_ns_bind(struct rpmsg_device *rdev, void *priv_,
 
 static void usrsock_rpmsg_ns_unbind(struct rpmsg_endpoint *ept)
 {
+  struct usrsock_rpmsg_ept_s *uept = (struct usrsock_rpmsg_ept_s *)ept;
   struct usrsock_rpmsg_s *priv = ept->priv;
   struct socket *socks[CONFIG_NSOCKET_DESCRIPTORS];
   int count = 0;
@@ -731,10 +986,12 @@ static void usrsock_rpmsg_ns_unbind(struct rpmsg_endpoint *ept)
     }
 
   rpmsg_destroy_ept(ept);
+  pthread_mutex_destroy(&uept->lock);
+  free(uept);
 }
 
-static int usrsock_rpmsg_ept_cb(struct rpmsg_endpoint *ept, void *data,
-                                size_t len, uint32_t src, void *priv)
+static int usrsock_rpmsg_dispatch(struct rpmsg_endpoint *ept, void *data,
+                                  size_t len, uint32_t src, void *priv)
 {
   struct usrsock_request_common_s *common = data;
 
@@ -747,6 +1004,64 @@ static int usrsock_rpmsg_ept_cb(struct rpmsg_endpoint *ept, void *data,
   return -EINVAL;
 }
 
+static int usrsock_rpmsg_batch_handler(struct rpmsg_endpoint *ept,
+                                       void *data, size_t len,
+                                       uint32_t src, void *priv)
+{
+  struct usrsock_rpmsg_batch_s *batch = data;
+  struct usrsock_rpmsg_record_s *record;
+  size_t offset = sizeof(*batch);
+  int ret = 0;
+  int retr;
+  int i;
+
+  /* Every request gets its ack even if an earlier one failed */
+
+  for (i = 0; i < batch->count; i++)
+    {
+      record = data + offset;
+      if (offset + sizeof(*record) > len ||
+          offset + sizeof(*record) + record->len > len)
+        {
+          return -EINVAL;
+        }
+
+      retr = usrsock_rpmsg_dispatch(ept, record + 1, record->len, src, priv);
+      if (retr < 0 && ret >= 0)
+        {
+          ret = retr;
+        }
+
+      offset += USRSOCK_RPMSG_ALIGN(sizeof(*record) + record->len);
+    }
+
+  return ret;
+}
+
+static int usrsock_rpmsg_ept_cb(struct rpmsg_endpoint *ept, void *data,
+                                size_t len, uint32_t src, void *priv)
+{
+  struct usrsock_request_common_s *common = data;
+  int retr;
+  int ret;
+
+  /* Collect all acks and events generated by this message into one */
+
+  usrsock_rpmsg_batch_begin(ept);
+
+  if (common->reqid == USRSOCK_RPMSG_BATCH)
+    {
+      ret = usrsock_rpmsg_batch_handler(ept, data, len, src, priv);
+    }
+  else
+    {
+      ret = usrsock_rpmsg_dispatch(ept, data, len, src, priv);
+    }
+
+  retr = usrsock_rpmsg_batch_end(ept);
+  return ret < 0 ? ret : retr;
+}
+
 static int usrsock_rpmsg_prepare_poll(struct usrsock_rpmsg_s *priv,
                                       struct pollfd *pfds)
 {
@@ -776,6 +1091,10 @@ static int usrsock_rpmsg_prepare_poll(struct usrsock_rpmsg_s *priv,
 static void usrsock_rpmsg_process_poll(struct usrsock_rpmsg_s *priv,
                                        struct pollfd *pfds, int count)
 {
+  struct rpmsg_endpoint *epts[CONFIG_NSOCKET_DESCRIPTORS];
+  uint16_t evmasks[CONFIG_NSOCKET_DESCRIPTORS];
+  int16_t usockids[CONFIG_NSOCKET_DESCRIPTORS];
+  int nevents = 0;
   int i;
   int j;
 
@@ -817,12 +1136,33 @@ static void usrsock_rpmsg_process_poll(struct usrsock_rpmsg_s *priv,
 
           if (events != 0)
             {
-              usrsock_rpmsg_send_event(priv->epts[j], j, events);
+              epts[nevents]       = priv->epts[j];
+              usockids[nevents]   = j;
+              evmasks[nevents++]  = events;
             }
         }
 
       pthread_mutex_unlock(&priv->mutex);
     }
+
+  /* Send the events outside the mutex, so the whole round goes out in one
+   * message per client.
+   */
+
+  for (i = 0; i < nevents; i++)
+    {
+      usrsock_rpmsg_batch_begin(epts[i]);
+    }
+
+  for (i = 0; i < nevents; i++)
+    {
+      usrsock_rpmsg_send_event(epts[i], usockids[i], evmasks[i]);
+    }
+
+  for (i = 0; i < nevents; i++)
+    {
+      usrsock_rpmsg_batch_end(epts[i]);
+    }
 }
 
 /****************************************************************************
@@ -39,6 +39,10 @@
 #include <crc32.h>
 #include <debug.h>
 
+#ifdef CONFIG_TESTING_FSTEST_BENCH
+#  include "fsutils/fsbench.h"
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -936,6 +940,16 @@ int main(int argc, FAR char *argv[])
   unsigned int i;
   int ret;
 
+#ifdef CONFIG_TESTING_FSTEST_BENCH
+  /* Any command line argument selects the benchmark */
+
+  if (argc > 1)
+    {
+      return fsbench_main(CONFIG_TESTING_FSTEST_MOUNTPT,
+                          CONFIG_TESTING_FSTEST_MOUNTPT, argc, argv);
+    }
+#endif
+
   /* Seed the random number generated */
 
   srand(0x93846);
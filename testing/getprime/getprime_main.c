@@ -48,8 +48,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <time.h>
+#include <errno.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -59,6 +63,66 @@
 #define PRIME_RUNS  10
 #define MAX_THREADS 8
 
+/* Configuration of the segmented sieve benchmark */
+
+#ifndef CONFIG_TESTING_GETPRIME_SIEVE_RANGE
+#  define CONFIG_TESTING_GETPRIME_SIEVE_RANGE 2000000
+#endif
+
+#ifndef CONFIG_TESTING_GETPRIME_SIEVE_SEGMENT
+#  define CONFIG_TESTING_GETPRIME_SIEVE_SEGMENT 16384
+#endif
+
+#ifndef CONFIG_TESTING_GETPRIME_SIEVE_STACKSIZE
+#  define CONFIG_TESTING_GETPRIME_SIEVE_STACKSIZE 2048
+#endif
+
+#if defined(CONFIG_SMP) && CONFIG_SMP_NCPUS > 1
+#  define SIEVE_NCPUS CONFIG_SMP_NCPUS
+#else
+#  define SIEVE_NCPUS 1
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define SIEVE_CLOCK CLOCK_MONOTONIC
+#else
+#  define SIEVE_CLOCK CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Parameters and shared state of one sieve run */
+
+struct sieve_s
+{
+  uint32_t range;                  /* Count primes below this value */
+  uint32_t segsize;                /* Numbers per segment (even) */
+  uint32_t nsegs;                  /* Number of segments in the range */
+  uint32_t batch;                  /* Segments claimed at once (dynamic) */
+  bool dynamic;                    /* Chunked dynamic vs. static schedule */
+  bool affinity;                   /* Pin worker i to CPU i % NCPUS */
+  int nthreads;                    /* Workers in the current run */
+
+  FAR const uint32_t *bprimes;     /* Odd base primes <= sqrt(range) */
+  uint32_t nbprimes;
+
+  pthread_mutex_t lock;            /* Protects 'next' */
+  uint32_t next;                   /* Next unclaimed segment */
+};
+
+/* Per worker results */
+
+struct sieve_worker_s
+{
+  FAR struct sieve_s *sieve;
+  int id;
+  uint32_t count;                  /* Primes found by this worker */
+  uint32_t last;                   /* Largest prime found */
+  uint32_t nsegs;                  /* Segments processed */
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -131,6 +195,7 @@ static FAR void *thread_func(FAR void *param)
 static void get_prime_in_parallel(int n)
 {
   pthread_t thread[MAX_THREADS];
+  int id[MAX_THREADS];
   struct sched_param sparam;
   pthread_attr_t attr;
   pthread_addr_t result;
@@ -154,18 +219,542 @@ static void get_prime_in_parallel(int n)
   for (i = 0; i < n; i++)
     {
       printf("Start thread #%d \n", i);
+      id[i]  = i;
       status = pthread_create(&thread[i], &attr,
-                              thread_func, (FAR void *)&i);
+                              thread_func, (FAR void *)&id[i]);
       ASSERT(status == OK);
     }
 
-  /* Wait for finishing the last thread */
+  /* Wait for all threads to finish */
 
-  pthread_join(thread[n - 1], &result);
+  for (i = 0; i < n; i++)
+    {
+      pthread_join(thread[i], &result);
+    }
 
   printf("Done\n");
 }
 
+/****************************************************************************
+ * Name: sieve_gettime
+ ****************************************************************************/
+
+static uint64_t sieve_gettime(void)
+{
+  struct timespec ts;
+
+  clock_gettime(SIEVE_CLOCK, &ts);
+  return (uint64_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+
+/****************************************************************************
+ * Name: sieve_baseprimes
+ *
+ * Description:
+ *   Return the odd primes up to sqrt(range) using a plain sieve.  These are
+ *   shared read-only by all workers.
+ *
+ ****************************************************************************/
+
+static FAR uint32_t *sieve_baseprimes(uint32_t range, FAR uint32_t *nprimes)
+{
+  FAR uint32_t *primes;
+  FAR uint8_t *composite;
+  uint32_t limit = 1;
+  uint32_t n = 0;
+  uint32_t i;
+  uint32_t j;
+
+  while ((uint64_t)(limit + 1) * (limit + 1) <= range)
+    {
+      limit++;
+    }
+
+  composite = zalloc(limit + 1);
+  primes    = malloc((limit / 2 + 1) * sizeof(uint32_t));
+  if (composite == NULL || primes == NULL)
+    {
+      free(composite);
+      free(primes);
+      return NULL;
+    }
+
+  for (i = 3; i <= limit; i += 2)
+    {
+      if (!composite[i])
+        {
+          primes[n++] = i;
+          for (j = i * i; j <= limit; j += 2 * i)
+            {
+              composite[j] = 1;
+            }
+        }
+    }
+
+  free(composite);
+  *nprimes = n;
+  return primes;
+}
+
+/****************************************************************************
+ * Name: sieve_segment
+ *
+ * Description:
+ *   Sieve the odd numbers of segment 'seg' using the base primes.  'mark'
+ *   holds segsize / 2 bytes, one per odd number.
+ *
+ ****************************************************************************/
+
+static void sieve_segment(FAR struct sieve_worker_s *worker,
+                          FAR uint8_t *mark, uint32_t seg)
+{
+  FAR struct sieve_s *sieve = worker->sieve;
+  uint32_t lo = seg * sieve->segsize;
+  uint32_t hi = lo + sieve->segsize;
+  uint32_t nodd;
+  uint32_t i;
+
+  if (hi > sieve->range || hi < lo)
+    {
+      hi = sieve->range;
+    }
+
+  /* Index j stands for the odd number lo + 2 * j + 1 ('lo' is even) */
+
+  nodd = (hi - lo) / 2;
+  memset(mark, 0, nodd);
+
+  for (i = 0; i < sieve->nbprimes; i++)
+    {
+      uint32_t p = sieve->bprimes[i];
+      uint64_t start = (uint64_t)p * p;
+      uint64_t n;
+
+      if (start >= hi)
+        {
+          break;
+        }
+
+      if (start < lo)
+        {
+          start = ((uint64_t)lo + p - 1) / p * p;
+          if ((start & 1) == 0)
+            {
+              start += p;
+            }
+        }
+
+      for (n = start; n < hi; n += 2 * p)
+        {
+          mark[(n - lo - 1) / 2] = 1;
+        }
+    }
+
+  /* 1 is not prime; 2 is accounted for by the caller */
+
+  for (i = lo == 0 ? 1 : 0; i < nodd; i++)
+    {
+      if (!mark[i])
+        {
+          worker->count++;
+          worker->last = lo + 2 * i + 1;
+        }
+    }
+
+  worker->nsegs++;
+}
+
+/****************************************************************************
+ * Name: sieve_claim
+ *
+ * Description:
+ *   Claim the next batch of segments.  Returns the number of segments
+ *   claimed (zero when the range is exhausted).
+ *
+ ****************************************************************************/
+
+static uint32_t sieve_claim(FAR struct sieve_s *sieve, FAR uint32_t *first)
+{
+  uint32_t n;
+
+  pthread_mutex_lock(&sieve->lock);
+  *first = sieve->next;
+  n      = sieve->nsegs - sieve->next;
+  if (n > sieve->batch)
+    {
+      n = sieve->batch;
+    }
+
+  sieve->next += n;
+  pthread_mutex_unlock(&sieve->lock);
+  return n;
+}
+
+/****************************************************************************
+ * Name: sieve_thread
+ ****************************************************************************/
+
+static FAR void *sieve_thread(FAR void *param)
+{
+  FAR struct sieve_worker_s *worker = (FAR struct sieve_worker_s *)param;
+  FAR struct sieve_s *sieve = worker->sieve;
+  FAR uint8_t *mark;
+  uint32_t first;
+  uint32_t n;
+  uint32_t seg;
+
+  mark = malloc(sieve->segsize / 2);
+  if (mark == NULL)
+    {
+      return (FAR void *)-ENOMEM;
+    }
+
+  if (sieve->dynamic)
+    {
+      /* Chunked self-scheduling: idle workers keep pulling batches from
+       * the shared counter, so faster CPUs naturally take more work.
+       */
+
+      while ((n = sieve_claim(sieve, &first)) > 0)
+        {
+          for (seg = first; seg < first + n; seg++)
+            {
+              sieve_segment(worker, mark, seg);
+            }
+        }
+    }
+  else
+    {
+      /* Static round-robin partition */
+
+      for (seg = worker->id; seg < sieve->nsegs; seg += sieve->nthreads)
+        {
+          sieve_segment(worker, mark, seg);
+        }
+    }
+
+  free(mark);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: sieve_run
+ *
+ * Description:
+ *   Run the sieve once with 'nthreads' workers.  Returns the elapsed time
+ *   in microseconds, or a negated errno value.
+ *
+ ****************************************************************************/
+
+static int64_t sieve_run(FAR struct sieve_s *sieve,
+                         FAR struct sieve_worker_s *workers, int nthreads,
+                         FAR uint32_t *count, FAR uint32_t *last)
+{
+  pthread_t thread[MAX_THREADS];
+  pthread_attr_t attr;
+  FAR void *result;
+  uint64_t start;
+  uint64_t elapsed;
+  int ret = OK;
+  int status;
+  int i;
+
+  sieve->nthreads = nthreads;
+  sieve->next     = 0;
+  memset(workers, 0, nthreads * sizeof(struct sieve_worker_s));
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_TESTING_GETPRIME_SIEVE_STACKSIZE);
+
+  start = sieve_gettime();
+
+  for (i = 0; i < nthreads; i++)
+    {
+      workers[i].sieve = sieve;
+      workers[i].id    = i;
+
+#if defined(CONFIG_SMP) && CONFIG_SMP_NCPUS > 1
+      if (sieve->affinity)
+        {
+          cpu_set_t cpuset;
+
+          CPU_ZERO(&cpuset);
+          CPU_SET(i % SIEVE_NCPUS, &cpuset);
+          pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+        }
+#endif
+
+      status = pthread_create(&thread[i], &attr, sieve_thread, &workers[i]);
+      if (status != 0)
+        {
+          printf("ERROR: pthread_create failed: %d\n", status);
+          ret = -status;
+          break;
+        }
+    }
+
+  nthreads = i;
+  for (i = 0; i < nthreads; i++)
+    {
+      pthread_join(thread[i], &result);
+      if (result != NULL)
+        {
+          ret = (int)(intptr_t)result;
+        }
+    }
+
+  elapsed = sieve_gettime() - start;
+  pthread_attr_destroy(&attr);
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  *count = sieve->range > 2 ? 1 : 0;
+  *last  = sieve->range > 2 ? 2 : 0;
+
+  for (i = 0; i < nthreads; i++)
+    {
+      *count += workers[i].count;
+      if (workers[i].last > *last)
+        {
+          *last = workers[i].last;
+        }
+    }
+
+  return (int64_t)elapsed;
+}
+
+/****************************************************************************
+ * Name: sieve_usage
+ ****************************************************************************/
+
+static void sieve_usage(FAR const char *progname)
+{
+  printf("Usage: %s [<nthreads>]\n", progname);
+  printf("       %s -s [-n <maxthreads>] [-r <range>] [-g <segsize>] "
+         "[-c <batch>] [-k <repeat>] [-m static|dynamic] [-a]\n",
+         progname);
+  printf("\n<nthreads> runs the original trial division test in "
+         "1-%d threads.\n", MAX_THREADS);
+  printf("-s runs the segmented sieve SMP scaling benchmark:\n");
+  printf("  -n Measure with 1..<maxthreads> threads (default %d)\n",
+         SIEVE_NCPUS);
+  printf("  -r Count primes below <range> (default %d)\n",
+         CONFIG_TESTING_GETPRIME_SIEVE_RANGE);
+  printf("  -g Numbers per segment (default %d)\n",
+         CONFIG_TESTING_GETPRIME_SIEVE_SEGMENT);
+  printf("  -c Segments claimed per scheduling step (default 1)\n");
+  printf("  -k Runs per thread count, best time is kept (default 3)\n");
+  printf("  -m Segment schedule (default dynamic)\n");
+#if defined(CONFIG_SMP) && CONFIG_SMP_NCPUS > 1
+  printf("  -a Pin worker i to CPU i %% %d\n", SIEVE_NCPUS);
+#endif
+}
+
+/****************************************************************************
+ * Name: sieve_main
+ *
+ * Description:
+ *   Run the sieve for 1..maxthreads workers and report speedup and
+ *   parallel efficiency relative to the single threaded run.
+ *
+ ****************************************************************************/
+
+static int sieve_main(int argc, FAR char *argv[])
+{
+  FAR struct sieve_worker_s *workers;
+  FAR uint32_t *bprimes;
+  struct sieve_s sieve;
+  uint64_t base = 0;
+  uint32_t refcount = 0;
+  FAR char *endp;
+  int maxthreads = SIEVE_NCPUS;
+  int repeat = 3;
+  int option;
+  int ret = EXIT_SUCCESS;
+  int n;
+  int i;
+
+  memset(&sieve, 0, sizeof(sieve));
+  sieve.range   = CONFIG_TESTING_GETPRIME_SIEVE_RANGE;
+  sieve.segsize = CONFIG_TESTING_GETPRIME_SIEVE_SEGMENT;
+  sieve.batch   = 1;
+  sieve.dynamic = true;
+
+  while ((option = getopt(argc, argv, "sn:r:g:c:k:m:a")) != ERROR)
+    {
+      switch (option)
+        {
+          case 's':
+            break;
+
+          case 'n':
+            maxthreads = (int)strtol(optarg, &endp, 10);
+            if (*endp != '\0' || maxthreads < 1 || maxthreads > MAX_THREADS)
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'r':
+            sieve.range = (uint32_t)strtoul(optarg, &endp, 10);
+            if (*endp != '\0' || sieve.range < 3)
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'g':
+            sieve.segsize = (uint32_t)strtoul(optarg, &endp, 10) & ~1;
+            if (*endp != '\0' || sieve.segsize < 2)
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'c':
+            sieve.batch = (uint32_t)strtoul(optarg, &endp, 10);
+            if (*endp != '\0' || sieve.batch < 1)
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'k':
+            repeat = (int)strtol(optarg, &endp, 10);
+            if (*endp != '\0' || repeat < 1)
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'm':
+            if (strcmp(optarg, "static") == 0)
+              {
+                sieve.dynamic = false;
+              }
+            else if (strcmp(optarg, "dynamic") == 0)
+              {
+                sieve.dynamic = true;
+              }
+            else
+              {
+                goto errout_with_usage;
+              }
+            break;
+
+          case 'a':
+            sieve.affinity = true;
+            break;
+
+          default:
+            goto errout_with_usage;
+        }
+    }
+
+  sieve.nsegs = (sieve.range + sieve.segsize - 1) / sieve.segsize;
+
+  bprimes = sieve_baseprimes(sieve.range, &sieve.nbprimes);
+  workers = malloc(maxthreads * sizeof(struct sieve_worker_s));
+  if (bprimes == NULL || workers == NULL)
+    {
+      printf("ERROR: Out of memory\n");
+      free(bprimes);
+      free(workers);
+      return EXIT_FAILURE;
+    }
+
+  sieve.bprimes = bprimes;
+  pthread_mutex_init(&sieve.lock, NULL);
+
+  printf("Sieve: range %lu, %lu segments of %lu, %s schedule",
+         (unsigned long)sieve.range, (unsigned long)sieve.nsegs,
+         (unsigned long)sieve.segsize,
+         sieve.dynamic ? "dynamic" : "static");
+  if (sieve.dynamic)
+    {
+      printf(" (batch %lu)", (unsigned long)sieve.batch);
+    }
+
+  printf("%s, %d CPU(s)\n\n", sieve.affinity ? ", pinned" : "",
+         SIEVE_NCPUS);
+  printf("threads     usec   speedup  efficiency  primes     largest\n");
+
+  for (n = 1; n <= maxthreads; n++)
+    {
+      uint64_t best = UINT64_MAX;
+      uint32_t count = 0;
+      uint32_t last = 0;
+
+      for (i = 0; i < repeat; i++)
+        {
+          int64_t elapsed = sieve_run(&sieve, workers, n, &count, &last);
+
+          if (elapsed < 0)
+            {
+              ret = EXIT_FAILURE;
+              goto errout;
+            }
+
+          if ((uint64_t)elapsed < best)
+            {
+              best = elapsed;
+            }
+        }
+
+      if (n == 1)
+        {
+          base     = best;
+          refcount = count;
+        }
+      else if (count != refcount)
+        {
+          printf("ERROR: %d threads found %lu primes, expected %lu\n", n,
+                 (unsigned long)count, (unsigned long)refcount);
+          ret = EXIT_FAILURE;
+        }
+
+      /* Speedup and efficiency in hundredths */
+
+      if (best == 0)
+        {
+          best = 1;
+        }
+
+      printf("%7d %8lu %6lu.%02lu %9lu%%  %7lu %10lu\n", n,
+             (unsigned long)best,
+             (unsigned long)(base * 100 / best / 100),
+             (unsigned long)(base * 100 / best % 100),
+             (unsigned long)(base * 100 / best / n),
+             (unsigned long)count, (unsigned long)last);
+
+      /* Show the load balance of the last run */
+
+      if (n > 1)
+        {
+          printf("        segments/thread:");
+          for (i = 0; i < n; i++)
+            {
+              printf(" %lu", (unsigned long)workers[i].nsegs);
+            }
+
+          printf("\n");
+        }
+    }
+
+errout:
+  pthread_mutex_destroy(&sieve.lock);
+  free(workers);
+  free(bprimes);
+  return ret;
+
+errout_with_usage:
+  sieve_usage(argv[0]);
+  return EXIT_FAILURE;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -182,6 +771,11 @@ int main(int argc, FAR char *argv[])
   char *endp;
   int n = 1;
 
+  if (argc > 1 && argv[1][0] == '-')
+    {
+      return sieve_main(argc, argv);
+    }
+
   if (argc == 2)
     {
       n = (int)strtol(argv[1], &endp, 10);
@@ -0,0 +1,111 @@
+/****************************************************************************
+ * testing/mm/mm.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_TESTING_MM_MM_H
+#define __APPS_TESTING_MM_MM_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_TESTING_MM_BENCH_NOPS
+#  define CONFIG_TESTING_MM_BENCH_NOPS 2000
+#endif
+
+#ifndef CONFIG_TESTING_MM_BENCH_NSLOTS
+#  define CONFIG_TESTING_MM_BENCH_NSLOTS 128
+#endif
+
+#ifndef CONFIG_TESTING_MM_BENCH_MAXSIZE
+#  define CONFIG_TESTING_MM_BENCH_MAXSIZE 16384
+#endif
+
+#ifndef CONFIG_TESTING_MM_BENCH_MAXTHREADS
+#  define CONFIG_TESTING_MM_BENCH_MAXTHREADS 4
+#endif
+
+#ifndef CONFIG_TESTING_MM_BENCH_NSAMPLES
+#  define CONFIG_TESTING_MM_BENCH_NSAMPLES 32
+#endif
+
+#ifndef CONFIG_TESTING_MM_BENCH_STACKSIZE
+#  define CONFIG_TESTING_MM_BENCH_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_TESTING_MM_POOL_SLABSIZE
+#  define CONFIG_TESTING_MM_POOL_SLABSIZE 8192
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The set of operations used by the benchmark.  Each allocator under test
+ * provides one of these so that the same trace can be replayed against the
+ * default heap and against the size-class pool.
+ */
+
+struct mm_allocator_s
+{
+  FAR const char *name;
+  CODE int   (*initialize)(void);
+  CODE void  (*uninitialize)(void);
+  CODE FAR void *(*malloc)(size_t size);
+  CODE FAR void *(*realloc)(FAR void *ptr, size_t size);
+  CODE FAR void *(*memalign)(size_t alignment, size_t size);
+  CODE void  (*free)(FAR void *ptr);
+  CODE void  (*showstats)(void);
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef CONFIG_TESTING_MM_POOL
+extern const struct mm_allocator_s g_mm_pool_allocator;
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench
+ *
+ * Description:
+ *   Parse the benchmark command line and run the allocator benchmark.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_TESTING_MM_BENCH
+int mm_bench(int argc, FAR char *argv[]);
+#endif
+
+#endif /* __APPS_TESTING_MM_MM_H */
@@ -0,0 +1,1138 @@
+/****************************************************************************
+ * testing/mm/mm_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "mm.h"
+
+#ifdef CONFIG_TESTING_MM_BENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MM_BENCH_PREFIX  "mm bench: "
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define MM_BENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define MM_BENCH_CLOCK CLOCK_REALTIME
+#endif
+
+/* Latencies are collected in log2 buckets of nanoseconds */
+
+#define MM_BENCH_NBUCKETS 32
+
+/* Number of bytes touched after each allocation (outside of the timed
+ * region) so that the allocator sees realistic cache and TLB state.
+ */
+
+#define MM_BENCH_TOUCH    64
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum mm_benchop_e
+{
+  MM_BENCH_MALLOC = 0,
+  MM_BENCH_REALLOC,
+  MM_BENCH_MEMALIGN,
+  MM_BENCH_FREE,
+  MM_BENCH_NOPS
+};
+
+/* One entry of an allocation trace */
+
+struct mm_traceop_s
+{
+  uint8_t  op;                     /* See enum mm_benchop_e */
+  uint8_t  alignlog2;              /* log2 of the alignment (memalign) */
+  uint16_t slot;                   /* Slot the operation applies to */
+  uint32_t size;                   /* Requested size */
+};
+
+struct mm_hist_s
+{
+  uint32_t count;
+  uint32_t fails;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint32_t bucket[MM_BENCH_NBUCKETS];
+};
+
+struct mm_fragsample_s
+{
+  uint32_t op;                     /* Trace index of the sample */
+  size_t   used;                   /* Total allocated space */
+  size_t   free;                   /* Total non-inuse space */
+  size_t   largest;                /* Largest non-inuse chunk */
+};
+
+struct mm_benchcfg_s
+{
+  uint32_t nops;                   /* Operations per thread */
+  uint32_t maxsize;                /* Largest generated request */
+  uint32_t seed;                   /* PRNG seed for trace generation */
+  int      nthreads;               /* Number of concurrent threads */
+  bool     heap;                   /* Benchmark the default heap */
+  bool     pool;                   /* Benchmark the size-class pool */
+  FAR const char *replay;          /* Trace file to replay */
+  FAR const char *record;          /* Trace file to record */
+};
+
+struct mm_thread_s
+{
+  FAR const struct mm_allocator_s *alloc;
+  FAR const struct mm_traceop_s *trace;
+  uint32_t ntrace;
+  FAR void *slots[CONFIG_TESTING_MM_BENCH_NSLOTS];
+  struct mm_hist_s hist[MM_BENCH_NOPS];
+  uint64_t elapsed;                /* Wall time for the whole trace */
+  FAR struct mm_fragsample_s *samples;
+  int nsamples;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static FAR void *mm_heap_memalign(size_t alignment, size_t size);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_opnames[] = "mraf";
+
+static FAR const char *g_opstrings[MM_BENCH_NOPS] =
+{
+  "malloc", "realloc", "memalign", "free"
+};
+
+static const struct mm_allocator_s g_mm_heap_allocator =
+{
+  "heap",
+  NULL,
+  NULL,
+  malloc,
+  realloc,
+  mm_heap_memalign,
+  free,
+  NULL
+};
+
+static struct mm_thread_s g_threads[CONFIG_TESTING_MM_BENCH_MAXTHREADS];
+static struct mm_fragsample_s g_samples[CONFIG_TESTING_MM_BENCH_NSAMPLES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_heap_memalign
+ ****************************************************************************/
+
+static FAR void *mm_heap_memalign(size_t alignment, size_t size)
+{
+  return memalign(alignment, size);
+}
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(FAR const char *progname, int exitcode)
+{
+  printf("\nUsage: %s -b [-n <ops>] [-t <threads>] [-s <seed>] "
+         "[-m <maxsize>]\n", progname);
+  printf("          [-a heap|pool|both] [-r <trace>] [-w <trace>]\n");
+  printf("\nWhere:\n");
+  printf("  -b Run the allocator benchmark instead of the fixed test.\n");
+  printf("  -n Operations per thread (default %d).\n",
+         CONFIG_TESTING_MM_BENCH_NOPS);
+  printf("  -t Number of concurrent threads, 1-%d (default 1).\n",
+         CONFIG_TESTING_MM_BENCH_MAXTHREADS);
+  printf("  -s Seed of the generated trace (default 1).\n");
+  printf("  -m Largest generated allocation in bytes (default %d).\n",
+         CONFIG_TESTING_MM_BENCH_MAXSIZE);
+#ifdef CONFIG_TESTING_MM_POOL
+  printf("  -a Allocator to benchmark (default heap).\n");
+#else
+  printf("  -a Allocator to benchmark (only heap is configured).\n");
+#endif
+  printf("  -r Replay the trace stored in <trace>, with the number of\n"
+         "     threads it was recorded with.\n");
+  printf("  -w Record the generated traces to <trace>.\n");
+  exit(exitcode);
+}
+
+/****************************************************************************
+ * Name: parse_commandline
+ ****************************************************************************/
+
+static void parse_commandline(int argc, FAR char **argv,
+                              FAR struct mm_benchcfg_s *cfg)
+{
+  FAR char *ptr;
+  int option;
+
+  while ((option = getopt(argc, argv, "bn:t:s:m:a:r:w:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'b':
+            break;
+
+          case 'n':
+            cfg->nops = (uint32_t)strtoul(optarg, &ptr, 10);
+            if (*ptr != '\0' || cfg->nops == 0)
+              {
+                printf(MM_BENCH_PREFIX "Invalid <ops>: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 't':
+            cfg->nthreads = (int)strtol(optarg, &ptr, 10);
+            if (*ptr != '\0' || cfg->nthreads < 1 ||
+                cfg->nthreads > CONFIG_TESTING_MM_BENCH_MAXTHREADS)
+              {
+                printf(MM_BENCH_PREFIX "Invalid <threads>: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 's':
+            cfg->seed = (uint32_t)strtoul(optarg, &ptr, 0);
+            if (*ptr != '\0')
+              {
+                printf(MM_BENCH_PREFIX "Invalid <seed>: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 'm':
+            cfg->maxsize = (uint32_t)strtoul(optarg, &ptr, 10);
+            if (*ptr != '\0' || cfg->maxsize == 0)
+              {
+                printf(MM_BENCH_PREFIX "Invalid <maxsize>: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 'a':
+            cfg->heap = strcmp(optarg, "heap") == 0 ||
+                        strcmp(optarg, "both") == 0;
+            cfg->pool = strcmp(optarg, "pool") == 0 ||
+                        strcmp(optarg, "both") == 0;
+#ifndef CONFIG_TESTING_MM_POOL
+            if (cfg->pool)
+              {
+                printf(MM_BENCH_PREFIX
+                       "Pool allocator not enabled (CONFIG_TESTING_MM_POOL)\n");
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+#endif
+            if (!cfg->heap && !cfg->pool)
+              {
+                printf(MM_BENCH_PREFIX "Invalid allocator: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+            break;
+
+          case 'r':
+            cfg->replay = optarg;
+            break;
+
+          case 'w':
+            cfg->record = optarg;
+            break;
+
+          default:
+            printf(MM_BENCH_PREFIX "Unrecognized option: '%c'\n", option);
+            show_usage(argv[0], EXIT_FAILURE);
+        }
+    }
+
+  if (optind != argc)
+    {
+      printf(MM_BENCH_PREFIX "Too many arguments\n");
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+}
+
+/****************************************************************************
+ * Name: mm_bench_rand
+ *
+ * Description:
+ *   xorshift32.  Each thread owns its state so traces are reproducible
+ *   from the seed regardless of scheduling.
+ *
+ ****************************************************************************/
+
+static uint32_t mm_bench_rand(FAR uint32_t *state)
+{
+  uint32_t x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+/****************************************************************************
+ * Name: mm_bench_size
+ *
+ * Description:
+ *   Return a request size following a long-tailed distribution typical of
+ *   embedded applications: mostly small objects, some buffers and a few
+ *   large blocks.
+ *
+ ****************************************************************************/
+
+static uint32_t mm_bench_size(FAR uint32_t *state, uint32_t maxsize)
+{
+  uint32_t pct = mm_bench_rand(state) % 100;
+  uint32_t size;
+
+  if (pct < 70)
+    {
+      size = 1 + mm_bench_rand(state) % 256;
+    }
+  else if (pct < 95)
+    {
+      size = 257 + mm_bench_rand(state) % (4096 - 256);
+    }
+  else
+    {
+      size = 4097 + mm_bench_rand(state) % maxsize;
+    }
+
+  return size > maxsize ? maxsize : size;
+}
+
+/****************************************************************************
+ * Name: mm_bench_generate
+ *
+ * Description:
+ *   Generate a trace that keeps the slot table partially occupied, mixing
+ *   allocations, reallocations and frees of varying size and lifetime.
+ *
+ ****************************************************************************/
+
+static void mm_bench_generate(FAR struct mm_traceop_s *trace, uint32_t nops,
+                              uint32_t seed, uint32_t maxsize)
+{
+  bool live[CONFIG_TESTING_MM_BENCH_NSLOTS];
+  uint32_t state = seed != 0 ? seed : 1;
+  uint32_t i;
+
+  memset(live, 0, sizeof(live));
+
+  for (i = 0; i < nops; i++)
+    {
+      FAR struct mm_traceop_s *entry = &trace[i];
+      uint32_t pct;
+
+      entry->slot      = mm_bench_rand(&state) %
+                         CONFIG_TESTING_MM_BENCH_NSLOTS;
+      entry->alignlog2 = 0;
+      entry->size      = 0;
+
+      pct = mm_bench_rand(&state) % 100;
+      if (!live[entry->slot])
+        {
+          entry->size = mm_bench_size(&state, maxsize);
+          if (pct < 5)
+            {
+              entry->op        = MM_BENCH_MEMALIGN;
+              entry->alignlog2 = 4 + mm_bench_rand(&state) % 8;
+            }
+          else
+            {
+              entry->op = MM_BENCH_MALLOC;
+            }
+
+          live[entry->slot] = true;
+        }
+      else if (pct < 35)
+        {
+          entry->op   = MM_BENCH_REALLOC;
+          entry->size = mm_bench_size(&state, maxsize);
+        }
+      else
+        {
+          entry->op         = MM_BENCH_FREE;
+          live[entry->slot] = false;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_bench_load
+ *
+ * Description:
+ *   Load a trace file.  Each line holds one operation:
+ *
+ *     m <slot> <size>          malloc
+ *     r <slot> <size>          realloc
+ *     a <slot> <size> <align>  memalign
+ *     f <slot>                 free
+ *
+ *   A line "t <thread>" starts the trace of the given thread, so that a
+ *   multi-threaded run is replayed as it was recorded.  The operations
+ *   before the first such line belong to thread 0.  The number of traces
+ *   is returned in *ntraces.
+ *
+ ****************************************************************************/
+
+static int mm_bench_load(FAR const char *path,
+                         FAR struct mm_traceop_s **traces,
+                         FAR uint32_t *ntrace, FAR int *ntraces)
+{
+  FAR struct mm_traceop_s *newentries;
+  uint32_t nalloc[CONFIG_TESTING_MM_BENCH_MAXTHREADS];
+  FAR FILE *stream;
+  char line[64];
+  int cur = 0;
+  int t;
+
+  memset(nalloc, 0, sizeof(nalloc));
+  *ntraces = 1;
+
+  stream = fopen(path, "r");
+  if (stream == NULL)
+    {
+      printf(MM_BENCH_PREFIX "ERROR: Failed to open %s: %d\n", path, errno);
+      return -errno;
+    }
+
+  while (fgets(line, sizeof(line), stream) != NULL)
+    {
+      FAR struct mm_traceop_s *entry;
+      unsigned long slot = 0;
+      unsigned long size = 0;
+      unsigned long align = 0;
+      FAR const char *op;
+      char opchar;
+
+      if (sscanf(line, " %c %lu %lu %lu", &opchar, &slot, &size, &align) < 2)
+        {
+          continue;
+        }
+
+      if (opchar == 't')
+        {
+          if (slot >= CONFIG_TESTING_MM_BENCH_MAXTHREADS)
+            {
+              printf(MM_BENCH_PREFIX "ERROR: %s: too many threads\n", path);
+              goto errout;
+            }
+
+          cur = (int)slot;
+          if (cur >= *ntraces)
+            {
+              *ntraces = cur + 1;
+            }
+
+          continue;
+        }
+
+      op = strchr(g_opnames, opchar);
+      if (op == NULL || slot >= CONFIG_TESTING_MM_BENCH_NSLOTS)
+        {
+          printf(MM_BENCH_PREFIX "Skipping bad trace line: %s", line);
+          continue;
+        }
+
+      if (ntrace[cur] >= nalloc[cur])
+        {
+          nalloc[cur] = nalloc[cur] != 0 ? 2 * nalloc[cur] : 256;
+          newentries  = realloc(traces[cur],
+                                nalloc[cur] * sizeof(struct mm_traceop_s));
+          if (newentries == NULL)
+            {
+              printf(MM_BENCH_PREFIX "ERROR: No memory for trace\n");
+              goto errout;
+            }
+
+          traces[cur] = newentries;
+        }
+
+      entry            = &traces[cur][ntrace[cur]++];
+      entry->op        = op - g_opnames;
+      entry->slot      = slot;
+      entry->size      = size;
+      entry->alignlog2 = 0;
+
+      while (align > 1 && entry->alignlog2 < 31)
+        {
+          align >>= 1;
+          entry->alignlog2++;
+        }
+    }
+
+  fclose(stream);
+
+  for (t = 0; t < *ntraces; t++)
+    {
+      if (ntrace[t] == 0)
+        {
+          printf(MM_BENCH_PREFIX "ERROR: %s holds no operations for "
+                 "thread %d\n", path, t);
+          goto errout_with_traces;
+        }
+    }
+
+  return OK;
+
+errout:
+  fclose(stream);
+
+errout_with_traces:
+  for (t = 0; t < CONFIG_TESTING_MM_BENCH_MAXTHREADS; t++)
+    {
+      free(traces[t]);
+      traces[t] = NULL;
+    }
+
+  return -EINVAL;
+}
+
+/****************************************************************************
+ * Name: mm_bench_save
+ ****************************************************************************/
+
+static int mm_bench_save(FAR const char *path,
+                         FAR struct mm_traceop_s **traces,
+                         FAR const uint32_t *ntrace, int nthreads)
+{
+  FAR FILE *stream;
+  uint32_t i;
+  int t;
+
+  stream = fopen(path, "w");
+  if (stream == NULL)
+    {
+      printf(MM_BENCH_PREFIX "ERROR: Failed to create %s: %d\n",
+             path, errno);
+      return -errno;
+    }
+
+  for (t = 0; t < nthreads; t++)
+    {
+      fprintf(stream, "t %d\n", t);
+
+      for (i = 0; i < ntrace[t]; i++)
+        {
+          FAR const struct mm_traceop_s *entry = &traces[t][i];
+
+          switch (entry->op)
+            {
+              case MM_BENCH_MEMALIGN:
+                fprintf(stream, "a %u %lu %lu\n", entry->slot,
+                        (unsigned long)entry->size, 1ul << entry->alignlog2);
+                break;
+
+              case MM_BENCH_FREE:
+                fprintf(stream, "f %u\n", entry->slot);
+                break;
+
+              default:
+                fprintf(stream, "%c %u %lu\n", g_opnames[entry->op],
+                        entry->slot, (unsigned long)entry->size);
+                break;
+            }
+        }
+    }
+
+  fclose(stream);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_bench_record
+ *
+ * Description:
+ *   Add one latency measurement to a histogram.
+ *
+ ****************************************************************************/
+
+static void mm_bench_record(FAR struct mm_hist_s *hist,
+                            FAR const struct timespec *start,
+                            FAR const struct timespec *end, bool ok)
+{
+  uint64_t ns;
+  uint32_t lat;
+  int bucket = 0;
+
+  ns  = (uint64_t)(end->tv_sec - start->tv_sec) * NSEC_PER_SEC +
+        end->tv_nsec - start->tv_nsec;
+  lat = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+
+  if (hist->count == 0 || lat < hist->min)
+    {
+      hist->min = lat;
+    }
+
+  if (lat > hist->max)
+    {
+      hist->max = lat;
+    }
+
+  while ((lat >>= 1) != 0 && bucket < MM_BENCH_NBUCKETS - 1)
+    {
+      bucket++;
+    }
+
+  hist->bucket[bucket]++;
+  hist->total += ns;
+  hist->count++;
+
+  if (!ok)
+    {
+      hist->fails++;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_bench_sample
+ ****************************************************************************/
+
+static void mm_bench_sample(FAR struct mm_thread_s *thread, uint32_t op)
+{
+  FAR struct mm_fragsample_s *sample;
+  struct mallinfo info;
+
+  if (thread->nsamples >= CONFIG_TESTING_MM_BENCH_NSAMPLES)
+    {
+      return;
+    }
+
+  info            = mallinfo();
+  sample          = &thread->samples[thread->nsamples++];
+  sample->op      = op;
+  sample->used    = info.uordblks;
+  sample->free    = info.fordblks;
+  sample->largest = info.mxordblk;
+}
+
+/****************************************************************************
+ * Name: mm_bench_thread
+ *
+ * Description:
+ *   Replay a trace against one allocator, timing every operation.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_bench_thread(FAR void *arg)
+{
+  FAR struct mm_thread_s *thread = (FAR struct mm_thread_s *)arg;
+  FAR const struct mm_allocator_s *alloc = thread->alloc;
+  struct timespec start;
+  struct timespec end;
+  struct timespec t0;
+  struct timespec t1;
+  uint32_t interval;
+  uint32_t i;
+
+  interval = thread->ntrace / CONFIG_TESTING_MM_BENCH_NSAMPLES;
+  if (interval == 0)
+    {
+      interval = 1;
+    }
+
+  clock_gettime(MM_BENCH_CLOCK, &t0);
+
+  for (i = 0; i < thread->ntrace; i++)
+    {
+      FAR const struct mm_traceop_s *entry = &thread->trace[i];
+      FAR void **slot = &thread->slots[entry->slot];
+      FAR void *ptr = NULL;
+      bool ok = true;
+
+      switch (entry->op)
+        {
+          case MM_BENCH_MALLOC:
+          case MM_BENCH_MEMALIGN:
+
+            /* Replayed traces may allocate into an occupied slot */
+
+            if (*slot != NULL)
+              {
+                alloc->free(*slot);
+                *slot = NULL;
+              }
+
+            clock_gettime(MM_BENCH_CLOCK, &start);
+            if (entry->op == MM_BENCH_MALLOC)
+              {
+                ptr = alloc->malloc(entry->size);
+              }
+            else
+              {
+                ptr = alloc->memalign((size_t)1 << entry->alignlog2,
+                                      entry->size);
+              }
+
+            clock_gettime(MM_BENCH_CLOCK, &end);
+
+            ok    = ptr != NULL;
+            *slot = ptr;
+            break;
+
+          case MM_BENCH_REALLOC:
+            clock_gettime(MM_BENCH_CLOCK, &start);
+            ptr = alloc->realloc(*slot, entry->size);
+            clock_gettime(MM_BENCH_CLOCK, &end);
+
+            /* On failure the original block is still valid */
+
+            ok = ptr != NULL;
+            if (ok)
+              {
+                *slot = ptr;
+              }
+            break;
+
+          case MM_BENCH_FREE:
+          default:
+            clock_gettime(MM_BENCH_CLOCK, &start);
+            alloc->free(*slot);
+            clock_gettime(MM_BENCH_CLOCK, &end);
+
+            *slot = NULL;
+            break;
+        }
+
+      mm_bench_record(&thread->hist[entry->op], &start, &end, ok);
+
+      if (ptr != NULL)
+        {
+          memset(ptr, entry->slot,
+                 entry->size < MM_BENCH_TOUCH ? entry->size :
+                                                MM_BENCH_TOUCH);
+        }
+
+      if (thread->samples != NULL && (i % interval) == 0)
+        {
+          mm_bench_sample(thread, i);
+        }
+    }
+
+  clock_gettime(MM_BENCH_CLOCK, &t1);
+  thread->elapsed = (uint64_t)(t1.tv_sec - t0.tv_sec) * NSEC_PER_SEC +
+                    t1.tv_nsec - t0.tv_nsec;
+
+  if (thread->samples != NULL)
+    {
+      mm_bench_sample(thread, thread->ntrace);
+    }
+
+  /* Release whatever the trace left allocated */
+
+  for (i = 0; i < CONFIG_TESTING_MM_BENCH_NSLOTS; i++)
+    {
+      if (thread->slots[i] != NULL)
+        {
+          alloc->free(thread->slots[i]);
+          thread->slots[i] = NULL;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_bench_percentile
+ *
+ * Description:
+ *   Return the upper bound (in ns) of the bucket containing the given
+ *   percentile.
+ *
+ ****************************************************************************/
+
+static uint32_t mm_bench_percentile(FAR const struct mm_hist_s *hist,
+                                    int pct)
+{
+  uint32_t target = (uint32_t)(((uint64_t)hist->count * pct + 99) / 100);
+  uint32_t cumul = 0;
+  int i;
+
+  for (i = 0; i < MM_BENCH_NBUCKETS; i++)
+    {
+      cumul += hist->bucket[i];
+      if (cumul >= target)
+        {
+          break;
+        }
+    }
+
+  return i >= MM_BENCH_NBUCKETS - 1 ? hist->max : (2u << i) - 1;
+}
+
+/****************************************************************************
+ * Name: mm_bench_report
+ ****************************************************************************/
+
+static void mm_bench_report(FAR const struct mm_allocator_s *alloc,
+                            int nthreads)
+{
+  struct mm_hist_s total[MM_BENCH_NOPS];
+  uint64_t elapsed = 0;
+  uint64_t nops = 0;
+  int op;
+  int t;
+  int i;
+
+  memset(total, 0, sizeof(total));
+
+  for (t = 0; t < nthreads; t++)
+    {
+      FAR struct mm_thread_s *thread = &g_threads[t];
+
+      if (thread->elapsed > elapsed)
+        {
+          elapsed = thread->elapsed;
+        }
+
+      for (op = 0; op < MM_BENCH_NOPS; op++)
+        {
+          FAR struct mm_hist_s *src = &thread->hist[op];
+          FAR struct mm_hist_s *dst = &total[op];
+
+          if (src->count == 0)
+            {
+              continue;
+            }
+
+          if (dst->count == 0 || src->min < dst->min)
+            {
+              dst->min = src->min;
+            }
+
+          if (src->max > dst->max)
+            {
+              dst->max = src->max;
+            }
+
+          dst->count += src->count;
+          dst->fails += src->fails;
+          dst->total += src->total;
+
+          for (i = 0; i < MM_BENCH_NBUCKETS; i++)
+            {
+              dst->bucket[i] += src->bucket[i];
+            }
+        }
+    }
+
+  printf("\n%s: %d thread(s), %lu ms\n", alloc->name, nthreads,
+         (unsigned long)(elapsed / NSEC_PER_MSEC));
+  printf("  %-8s %7s %5s %7s %7s %7s %7s %7s %8s\n",
+         "op", "count", "fail", "min", "avg", "p50", "p90", "p99", "max");
+
+  for (op = 0; op < MM_BENCH_NOPS; op++)
+    {
+      FAR struct mm_hist_s *hist = &total[op];
+
+      nops += hist->count;
+      if (hist->count == 0)
+        {
+          continue;
+        }
+
+      printf("  %-8s %7lu %5lu %7lu %7lu %7lu %7lu %7lu %8lu\n",
+             g_opstrings[op],
+             (unsigned long)hist->count,
+             (unsigned long)hist->fails,
+             (unsigned long)hist->min,
+             (unsigned long)(hist->total / hist->count),
+             (unsigned long)mm_bench_percentile(hist, 50),
+             (unsigned long)mm_bench_percentile(hist, 90),
+             (unsigned long)mm_bench_percentile(hist, 99),
+             (unsigned long)hist->max);
+    }
+
+  printf("  (latencies in ns)\n");
+
+  if (elapsed > 0)
+    {
+      printf("  throughput: %lu ops/s\n",
+             (unsigned long)(nops * NSEC_PER_SEC / elapsed));
+    }
+
+  /* Print the latency histogram of all operations */
+
+  printf("  histogram (ns < 2^n):\n");
+  for (i = 0; i < MM_BENCH_NBUCKETS; i++)
+    {
+      uint32_t count = 0;
+
+      for (op = 0; op < MM_BENCH_NOPS; op++)
+        {
+          count += total[op].bucket[i];
+        }
+
+      if (count > 0)
+        {
+          printf("    %2d: %lu\n", i + 1, (unsigned long)count);
+        }
+    }
+
+  /* Fragmentation over time as seen by thread 0.  The metric is the share
+   * of free space that is not part of the largest free chunk.
+   */
+
+  printf("  fragmentation:\n");
+  printf("    %7s %9s %9s %9s %5s\n", "op", "used", "free", "largest",
+         "frag%");
+
+  for (i = 0; i < g_threads[0].nsamples; i++)
+    {
+      FAR struct mm_fragsample_s *sample = &g_samples[i];
+      unsigned long frag = 0;
+
+      if (sample->free > 0)
+        {
+          frag = 100 - (unsigned long)
+                 ((uint64_t)sample->largest * 100 / sample->free);
+        }
+
+      printf("    %7lu %9lu %9lu %9lu %5lu\n",
+             (unsigned long)sample->op, (unsigned long)sample->used,
+             (unsigned long)sample->free, (unsigned long)sample->largest,
+             frag);
+    }
+
+  if (alloc->showstats != NULL)
+    {
+      alloc->showstats();
+    }
+}
+
+/****************************************************************************
+ * Name: mm_bench_run
+ ****************************************************************************/
+
+static int mm_bench_run(FAR const struct mm_allocator_s *alloc,
+                        FAR struct mm_traceop_s **traces,
+                        FAR const uint32_t *ntrace, int nthreads)
+{
+  pthread_t threads[CONFIG_TESTING_MM_BENCH_MAXTHREADS];
+  pthread_attr_t attr;
+  struct mallinfo before;
+  struct mallinfo after;
+  int ret;
+  int t;
+
+  if (alloc->initialize != NULL)
+    {
+      ret = alloc->initialize();
+      if (ret < 0)
+        {
+          printf(MM_BENCH_PREFIX "ERROR: %s initialize failed: %d\n",
+                 alloc->name, ret);
+          return ret;
+        }
+    }
+
+  memset(g_threads, 0, sizeof(g_threads));
+  before = mallinfo();
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_TESTING_MM_BENCH_STACKSIZE);
+
+  for (t = 0; t < nthreads; t++)
+    {
+      g_threads[t].alloc   = alloc;
+      g_threads[t].trace   = traces[t];
+      g_threads[t].ntrace  = ntrace[t];
+      g_threads[t].samples = t == 0 ? g_samples : NULL;
+
+      ret = pthread_create(&threads[t], &attr, mm_bench_thread,
+                           &g_threads[t]);
+      if (ret != 0)
+        {
+          printf(MM_BENCH_PREFIX "ERROR: pthread_create failed: %d\n", ret);
+          break;
+        }
+    }
+
+  nthreads = t;
+  for (t = 0; t < nthreads; t++)
+    {
+      pthread_join(threads[t], NULL);
+    }
+
+  pthread_attr_destroy(&attr);
+
+  if (nthreads > 0)
+    {
+      mm_bench_report(alloc, nthreads);
+    }
+
+  if (alloc->uninitialize != NULL)
+    {
+      alloc->uninitialize();
+    }
+
+  after = mallinfo();
+  if (after.uordblks != before.uordblks)
+    {
+      printf("  WARNING: heap in use changed from %lu to %lu bytes\n",
+             (unsigned long)before.uordblks, (unsigned long)after.uordblks);
+    }
+
+  return nthreads > 0 ? OK : -EAGAIN;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench
+ ****************************************************************************/
+
+int mm_bench(int argc, FAR char *argv[])
+{
+  FAR struct mm_traceop_s *traces[CONFIG_TESTING_MM_BENCH_MAXTHREADS];
+  uint32_t ntrace[CONFIG_TESTING_MM_BENCH_MAXTHREADS];
+  struct mm_benchcfg_s cfg;
+  int ntraces;
+  int ret = OK;
+  int t;
+
+  memset(&cfg, 0, sizeof(cfg));
+  memset(traces, 0, sizeof(traces));
+  memset(ntrace, 0, sizeof(ntrace));
+  cfg.nops     = CONFIG_TESTING_MM_BENCH_NOPS;
+  cfg.maxsize  = CONFIG_TESTING_MM_BENCH_MAXSIZE;
+  cfg.seed     = 1;
+  cfg.nthreads = 1;
+  cfg.heap     = true;
+
+  parse_commandline(argc, argv, &cfg);
+
+  /* A recorded run is replayed with one trace per thread, as it was
+   * recorded.  A single trace is shared by all threads, each thread
+   * operating on its own slot table.  Generated traces use one seed per
+   * thread.
+   */
+
+  if (cfg.replay != NULL)
+    {
+      ret = mm_bench_load(cfg.replay, traces, ntrace, &ntraces);
+      if (ret < 0)
+        {
+          return EXIT_FAILURE;
+        }
+
+      if (ntraces == 1)
+        {
+          for (t = 1; t < cfg.nthreads; t++)
+            {
+              traces[t] = traces[0];
+              ntrace[t] = ntrace[0];
+            }
+        }
+      else if (ntraces != cfg.nthreads)
+        {
+          printf(MM_BENCH_PREFIX "ERROR: %s was recorded with %d threads, "
+                 "use -t %d\n", cfg.replay, ntraces, ntraces);
+          ret = -EINVAL;
+          goto errout;
+        }
+    }
+  else
+    {
+      ntraces = cfg.nthreads;
+      for (t = 0; t < cfg.nthreads; t++)
+        {
+          traces[t] = malloc(cfg.nops * sizeof(struct mm_traceop_s));
+          if (traces[t] == NULL)
+            {
+              printf(MM_BENCH_PREFIX "ERROR: No memory for trace\n");
+              ret = -ENOMEM;
+              goto errout;
+            }
+
+          ntrace[t] = cfg.nops;
+          mm_bench_generate(traces[t], cfg.nops, cfg.seed + t, cfg.maxsize);
+        }
+    }
+
+  if (cfg.record != NULL)
+    {
+      ret = mm_bench_save(cfg.record, traces, ntrace, cfg.nthreads);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+    }
+
+  printf(MM_BENCH_PREFIX "%lu operations per thread, %d thread(s)\n",
+         (unsigned long)ntrace[0], cfg.nthreads);
+
+  if (cfg.heap)
+    {
+      ret = mm_bench_run(&g_mm_heap_allocator, traces, ntrace,
+                         cfg.nthreads);
+    }
+
+#ifdef CONFIG_TESTING_MM_POOL
+  if (cfg.pool && ret >= 0)
+    {
+      ret = mm_bench_run(&g_mm_pool_allocator, traces, ntrace,
+                         cfg.nthreads);
+    }
+#endif
+
+errout:
+
+  /* Shared traces are freed once */
+
+  for (t = 0; t < ntraces; t++)
+    {
+      free(traces[t]);
+    }
+
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif /* CONFIG_TESTING_MM_BENCH */
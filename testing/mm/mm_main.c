@@ -37,10 +37,14 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "mm.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -297,6 +301,15 @@ static void do_frees(FAR void **mem, FAR const int *size,
 
 int main(int argc, FAR char *argv[])
 {
+#ifdef CONFIG_TESTING_MM_BENCH
+  /* Any command line argument selects the benchmark */
+
+  if (argc > 1)
+    {
+      return mm_bench(argc, argv);
+    }
+#endif
+
   mm_showmallinfo();
 
   /* Allocate some memory */
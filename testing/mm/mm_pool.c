@@ -0,0 +1,432 @@
+/****************************************************************************
+ * testing/mm/mm_pool.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "mm.h"
+
+#ifdef CONFIG_TESTING_MM_POOL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size classes are powers of two from 16 bytes up to 2 KiB.  Anything
+ * larger, and any allocation with a stricter alignment than the block
+ * header provides, falls back to the default heap.
+ */
+
+#define MM_POOL_MINSHIFT   4
+#define MM_POOL_NCLASSES   8
+#define MM_POOL_MINSIZE    (1 << MM_POOL_MINSHIFT)
+#define MM_POOL_MAXSIZE    (MM_POOL_MINSIZE << (MM_POOL_NCLASSES - 1))
+
+#define MM_POOL_HDRSIZE    sizeof(struct mm_poolhdr_s)
+#define MM_POOL_ALIGN_UP(a, b) (((a) + ((b) - 1)) & ~((uintptr_t)(b) - 1))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Every block handed out is preceded by this header.  For pooled blocks
+ * 'raw' is NULL and 'size' is the class size.  For heap fallback blocks
+ * 'raw' is the pointer returned by malloc() and 'size' is the requested
+ * size.  While a pooled block sits on a free list, 'raw' holds the free
+ * list link.
+ */
+
+struct mm_poolhdr_s
+{
+  FAR void *raw;
+  size_t size;
+};
+
+struct mm_poolslab_s
+{
+  FAR struct mm_poolslab_s *flink;
+};
+
+struct mm_poolclass_s
+{
+  pthread_mutex_t lock;            /* Protects the class free list */
+  FAR struct mm_poolhdr_s *free;   /* Head of the free list */
+  size_t   nallocs;                /* Number of allocations served */
+  size_t   nfrees;                 /* Number of frees returned */
+  size_t   ninuse;                 /* Number of blocks currently in use */
+  size_t   nslabs;                 /* Number of slabs carved for this class */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int  mm_pool_initialize(void);
+static void mm_pool_uninitialize(void);
+static FAR void *mm_pool_malloc(size_t size);
+static FAR void *mm_pool_realloc(FAR void *ptr, size_t size);
+static FAR void *mm_pool_memalign(size_t alignment, size_t size);
+static void mm_pool_free(FAR void *ptr);
+static void mm_pool_showstats(void);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mm_poolclass_s g_pool_class[MM_POOL_NCLASSES];
+static FAR struct mm_poolslab_s *g_pool_slabs;
+static pthread_mutex_t g_pool_slablock;
+static size_t g_pool_nlarge;
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct mm_allocator_s g_mm_pool_allocator =
+{
+  "pool",
+  mm_pool_initialize,
+  mm_pool_uninitialize,
+  mm_pool_malloc,
+  mm_pool_realloc,
+  mm_pool_memalign,
+  mm_pool_free,
+  mm_pool_showstats
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pool_class
+ *
+ * Description:
+ *   Return the size class serving 'size' bytes, or MM_POOL_NCLASSES if the
+ *   request must go to the heap.
+ *
+ ****************************************************************************/
+
+static inline int mm_pool_class(size_t size)
+{
+  int cls = 0;
+
+  if (size > MM_POOL_MAXSIZE)
+    {
+      return MM_POOL_NCLASSES;
+    }
+
+  while (((size_t)MM_POOL_MINSIZE << cls) < size)
+    {
+      cls++;
+    }
+
+  return cls;
+}
+
+/****************************************************************************
+ * Name: mm_pool_refill
+ *
+ * Description:
+ *   Carve a new slab into free blocks for one class.  Called with the class
+ *   lock held.
+ *
+ ****************************************************************************/
+
+static int mm_pool_refill(FAR struct mm_poolclass_s *class, int cls)
+{
+  FAR struct mm_poolslab_s *slab;
+  FAR struct mm_poolhdr_s *hdr;
+  FAR uint8_t *next;
+  FAR uint8_t *end;
+  size_t chunksize;
+
+  slab = malloc(CONFIG_TESTING_MM_POOL_SLABSIZE);
+  if (slab == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  pthread_mutex_lock(&g_pool_slablock);
+  slab->flink  = g_pool_slabs;
+  g_pool_slabs = slab;
+  pthread_mutex_unlock(&g_pool_slablock);
+
+  chunksize = MM_POOL_HDRSIZE + (MM_POOL_MINSIZE << cls);
+  next      = (FAR uint8_t *)slab +
+              MM_POOL_ALIGN_UP(sizeof(struct mm_poolslab_s),
+                               MM_POOL_HDRSIZE);
+  end       = (FAR uint8_t *)slab + CONFIG_TESTING_MM_POOL_SLABSIZE;
+
+  for (; next + chunksize <= end; next += chunksize)
+    {
+      hdr         = (FAR struct mm_poolhdr_s *)next;
+      hdr->size   = MM_POOL_MINSIZE << cls;
+      hdr->raw    = class->free;
+      class->free = hdr;
+    }
+
+  class->nslabs++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_pool_initialize
+ ****************************************************************************/
+
+static int mm_pool_initialize(void)
+{
+  int cls;
+
+  memset(g_pool_class, 0, sizeof(g_pool_class));
+  for (cls = 0; cls < MM_POOL_NCLASSES; cls++)
+    {
+      pthread_mutex_init(&g_pool_class[cls].lock, NULL);
+    }
+
+  pthread_mutex_init(&g_pool_slablock, NULL);
+  g_pool_slabs  = NULL;
+  g_pool_nlarge = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_pool_uninitialize
+ *
+ * Description:
+ *   Return all slabs to the heap.  All pooled blocks must have been freed.
+ *
+ ****************************************************************************/
+
+static void mm_pool_uninitialize(void)
+{
+  FAR struct mm_poolslab_s *slab;
+  int cls;
+
+  while ((slab = g_pool_slabs) != NULL)
+    {
+      g_pool_slabs = slab->flink;
+      free(slab);
+    }
+
+  for (cls = 0; cls < MM_POOL_NCLASSES; cls++)
+    {
+      pthread_mutex_destroy(&g_pool_class[cls].lock);
+      g_pool_class[cls].free = NULL;
+    }
+
+  pthread_mutex_destroy(&g_pool_slablock);
+}
+
+/****************************************************************************
+ * Name: mm_pool_malloc
+ ****************************************************************************/
+
+static FAR void *mm_pool_malloc(size_t size)
+{
+  FAR struct mm_poolclass_s *class;
+  FAR struct mm_poolhdr_s *hdr;
+  int cls;
+
+  cls = mm_pool_class(size);
+  if (cls >= MM_POOL_NCLASSES)
+    {
+      /* Large block fallback */
+
+      hdr = malloc(MM_POOL_HDRSIZE + size);
+      if (hdr == NULL)
+        {
+          return NULL;
+        }
+
+      hdr->raw  = hdr;
+      hdr->size = size;
+
+      pthread_mutex_lock(&g_pool_slablock);
+      g_pool_nlarge++;
+      pthread_mutex_unlock(&g_pool_slablock);
+      return hdr + 1;
+    }
+
+  class = &g_pool_class[cls];
+  pthread_mutex_lock(&class->lock);
+
+  if (class->free == NULL && mm_pool_refill(class, cls) < 0)
+    {
+      pthread_mutex_unlock(&class->lock);
+      return NULL;
+    }
+
+  hdr         = class->free;
+  class->free = hdr->raw;
+  class->nallocs++;
+  class->ninuse++;
+  pthread_mutex_unlock(&class->lock);
+
+  hdr->raw  = NULL;
+  return hdr + 1;
+}
+
+/****************************************************************************
+ * Name: mm_pool_free
+ ****************************************************************************/
+
+static void mm_pool_free(FAR void *ptr)
+{
+  FAR struct mm_poolclass_s *class;
+  FAR struct mm_poolhdr_s *hdr;
+
+  if (ptr == NULL)
+    {
+      return;
+    }
+
+  hdr = (FAR struct mm_poolhdr_s *)ptr - 1;
+  if (hdr->raw != NULL)
+    {
+      free(hdr->raw);
+      return;
+    }
+
+  class = &g_pool_class[mm_pool_class(hdr->size)];
+  pthread_mutex_lock(&class->lock);
+  hdr->raw    = class->free;
+  class->free = hdr;
+  class->nfrees++;
+  class->ninuse--;
+  pthread_mutex_unlock(&class->lock);
+}
+
+/****************************************************************************
+ * Name: mm_pool_realloc
+ ****************************************************************************/
+
+static FAR void *mm_pool_realloc(FAR void *ptr, size_t size)
+{
+  FAR struct mm_poolhdr_s *hdr;
+  FAR void *newptr;
+  size_t oldsize;
+
+  if (ptr == NULL)
+    {
+      return mm_pool_malloc(size);
+    }
+
+  if (size == 0)
+    {
+      mm_pool_free(ptr);
+      return NULL;
+    }
+
+  /* Keep the block if it is a pooled block and the new size still maps to
+   * the same class.
+   */
+
+  hdr     = (FAR struct mm_poolhdr_s *)ptr - 1;
+  oldsize = hdr->size;
+
+  if (hdr->raw == NULL && mm_pool_class(size) == mm_pool_class(oldsize))
+    {
+      return ptr;
+    }
+
+  newptr = mm_pool_malloc(size);
+  if (newptr != NULL)
+    {
+      memcpy(newptr, ptr, oldsize < size ? oldsize : size);
+      mm_pool_free(ptr);
+    }
+
+  return newptr;
+}
+
+/****************************************************************************
+ * Name: mm_pool_memalign
+ ****************************************************************************/
+
+static FAR void *mm_pool_memalign(size_t alignment, size_t size)
+{
+  FAR struct mm_poolhdr_s *hdr;
+  FAR void *raw;
+  uintptr_t user;
+
+  if (alignment <= MM_POOL_HDRSIZE)
+    {
+      return mm_pool_malloc(size);
+    }
+
+  raw = malloc(MM_POOL_HDRSIZE + alignment + size);
+  if (raw == NULL)
+    {
+      return NULL;
+    }
+
+  user      = MM_POOL_ALIGN_UP((uintptr_t)raw + MM_POOL_HDRSIZE, alignment);
+  hdr       = (FAR struct mm_poolhdr_s *)user - 1;
+  hdr->raw  = raw;
+  hdr->size = size;
+
+  pthread_mutex_lock(&g_pool_slablock);
+  g_pool_nlarge++;
+  pthread_mutex_unlock(&g_pool_slablock);
+  return (FAR void *)user;
+}
+
+/****************************************************************************
+ * Name: mm_pool_showstats
+ ****************************************************************************/
+
+static void mm_pool_showstats(void)
+{
+  FAR struct mm_poolclass_s *class;
+  int cls;
+
+  printf("     pool classes:\n");
+  printf("       %6s %8s %8s %6s %6s\n",
+         "size", "allocs", "frees", "inuse", "slabs");
+
+  for (cls = 0; cls < MM_POOL_NCLASSES; cls++)
+    {
+      class = &g_pool_class[cls];
+      if (class->nslabs > 0)
+        {
+          printf("       %6d %8lu %8lu %6lu %6lu\n",
+                 MM_POOL_MINSIZE << cls,
+                 (unsigned long)class->nallocs,
+                 (unsigned long)class->nfrees,
+                 (unsigned long)class->ninuse,
+                 (unsigned long)class->nslabs);
+        }
+    }
+
+  printf("       heap fallbacks: %lu\n", (unsigned long)g_pool_nlarge);
+}
+
+#endif /* CONFIG_TESTING_MM_POOL */
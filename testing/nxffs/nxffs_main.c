@@ -37,6 +37,10 @@
 #include <crc32.h>
 #include <debug.h>
 
+#ifdef CONFIG_TESTING_NXFFS_BENCH
+#  include "fsutils/fsbench.h"
+#endif
+
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/nxffs.h>
 
@@ -813,6 +817,15 @@ int main(int argc, FAR char *argv[])
       exit(3);
     }
 
+#ifdef CONFIG_TESTING_NXFFS_BENCH
+  /* Any command line argument selects the benchmark */
+
+  if (argc > 1)
+    {
+      return fsbench_main("nxffs", CONFIG_TESTING_NXFFS_MOUNTPT, argc, argv);
+    }
+#endif
+
   /* Set up memory monitoring */
 
   g_mmbefore   = mallinfo();
@@ -44,15 +44,81 @@
 
 #include <sys/ioctl.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <unistd.h>
+#include <time.h>
 #include <errno.h>
 
 #include <nuttx/wireless/bluetooth/bt_ioctl.h>
 
 #include "btsak.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_BTSAK_SCAN_NRSP
+#  define CONFIG_BTSAK_SCAN_NRSP     32
+#endif
+
+#ifndef CONFIG_BTSAK_SCAN_NENTRIES
+#  define CONFIG_BTSAK_SCAN_NENTRIES 256
+#endif
+
+/* Size of the address hash table: a power of two at least twice the
+ * number of entries, so that probe sequences stay short.
+ */
+
+#define BTSAK_SCAN_HASHSIZE \
+  (CONFIG_BTSAK_SCAN_NENTRIES <= 64  ? 128  : \
+   CONFIG_BTSAK_SCAN_NENTRIES <= 128 ? 256  : \
+   CONFIG_BTSAK_SCAN_NENTRIES <= 256 ? 512  : \
+   CONFIG_BTSAK_SCAN_NENTRIES <= 512 ? 1024 : 2048)
+
+#define BTSAK_SCAN_NOENTRY 0xffff
+
+/* Averaged RSSI is kept in 1/16 dBm, each new report weighs 1/4 */
+
+#define BTSAK_RSSI_SHIFT   4
+#define BTSAK_RSSI_WEIGHT  2
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One advertiser of the scan watch table */
+
+struct btsak_scan_entry_s
+{
+  bt_addr_le_t addr;                 /* Advertiser address */
+  uint8_t type;                      /* Last advertising report type */
+  int8_t last;                       /* Last RSSI (dBm) */
+  int8_t min;                        /* Min. RSSI in the period (dBm) */
+  int8_t max;                        /* Max. RSSI in the period (dBm) */
+  int16_t avg;                       /* Averaged RSSI (1/16 dBm) */
+  uint16_t nperiod;                  /* Reports in the period */
+  uint32_t count;                    /* Reports since first seen */
+  uint32_t first;                    /* First report (ms) */
+  uint32_t seen;                     /* Last report (ms) */
+};
+
+/* Scan watch state */
+
+struct btsak_scan_watch_s
+{
+  FAR struct bt_scanresponse_s *rsp; /* ioctl(SIOCBTSCANGET) buffer */
+  uint16_t nentries;                 /* Entries in use */
+  uint16_t hash[BTSAK_SCAN_HASHSIZE];
+  struct btsak_scan_entry_s entries[CONFIG_BTSAK_SCAN_NENTRIES];
+  uint32_t nreports;                 /* Reports in the period */
+  uint32_t ndropped;                 /* Reports lost, table full */
+  uint32_t ncalls;                   /* ioctl calls in the period */
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -70,13 +136,19 @@ static void btsak_scan_showusage(FAR const char *progname,
 {
   fprintf(stderr, "%s:  Scan commands:\n", cmd);
   fprintf(stderr, "Usage:\n\n");
-  fprintf(stderr, "\t%s <ifname> %s [-h] <start [-d]|get|stop>\n",
-          progname, cmd);
+  fprintf(stderr, "\t%s <ifname> %s [-h] <start [-d]|get|stop|watch "
+          "[-i <ms>] [-p <ms>] [-a <s>] [-t <s>]>\n", progname, cmd);
   fprintf(stderr, "\nWhere the options do the following:\n\n");
   fprintf(stderr, "\tstart\t- Starts scanning.  The -d option enables duplicate\n");
   fprintf(stderr, "\t\t  filtering.\n");
   fprintf(stderr, "\tget\t- Shows new accumulated scan results\n");
   fprintf(stderr, "\tstop\t- Stops scanning\n");
+  fprintf(stderr, "\twatch\t- Scans continuously and shows a summary of\n");
+  fprintf(stderr, "\t\t  the advertisers every -i ms (default 5000).\n");
+  fprintf(stderr, "\t\t  Reports are drained every -p ms (default 100),\n");
+  fprintf(stderr, "\t\t  advertisers not heard for -a s (default 60)\n");
+  fprintf(stderr, "\t\t  are dropped and the scan stops after -t s\n");
+  fprintf(stderr, "\t\t  (default 0: never).\n");
   exit(exitcode);
 }
 
@@ -147,44 +219,56 @@ static void btsak_cmd_scanget(FAR struct btsak_s *btsak, FAR char *cmd,
                               int argc, FAR char *argv[])
 {
   struct btreq_s btreq;
-  struct bt_scanresponse_s result[5];
+  FAR struct bt_scanresponse_s *result;
   int sockfd;
   int ret;
 
-  /* Perform the IOCTL to get the scan results so far */
+  result = malloc(CONFIG_BTSAK_SCAN_NRSP * sizeof(struct bt_scanresponse_s));
+  if (result == NULL)
+    {
+      fprintf(stderr, "ERROR:  Failed to allocate scan results\n");
+      return;
+    }
 
-  memset(&btreq, 0, sizeof(struct btreq_s));
-  strncpy(btreq.btr_name, btsak->ifname, IFNAMSIZ);
-  btreq.btr_nrsp = 5;
-  btreq.btr_rsp  = result;
+  /* Perform the IOCTL to get the scan results so far, up to
+   * CONFIG_BTSAK_SCAN_NRSP at a time, until the stack has no more.
+   */
 
   sockfd = btsak_socket(btsak);
   if (sockfd >= 0)
     {
-      ret = ioctl(sockfd, SIOCBTSCANGET,
-                  (unsigned long)((uintptr_t)&btreq));
-      if (ret < 0)
-        {
-          fprintf(stderr, "ERROR:  ioctl(SIOCBTSCANGET) failed: %d\n",
-                  errno);
-        }
+      FAR struct bt_scanresponse_s *rsp;
+      int n = 0;
+      int i;
+      int j;
+      int k;
 
-      /* Show scan results */
+      printf("Scan result:\n");
 
-      else
+      do
         {
-          FAR struct bt_scanresponse_s *rsp;
-          int i;
-          int j;
-          int k;
+          memset(&btreq, 0, sizeof(struct btreq_s));
+          strncpy(btreq.btr_name, btsak->ifname, IFNAMSIZ);
+          btreq.btr_nrsp = CONFIG_BTSAK_SCAN_NRSP;
+          btreq.btr_rsp  = result;
+
+          ret = ioctl(sockfd, SIOCBTSCANGET,
+                      (unsigned long)((uintptr_t)&btreq));
+          if (ret < 0)
+            {
+              fprintf(stderr, "ERROR:  ioctl(SIOCBTSCANGET) failed: %d\n",
+                      errno);
+              break;
+            }
+
+          /* Show scan results */
 
-          printf("Scan result:\n");
           for (i = 0; i < btreq.btr_nrsp; i++)
             {
               rsp = &result[i];
               printf("%2d.\taddr:           "
                      "%02x:%02x:%02x:%02x:%02x:%02x type: %d\n",
-                     i + 1,
+                     ++n,
                      rsp->sr_addr.val[5], rsp->sr_addr.val[4],
                      rsp->sr_addr.val[3], rsp->sr_addr.val[2],
                      rsp->sr_addr.val[1], rsp->sr_addr.val[0],
@@ -209,9 +293,409 @@ static void btsak_cmd_scanget(FAR struct btsak_s *btsak, FAR char *cmd,
                 }
             }
         }
+      while (btreq.btr_nrsp == CONFIG_BTSAK_SCAN_NRSP);
 
       close(sockfd);
     }
+
+  free(result);
+}
+
+/****************************************************************************
+ * Name: btsak_scan_now
+ *
+ * Description:
+ *   Return the time in milliseconds.
+ *
+ ****************************************************************************/
+
+static uint32_t btsak_scan_now(void)
+{
+  struct timespec ts;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: btsak_scan_hash
+ *
+ * Description:
+ *   Return the first slot of the address in the hash table.
+ *
+ ****************************************************************************/
+
+static unsigned int btsak_scan_hash(FAR const bt_addr_le_t *addr)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < 6; i++)
+    {
+      hash = (hash ^ addr->val[i]) * 16777619u;
+    }
+
+  hash = (hash ^ addr->type) * 16777619u;
+  return hash & (BTSAK_SCAN_HASHSIZE - 1);
+}
+
+/****************************************************************************
+ * Name: btsak_scan_rehash
+ *
+ * Description:
+ *   Rebuild the hash table after entries were removed.
+ *
+ ****************************************************************************/
+
+static void btsak_scan_rehash(FAR struct btsak_scan_watch_s *watch)
+{
+  unsigned int slot;
+  int i;
+
+  memset(watch->hash, 0xff, sizeof(watch->hash));
+
+  for (i = 0; i < watch->nentries; i++)
+    {
+      slot = btsak_scan_hash(&watch->entries[i].addr);
+      while (watch->hash[slot] != BTSAK_SCAN_NOENTRY)
+        {
+          slot = (slot + 1) & (BTSAK_SCAN_HASHSIZE - 1);
+        }
+
+      watch->hash[slot] = i;
+    }
+}
+
+/****************************************************************************
+ * Name: btsak_scan_report
+ *
+ * Description:
+ *   Merge one advertising report into the watch table.
+ *
+ ****************************************************************************/
+
+static void btsak_scan_report(FAR struct btsak_scan_watch_s *watch,
+                              FAR const struct bt_scanresponse_s *rsp,
+                              uint32_t now)
+{
+  FAR struct btsak_scan_entry_s *entry;
+  unsigned int slot;
+  uint16_t ndx;
+
+  watch->nreports++;
+
+  /* Look the address up */
+
+  slot = btsak_scan_hash(&rsp->sr_addr);
+  while ((ndx = watch->hash[slot]) != BTSAK_SCAN_NOENTRY &&
+         memcmp(&watch->entries[ndx].addr, &rsp->sr_addr,
+                sizeof(bt_addr_le_t)) != 0)
+    {
+      slot = (slot + 1) & (BTSAK_SCAN_HASHSIZE - 1);
+    }
+
+  if (ndx == BTSAK_SCAN_NOENTRY)
+    {
+      if (watch->nentries >= CONFIG_BTSAK_SCAN_NENTRIES)
+        {
+          watch->ndropped++;
+          return;
+        }
+
+      ndx = watch->nentries++;
+      watch->hash[slot] = ndx;
+
+      entry = &watch->entries[ndx];
+      memset(entry, 0, sizeof(struct btsak_scan_entry_s));
+      memcpy(&entry->addr, &rsp->sr_addr, sizeof(bt_addr_le_t));
+      entry->avg   = rsp->sr_rssi * (1 << BTSAK_RSSI_SHIFT);
+      entry->first = now;
+    }
+
+  entry = &watch->entries[ndx];
+
+  if (entry->nperiod == 0 || rsp->sr_rssi < entry->min)
+    {
+      entry->min = rsp->sr_rssi;
+    }
+
+  if (entry->nperiod == 0 || rsp->sr_rssi > entry->max)
+    {
+      entry->max = rsp->sr_rssi;
+    }
+
+  /* Exponential moving average */
+
+  entry->avg += (rsp->sr_rssi * (1 << BTSAK_RSSI_SHIFT) - entry->avg) /
+                (1 << BTSAK_RSSI_WEIGHT);
+
+  entry->type = rsp->sr_type;
+  entry->last = rsp->sr_rssi;
+  entry->seen = now;
+  entry->count++;
+
+  if (entry->nperiod < UINT16_MAX)
+    {
+      entry->nperiod++;
+    }
+}
+
+/****************************************************************************
+ * Name: btsak_scan_drain
+ *
+ * Description:
+ *   Read all of the buffered advertising reports.
+ *
+ ****************************************************************************/
+
+static int btsak_scan_drain(FAR struct btsak_s *btsak, int sockfd,
+                            FAR struct btsak_scan_watch_s *watch)
+{
+  struct btreq_s btreq;
+  uint32_t now;
+  int ret;
+  int i;
+
+  do
+    {
+      memset(&btreq, 0, sizeof(struct btreq_s));
+      strncpy(btreq.btr_name, btsak->ifname, IFNAMSIZ);
+      btreq.btr_nrsp = CONFIG_BTSAK_SCAN_NRSP;
+      btreq.btr_rsp  = watch->rsp;
+
+      ret = ioctl(sockfd, SIOCBTSCANGET, (unsigned long)((uintptr_t)&btreq));
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR:  ioctl(SIOCBTSCANGET) failed: %d\n",
+                  errno);
+          return ret;
+        }
+
+      watch->ncalls++;
+      now = btsak_scan_now();
+
+      for (i = 0; i < btreq.btr_nrsp; i++)
+        {
+          btsak_scan_report(watch, &watch->rsp[i], now);
+        }
+    }
+  while (btreq.btr_nrsp == CONFIG_BTSAK_SCAN_NRSP);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: btsak_scan_summary
+ *
+ * Description:
+ *   Show the advertisers heard in the last period, then drop the ones that
+ *   were not heard for maxage ms and start a new period.
+ *
+ ****************************************************************************/
+
+static void btsak_scan_summary(FAR struct btsak_scan_watch_s *watch,
+                               uint32_t now, uint32_t maxage)
+{
+  FAR struct btsak_scan_entry_s *entry;
+  bool removed = false;
+  int nactive = 0;
+  int i;
+
+  printf("addr              t  rpt  avg  min  max  age  total\n");
+
+  for (i = 0; i < watch->nentries; i++)
+    {
+      entry = &watch->entries[i];
+      if (entry->nperiod == 0)
+        {
+          continue;
+        }
+
+      nactive++;
+      printf("%02x:%02x:%02x:%02x:%02x:%02x %u %4u %4d %4d %4d %4lu %6lu\n",
+             entry->addr.val[5], entry->addr.val[4], entry->addr.val[3],
+             entry->addr.val[2], entry->addr.val[1], entry->addr.val[0],
+             entry->addr.type, entry->nperiod,
+             entry->avg / (1 << BTSAK_RSSI_SHIFT), entry->min, entry->max,
+             (unsigned long)((now - entry->first) / 1000),
+             (unsigned long)entry->count);
+    }
+
+  printf("active %d/%d  reports %lu  calls %lu  dropped %lu\n",
+         nactive, watch->nentries, (unsigned long)watch->nreports,
+         (unsigned long)watch->ncalls, (unsigned long)watch->ndropped);
+
+  /* Age the table, keeping the order of the remaining entries */
+
+  for (i = 0; i < watch->nentries; )
+    {
+      entry = &watch->entries[i];
+      entry->nperiod = 0;
+
+      if (maxage > 0 && now - entry->seen > maxage)
+        {
+          memmove(entry, entry + 1, (watch->nentries - i - 1) *
+                  sizeof(struct btsak_scan_entry_s));
+          watch->nentries--;
+          removed = true;
+        }
+      else
+        {
+          i++;
+        }
+    }
+
+  if (removed)
+    {
+      btsak_scan_rehash(watch);
+    }
+
+  watch->nreports = 0;
+  watch->ncalls   = 0;
+  watch->ndropped = 0;
+}
+
+/****************************************************************************
+ * Name: btsak_cmd_scanwatch
+ *
+ * Description:
+ *   Scan watch command
+ *
+ ****************************************************************************/
+
+static void btsak_cmd_scanwatch(FAR struct btsak_s *btsak, FAR char *cmd,
+                                int argc, FAR char *argv[])
+{
+  FAR struct btsak_scan_watch_s *watch;
+  struct btreq_s btreq;
+  uint32_t interval = 5000;
+  uint32_t pollms = 100;
+  uint32_t maxage = 60000;
+  uint32_t duration = 0;
+  uint32_t start;
+  uint32_t period;
+  uint32_t now;
+  int argind;
+  int sockfd;
+  int ret;
+
+  for (argind = 1; argind < argc; argind += 2)
+    {
+      if (strcmp(argv[argind], "-h") == 0 || argind + 1 >= argc)
+        {
+          btsak_scan_showusage(btsak->progname, cmd,
+                               strcmp(argv[argind], "-h") == 0 ?
+                               EXIT_SUCCESS : EXIT_FAILURE);
+        }
+
+      if (strcmp(argv[argind], "-i") == 0)
+        {
+          interval = btsak_str2long(argv[argind + 1]);
+        }
+      else if (strcmp(argv[argind], "-p") == 0)
+        {
+          pollms = btsak_str2long(argv[argind + 1]);
+        }
+      else if (strcmp(argv[argind], "-a") == 0)
+        {
+          maxage = btsak_str2long(argv[argind + 1]) * 1000;
+        }
+      else if (strcmp(argv[argind], "-t") == 0)
+        {
+          duration = btsak_str2long(argv[argind + 1]) * 1000;
+        }
+      else
+        {
+          fprintf(stderr, "ERROR:  Unrecognized option: %s\n",
+                  argv[argind]);
+          btsak_scan_showusage(btsak->progname, cmd, EXIT_FAILURE);
+        }
+    }
+
+  watch = malloc(sizeof(struct btsak_scan_watch_s));
+  if (watch != NULL)
+    {
+      watch->rsp = malloc(CONFIG_BTSAK_SCAN_NRSP *
+                          sizeof(struct bt_scanresponse_s));
+    }
+
+  if (watch == NULL || watch->rsp == NULL)
+    {
+      fprintf(stderr, "ERROR:  Failed to allocate the scan table\n");
+      free(watch);
+      return;
+    }
+
+  watch->nentries = 0;
+  watch->nreports = 0;
+  watch->ncalls   = 0;
+  watch->ndropped = 0;
+  memset(watch->hash, 0xff, sizeof(watch->hash));
+
+  sockfd = btsak_socket(btsak);
+  if (sockfd < 0)
+    {
+      goto errout;
+    }
+
+  /* Start scanning without duplicate filtering: every report updates the
+   * RSSI average of its advertiser.
+   */
+
+  memset(&btreq, 0, sizeof(struct btreq_s));
+  strncpy(btreq.btr_name, btsak->ifname, IFNAMSIZ);
+  btreq.btr_dupenable = false;
+
+  ret = ioctl(sockfd, SIOCBTSCANSTART, (unsigned long)((uintptr_t)&btreq));
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR:  ioctl(SIOCBTSCANSTART) failed: %d\n",
+              errno);
+      goto errout_with_sock;
+    }
+
+  start  = btsak_scan_now();
+  period = start;
+
+  do
+    {
+      usleep(pollms * 1000);
+
+      if (btsak_scan_drain(btsak, sockfd, watch) < 0)
+        {
+          break;
+        }
+
+      now = btsak_scan_now();
+      if (now - period >= interval)
+        {
+          btsak_scan_summary(watch, now, maxage);
+          period = now;
+        }
+    }
+  while (duration == 0 || now - start < duration);
+
+  memset(&btreq, 0, sizeof(struct btreq_s));
+  strncpy(btreq.btr_name, btsak->ifname, IFNAMSIZ);
+
+  ret = ioctl(sockfd, SIOCBTSCANSTOP, (unsigned long)((uintptr_t)&btreq));
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR:  ioctl(SIOCBTSCANSTOP) failed: %d\n",
+              errno);
+    }
+
+errout_with_sock:
+  close(sockfd);
+
+errout:
+  free(watch->rsp);
+  free(watch);
 }
 
 /****************************************************************************
@@ -257,7 +741,7 @@ static void btsak_cmd_scanstop(FAR struct btsak_s *btsak, FAR char *cmd,
  * Name: btsak_cmd_scan
  *
  * Description:
- *   scan [-h] <start [-d] |get|stop> command
+ *   scan [-h] <start [-d] |get|stop|watch [options]> command
  *
  ****************************************************************************/
 
@@ -292,6 +776,10 @@ void btsak_cmd_scan(FAR struct btsak_s *btsak, int argc, FAR char *argv[])
     {
       btsak_cmd_scanstop(btsak, argv[0], argc - argind, &argv[argind]);
     }
+  else if (strcmp(argv[argind], "watch") == 0)
+    {
+      btsak_cmd_scanwatch(btsak, argv[0], argc - argind, &argv[argind]);
+    }
   else
     {
       fprintf(stderr, "ERROR:  Unrecognized scan command: %s\n", argv[argind]);
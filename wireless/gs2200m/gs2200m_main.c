@@ -52,6 +52,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <poll.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <sys/socket.h>
@@ -82,6 +83,36 @@
 #define SOCKET_BASE  10000
 #define SOCKET_COUNT 16
 
+/* The largest packet returned by GS2200M_IOC_RECV */
+
+#define GS2200M_PKTLEN_MAX  1500
+
+#ifndef CONFIG_WIRELESS_GS2200M_RECVBUF
+#  define CONFIG_WIRELESS_GS2200M_RECVBUF 0
+#endif
+
+#ifndef CONFIG_WIRELESS_GS2200M_BATCH
+#  define CONFIG_WIRELESS_GS2200M_BATCH 8
+#endif
+
+#ifndef CONFIG_WIRELESS_GS2200M_STATS_INTERVAL
+#  define CONFIG_WIRELESS_GS2200M_STATS_INTERVAL 0
+#endif
+
+#if CONFIG_WIRELESS_GS2200M_RECVBUF > 0
+#  if CONFIG_WIRELESS_GS2200M_RECVBUF < GS2200M_PKTLEN_MAX
+#    error CONFIG_WIRELESS_GS2200M_RECVBUF must hold at least one packet
+#  endif
+#  define GS2200M_READAHEAD 1
+#endif
+
+#if CONFIG_WIRELESS_GS2200M_STATS_INTERVAL > 0
+#  define GS2200M_STATS 1
+#  define gs2200m_stats_inc(p, f, n)  ((p)->stats.f += (n))
+#else
+#  define gs2200m_stats_inc(p, f, n)
+#endif
+
 /****************************************************************************
  * Private Data Types
  ****************************************************************************/
@@ -98,7 +129,30 @@ struct usock_s
   int8_t  type;
   char    cid;
   enum sock_state_e state;
+#ifdef GS2200M_READAHEAD
+  /* TCP data received from the driver but not yet by the application */
+
+  FAR uint8_t *rxbuf;
+  uint16_t rxhead;    /* Offset of the first unread byte */
+  uint16_t rxlen;     /* Number of unread bytes */
+  uint16_t pending;   /* Driver notifications not yet fetched */
+  int16_t  rxerr;     /* Deferred receive error */
+  bool     eof;       /* The remote end closed the connection */
+#endif
+};
+
+#ifdef GS2200M_STATS
+struct gs2200m_stats_s
+{
+  uint32_t wakeups;   /* poll() returns */
+  uint32_t requests;  /* usrsock requests */
+  uint32_t events;    /* Notifications from the driver */
+  uint32_t nsend;     /* GS2200M_IOC_SEND */
+  uint32_t nrecv;     /* GS2200M_IOC_RECV */
+  uint32_t txbytes;   /* Bytes sent */
+  uint32_t rxbytes;   /* Bytes received by the application */
 };
+#endif
 
 struct gs2200m_s
 {
@@ -108,6 +162,19 @@ struct gs2200m_s
   uint8_t ch;
   int     gsfd;
   struct usock_s sockets[SOCKET_COUNT];
+
+  /* Send buffer, kept between the requests and grown on demand */
+
+  FAR uint8_t *sendbuf;
+  size_t  sendbuflen;
+
+  /* Receive buffer for the sockets without read-ahead */
+
+  uint8_t recvbuf[GS2200M_PKTLEN_MAX];
+
+#ifdef GS2200M_STATS
+  struct gs2200m_stats_s stats;
+#endif
 };
 
 /****************************************************************************
@@ -344,9 +411,88 @@ static int gs2200m_socket_free(FAR struct gs2200m_s *priv, int sockid)
   usock->state = CLOSED;
   usock->cid = 'z'; /* invalid */
 
+#ifdef GS2200M_READAHEAD
+  free(usock->rxbuf);
+  usock->rxbuf = NULL;
+#endif
+
   return 0;
 }
 
+#ifdef GS2200M_READAHEAD
+/****************************************************************************
+ * Name: gs2200m_readahead
+ *
+ * Description:
+ *   Fetch the packets the driver notified for a TCP socket into its
+ *   read-ahead buffer, as long as a whole packet fits.  Returns true if the
+ *   application has something to receive.
+ *
+ ****************************************************************************/
+
+static bool gs2200m_readahead(FAR struct gs2200m_s *priv,
+                              FAR struct usock_s *usock)
+{
+  struct gs2200m_recv_msg rmsg;
+  size_t room;
+  int ret;
+
+  if (usock->rxbuf == NULL && usock->pending > 0)
+    {
+      usock->rxbuf = malloc(CONFIG_WIRELESS_GS2200M_RECVBUF);
+      if (usock->rxbuf == NULL)
+        {
+          usock->rxerr   = -ENOMEM;
+          usock->pending = 0;
+        }
+    }
+
+  while (usock->pending > 0 && !usock->eof)
+    {
+      room = CONFIG_WIRELESS_GS2200M_RECVBUF - usock->rxlen;
+      if (room < GS2200M_PKTLEN_MAX)
+        {
+          /* Wait until the application has made room */
+
+          break;
+        }
+
+      if (usock->rxhead > 0)
+        {
+          memmove(usock->rxbuf, usock->rxbuf + usock->rxhead,
+                  usock->rxlen);
+          usock->rxhead = 0;
+        }
+
+      memset(&rmsg, 0, sizeof(rmsg));
+      rmsg.buf    = usock->rxbuf + usock->rxlen;
+      rmsg.cid    = usock->cid;
+      rmsg.reqlen = room;
+      rmsg.is_tcp = true;
+
+      ret = ioctl(priv->gsfd, GS2200M_IOC_RECV, (unsigned long)&rmsg);
+      gs2200m_stats_inc(priv, nrecv, 1);
+      usock->pending--;
+
+      if (0 != ret)
+        {
+          usock->rxerr = -errno;
+          break;
+        }
+
+      if (0 == rmsg.len)
+        {
+          usock->eof = true;
+          break;
+        }
+
+      usock->rxlen += rmsg.len;
+    }
+
+  return usock->rxlen > 0 || usock->rxerr != 0 || usock->eof;
+}
+#endif
+
 /****************************************************************************
  * Name: read_req
  ****************************************************************************/
@@ -689,7 +835,7 @@ static int sendto_request(int fd, FAR struct gs2200m_s *priv,
   struct usrsock_message_req_ack_s resp;
   struct gs2200m_send_msg smsg;
   FAR struct usock_s *usock;
-  uint8_t *sendbuf = NULL;
+  FAR uint8_t *sendbuf;
   ssize_t wlen;
   ssize_t rlen;
   int nret;
@@ -761,8 +907,16 @@ static int sendto_request(int fd, FAR struct gs2200m_s *priv,
 
   if (req->buflen > 0)
     {
-      sendbuf = calloc(1, req->buflen);
-      ASSERT(sendbuf);
+      if (req->buflen > priv->sendbuflen)
+        {
+          sendbuf = realloc(priv->sendbuf, req->buflen);
+          ASSERT(sendbuf);
+
+          priv->sendbuf    = sendbuf;
+          priv->sendbuflen = req->buflen;
+        }
+
+      sendbuf = priv->sendbuf;
 
       /* Read data from usrsock. */
 
@@ -780,6 +934,7 @@ static int sendto_request(int fd, FAR struct gs2200m_s *priv,
 
       nret = ioctl(priv->gsfd, GS2200M_IOC_SEND,
                    (unsigned long)&smsg);
+      gs2200m_stats_inc(priv, nsend, 1);
 
       if (usock->cid != smsg.cid)
         {
@@ -795,15 +950,11 @@ static int sendto_request(int fd, FAR struct gs2200m_s *priv,
       /* return length which gs2200m sent */
 
       ret = smsg.len;
+      gs2200m_stats_inc(priv, txbytes, smsg.len);
     }
 
 prepare:
 
-  if (sendbuf)
-    {
-      free(sendbuf);
-    }
-
   /* Send ACK response. */
 
   memset(&resp, 0, sizeof(resp));
@@ -841,6 +992,10 @@ static int recvfrom_request(int fd, FAR struct gs2200m_s *priv,
   struct usrsock_message_datareq_ack_s resp;
   struct gs2200m_recv_msg rmsg;
   FAR struct usock_s *usock;
+  FAR uint8_t *data = NULL;
+#ifdef GS2200M_READAHEAD
+  bool readahead = false;
+#endif
   int ret = 0;
 
   DEBUGASSERT(priv);
@@ -849,6 +1004,8 @@ static int recvfrom_request(int fd, FAR struct gs2200m_s *priv,
   gs2200m_printf("%s: start (req->max_buflen=%d) \n",
                  __func__, req->max_buflen);
 
+  memset(&rmsg, 0, sizeof(rmsg));
+
   /* Check if this socket exists. */
 
   usock = gs2200m_socket_get(priv, req->usockid);
@@ -867,18 +1024,46 @@ static int recvfrom_request(int fd, FAR struct gs2200m_s *priv,
       goto prepare;
     }
 
-  memset(&rmsg, 0, sizeof(rmsg));
-  rmsg.buf = calloc(1, 1500);
+#ifdef GS2200M_READAHEAD
+  if (SOCK_STREAM == usock->type)
+    {
+      /* Serve the request from the read-ahead buffer */
+
+      readahead = true;
+      gs2200m_readahead(priv, usock);
+
+      if (usock->rxlen > 0)
+        {
+          ret  = MIN(usock->rxlen, req->max_buflen);
+          data = usock->rxbuf + usock->rxhead;
+        }
+      else if (usock->rxerr != 0)
+        {
+          ret = usock->rxerr;
+          usock->rxerr = 0;
+        }
+      else if (!usock->eof)
+        {
+          ret = -EAGAIN;
+        }
+
+      goto prepare;
+    }
+#endif
+
+  rmsg.buf = priv->recvbuf;
   rmsg.cid = usock->cid;
-  rmsg.reqlen = req->max_buflen;
+  rmsg.reqlen = MIN(req->max_buflen, GS2200M_PKTLEN_MAX);
   rmsg.is_tcp = (usock->type == SOCK_STREAM) ? true : false;
 
   ret = ioctl(priv->gsfd, GS2200M_IOC_RECV,
               (unsigned long)&rmsg);
+  gs2200m_stats_inc(priv, nrecv, 1);
 
   if (0 == ret)
     {
-      ret = rmsg.len;
+      ret  = rmsg.len;
+      data = rmsg.buf;
     }
   else
     {
@@ -909,7 +1094,7 @@ prepare:
       resp.valuelen = MIN(resp.valuelen_nontrunc,
                           req->max_addrlen);
 
-      if (0 == rmsg.len)
+      if (0 == ret)
         {
           usock_send_event(fd, priv, usock,
                            USRSOCK_EVENT_REMOTE_CLOSED
@@ -942,20 +1127,43 @@ prepare:
     {
       /* Send buffer */
 
-      ret = _write_to_usock(fd, rmsg.buf, resp.reqack.result);
+      ret = _write_to_usock(fd, data, resp.reqack.result);
 
       if (0 > ret)
         {
           goto err_out;
         }
+
+      gs2200m_stats_inc(priv, rxbytes, resp.reqack.result);
     }
 
+#ifdef GS2200M_READAHEAD
+  if (readahead && resp.reqack.result > 0)
+    {
+      usock->rxhead += resp.reqack.result;
+      usock->rxlen  -= resp.reqack.result;
+
+      if (0 == usock->rxlen)
+        {
+          usock->rxhead = 0;
+        }
+
+      /* Refill the room just made and let kernel-side know that there is
+       * more recv data.
+       */
+
+      if (gs2200m_readahead(priv, usock))
+        {
+          ret = usock_send_event(fd, priv, usock,
+                                 USRSOCK_EVENT_RECVFROM_AVAIL);
+        }
+    }
+#endif
+
 err_out:
 
   gs2200m_printf("%s: *** end ret=%d \n", __func__, ret);
 
-  free(rmsg.buf);
-
   return ret;
 }
 
@@ -1386,6 +1594,142 @@ static int ioctl_request(int fd, FAR struct gs2200m_s *priv,
   return ret;
 }
 
+/****************************************************************************
+ * Name: gs2200m_pollin
+ *
+ * Description:
+ *   Return true if fd can be read without blocking.
+ *
+ ****************************************************************************/
+
+static bool gs2200m_pollin(int fd)
+{
+  struct pollfd pfd;
+
+  pfd.fd      = fd;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+
+  return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) != 0;
+}
+
+/****************************************************************************
+ * Name: gs2200m_events
+ *
+ * Description:
+ *   Take up to CONFIG_WIRELESS_GS2200M_BATCH notifications from the driver
+ *   and tell the kernel-side about the sockets which have data.  The TCP
+ *   data is read ahead, so a burst of packets for one connection results in
+ *   a single event and large recvfrom() responses.
+ *
+ ****************************************************************************/
+
+static void gs2200m_events(int usrsockfd, FAR struct gs2200m_s *priv)
+{
+  FAR struct usock_s *usock;
+#ifdef GS2200M_READAHEAD
+  uint32_t avail = 0;
+  int i;
+#endif
+  int nevents = 0;
+  char cid;
+  int ret;
+
+  do
+    {
+      /* retrieve cid from gs2200m driver */
+
+      cid = 'z';
+      ret = read(priv->gsfd, &cid, sizeof(cid));
+      ASSERT(ret == sizeof(cid));
+      gs2200m_stats_inc(priv, events, 1);
+
+      /* find usock by the cid */
+
+      usock = gs2200m_find_socket_by_cid(priv, cid);
+
+      if (NULL == usock)
+        {
+          gs2200m_printf("=== %s: cid=%c not found (ignored) \n",
+                         __func__, cid);
+        }
+#ifdef GS2200M_READAHEAD
+      else if (SOCK_STREAM == usock->type && CONNECTED == usock->state)
+        {
+          usock->pending++;
+          avail |= 1 << (usock - priv->sockets);
+        }
+#endif
+      else
+        {
+          /* send event to call xxxx_request() */
+
+          usock_send_event(usrsockfd, priv, usock,
+                           USRSOCK_EVENT_RECVFROM_AVAIL);
+        }
+    }
+  while (++nevents < CONFIG_WIRELESS_GS2200M_BATCH &&
+         gs2200m_pollin(priv->gsfd));
+
+#ifdef GS2200M_READAHEAD
+  for (i = 0; avail != 0; i++, avail >>= 1)
+    {
+      usock = &priv->sockets[i];
+
+      if ((avail & 1) != 0 && gs2200m_readahead(priv, usock))
+        {
+          usock_send_event(usrsockfd, priv, usock,
+                           USRSOCK_EVENT_RECVFROM_AVAIL);
+        }
+    }
+#endif
+}
+
+#ifdef GS2200M_STATS
+/****************************************************************************
+ * Name: gs2200m_now
+ ****************************************************************************/
+
+static uint32_t gs2200m_now(void)
+{
+  struct timespec ts;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: gs2200m_stats_show
+ ****************************************************************************/
+
+static void gs2200m_stats_show(FAR struct gs2200m_s *priv, uint32_t elapsed)
+{
+  FAR struct gs2200m_stats_s *stats = &priv->stats;
+
+  if (elapsed == 0)
+    {
+      return;
+    }
+
+  printf("gs2200m: tx %lu B/s (%lu send) rx %lu B/s (%lu recv) "
+         "req %lu ev %lu wakeup %lu\n",
+         (unsigned long)((uint64_t)stats->txbytes * 1000 / elapsed),
+         (unsigned long)stats->nsend,
+         (unsigned long)((uint64_t)stats->rxbytes * 1000 / elapsed),
+         (unsigned long)stats->nrecv,
+         (unsigned long)stats->requests,
+         (unsigned long)stats->events,
+         (unsigned long)stats->wakeups);
+
+  memset(stats, 0, sizeof(*stats));
+}
+#endif
+
 /****************************************************************************
  * Name: gs2200m_loop
  ****************************************************************************/
@@ -1393,11 +1737,15 @@ static int ioctl_request(int fd, FAR struct gs2200m_s *priv,
 static int gs2200m_loop(FAR struct gs2200m_s *priv)
 {
   struct gs2200m_assoc_msg amsg;
-  FAR struct usock_s *usock;
   struct pollfd fds[2];
+  int  timeout = -1;
   int  fd[2];
-  char cid;
   int  ret;
+  int  n;
+#ifdef GS2200M_STATS
+  uint32_t period;
+  uint32_t now;
+#endif
 
   fd[0] = open("/dev/usrsock", O_RDWR);
   ASSERT(0 <= fd[0]);
@@ -1422,6 +1770,11 @@ static int gs2200m_loop(FAR struct gs2200m_s *priv)
       fprintf(stderr, "association failed : retrying\n");
     }
 
+#ifdef GS2200M_STATS
+  timeout = CONFIG_WIRELESS_GS2200M_STATS_INTERVAL * 1000;
+  period  = gs2200m_now();
+#endif
+
   while (true)
     {
       memset(fds, 0, sizeof(fds));
@@ -1433,13 +1786,25 @@ static int gs2200m_loop(FAR struct gs2200m_s *priv)
       fds[1].fd     = fd[1];
       fds[1].events = POLLIN;
 
-      ret = poll(fds, 2, -1);
-      ASSERT(0 < ret);
+      ret = poll(fds, 2, timeout);
+      ASSERT(0 <= ret);
+      gs2200m_stats_inc(priv, wakeups, 1);
 
       if (fds[0].revents & POLLIN)
         {
-          ret = usrsock_request(fd[0], priv);
-          ASSERT(0 == ret);
+          /* Handle the requests queued meanwhile without polling the
+           * driver in between.
+           */
+
+          n = 0;
+          do
+            {
+              ret = usrsock_request(fd[0], priv);
+              ASSERT(0 == ret);
+              gs2200m_stats_inc(priv, requests, 1);
+            }
+          while (++n < CONFIG_WIRELESS_GS2200M_BATCH &&
+                 gs2200m_pollin(fd[0]));
         }
 
       if (fds[1].revents & POLLIN)
@@ -1447,29 +1812,17 @@ static int gs2200m_loop(FAR struct gs2200m_s *priv)
           gs2200m_printf("=== %s: event from /dev/gs2200m \n",
                          __func__);
 
-          /* retrieve cid from gs2200m driver */
-
-          cid = 'z';
-          ret = read(fd[1], &cid, sizeof(cid));
-          ASSERT(ret == sizeof(cid));
-
-          /* find usock by the cid */
-
-          usock = gs2200m_find_socket_by_cid(priv, cid);
-
-          if (NULL == usock)
-            {
-              gs2200m_printf("=== %s: cid=%c not found (ignored) \n",
-                             __func__, cid);
-            }
-          else
-            {
-              /* send event to call xxxx_request() */
+          gs2200m_events(fd[0], priv);
+        }
 
-              usock_send_event(fd[0], priv, usock,
-                               USRSOCK_EVENT_RECVFROM_AVAIL);
-            }
+#ifdef GS2200M_STATS
+      now = gs2200m_now();
+      if (now - period >= (uint32_t)timeout)
+        {
+          gs2200m_stats_show(priv, now - period);
+          period = now;
         }
+#endif
     }
 
   close(fd[1]);
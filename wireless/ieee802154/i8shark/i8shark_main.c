@@ -42,12 +42,17 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <fcntl.h>
 #include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -73,6 +78,23 @@
 #  define CONFIG_IEEE802154_I8SHARK_DAEMON_STACKSIZE 2048
 #endif
 
+#ifndef CONFIG_IEEE802154_I8SHARK_READER_PRIORITY
+#  define CONFIG_IEEE802154_I8SHARK_READER_PRIORITY \
+     (CONFIG_IEEE802154_I8SHARK_DAEMON_PRIORITY + 1)
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_READER_STACKSIZE
+#  define CONFIG_IEEE802154_I8SHARK_READER_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_RINGSIZE
+#  define CONFIG_IEEE802154_I8SHARK_RINGSIZE 8
+#endif
+
+#if CONFIG_IEEE802154_I8SHARK_RINGSIZE < 2
+#  error "CONFIG_IEEE802154_I8SHARK_RINGSIZE must be at least 2"
+#endif
+
 #ifndef CONFIG_IEEE802154_I8SHARK_CHANNEL
 #  define CONFIG_IEEE802154_I8SHARK_CHANNEL 11
 #endif
@@ -90,10 +112,76 @@
 #define ZEP_MAX_HDRSIZE 32
 #define I8SHARK_MAX_ZEPFRAME IEEE802154_MAX_PHY_PACKET_SIZE + ZEP_MAX_HDRSIZE
 
+/* Seconds between the NTP epoch (1900) and the Unix epoch (1970) */
+
+#define NTP_EPOCH_OFFSET 2208988800ul
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+/* pcapng block types and link types */
+
+#  define PCAPNG_SHB_TYPE   0x0a0d0d0a   /* Section Header Block */
+#  define PCAPNG_IDB_TYPE   0x00000001   /* Interface Description Block */
+#  define PCAPNG_EPB_TYPE   0x00000006   /* Enhanced Packet Block */
+#  define PCAPNG_BYTEORDER  0x1a2b3c4d
+
+#  define PCAPNG_SHB_SIZE   28
+#  define PCAPNG_IDB_SIZE   20
+#  define PCAPNG_EPB_HDRSIZE 32          /* EPB size without packet data */
+
+#  if defined(CONFIG_IEEE802154_I8SHARK_SUPPRESS_FCS) || \
+      defined(CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR)
+#    define PCAPNG_LINKTYPE 230          /* LINKTYPE_IEEE802_15_4_NOFCS */
+#  else
+#    define PCAPNG_LINKTYPE 195          /* LINKTYPE_IEEE802_15_4_WITHFCS */
+#  endif
+
+/* Room for a few of the largest Enhanced Packet Blocks.  Blocks are
+ * collected here and written with one write() per wakeup.
+ */
+
+#  define I8SHARK_MAX_EPB \
+     (PCAPNG_EPB_HDRSIZE + ((IEEE802154_MAX_PHY_PACKET_SIZE + 3) & ~3))
+#  define I8SHARK_OUTBUFSIZE (4 * I8SHARK_MAX_EPB)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* One captured frame and the time that it was received */
+
+struct i8shark_rxentry_s
+{
+  struct timespec ts;
+  struct mac802154dev_rxframe_s frame;
+};
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+/* The blocks at the beginning of a pcapng file, in host byte order */
+
+struct pcapng_hdr_s
+{
+  /* Section Header Block */
+
+  uint32_t shb_type;
+  uint32_t shb_size;
+  uint32_t shb_byteorder;
+  uint16_t shb_major;
+  uint16_t shb_minor;
+  uint32_t shb_seclen[2];
+  uint32_t shb_size2;
+
+  /* Interface Description Block */
+
+  uint32_t idb_type;
+  uint32_t idb_size;
+  uint16_t idb_linktype;
+  uint16_t idb_reserved;
+  uint32_t idb_snaplen;
+  uint32_t idb_size2;
+};
+#endif
+
 struct i8shark_state_s
 {
   bool initialized      : 1;
@@ -105,6 +193,32 @@ struct i8shark_state_s
   /* User exposed settings */
 
   FAR char devpath[I8SHARK_MAX_DEVPATH];
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  FAR char *outpath;            /* pcapng file to write instead of UDP */
+#endif
+
+  /* Capture pipeline.  The reader thread is the only writer of 'head' and
+   * the daemon is the only writer of 'tail', so the ring needs no lock.
+   * The reader posts 'rxsem' after each frame it adds.
+   */
+
+  int fd;                       /* MAC character driver */
+  sem_t rxsem;                  /* Counts frames added to the ring */
+  volatile uint16_t head;       /* Next slot written by the reader */
+  volatile uint16_t tail;       /* Next slot read by the daemon */
+  struct i8shark_rxentry_s ring[CONFIG_IEEE802154_I8SHARK_RINGSIZE];
+
+  /* Statistics */
+
+  uint32_t nframes;             /* Frames read from the MAC */
+  uint32_t ndropped;            /* Frames dropped because the ring was full */
+  uint32_t nreaderrs;           /* Failed reads from the MAC */
+  uint32_t nsenderrs;           /* Failed UDP sends or file writes */
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  uint16_t outlen;              /* Bytes pending in outbuf */
+  uint32_t outbuf[I8SHARK_OUTBUFSIZE / 4];
+#endif
 };
 
 /****************************************************************************
@@ -112,6 +226,22 @@ struct i8shark_state_s
  ****************************************************************************/
 
 static int i8shark_init(FAR struct i8shark_state_s *i8shark);
+static void i8shark_stats(FAR struct i8shark_state_s *i8shark);
+static FAR void *i8shark_reader(FAR void *arg);
+static int i8shark_copyframe(FAR const struct mac802154dev_rxframe_s *frame,
+                             uint8_t fcslen, FAR uint8_t *dest);
+static int i8shark_zepframe(FAR const struct i8shark_rxentry_s *entry,
+                            uint8_t chan, uint8_t fcslen,
+                            FAR uint8_t *zepframe);
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+static int i8shark_pcapng_open(FAR struct i8shark_state_s *i8shark);
+static int i8shark_pcapng_frame(FAR struct i8shark_state_s *i8shark,
+                                int outfd,
+                                FAR const struct i8shark_rxentry_s *entry,
+                                uint8_t fcslen);
+static int i8shark_pcapng_flush(FAR struct i8shark_state_s *i8shark,
+                                int outfd);
+#endif
 static int i8shark_daemon(int argc, FAR char *argv[]);
 
 /****************************************************************************
@@ -153,233 +283,622 @@ static int i8shark_init(FAR struct i8shark_state_s *i8shark)
 }
 
 /****************************************************************************
- * Name : i8shark_daemon
+ * Name: i8shark_stats
+ *
+ * Description:
+ *   Report the capture counters.  Any dropped frame means that the capture
+ *   is incomplete.
+ *
+ ****************************************************************************/
+
+static void i8shark_stats(FAR struct i8shark_state_s *i8shark)
+{
+  printf("i8shark: %lu frames, %lu dropped, %lu read errors, "
+         "%lu send errors\n",
+         (unsigned long)i8shark->nframes, (unsigned long)i8shark->ndropped,
+         (unsigned long)i8shark->nreaderrs,
+         (unsigned long)i8shark->nsenderrs);
+}
+
+/****************************************************************************
+ * Name : i8shark_reader
  *
  * Description :
- *   This daemon reads all incoming IEEE 802.15.4 frames from a MAC802154 character
- *   driver, packages the frames into a Wireshark Zigbee Encapsulate Protocol (ZEP)
- *   packet and sends it over Ethernet to the specified host machine running
- *   Wireshark.
+ *   This thread does nothing but read frames from the MAC character driver
+ *   into the ring so that the driver is drained at the rate frames arrive,
+ *   even while the daemon is busy sending earlier frames.  The frame is
+ *   always read into the free slot at 'head', which the daemon never looks
+ *   at.  It is only dropped and counted if the ring is still full once the
+ *   read() returns.
  *
  ****************************************************************************/
 
-static int i8shark_daemon(int argc, FAR char *argv[])
+static FAR void *i8shark_reader(FAR void *arg)
 {
+  FAR struct i8shark_state_s *i8shark = (FAR struct i8shark_state_s *)arg;
   int ret;
-  int fd;
-  struct sockaddr_in addr;
-  struct sockaddr_in raddr;
-  socklen_t addrlen;
-  int sockfd;
 
-  fprintf(stderr, "i8shark: daemon started\n");
-  g_i8shark.daemon_started = true;
+  while (!i8shark->daemon_shutdown)
+    {
+      uint16_t head = i8shark->head;
+      uint16_t next = head + 1;
+      FAR struct i8shark_rxentry_s *entry = &i8shark->ring[head];
 
-  fd = open(g_i8shark.devpath, O_RDWR);
-  if (fd < 0)
+      if (next >= CONFIG_IEEE802154_I8SHARK_RINGSIZE)
+        {
+          next = 0;
+        }
+
+      /* Get an incoming frame from the MAC character driver */
+
+      ret = read(i8shark->fd, &entry->frame,
+                 sizeof(struct mac802154dev_rxframe_s));
+      if (ret < 0)
+        {
+          if (errno != EINTR)
+            {
+              i8shark->nreaderrs++;
+            }
+
+          continue;
+        }
+
+      i8shark->nframes++;
+
+      /* The read() may have blocked for a long time: the daemon may have
+       * freed slots meanwhile.
+       */
+
+      if (next == i8shark->tail)
+        {
+          i8shark->ndropped++;
+          continue;
+        }
+
+      clock_gettime(CLOCK_REALTIME, &entry->ts);
+
+      /* Publish the frame.  The entry is complete before 'head' moves and
+       * sem_post() orders the update for the daemon.
+       */
+
+      i8shark->head = next;
+      sem_post(&i8shark->rxsem);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name : i8shark_copyframe
+ *
+ * Description :
+ *   Copy the part of a received frame that is passed on to Wireshark.
+ *
+ * Returned Value:
+ *   The number of bytes copied to 'dest'.
+ *
+ ****************************************************************************/
+
+static int i8shark_copyframe(FAR const struct mac802154dev_rxframe_s *frame,
+                             uint8_t fcslen, FAR uint8_t *dest)
+{
+#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
+  /* XBee radios use a 2 byte "application header" to support duplicate
+   * packet detection.  Wireshark doesn't know how to handle this data, so we
+   * provide a configuration option that drops the first 2 bytes of the
+   * payload portion of the frame for all sniffed frames
+   *
+   * NOTE: Since we remove data from the frame, the FCS is no longer valid
+   * and Wireshark will fail to disect the frame.  Wireshark ignores a case
+   * where the FCS is not included in the actual frame.  Therefore, we
+   * subtract 4 rather than 2 to remove the FCS field so that the disector
+   * will not fail.
+   */
+
+  memcpy(dest, frame->payload, frame->offset);
+  memcpy(&dest[frame->offset], (frame->payload + frame->offset + 2),
+         (frame->length - frame->offset - 2));
+  return frame->length - 4;
+#else
+  /* If FCS suppression is enabled, fcslen is the FCS length of the current
+   * radio settings and reduces the piece of the frame copied.
+   */
+
+  memcpy(dest, frame->payload, frame->length - fcslen);
+  return frame->length - fcslen;
+#endif
+}
+
+/****************************************************************************
+ * Name : i8shark_zepframe
+ *
+ * Description :
+ *   Package one captured frame as a Wireshark Zigbee Encapsulate Protocol
+ *   (ZEP) packet.
+ *
+ * Returned Value:
+ *   The size of the ZEP packet.
+ *
+ ****************************************************************************/
+
+static int i8shark_zepframe(FAR const struct i8shark_rxentry_s *entry,
+                            uint8_t chan, uint8_t fcslen,
+                            FAR uint8_t *zepframe)
+{
+  FAR const struct mac802154dev_rxframe_s *frame = &entry->frame;
+  enum ieee802154_frametype_e ftype;
+  FAR uint8_t *lenptr = NULL;
+  uint32_t ntpsec;
+  uint32_t ntpfrac;
+  int len;
+  int i = 0;
+
+  /* First 2 bytes of packet represent preamble. For ZEP, "EX" */
+
+  zepframe[i++] = 'E';
+  zepframe[i++] = 'X';
+
+  /* The next byte is the version. We are using V2 */
+
+  zepframe[i++] = 2;
+
+  /* Next byte is type. ZEP only differentiates between ACK and Data. My
+   * assumption is that Data also includes MAC command frames and beacon
+   * frames. So we really only need to check if it's an ACK or not.
+   */
+
+  ftype = ((*(FAR const uint16_t *)frame->payload) &
+           IEEE802154_FRAMECTRL_FTYPE) >> IEEE802154_FRAMECTRL_SHIFT_FTYPE;
+
+  if (ftype == IEEE802154_FRAME_ACK)
     {
-      fprintf(stderr, "ERROR: cannot open %s, errno=%d\n", g_i8shark.devpath, errno);
-      g_i8shark.daemon_started = false;
-      ret = errno;
-      return ret;
+      zepframe[i++] = 2;
+
+      /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
+       * despite 802.15.4 sequence number only being 1-byte
+       */
+
+      zepframe[i] = frame->meta.dsn;
+      i += 4;
     }
+  else
+    {
+      zepframe[i++] = 1;
 
-  /* Place the MAC into promiscuous mode */
+      /* Next bytes is the Channel ID */
 
-  ieee802154_setpromisc(fd, true);
+      zepframe[i++] = chan;
 
-  /* Always listen */
+      /* For now, just hard code the device ID to an arbitrary value */
 
-  ieee802154_setrxonidle(fd, true);
+      zepframe[i++] = 0xfa;
+      zepframe[i++] = 0xde;
+
+      /* Not completely sure what LQI mode is. My best guess as of now based
+       * on a few comments in the Wireshark code is that it determines whether
+       * the last 2 bytes of the frame portion of the packet is the CRC or the
+       * LQI.  I believe it is CRC = 1, LQI = 0. We will assume the CRC is the
+       * last few bytes as that is what the MAC layer expects. However, this
+       * may be a bad assumption for certain radios.
+       */
+
+      zepframe[i++] = 1;
+
+      /* Next byte is the LQI value */
+
+      zepframe[i++] = frame->meta.lqi;
+
+      /* The time that the frame was read from the MAC, as a big-endian NTP
+       * timestamp.
+       */
+
+      ntpsec  = (uint32_t)entry->ts.tv_sec + NTP_EPOCH_OFFSET;
+      ntpfrac = (uint32_t)(((uint64_t)entry->ts.tv_nsec << 32) / 1000000000);
+
+      zepframe[i++] = ntpsec >> 24;
+      zepframe[i++] = ntpsec >> 16;
+      zepframe[i++] = ntpsec >> 8;
+      zepframe[i++] = ntpsec;
+      zepframe[i++] = ntpfrac >> 24;
+      zepframe[i++] = ntpfrac >> 16;
+      zepframe[i++] = ntpfrac >> 8;
+      zepframe[i++] = ntpfrac;
+
+      /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
+       * despite 802.15.4 sequence number only being 1-byte
+       */
 
-  /* Create a UDP socket to send the data to Wireshark */
+      zepframe[i]   = frame->meta.dsn;
+      zepframe[i+1] = 0;
+      zepframe[i+2] = 0;
+      zepframe[i+3] = 0;
+      i += 4;
 
-  sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-  if (sockfd < 0)
+      /* Skip 10-bytes for reserved fields */
+
+      memset(&zepframe[i], 0, 10);
+      i += 10;
+
+      /* Last byte is the length */
+
+      lenptr = &zepframe[i++];
+    }
+
+  /* The ZEP header is filled, now copy the frame in */
+
+  len = i8shark_copyframe(frame, fcslen, &zepframe[i]);
+  if (lenptr != NULL)
     {
-      fprintf(stderr, "ERROR: socket failure %d\n", errno);
-      g_i8shark.daemon_started = false;
-      return -1;
+      *lenptr = len;
     }
 
-  /* We bind to the IP address of the outbound interface so that the OS knows
-   * which interface to use to send the packet.
-   */
+  return i + len;
+}
 
-  netlib_get_ipv4addr(CONFIG_IEEE802154_I8SHARK_FORWARDING_IFNAME, &addr.sin_addr);
-  addr.sin_port   = 0;
-  addr.sin_family = AF_INET;
-  addrlen = sizeof(struct sockaddr_in);
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+/****************************************************************************
+ * Name : i8shark_pcapng_open
+ *
+ * Description :
+ *   Create the pcapng file and write the section header and the interface
+ *   description.
+ *
+ * Returned Value:
+ *   The open file descriptor on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int i8shark_pcapng_open(FAR struct i8shark_state_s *i8shark)
+{
+  struct pcapng_hdr_s hdr;
+  int outfd;
+  int errcode;
 
-  if (bind(sockfd, (FAR struct sockaddr *)&addr, addrlen) < 0)
+  outfd = open(i8shark->outpath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (outfd < 0)
     {
-      fprintf(stderr, "ERROR: Bind failure: %d\n", errno);
-      return -1;
+      return -errno;
     }
 
-  /* Setup our remote address. Wireshark expects ZEP packets over UDP on port 17754 */
+  /* Section Header Block.  The section length is not known (-1) */
 
-  raddr.sin_family      = AF_INET;
-  raddr.sin_port        = HTONS(17754);
-  raddr.sin_addr.s_addr = HTONL(CONFIG_IEEE802154_I8SHARK_HOST_IPADDR);
+  hdr.shb_type      = PCAPNG_SHB_TYPE;
+  hdr.shb_size      = PCAPNG_SHB_SIZE;
+  hdr.shb_byteorder = PCAPNG_BYTEORDER;
+  hdr.shb_major     = 1;
+  hdr.shb_minor     = 0;
+  hdr.shb_seclen[0] = 0xffffffff;
+  hdr.shb_seclen[1] = 0xffffffff;
+  hdr.shb_size2     = PCAPNG_SHB_SIZE;
 
-  /* Loop until the daemon is shutdown reading incoming IEEE 802.15.4 frames,
-   * packing them into Wireshark "Zigbee Encapsulation Packets" (ZEP) and sending
-   * them over UDP to Wireshark.
+  /* Interface Description Block.  No snap length limit and the default
+   * microsecond timestamp resolution.
    */
 
-  while (!g_i8shark.daemon_shutdown)
+  hdr.idb_type      = PCAPNG_IDB_TYPE;
+  hdr.idb_size      = PCAPNG_IDB_SIZE;
+  hdr.idb_linktype  = PCAPNG_LINKTYPE;
+  hdr.idb_reserved  = 0;
+  hdr.idb_snaplen   = 0;
+  hdr.idb_size2     = PCAPNG_IDB_SIZE;
+
+  if (write(outfd, &hdr, sizeof(hdr)) != sizeof(hdr))
     {
-      struct mac802154dev_rxframe_s frame;
-      enum ieee802154_frametype_e ftype;
-      uint8_t zepframe[I8SHARK_MAX_ZEPFRAME];
-      clock_t systime;
-      int i = 0;
-      int nbytes;
+      errcode = errno;
+      close(outfd);
+      return -errcode;
+    }
 
-      /* Get an incoming frame from the MAC character driver */
+  i8shark->outlen = 0;
+  return outfd;
+}
 
-      ret = read(fd, &frame, sizeof(struct mac802154dev_rxframe_s));
-      if (ret < 0)
+/****************************************************************************
+ * Name : i8shark_pcapng_frame
+ *
+ * Description :
+ *   Add one captured frame to the pcapng output buffer as an Enhanced
+ *   Packet Block, writing the buffer first if there is no room for it.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on a write failure.
+ *
+ ****************************************************************************/
+
+static int i8shark_pcapng_frame(FAR struct i8shark_state_s *i8shark,
+                                int outfd,
+                                FAR const struct i8shark_rxentry_s *entry,
+                                uint8_t fcslen)
+{
+  FAR uint32_t *epb;
+  uint64_t usecs;
+  uint32_t blksize;
+  int len;
+  int ret = OK;
+
+  if (i8shark->outlen + I8SHARK_MAX_EPB > I8SHARK_OUTBUFSIZE)
+    {
+      ret = i8shark_pcapng_flush(i8shark, outfd);
+    }
+
+  /* Copy the frame data behind the block header and pad it to 32 bits */
+
+  epb = &i8shark->outbuf[i8shark->outlen >> 2];
+  len = i8shark_copyframe(&entry->frame, fcslen, (FAR uint8_t *)&epb[7]);
+
+  blksize = PCAPNG_EPB_HDRSIZE + ((len + 3) & ~3);
+  memset((FAR uint8_t *)&epb[7] + len, 0, ((len + 3) & ~3) - len);
+
+  usecs = (uint64_t)entry->ts.tv_sec * 1000000 + entry->ts.tv_nsec / 1000;
+
+  epb[0] = PCAPNG_EPB_TYPE;
+  epb[1] = blksize;
+  epb[2] = 0;                           /* Interface ID */
+  epb[3] = (uint32_t)(usecs >> 32);
+  epb[4] = (uint32_t)usecs;
+  epb[5] = len;                         /* Captured length */
+  epb[6] = len;                         /* Original length */
+  epb[(blksize >> 2) - 1] = blksize;
+
+  i8shark->outlen += blksize;
+  return ret;
+}
+
+/****************************************************************************
+ * Name : i8shark_pcapng_flush
+ *
+ * Description :
+ *   Write the pending Enhanced Packet Blocks to the pcapng file.
+ *
+ ****************************************************************************/
+
+static int i8shark_pcapng_flush(FAR struct i8shark_state_s *i8shark,
+                                int outfd)
+{
+  ssize_t nwritten;
+  int ret = OK;
+
+  if (i8shark->outlen > 0)
+    {
+      nwritten = write(outfd, i8shark->outbuf, i8shark->outlen);
+      if (nwritten != i8shark->outlen)
         {
-          continue;
+          ret = nwritten < 0 ? -errno : -EIO;
         }
 
-      /* First 2 bytes of packet represent preamble. For ZEP, "EX" */
+      i8shark->outlen = 0;
+    }
 
-      zepframe[i++] = 'E';
-      zepframe[i++] = 'X';
+  return ret;
+}
+#endif
 
-      /* The next byte is the version. We are using V2 */
+/****************************************************************************
+ * Name : i8shark_daemon
+ *
+ * Description :
+ *   This daemon takes the IEEE 802.15.4 frames that the reader thread
+ *   collects from a MAC802154 character driver, packages the frames into a
+ *   Wireshark Zigbee Encapsulate Protocol (ZEP) packet and sends it over
+ *   Ethernet to the specified host machine running Wireshark.  If an output
+ *   file was given, the frames are written to that pcapng file instead.
+ *
+ *   Each wakeup handles all of the frames that are waiting in the ring.
+ *
+ ****************************************************************************/
 
-      zepframe[i++] = 2;
+static int i8shark_daemon(int argc, FAR char *argv[])
+{
+  struct sched_param sparam;
+  pthread_attr_t attr;
+  pthread_t reader;
+  struct sockaddr_in addr;
+  struct sockaddr_in raddr;
+  socklen_t addrlen;
+  int sockfd = -1;
+  int outfd = -1;
+  int ret = ERROR;
 
-      /* Next byte is type. ZEP only differentiates between ACK and Data. My
-       * assumption is that Data also includes MAC command frames and beacon
-       * frames. So we really only need to check if it's an ACK or not.
-       */
+  fprintf(stderr, "i8shark: daemon started\n");
+  g_i8shark.daemon_started = true;
 
-      ftype = ((*(uint16_t *)frame.payload) & IEEE802154_FRAMECTRL_FTYPE) >>
-              IEEE802154_FRAMECTRL_SHIFT_FTYPE;
+  g_i8shark.fd = open(g_i8shark.devpath, O_RDWR);
+  if (g_i8shark.fd < 0)
+    {
+      fprintf(stderr, "ERROR: cannot open %s, errno=%d\n", g_i8shark.devpath, errno);
+      g_i8shark.daemon_started = false;
+      return errno;
+    }
 
-      if (ftype == IEEE802154_FRAME_ACK)
-        {
-          zepframe[i++] = 2;
+  /* Place the MAC into promiscuous mode */
 
-          /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
-           * despite 802.15.4 sequence number only being 1-byte
-           */
+  ieee802154_setpromisc(g_i8shark.fd, true);
 
-          zepframe[i] = frame.meta.dsn;
-          i += 4;
-        }
-      else
-        {
-          zepframe[i++] = 1;
+  /* Always listen */
 
-          /* Next bytes is the Channel ID */
+  ieee802154_setrxonidle(g_i8shark.fd, true);
 
-          ieee802154_getchan(fd, &zepframe[i++]);
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  if (g_i8shark.outpath != NULL)
+    {
+      outfd = i8shark_pcapng_open(&g_i8shark);
+      if (outfd < 0)
+        {
+          fprintf(stderr, "ERROR: cannot create %s: %d\n",
+                  g_i8shark.outpath, outfd);
+          goto errout_with_fd;
+        }
+    }
+  else
+#endif
+    {
+      /* Create a UDP socket to send the data to Wireshark */
 
-          /* For now, just hard code the device ID to an arbitrary value */
+      sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+      if (sockfd < 0)
+        {
+          fprintf(stderr, "ERROR: socket failure %d\n", errno);
+          goto errout_with_fd;
+        }
 
-          zepframe[i++] = 0xFA;
-          zepframe[i++] = 0xDE;
+      /* We bind to the IP address of the outbound interface so that the OS
+       * knows which interface to use to send the packet.
+       */
 
-          /* Not completely sure what LQI mode is. My best guess as of now based
-           * on a few comments in the Wireshark code is that it determines whether
-           * the last 2 bytes of the frame portion of the packet is the CRC or the
-           * LQI.  I believe it is CRC = 1, LQI = 0. We will assume the CRC is the
-           * last few bytes as that is what the MAC layer expects. However, this
-           * may be a bad assumption for certain radios.
-           */
+      netlib_get_ipv4addr(CONFIG_IEEE802154_I8SHARK_FORWARDING_IFNAME,
+                          &addr.sin_addr);
+      addr.sin_port   = 0;
+      addr.sin_family = AF_INET;
+      addrlen = sizeof(struct sockaddr_in);
 
-          zepframe[i++] = 1;
+      if (bind(sockfd, (FAR struct sockaddr *)&addr, addrlen) < 0)
+        {
+          fprintf(stderr, "ERROR: Bind failure: %d\n", errno);
+          goto errout_with_output;
+        }
 
-          /* Next byte is the LQI value */
+      /* Setup our remote address. Wireshark expects ZEP packets over UDP on
+       * port 17754
+       */
 
-          zepframe[i++] = frame.meta.lqi;
+      raddr.sin_family      = AF_INET;
+      raddr.sin_port        = HTONS(17754);
+      raddr.sin_addr.s_addr = HTONL(CONFIG_IEEE802154_I8SHARK_HOST_IPADDR);
+    }
 
-          /* Need to use NTP to get time, but for now, include the system time */
+  /* Start the reader thread with an empty ring */
 
-          systime = clock();
-          memcpy(&zepframe[i], &systime, 8);
-          i += 8;
+  g_i8shark.head      = 0;
+  g_i8shark.tail      = 0;
+  g_i8shark.nframes   = 0;
+  g_i8shark.ndropped  = 0;
+  g_i8shark.nreaderrs = 0;
+  g_i8shark.nsenderrs = 0;
+  sem_init(&g_i8shark.rxsem, 0, 0);
 
-          /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
-           * despite 802.15.4 sequence number only being 1-byte
-           */
+  pthread_attr_init(&attr);
+  sparam.sched_priority = CONFIG_IEEE802154_I8SHARK_READER_PRIORITY;
+  pthread_attr_setschedparam(&attr, &sparam);
+  pthread_attr_setstacksize(&attr, CONFIG_IEEE802154_I8SHARK_READER_STACKSIZE);
 
-          zepframe[i]   = frame.meta.dsn;
-          zepframe[i+1] = 0;
-          zepframe[i+2] = 0;
-          zepframe[i+3] = 0;
-          i += 4;
+  ret = pthread_create(&reader, &attr, i8shark_reader, &g_i8shark);
+  if (ret != 0)
+    {
+      fprintf(stderr, "ERROR: cannot start reader thread: %d\n", ret);
+      sem_destroy(&g_i8shark.rxsem);
+      ret = ERROR;
+      goto errout_with_output;
+    }
 
-          /* Skip 10-bytes for reserved fields */
+  /* Loop until the daemon is shutdown taking the frames that the reader
+   * collects, packing them into Wireshark "Zigbee Encapsulation Packets"
+   * (ZEP) and sending them over UDP to Wireshark (or writing them to the
+   * pcapng file).
+   */
 
-          i += 10;
+  while (!g_i8shark.daemon_shutdown)
+    {
+      uint8_t zepframe[I8SHARK_MAX_ZEPFRAME];
+      uint8_t fcslen = 0;
+      uint8_t chan = 0;
+      uint16_t tail;
+      int nbytes;
+      int len;
 
-          /* Last byte is the length */
+      /* Wait for the reader to add frames to the ring */
 
-#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
-          zepframe[i++] = frame.length - 2;
-#else
-          zepframe[i++] = frame.length;
-#endif
+      if (sem_wait(&g_i8shark.rxsem) < 0)
+        {
+          continue;
         }
 
-      /* The ZEP header is filled, now copy the frame in */
+      tail = g_i8shark.tail;
+      if (tail == g_i8shark.head)
+        {
+          /* Already handled in an earlier wakeup */
 
-#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
-      memcpy(&zepframe[i], frame.payload, frame.offset);
-      i += frame.offset;
-
-      /* XBee radios use a 2 byte "application header" to support duplicate packet
-       * detection.  Wireshark doesn't know how to handle this data, so we provide
-       * a configuration option that drops the first 2 bytes of the payload portion
-       * of the frame for all sniffed frames
-       *
-       * NOTE: Since we remove data from the frame, the FCS is no longer valid
-       * and Wireshark will fail to disect the frame.  Wireshark ignores a case
-       * where the FCS is not included in the actual frame.  Therefore, we
-       * subtract 4 rather than 2 to remove the FCS field so that the disector
-       * will not fail.
-       */
+          continue;
+        }
 
-      memcpy(&zepframe[i], (frame.payload + frame.offset + 2),
-             (frame.length - frame.offset - 2));
-      i += frame.length - frame.offset - 4;
-#else
-      /* If FCS suppression is enabled, subtract the FCS length to reduce the
-       * piece of the frame copied.
-       */
+      /* The radio settings are the same for the whole batch */
 
+      ieee802154_getchan(g_i8shark.fd, &chan);
 #ifdef CONFIG_IEEE802154_I8SHARK_SUPPRESS_FCS
-      {
-        uint8_t fcslen;
-        ieee802154_getfcslen(fd, &fcslen);
-        frame.length -= fcslen;
-      }
+      ieee802154_getfcslen(g_i8shark.fd, &fcslen);
 #endif
 
-      memcpy(&zepframe[i], frame.payload, frame.length);
-      i += frame.length;
+      /* Handle every frame that is waiting */
+
+      while (tail != g_i8shark.head)
+        {
+          FAR struct i8shark_rxentry_s *entry = &g_i8shark.ring[tail];
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+          if (outfd >= 0)
+            {
+              if (i8shark_pcapng_frame(&g_i8shark, outfd, entry,
+                                       fcslen) < 0)
+                {
+                  g_i8shark.nsenderrs++;
+                }
+            }
+          else
 #endif
+            {
+              /* Send the encapsulated frame to Wireshark over UDP */
+
+              len = i8shark_zepframe(entry, chan, fcslen, zepframe);
+              nbytes = sendto(sockfd, zepframe, len, 0,
+                              (FAR struct sockaddr *)&raddr, addrlen);
+              if (nbytes < len)
+                {
+                  g_i8shark.nsenderrs++;
+                }
+            }
+
+          /* Give the slot back to the reader */
+
+          if (++tail >= CONFIG_IEEE802154_I8SHARK_RINGSIZE)
+            {
+              tail = 0;
+            }
 
-      /* Send the encapsulated frame to Wireshark over UDP */
+          g_i8shark.tail = tail;
+        }
 
-      nbytes = sendto(sockfd, zepframe, i, 0, (struct sockaddr*)&raddr, addrlen);
-      if (nbytes < i)
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+      if (outfd >= 0 && i8shark_pcapng_flush(&g_i8shark, outfd) < 0)
         {
-          fprintf(stderr, "ERROR: sendto() did not send all bytes. %d\n", errno);
+          g_i8shark.nsenderrs++;
         }
+#endif
+    }
+
+  /* Stop the reader (it is waiting in read()) */
+
+  pthread_cancel(reader);
+  pthread_join(reader, NULL);
+  sem_destroy(&g_i8shark.rxsem);
+
+  i8shark_stats(&g_i8shark);
+  ret = OK;
+
+errout_with_output:
+  if (sockfd >= 0)
+    {
+      close(sockfd);
     }
 
+  if (outfd >= 0)
+    {
+      close(outfd);
+    }
+
+errout_with_fd:
   g_i8shark.daemon_started = false;
-  close(fd);
+  close(g_i8shark.fd);
   printf("i8shark: daemon closing\n");
-  return OK;
+  return ret;
 }
 
 /****************************************************************************
@@ -399,7 +918,17 @@ int main(int argc, FAR char *argv[])
       i8shark_init(&g_i8shark);
     }
 
-  if (argc > 1)
+  /* If the daemon is already running, just report how the capture is
+   * doing.
+   */
+
+  if (g_i8shark.daemon_started)
+    {
+      i8shark_stats(&g_i8shark);
+      return OK;
+    }
+
+  if (argc > argind)
     {
       /* If the first argument is an interface, update our character device path */
 
@@ -407,25 +936,46 @@ int main(int argc, FAR char *argv[])
         {
           /* Check if the name is the same as the current one */
 
-          if (!strcmp(g_i8shark.devpath, argv[argind]))
+          if (strcmp(g_i8shark.devpath, argv[argind]) != 0)
             {
-              /* Adapter daemon can't be running when we change device path */
-
-              if (g_i8shark.daemon_started)
-                {
-                  printf("Can't change devpath when daemon is running.\n");
-                  exit(1);
-                }
-
               /* Copy the path into our state structure */
 
-              strcpy(g_i8shark.devpath, argv[1]);
+              strncpy(g_i8shark.devpath, argv[argind], I8SHARK_MAX_DEVPATH);
+              g_i8shark.devpath[I8SHARK_MAX_DEVPATH - 1] = '\0';
             }
 
           argind++;
         }
     }
 
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  /* -w <file> writes the capture to a pcapng file instead of sending it to
+   * Wireshark.
+   */
+
+  if (g_i8shark.outpath != NULL)
+    {
+      free(g_i8shark.outpath);
+      g_i8shark.outpath = NULL;
+    }
+
+  if (argc > argind + 1 && strcmp(argv[argind], "-w") == 0)
+    {
+      g_i8shark.outpath = strdup(argv[argind + 1]);
+      argind += 2;
+    }
+#endif
+
+  if (argc > argind)
+    {
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+      fprintf(stderr, "Usage: i8shark [/dev/<ieee>] [-w <file>]\n");
+#else
+      fprintf(stderr, "Usage: i8shark [/dev/<ieee>]\n");
+#endif
+      return ERROR;
+    }
+
   /* If the daemon is not running, start it. */
 
   g_i8shark.daemon_pid = task_create("i8shark",
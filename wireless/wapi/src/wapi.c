@@ -665,31 +665,16 @@ static int wapi_txpower_cmd(int sock, int argc, FAR char **argv)
 
 static int wapi_scan_results_cmd(int sock, int argc, FAR char **argv)
 {
-  int sleepdur = 200 * 1000;
-  int sleeptries = 25;
   struct wapi_list_s list;
   FAR struct wapi_scan_info_s *info;
   int ret;
 
   /* Wait for completion */
 
-  do
-    {
-      ret = wapi_scan_stat(sock, argv[0]);
-      if (ret < 0)
-        {
-          WAPI_ERROR("ERROR: wapi_scan_stat() failed: %d, sleeptries: %d\n",
-                      ret, sleeptries);
-        }
-      else if (ret == 1)
-        {
-          usleep(sleepdur);
-        }
-    }
-  while (--sleeptries > 0 && ret > 0);
-
+  ret = wapi_scan_wait(sock, argv[0], 5000);
   if (ret < 0)
     {
+      WAPI_ERROR("ERROR: wapi_scan_wait() failed: %d\n", ret);
       return ret;
     }
 
@@ -39,9 +39,13 @@
  ****************************************************************************/
 
 #include <sys/ioctl.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <unistd.h>
+#include <time.h>
 #include <math.h>
 #include <errno.h>
 
@@ -51,6 +55,15 @@
 #include "wireless/wapi.h"
 #include "util.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* wapi_scan_wait() status polling interval, doubled up to the maximum */
+
+#define WAPI_SCAN_WAIT_MIN_MS  10
+#define WAPI_SCAN_WAIT_MAX_MS  100
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -294,55 +307,20 @@ static int wapi_event_stream_extract(FAR struct wapi_event_stream_s *stream,
 }
 
 /****************************************************************************
- * Name: wapi_scan_event
+ * Name: wapi_scan_event_info
  *
  * Description:
+ *   Decodes a scan event describing the current cell into info.
  *
  ****************************************************************************/
 
-static int wapi_scan_event(FAR struct iw_event *event,
-                           FAR struct wapi_list_s *list)
+static int wapi_scan_event_info(FAR struct iw_event *event,
+                                FAR struct wapi_scan_info_s *info)
 {
-  FAR struct wapi_scan_info_s *info;
-
-  /* Get current "wapi_info_t". */
-
-  info = list->head.scan;
-
   /* Decode the event. */
 
   switch (event->cmd)
     {
-    case SIOCGIWAP:
-      {
-        struct wapi_scan_info_s *temp;
-
-        /* Allocate a new cell. */
-
-        temp = malloc(sizeof(struct wapi_scan_info_s));
-        if (!temp)
-          {
-            WAPI_STRERROR("malloc()");
-            return -1;
-          }
-
-        /* Reset it. */
-
-        bzero(temp, sizeof(struct wapi_scan_info_s));
-
-        /* Save cell identifier. */
-
-        memcpy(&temp->ap, &event->u.ap_addr.sa_data,
-               sizeof(struct ether_addr));
-
-        /* Push it to the head of the list. */
-
-        temp->next = info;
-        list->head.scan = temp;
-
-        break;
-      }
-
     case SIOCGIWFREQ:
       {
         info->has_freq = 1;
@@ -439,6 +417,265 @@ static int wapi_scan_event(FAR struct iw_event *event,
   return 0;
 }
 
+/****************************************************************************
+ * Name: wapi_scan_event
+ *
+ * Description:
+ *
+ ****************************************************************************/
+
+static int wapi_scan_event(FAR struct iw_event *event,
+                           FAR struct wapi_list_s *list)
+{
+  FAR struct wapi_scan_info_s *info;
+
+  /* Get current "wapi_info_t". */
+
+  info = list->head.scan;
+
+  if (event->cmd == SIOCGIWAP)
+    {
+      struct wapi_scan_info_s *temp;
+
+      /* Allocate a new cell. */
+
+      temp = malloc(sizeof(struct wapi_scan_info_s));
+      if (!temp)
+        {
+          WAPI_STRERROR("malloc()");
+          return -1;
+        }
+
+      /* Reset it. */
+
+      bzero(temp, sizeof(struct wapi_scan_info_s));
+
+      /* Save cell identifier. */
+
+      memcpy(&temp->ap, &event->u.ap_addr.sa_data,
+             sizeof(struct ether_addr));
+
+      /* Push it to the head of the list. */
+
+      temp->next = info;
+      list->head.scan = temp;
+      return 0;
+    }
+
+  if (info == NULL)
+    {
+      return 0;
+    }
+
+  return wapi_scan_event_info(event, info);
+}
+
+/****************************************************************************
+ * Name: wapi_scan_fetch
+ *
+ * Description:
+ *   Reads the results of a scan process into *buf, growing it as needed.
+ *
+ * Input Parameters:
+ *   buf    - Result buffer, allocated if NULL.
+ *   buflen - Size of *buf.
+ *
+ * Returned Value:
+ *   The length of the results; a negated errno on failure.
+ *
+ ****************************************************************************/
+
+static int wapi_scan_fetch(int sock, FAR const char *ifname,
+                           FAR char **buf, FAR size_t *buflen)
+{
+  struct iwreq wrq =
+  {
+  };
+
+  FAR char *tmp;
+  int ret;
+
+  if (*buf == NULL)
+    {
+      *buflen = IW_SCAN_MAX_DATA;
+      *buf = malloc(*buflen);
+      if (*buf == NULL)
+        {
+          WAPI_STRERROR("malloc()");
+          return -ENOMEM;
+        }
+    }
+
+  for (; ; )
+    {
+      /* Collect results. */
+
+      wrq.u.data.pointer = *buf;
+      wrq.u.data.length  = *buflen;
+      wrq.u.data.flags   = 0;
+      strncpy(wrq.ifr_name, ifname, IFNAMSIZ);
+
+      ret = ioctl(sock, SIOCGIWSCAN, (unsigned long)((uintptr_t)&wrq));
+      if (ret >= 0)
+        {
+          return wrq.u.data.length;
+        }
+
+      if (errno != E2BIG)
+        {
+          break;
+        }
+
+      tmp = realloc(*buf, *buflen * 2);
+      if (!tmp)
+        {
+          WAPI_STRERROR("realloc()");
+          return -ENOMEM;
+        }
+
+      *buf = tmp;
+      *buflen *= 2;
+    }
+
+  /* There is still something wrong. It's either EAGAIN or some other ioctl()
+   * failure. We don't bother, let the user deal with it.
+   */
+
+  ret = -errno;
+  if (ret != -EAGAIN)
+    {
+      WAPI_IOCTL_STRERROR(SIOCGIWSCAN, -ret);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: wapi_scan_now
+ *
+ * Description:
+ *   Time base of the scan cache, in milliseconds.
+ *
+ ****************************************************************************/
+
+static uint32_t wapi_scan_now(void)
+{
+  struct timespec ts;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: wapi_scan_cache_merge
+ *
+ * Description:
+ *   Merges one scan result into the cache.  The fields that the result
+ *   does not report are kept from the previous results of the BSS.
+ *
+ ****************************************************************************/
+
+static void wapi_scan_cache_merge(FAR struct wapi_scan_cache_s *cache,
+                                  FAR const struct wapi_scan_info_s *info,
+                                  uint32_t now)
+{
+  FAR struct wapi_scan_entry_s *entry = NULL;
+  FAR struct wapi_scan_info_s *cached;
+  enum wapi_scan_change_e change;
+  int i;
+
+  for (i = 0; i < cache->nentries; i++)
+    {
+      if (memcmp(&cache->entries[i].info.ap, &info->ap,
+                 sizeof(struct ether_addr)) == 0)
+        {
+          entry = &cache->entries[i];
+          break;
+        }
+    }
+
+  if (entry != NULL)
+    {
+      change = WAPI_SCAN_UPDATED;
+      cached = &entry->info;
+
+      if (info->has_essid)
+        {
+          cached->has_essid  = 1;
+          cached->essid_flag = info->essid_flag;
+          memcpy(cached->essid, info->essid, sizeof(cached->essid));
+        }
+
+      if (info->has_freq)
+        {
+          cached->has_freq = 1;
+          cached->freq     = info->freq;
+        }
+
+      if (info->has_mode)
+        {
+          cached->has_mode = 1;
+          cached->mode     = info->mode;
+        }
+
+      if (info->has_bitrate)
+        {
+          cached->has_bitrate = 1;
+          cached->bitrate     = info->bitrate;
+        }
+
+      if (info->has_rssi)
+        {
+          cached->has_rssi = 1;
+          cached->rssi     = info->rssi;
+        }
+    }
+  else
+    {
+      change = WAPI_SCAN_NEW;
+
+      if (cache->nentries < CONFIG_WIRELESS_WAPI_SCAN_CACHE_SIZE)
+        {
+          entry = &cache->entries[cache->nentries++];
+        }
+      else
+        {
+          /* Full, replace the entry reported least recently */
+
+          entry = &cache->entries[0];
+          for (i = 1; i < cache->nentries; i++)
+            {
+              if ((int32_t)(cache->entries[i].seen - entry->seen) < 0)
+                {
+                  entry = &cache->entries[i];
+                }
+            }
+
+          if (cache->cb != NULL)
+            {
+              cache->cb(cache->arg, WAPI_SCAN_EXPIRED, &entry->info);
+            }
+        }
+
+      entry->info  = *info;
+      entry->count = 0;
+    }
+
+  entry->info.next = NULL;
+  entry->seen = now;
+  entry->count++;
+
+  if (cache->cb != NULL)
+    {
+      cache->cb(cache->arg, change, &entry->info);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1180,6 +1417,68 @@ int wapi_scan_init(int sock, const char *ifname, const char *essid)
   return ret;
 }
 
+/****************************************************************************
+ * Name: wapi_scan_channel_init
+ *
+ * Description:
+ *   Starts a scan of the given channels only.
+ *
+ ****************************************************************************/
+
+int wapi_scan_channel_init(int sock, FAR const char *ifname,
+                           FAR const char *essid,
+                           FAR const uint8_t *channels, int nchannels)
+{
+  struct iw_scan_req req;
+  struct iwreq wrq =
+  {
+  };
+
+  size_t essid_len;
+  int ret;
+  int i;
+
+  if (nchannels <= 0 || nchannels > IW_MAX_FREQUENCIES)
+    {
+      return -EINVAL;
+    }
+
+  memset(&req, 0, sizeof(req));
+  req.bssid.sa_family = ARPHRD_ETHER;
+  memset(req.bssid.sa_data, 0xff, IFHWADDRLEN);
+  wrq.u.data.flags    = IW_SCAN_THIS_FREQ;
+
+  if (essid && (essid_len = strlen(essid)) > 0)
+    {
+      req.essid_len     = essid_len;
+      memcpy(req.essid, essid, essid_len);
+      wrq.u.data.flags |= IW_SCAN_THIS_ESSID;
+    }
+
+  /* Channel numbers are passed as frequencies with a zero exponent */
+
+  req.num_channels = nchannels;
+  for (i = 0; i < nchannels; i++)
+    {
+      req.channel_list[i].m = channels[i];
+      req.channel_list[i].e = 0;
+    }
+
+  wrq.u.data.pointer = (caddr_t)&req;
+  wrq.u.data.length  = sizeof(req);
+
+  strncpy(wrq.ifr_name, ifname, IFNAMSIZ);
+  ret = ioctl(sock, SIOCSIWSCAN, (unsigned long)((uintptr_t)&wrq));
+  if (ret < 0)
+    {
+      int errcode = errno;
+      WAPI_IOCTL_STRERROR(SIOCSIWSCAN, errcode);
+      ret = -errcode;
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: wapi_scan_stat
  *
@@ -1219,97 +1518,86 @@ int wapi_scan_stat(int sock, FAR const char *ifname)
           return 1;
         }
 
-      printf("err[%d]: %s\n", errno, strerror(errno));
-    }
-  else
-    {
       int errcode = errno;
       WAPI_IOCTL_STRERROR(SIOCGIWSCAN, errcode);
       ret = -errcode;
     }
+  else
+    {
+      /* Data is ready (and empty). */
+
+      ret = 0;
+    }
 
   return ret;
 }
 
 /****************************************************************************
- * Name: wapi_scan_coll
+ * Name: wapi_scan_wait
  *
  * Description:
- *   Collects the results of a scan process.
+ *   Waits for the completion of a scan.  The status is checked at short
+ *   intervals first, so that partial scans are picked up quickly.
  *
- * Input Parameters:
- *   aps - Pushes collected  struct wapi_scan_info_s into this list.
+ * Returned Value:
+ *   Zero, if data is ready; -ETIMEDOUT or another negated errno on failure.
  *
  ****************************************************************************/
 
-int wapi_scan_coll(int sock, FAR const char *ifname,
-                   FAR struct wapi_list_s *aps)
+int wapi_scan_wait(int sock, FAR const char *ifname, int timeout_ms)
 {
-  FAR char *buf;
-  int buflen;
-  struct iwreq wrq =
-  {
-  };
-
+  uint32_t start = wapi_scan_now();
+  int delay = WAPI_SCAN_WAIT_MIN_MS;
   int ret;
 
-  WAPI_VALIDATE_PTR(aps);
-
-  buflen = IW_SCAN_MAX_DATA;
-  buf = malloc(buflen * sizeof(char));
-  if (!buf)
+  while ((ret = wapi_scan_stat(sock, ifname)) == 1)
     {
-      WAPI_STRERROR("malloc()");
-      return -1;
-    }
-
-alloc:
-
-  /* Collect results. */
-
-  wrq.u.data.pointer = buf;
-  wrq.u.data.length  = buflen;
-  wrq.u.data.flags   = 0;
-  strncpy(wrq.ifr_name, ifname, IFNAMSIZ);
+      if ((int)(wapi_scan_now() - start) >= timeout_ms)
+        {
+          return -ETIMEDOUT;
+        }
 
-  ret = ioctl(sock, SIOCGIWSCAN, (unsigned long)((uintptr_t)&wrq));
-  if (ret < 0 && errno == E2BIG)
-    {
-      FAR char *tmp;
+      usleep(delay * 1000);
 
-      buflen *= 2;
-      tmp = realloc(buf, buflen);
-      if (!tmp)
+      if (delay < WAPI_SCAN_WAIT_MAX_MS)
         {
-          WAPI_STRERROR("realloc()");
-          free(buf);
-          return -1;
+          delay *= 2;
         }
-
-      buf = tmp;
-      goto alloc;
     }
 
-  /* There is still something wrong. It's either EAGAIN or some other ioctl()
-   * failure. We don't bother, let the user deal with it.
-   */
+  return ret;
+}
 
-  if (ret < 0)
-    {
-      int errcode = errno;
-      WAPI_IOCTL_STRERROR(SIOCGIWSCAN, errcode);
-      free(buf);
-      return -errcode;
-    }
+/****************************************************************************
+ * Name: wapi_scan_coll
+ *
+ * Description:
+ *   Collects the results of a scan process.
+ *
+ * Input Parameters:
+ *   aps - Pushes collected  struct wapi_scan_info_s into this list.
+ *
+ ****************************************************************************/
+
+int wapi_scan_coll(int sock, FAR const char *ifname,
+                   FAR struct wapi_list_s *aps)
+{
+  FAR char *buf = NULL;
+  size_t buflen;
+  int ret;
+
+  WAPI_VALIDATE_PTR(aps);
+
+  ret = wapi_scan_fetch(sock, ifname, &buf, &buflen);
 
   /* We have the results, process them. */
 
-  if (wrq.u.data.length)
+  if (ret > 0)
     {
       struct iw_event iwe;
       struct wapi_event_stream_s stream;
 
-      wapi_event_stream_init(&stream, buf, wrq.u.data.length);
+      wapi_event_stream_init(&stream, buf, ret);
       do
         {
           /* Get the next event from the stream */
@@ -1366,3 +1654,174 @@ void wapi_scan_coll_free(FAR struct wapi_list_s *list)
       info = temp;
     }
 }
+
+/****************************************************************************
+ * Name: wapi_scan_cache_init
+ *
+ * Description:
+ *   Initializes an empty scan result cache.
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_init(FAR struct wapi_scan_cache_s *cache,
+                          uint32_t maxage, wapi_scan_cb_t cb,
+                          FAR void *arg)
+{
+  memset(cache, 0, sizeof(struct wapi_scan_cache_s));
+  cache->maxage = maxage;
+  cache->cb     = cb;
+  cache->arg    = arg;
+}
+
+/****************************************************************************
+ * Name: wapi_scan_cache_update
+ *
+ * Description:
+ *   Collects the results of a scan process and merges them into the cache.
+ *
+ * Returned Value:
+ *   The number of results merged; a negated errno on failure.
+ *
+ ****************************************************************************/
+
+int wapi_scan_cache_update(int sock, FAR const char *ifname,
+                           FAR struct wapi_scan_cache_s *cache)
+{
+  struct wapi_event_stream_s stream;
+  struct wapi_scan_info_s info;
+  struct iw_event iwe;
+  bool valid = false;
+  int nresults = 0;
+  uint32_t now;
+  int ret;
+
+  WAPI_VALIDATE_PTR(cache);
+
+  ret = wapi_scan_fetch(sock, ifname, &cache->buf, &cache->buflen);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  now = wapi_scan_now();
+
+  /* Decode the cells straight into the cache: each SIOCGIWAP event starts
+   * a new cell and completes the previous one.
+   */
+
+  wapi_event_stream_init(&stream, cache->buf, ret);
+  while ((ret = wapi_event_stream_extract(&stream, &iwe)) > 0)
+    {
+      if (iwe.cmd == SIOCGIWAP)
+        {
+          if (valid)
+            {
+              wapi_scan_cache_merge(cache, &info, now);
+              nresults++;
+            }
+
+          bzero(&info, sizeof(struct wapi_scan_info_s));
+          memcpy(&info.ap, &iwe.u.ap_addr.sa_data,
+                 sizeof(struct ether_addr));
+          valid = true;
+        }
+      else if (valid)
+        {
+          wapi_scan_event_info(&iwe, &info);
+        }
+    }
+
+  if (ret < 0)
+    {
+      WAPI_ERROR("ERROR: wapi_event_stream_extract() failed!\n");
+    }
+
+  if (valid)
+    {
+      wapi_scan_cache_merge(cache, &info, now);
+      nresults++;
+    }
+
+  wapi_scan_cache_expire(cache);
+  return ret < 0 ? ret : nresults;
+}
+
+/****************************************************************************
+ * Name: wapi_scan_cache_expire
+ *
+ * Description:
+ *   Drops the cache entries not reported for cache->maxage ms.
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_expire(FAR struct wapi_scan_cache_s *cache)
+{
+  FAR struct wapi_scan_entry_s *entry;
+  uint32_t now;
+  int i = 0;
+
+  if (cache->maxage == 0)
+    {
+      return;
+    }
+
+  now = wapi_scan_now();
+  while (i < cache->nentries)
+    {
+      entry = &cache->entries[i];
+      if (now - entry->seen <= cache->maxage)
+        {
+          i++;
+          continue;
+        }
+
+      if (cache->cb != NULL)
+        {
+          cache->cb(cache->arg, WAPI_SCAN_EXPIRED, &entry->info);
+        }
+
+      *entry = cache->entries[--cache->nentries];
+    }
+}
+
+/****************************************************************************
+ * Name: wapi_scan_cache_find
+ *
+ * Description:
+ *   Looks up a BSS in the cache.
+ *
+ ****************************************************************************/
+
+FAR const struct wapi_scan_entry_s *
+wapi_scan_cache_find(FAR const struct wapi_scan_cache_s *cache,
+                     FAR const struct ether_addr *bssid)
+{
+  int i;
+
+  for (i = 0; i < cache->nentries; i++)
+    {
+      if (memcmp(&cache->entries[i].info.ap, bssid,
+                 sizeof(struct ether_addr)) == 0)
+        {
+          return &cache->entries[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: wapi_scan_cache_free
+ *
+ * Description:
+ *   Releases the buffer of the cache and empties it.
+ *
+ ****************************************************************************/
+
+void wapi_scan_cache_free(FAR struct wapi_scan_cache_s *cache)
+{
+  free(cache->buf);
+  cache->buf      = NULL;
+  cache->buflen   = 0;
+  cache->nentries = 0;
+}